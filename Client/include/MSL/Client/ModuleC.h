@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2019 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -25,8 +25,12 @@
  * @brief Shader module loading implementation for C.
  *
  * Modules can be read by stream with mslModule_readStream(), data pointer with
- * mslModule_readData(), or file with mslModule_readFile(). When finished with a module, call
- * mslModule_destroy() to destroy it.
+ * mslModule_readData(), or file with mslModule_readFile(). Files can also be memory mapped with
+ * mslModule_mapFile() and data buffers owned by the caller can be used directly with
+ * mslModule_wrapData() to avoid copying the data. Sectioned modules may also be opened with
+ * mslModule_openFile() or mslModule_openStream() to only read the reflection info up-front, reading
+ * the data for each shader with mslModule_readShaderData() when it's used. When finished with a
+ * module, call mslModule_destroy() to destroy it.
  *
  * The module will be created with a single allocation, the size of which can be queried with
  * mslModule_sizeof(). As a result of this implementation, most queries require computing an offset
@@ -80,6 +84,9 @@ MSL_CLIENT_EXPORT size_t mslModule_sizeof(size_t dataSize);
  * This will read exactly size bytes from the stream. This is used in order to allocate the proper
  * amount of data up-front and guarantee only a single allocation is done.
  *
+ * The module will be fully validated. Use mslModule_readStreamWithValidation() to choose the
+ * validation.
+ *
  * @param readFunc The function to read data from.
  * @param userData The user data to pass to the read function.
  * @param size The size of the data to read.
@@ -89,10 +96,27 @@ MSL_CLIENT_EXPORT size_t mslModule_sizeof(size_t dataSize);
 MSL_CLIENT_EXPORT mslModule* mslModule_readStream(mslReadFunction readFunc, void* userData,
 	size_t size, const mslAllocator* allocator);
 
+/**
+ * @brief Reads a shader module from a stream with the chosen validation.
+ *
+ * This is the same as mslModule_readStream(), but allows reducing the validation for trusted
+ * modules.
+ *
+ * @param readFunc The function to read data from.
+ * @param userData The user data to pass to the read function.
+ * @param size The size of the data to read.
+ * @param validation How much validation to perform on the module.
+ * @param allocator The allocator. If NULL, malloc will be used instead.
+ * @return The read shader module, or NULL if it couldn't be read. errno will be set on failure.
+ */
+MSL_CLIENT_EXPORT mslModule* mslModule_readStreamWithValidation(mslReadFunction readFunc,
+	void* userData, size_t size, mslValidation validation, const mslAllocator* allocator);
+
 /**
  * @brief Reads a shader module from a data buffer.
  *
- * This will copy the contents of the buffer into the created shader module.
+ * This will copy the contents of the buffer into the created shader module. The module will be
+ * fully validated. Use mslModule_readDataWithValidation() to choose the validation.
  *
  * @param data The data buffer to read from.
  * @param size The size of the data to read.
@@ -102,8 +126,49 @@ MSL_CLIENT_EXPORT mslModule* mslModule_readStream(mslReadFunction readFunc, void
 MSL_CLIENT_EXPORT mslModule* mslModule_readData(const void* data, size_t size,
 	const mslAllocator* allocator);
 
+/**
+ * @brief Reads a shader module from a data buffer with the chosen validation.
+ *
+ * This is the same as mslModule_readData(), but allows reducing the validation for trusted
+ * modules.
+ *
+ * @param data The data buffer to read from.
+ * @param size The size of the data to read.
+ * @param validation How much validation to perform on the module.
+ * @param allocator The allocator. If NULL, malloc will be used instead.
+ * @return The read shader module, or NULL if it couldn't be read. errno will be set on failure.
+ */
+MSL_CLIENT_EXPORT mslModule* mslModule_readDataWithValidation(const void* data, size_t size,
+	mslValidation validation, const mslAllocator* allocator);
+
+/**
+ * @brief Creates a shader module that references a data buffer without copying it.
+ *
+ * The data is verified in place and only the module metadata is allocated, which has the size
+ * mslModule_sizeof(0). The data must remain valid and unchanged until the module is destroyed, and
+ * must be aligned to 8 bytes.
+ *
+ * The data is never modified. When endian swapping is required, this will fall back to copying
+ * the data the same as mslModule_readDataWithValidation(). For SPIR-V modules with adjustable
+ * bindings, the data is copied with the allocator the first time mslModule_setUniformBinding() or
+ * mslModule_setUniformBindings() changes a binding, so the copy is only made when it's needed.
+ *
+ * @param data The data buffer to reference.
+ * @param size The size of the data.
+ * @param validation How much validation to perform on the module. This is also used when reading
+ *     shaders with mslModule_readShaderData().
+ * @param allocator The allocator. If NULL, malloc will be used instead.
+ * @return The shader module, or NULL if it couldn't be read. errno will be set on failure.
+ */
+MSL_CLIENT_EXPORT mslModule* mslModule_wrapData(const void* data, size_t size,
+	mslValidation validation, const mslAllocator* allocator);
+
 /**
  * @brief Reads a shader module from a file.
+ *
+ * The module will be fully validated. Use mslModule_readFileWithValidation() to choose the
+ * validation.
+ *
  * @param fileName The name of the file to read from.
  * @param allocator The allocator. If NULL, malloc will be used instead.
  * @return The read shader module, or NULL if it couldn't be read. errno will be set on failure.
@@ -111,6 +176,77 @@ MSL_CLIENT_EXPORT mslModule* mslModule_readData(const void* data, size_t size,
 MSL_CLIENT_EXPORT mslModule* mslModule_readFile(const char* fileName,
 	const mslAllocator* allocator);
 
+/**
+ * @brief Reads a shader module from a file with the chosen validation.
+ *
+ * This is the same as mslModule_readFile(), but allows reducing the validation for trusted
+ * modules.
+ *
+ * @param fileName The name of the file to read from.
+ * @param validation How much validation to perform on the module.
+ * @param allocator The allocator. If NULL, malloc will be used instead.
+ * @return The read shader module, or NULL if it couldn't be read. errno will be set on failure.
+ */
+MSL_CLIENT_EXPORT mslModule* mslModule_readFileWithValidation(const char* fileName,
+	mslValidation validation, const mslAllocator* allocator);
+
+/**
+ * @brief Maps a shader module from a file.
+ *
+ * The file is memory mapped read-only and verified in place, so the data isn't copied into memory
+ * up-front. Only the module metadata is allocated, which has the size mslModule_sizeof(0). The
+ * mapping is private, so if the data needs to be modified, such as for endian swapping or
+ * mslModule_setUniformBinding(), the modified pages are copied on write and the file is never
+ * changed. The mapping is released with mslModule_destroy().
+ *
+ * @param fileName The name of the file to map.
+ * @param validation How much validation to perform on the module.
+ * @param allocator The allocator. If NULL, malloc will be used instead.
+ * @return The mapped shader module, or NULL if it couldn't be mapped. errno will be set on
+ *     failure.
+ */
+MSL_CLIENT_EXPORT mslModule* mslModule_mapFile(const char* fileName, mslValidation validation,
+	const mslAllocator* allocator);
+
+/**
+ * @brief Opens a shader module from a stream, reading the shaders on demand.
+ *
+ * For sectioned modules, only the header and reflection info are read and validated, which has
+ * the size of the index within the module rather than the full module. The data for each shader
+ * is then read with mslModule_readShaderData(), and mslModule_shaderData() will return NULL.
+ * Modules that aren't sectioned are read in full the same as mslModule_readStream().
+ *
+ * The stream must remain valid until the module is destroyed. Reading shaders will seek within the
+ * stream, so it may not be accessed on multiple threads at once.
+ *
+ * @param readFunc The function to read data from.
+ * @param seekFunc The function to seek within the stream.
+ * @param userData The user data to pass to the read and seek functions.
+ * @param size The size of the full module within the stream.
+ * @param validation How much validation to perform on the module. This is also used when reading
+ *     shaders with mslModule_readShaderData().
+ * @param allocator The allocator. If NULL, malloc will be used instead.
+ * @return The opened shader module, or NULL if it couldn't be read. errno will be set on failure.
+ */
+MSL_CLIENT_EXPORT mslModule* mslModule_openStream(mslReadFunction readFunc,
+	mslSeekFunction seekFunc, void* userData, size_t size, mslValidation validation,
+	const mslAllocator* allocator);
+
+/**
+ * @brief Opens a shader module from a file, reading the shaders on demand.
+ *
+ * This is the same as mslModule_openStream(), keeping the file open until the module is
+ * destroyed if the module is sectioned.
+ *
+ * @param fileName The name of the file to open.
+ * @param validation How much validation to perform on the module. This is also used when reading
+ *     shaders with mslModule_readShaderData().
+ * @param allocator The allocator. If NULL, malloc will be used instead.
+ * @return The opened shader module, or NULL if it couldn't be read. errno will be set on failure.
+ */
+MSL_CLIENT_EXPORT mslModule* mslModule_openFile(const char* fileName, mslValidation validation,
+	const mslAllocator* allocator);
+
 /**
  * @brief Gets the file version of the module.
  * @param module The shader module.
@@ -139,6 +275,30 @@ MSL_CLIENT_EXPORT uint32_t mslModule_targetVersion(const mslModule* module);
  */
 MSL_CLIENT_EXPORT bool mslModule_adjustableBindings(const mslModule* module);
 
+/**
+ * @brief Gets whether or not the resources for each shader are placed in a Metal argument buffer.
+ *
+ * When true, the argument buffer is bound at buffer index 1 if the shader uses push constants,
+ * otherwise index 0. The uniform IDs are the IDs within the argument buffer, where sampled images
+ * use the following ID for the sampler.
+ *
+ * @param module The shader module.
+ * @return True if argument buffers are used.
+ */
+MSL_CLIENT_EXPORT bool mslModule_argumentBuffers(const mslModule* module);
+
+/**
+ * @brief Gets how the data for each shader is interpreted.
+ *
+ * This is always mslShaderDataFormat_Native for targets other than Metal. For Metal, the shader
+ * data is either a compiled MTLLibrary for each shader, the source for each shader, or the name
+ * of the function within the single MTLLibrary stored in the shared data.
+ *
+ * @param module The shader module.
+ * @return The shader data format.
+ */
+MSL_CLIENT_EXPORT mslShaderDataFormat mslModule_shaderDataFormat(const mslModule* module);
+
 /**
  * @brief Gets the number of pipelines within the shader module.
  * @param module The shader module.
@@ -156,6 +316,17 @@ MSL_CLIENT_EXPORT uint32_t mslModule_pipelineCount(const mslModule* module);
 MSL_CLIENT_EXPORT bool mslModule_pipeline(mslPipeline* outPipeline, const mslModule* module,
 	uint32_t pipelineIndex);
 
+/**
+ * @brief Finds a pipeline by name.
+ *
+ * This is a binary search for modules saved with name lookup tables, otherwise a linear search.
+ *
+ * @param module The shader module.
+ * @param name The name of the pipeline.
+ * @return The index of the pipeline, or MSL_UNKNOWN if not found.
+ */
+MSL_CLIENT_EXPORT uint32_t mslModule_findPipeline(const mslModule* module, const char* name);
+
 /**
  * @brief Gets the info for a struct within a pipeline.
  * @param[out] outStruct The structure to hold the struct info.
@@ -167,6 +338,32 @@ MSL_CLIENT_EXPORT bool mslModule_pipeline(mslPipeline* outPipeline, const mslMod
 MSL_CLIENT_EXPORT bool mslModule_struct(mslStruct* outStruct, const mslModule* module,
 	uint32_t pipelineIndex, uint32_t structIndex);
 
+/**
+ * @brief Gets the info for a range of structs within a pipeline in a single call.
+ * @param[out] outStructs The array to hold the struct info. This must have at least
+ *     structCount elements.
+ * @param module The shader module.
+ * @param pipelineIndex The index of the pipeline.
+ * @param firstStruct The index of the first struct.
+ * @param structCount The number of structs to get.
+ * @return False if the parameters are incorrect.
+ */
+MSL_CLIENT_EXPORT bool mslModule_structs(mslStruct* outStructs, const mslModule* module,
+	uint32_t pipelineIndex, uint32_t firstStruct, uint32_t structCount);
+
+/**
+ * @brief Finds a struct within a pipeline by name.
+ *
+ * This is a binary search for modules saved with name lookup tables, otherwise a linear search.
+ *
+ * @param module The shader module.
+ * @param pipelineIndex The index of the pipeline.
+ * @param name The name of the struct.
+ * @return The index of the struct, or MSL_UNKNOWN if not found.
+ */
+MSL_CLIENT_EXPORT uint32_t mslModule_findStruct(const mslModule* module, uint32_t pipelineIndex,
+	const char* name);
+
 /**
  * @brief Gets the info for a struct member within a pipeline.
  * @param[out] outStructMember The structure to hold the struct member info.
@@ -180,6 +377,21 @@ MSL_CLIENT_EXPORT bool mslModule_structMember(mslStructMember* outStructMember,
 	const mslModule* module, uint32_t pipelineIndex, uint32_t structIndex,
 	uint32_t structMemberIndex);
 
+/**
+ * @brief Gets the info for a range of members within a struct in a single call.
+ * @param[out] outStructMembers The array to hold the struct member info. This must have
+ *     at least memberCount elements.
+ * @param module The shader module.
+ * @param pipelineIndex The index of the pipeline.
+ * @param structIndex The index of the struct within the pipeline.
+ * @param firstMember The index of the first member.
+ * @param memberCount The number of members to get.
+ * @return False if the parameters are incorrect.
+ */
+MSL_CLIENT_EXPORT bool mslModule_structMembers(mslStructMember* outStructMembers,
+	const mslModule* module, uint32_t pipelineIndex, uint32_t structIndex, uint32_t firstMember,
+	uint32_t memberCount);
+
 /**
  * @brief Gets the array info for a struct member within a pipeline.
  * @param[out] outArrayInfo The structure to hold the struct member array info.
@@ -216,6 +428,32 @@ MSL_CLIENT_EXPORT bool mslModule_samplerState(mslSamplerState* outSamplerState,
 MSL_CLIENT_EXPORT bool mslModule_uniform(mslUniform* outUniform,
 	const mslModule* module, uint32_t pipelineIndex, uint32_t uniformIndex);
 
+/**
+ * @brief Gets the info for a range of uniforms within a pipeline in a single call.
+ * @param[out] outUniforms The array to hold the uniform info. This must have at least
+ *     uniformCount elements.
+ * @param module The shader module.
+ * @param pipelineIndex The index of the pipeline.
+ * @param firstUniform The index of the first uniform.
+ * @param uniformCount The number of uniforms to get.
+ * @return False if the parameters are incorrect.
+ */
+MSL_CLIENT_EXPORT bool mslModule_uniforms(mslUniform* outUniforms, const mslModule* module,
+	uint32_t pipelineIndex, uint32_t firstUniform, uint32_t uniformCount);
+
+/**
+ * @brief Finds a uniform within a pipeline by name.
+ *
+ * This is a binary search for modules saved with name lookup tables, otherwise a linear search.
+ *
+ * @param module The shader module.
+ * @param pipelineIndex The index of the pipeline.
+ * @param name The name of the uniform.
+ * @return The index of the uniform, or MSL_UNKNOWN if not found.
+ */
+MSL_CLIENT_EXPORT uint32_t mslModule_findUniform(const mslModule* module, uint32_t pipelineIndex,
+	const char* name);
+
 /**
  * @brief Gets the array info for a uniform within a pipeline.
  * @param[out] outArrayInfo The structure to hold the uniform array info.
@@ -239,6 +477,33 @@ MSL_CLIENT_EXPORT bool mslModule_uniformArrayInfo(mslArrayInfo* outArrayInfo,
 MSL_CLIENT_EXPORT bool mslModule_attribute(mslAttribute* outAttribute,
 	const mslModule* module, uint32_t pipelineIndex, uint32_t attributeIndex);
 
+/**
+ * @brief Gets the info for a range of attributes within a pipeline in a single call.
+ * @param[out] outAttributes The array to hold the attribute info. This must have at
+ *     least attributeCount elements.
+ * @param module The shader module.
+ * @param pipelineIndex The index of the pipeline.
+ * @param firstAttribute The index of the first attribute.
+ * @param attributeCount The number of attributes to get.
+ * @return False if the parameters are incorrect.
+ */
+MSL_CLIENT_EXPORT bool mslModule_attributes(mslAttribute* outAttributes,
+	const mslModule* module, uint32_t pipelineIndex, uint32_t firstAttribute,
+	uint32_t attributeCount);
+
+/**
+ * @brief Finds a vertex attribute within a pipeline by name.
+ *
+ * This is a binary search for modules saved with name lookup tables, otherwise a linear search.
+ *
+ * @param module The shader module.
+ * @param pipelineIndex The index of the pipeline.
+ * @param name The name of the attribute.
+ * @return The index of the attribute, or MSL_UNKNOWN if not found.
+ */
+MSL_CLIENT_EXPORT uint32_t mslModule_findAttribute(const mslModule* module,
+	uint32_t pipelineIndex, const char* name);
+
 /**
  * @brief Gets the info for a fragment output within a pipeline.
  * @param[out] outOutput The structure to hold the fragment output info.
@@ -250,6 +515,30 @@ MSL_CLIENT_EXPORT bool mslModule_attribute(mslAttribute* outAttribute,
 MSL_CLIENT_EXPORT bool mslModule_fragmentOutput(mslFragmentOutput* outOutput,
 	const mslModule* module, uint32_t pipelineIndex, uint32_t outputIndex);
 
+/**
+ * @brief Gets the info for a range of fragment outputs within a pipeline in a single call.
+ * @param[out] outOutputs The array to hold the fragment output info. This must have
+ *     at least outputCount elements.
+ * @param module The shader module.
+ * @param pipelineIndex The index of the pipeline.
+ * @param firstOutput The index of the first fragment output.
+ * @param outputCount The number of fragment outputs to get.
+ * @return False if the parameters are incorrect.
+ */
+MSL_CLIENT_EXPORT bool mslModule_fragmentOutputs(mslFragmentOutput* outOutputs,
+	const mslModule* module, uint32_t pipelineIndex, uint32_t firstOutput, uint32_t outputCount);
+
+/**
+ * @brief Gets the info for a specialization constant within a pipeline.
+ * @param[out] outConstant The structure to hold the specialization constant info.
+ * @param module The shader module.
+ * @param pipelineIndex The index of the pipeline.
+ * @param constantIndex The index of the specialization constant within the pipeline.
+ * @return False if the parameters are incorrect.
+ */
+MSL_CLIENT_EXPORT bool mslModule_specializationConstant(mslSpecializationConstant* outConstant,
+	const mslModule* module, uint32_t pipelineIndex, uint32_t constantIndex);
+
 /**
  * @brief Gets the array length for a vertex attribute within a pipeline.
  * @param module The shader module.
@@ -295,6 +584,10 @@ MSL_CLIENT_EXPORT uint32_t mslModule_shaderUniformId(const mslModule* module,
  * shaders. This will adjust the descriptor set and binding indices within the SPIR-V for each stage
  * within the pipeline, as well as update the indices requested with mslModule_uniform().
  *
+ * Compressed or encoded shaders and modules opened with mslModule_openFile() or
+ * mslModule_openStream() that read the shaders on demand can't be modified in place. Use
+ * mslModule_setUniformBindingCopy() with the data from mslModule_readShaderData() instead.
+ *
  * @param module The shader module.
  * @param pipelineIndex The index of the pipeline.
  * @param uniformIndex The index of the uniform within the pipeline.
@@ -325,6 +618,46 @@ MSL_CLIENT_EXPORT bool mslModule_setUniformBindingCopy(const mslModule* module,
 	uint32_t pipelineIndex, uint32_t uniformIndex, uint32_t descriptorSet, uint32_t binding,
 	mslSizedData shaderData[mslStage_Count]);
 
+/**
+ * @brief Sets the descriptor sets and bindings for all uniforms within a pipeline.
+ *
+ * This is equivalent to calling mslModule_setUniformBinding() for each uniform, but only looks up
+ * the shader data once. Modules saved by newer versions of the compiler store the location of
+ * each decoration, allowing the SPIR-V to be patched without scanning the instructions.
+ *
+ * All uniforms are checked before any are modified, so the pipeline is left unchanged on failure.
+ *
+ * @param module The shader module.
+ * @param pipelineIndex The index of the pipeline.
+ * @param descriptorSets The new descriptor set for each uniform. This must have
+ *     mslModule_uniformCount() elements.
+ * @param bindings The new binding index for each uniform. This must have mslModule_uniformCount()
+ *     elements.
+ * @return False if the parameters are incorrect or the bindings aren't adjustable.
+ */
+MSL_CLIENT_EXPORT bool mslModule_setUniformBindings(mslModule* module, uint32_t pipelineIndex,
+	const uint32_t* descriptorSets, const uint32_t* bindings);
+
+/**
+ * @brief Sets the descriptor sets and bindings for all uniforms within a copy of the shader data
+ * for a pipeline.
+ *
+ * This is equivalent to calling mslModule_setUniformBindingCopy() for each uniform.
+ *
+ * @param module The shader module.
+ * @param pipelineIndex The index of the pipeline.
+ * @param descriptorSets The new descriptor set for each uniform. This must have
+ *     mslModule_uniformCount() elements.
+ * @param bindings The new binding index for each uniform. This must have mslModule_uniformCount()
+ *     elements.
+ * @param shaderData The data for the shader stages. This must have come from the original shader
+ *     data.
+ * @return False if the parameters are incorrect.
+ */
+MSL_CLIENT_EXPORT bool mslModule_setUniformBindingsCopy(const mslModule* module,
+	uint32_t pipelineIndex, const uint32_t* descriptorSets, const uint32_t* bindings,
+	mslSizedData shaderData[mslStage_Count]);
+
 /**
  * @brief Gets number of shaders within the module.
  * @param module The shader module.
@@ -336,18 +669,60 @@ MSL_CLIENT_EXPORT uint32_t mslModule_shaderCount(const mslModule* module);
  * @brief Gets the size of a shader within the module.
  * @param module The shader module.
  * @param shaderIndex The index of the shader.
- * @return The size of the shader in bytes.
+ * @return The size of the shader in bytes. This is the size once decompressed and decoded for
+ *     compressed or encoded shaders.
  */
 MSL_CLIENT_EXPORT uint32_t mslModule_shaderSize(const mslModule* module, uint32_t shaderIndex);
 
 /**
  * @brief Gets the data of a shader within the module.
+ *
+ * The contents depend on mslModule_shaderDataFormat(). For Metal modules compiled with a shared
+ * library, the data is the null-terminated name of the function to get from the single
+ * MTLLibrary created from mslModule_sharedData(). For Metal modules compiled as source only, the
+ * data is null-terminated source to create an MTLLibrary from. Otherwise the data is SPIR-V, GLSL
+ * source, or a separate MTLLibrary for each shader based on the target.
+ *
  * @param module The shader module.
  * @param shaderIndex The index of the shader.
- * @return The data for the shader.
+ * @return The data for the shader, or NULL if the shader is compressed or encoded, or the module
+ *     was opened with mslModule_openFile() or mslModule_openStream() and the shader data isn't in
+ *     memory. Use mslModule_readShaderData() in these cases.
  */
 MSL_CLIENT_EXPORT const void* mslModule_shaderData(const mslModule* module, uint32_t shaderIndex);
 
+/**
+ * @brief Reads the data of a shader within the module into a buffer.
+ *
+ * This works for any module, but is primarily used for sectioned modules opened with
+ * mslModule_openFile() or mslModule_openStream() to read the shader from the stream when it's
+ * used and for compressed or encoded shaders. Compressed shaders are decompressed into outData,
+ * and when read from a stream are decompressed as they're read without an intermediate buffer.
+ * Encoded SPIR-V is decoded after decompressing, in place within outData. The checksum for the
+ * shader is checked unless the module was loaded with mslValidation_None.
+ *
+ * @param[out] outData The buffer to read into. This must have mslModule_shaderSize() bytes.
+ * @param module The shader module.
+ * @param shaderIndex The index of the shader.
+ * @return False if the shader couldn't be read. errno will be set on failure.
+ */
+MSL_CLIENT_EXPORT bool mslModule_readShaderData(void* outData, const mslModule* module,
+	uint32_t shaderIndex);
+
+/**
+ * @brief Gets the alignment guaranteed for the data of every shader within the module.
+ *
+ * Modules saved by the compiler align the data for each shader based on the shader-alignment
+ * option, which is at least 4 bytes. The returned value also accounts for the alignment of the
+ * memory the module was loaded into: memory mapped modules keep the full alignment, while modules
+ * that were copied are limited by the alignment of the allocator. When the alignment is at least
+ * what the graphics API requires, the shader data may be passed directly without copying.
+ *
+ * @param module The shader module.
+ * @return The alignment in bytes. This will be 1 for modules saved without aligned shader data.
+ */
+MSL_CLIENT_EXPORT uint32_t mslModule_shaderAlignment(const mslModule* module);
+
 /**
  * @brief Gets whether or not a shader uses push constants
  * @param module The shader module.
@@ -366,11 +741,113 @@ MSL_CLIENT_EXPORT uint32_t mslModule_sharedDataSize(const mslModule* module);
 
 /**
  * @brief Gets the shared data within the module.
+ *
+ * When mslModule_shaderDataFormat() is mslShaderDataFormat_LibraryFunction, this is the single
+ * MTLLibrary containing the functions for every shader in the module.
+ *
  * @param module The shader module.
  * @return The shared data.
  */
 MSL_CLIENT_EXPORT const void* mslModule_sharedData(const mslModule* module);
 
+/**
+ * @brief Gets the number of keywords used to compile variants of the pipelines.
+ * @param module The shader module.
+ * @return The number of variant keywords, or 0 if the module wasn't compiled with variants.
+ */
+MSL_CLIENT_EXPORT uint32_t mslModule_variantKeywordCount(const mslModule* module);
+
+/**
+ * @brief Gets the name of a variant keyword.
+ * @param module The shader module.
+ * @param keywordIndex The index of the keyword.
+ * @return The name of the keyword, or NULL if the parameters are incorrect.
+ */
+MSL_CLIENT_EXPORT const char* mslModule_variantKeywordName(const mslModule* module,
+	uint32_t keywordIndex);
+
+/**
+ * @brief Gets the number of values for a variant keyword.
+ * @param module The shader module.
+ * @param keywordIndex The index of the keyword.
+ * @return The number of values, or 0 if the parameters are incorrect.
+ */
+MSL_CLIENT_EXPORT uint32_t mslModule_variantKeywordValueCount(const mslModule* module,
+	uint32_t keywordIndex);
+
+/**
+ * @brief Gets a value for a variant keyword.
+ * @param module The shader module.
+ * @param keywordIndex The index of the keyword.
+ * @param valueIndex The index of the value.
+ * @return The value, or NULL if the parameters are incorrect.
+ */
+MSL_CLIENT_EXPORT const char* mslModule_variantKeywordValue(const mslModule* module,
+	uint32_t keywordIndex, uint32_t valueIndex);
+
+/**
+ * @brief Gets the number of permutations of the variant keyword values.
+ * @param module The shader module.
+ * @return The number of permutations, or 0 if the module wasn't compiled with variants or the
+ *     number of permutations is too large.
+ */
+MSL_CLIENT_EXPORT uint32_t mslModule_variantPermutationCount(const mslModule* module);
+
+/**
+ * @brief Gets the permutation index for a set of variant keyword values.
+ *
+ * The permutation index is the index of the value for each keyword multiplied by the product of
+ * the value counts for the previous keywords. The result may be cached and passed to
+ * mslModule_variantPipeline() for each pipeline.
+ *
+ * @param module The shader module.
+ * @param valueIndices The index of the value for each keyword. This must have
+ *     mslModule_variantKeywordCount() elements.
+ * @return The permutation index, or MSL_UNKNOWN if the parameters are incorrect or the number of
+ *     permutations is too large.
+ */
+MSL_CLIENT_EXPORT uint32_t mslModule_variantPermutationIndex(const mslModule* module,
+	const uint32_t* valueIndices);
+
+/**
+ * @brief Gets the number of pipelines in the source file that variants were compiled for.
+ * @param module The shader module.
+ * @return The number of variants.
+ */
+MSL_CLIENT_EXPORT uint32_t mslModule_variantCount(const mslModule* module);
+
+/**
+ * @brief Gets the name of the pipeline in the source file for a variant.
+ * @param module The shader module.
+ * @param variantIndex The index of the variant.
+ * @return The name of the pipeline, or NULL if the parameters are incorrect.
+ */
+MSL_CLIENT_EXPORT const char* mslModule_variantName(const mslModule* module,
+	uint32_t variantIndex);
+
+/**
+ * @brief Finds a variant by the name of the pipeline in the source file.
+ * @param module The shader module.
+ * @param name The name of the pipeline.
+ * @return The index of the variant, or MSL_UNKNOWN if not found.
+ */
+MSL_CLIENT_EXPORT uint32_t mslModule_findVariant(const mslModule* module, const char* name);
+
+/**
+ * @brief Gets the pipeline compiled for a permutation of a variant.
+ *
+ * This is a constant time lookup.
+ *
+ * @param module The shader module.
+ * @param variantIndex The index of the variant.
+ * @param permutationIndex The permutation index, as returned from
+ *     mslModule_variantPermutationIndex().
+ * @return The index of the pipeline, or MSL_UNKNOWN if the parameters are incorrect or the
+ *     pipeline doesn't exist for the permutation.
+ */
+MSL_CLIENT_EXPORT uint32_t mslModule_variantPipeline(const mslModule* module,
+	uint32_t variantIndex, uint32_t permutationIndex);
+
 /**
  * @brief Destroys a shader module.
  * @param module The module to destroy.
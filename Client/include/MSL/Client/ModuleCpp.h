@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2019 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -85,9 +85,10 @@ public:
 	 * will be destroyed.
 	 *
 	 * @param stream The stream to read from.
+	 * @param validation How much validation to perform on the module.
 	 * @return False if the module couldn't be read.
 	 */
-	bool read(std::istream& stream);
+	bool read(std::istream& stream, mslValidation validation = mslValidation_Full);
 
 	/**
 	 * @brief Reads the module from a stream.
@@ -97,9 +98,10 @@ public:
 	 *
 	 * @param stream The stream to read from.
 	 * @param size The size of the data to read.
+	 * @param validation How much validation to perform on the module.
 	 * @return False if the module couldn't be read.
 	 */
-	bool read(std::istream& stream, size_t size);
+	bool read(std::istream& stream, size_t size, mslValidation validation = mslValidation_Full);
 
 	/**
 	 * @brief Reads the module from a data buffer.
@@ -108,9 +110,23 @@ public:
 	 *
 	 * @param data The data to read from.
 	 * @param size The size of the data.
+	 * @param validation How much validation to perform on the module.
 	 * @return False if the module couldn't be read.
 	 */
-	bool read(const void* data, size_t size);
+	bool read(const void* data, size_t size, mslValidation validation = mslValidation_Full);
+
+	/**
+	 * @brief Creates the module referencing a data buffer without copying it.
+	 *
+	 * The data must remain valid and unchanged for the lifetime of the module. See
+	 * mslModule_wrapData() for details. The previous contents of the module will be destroyed.
+	 *
+	 * @param data The data to reference.
+	 * @param size The size of the data.
+	 * @param validation How much validation to perform on the module.
+	 * @return False if the module couldn't be read.
+	 */
+	bool wrap(const void* data, size_t size, mslValidation validation = mslValidation_Full);
 
 	/**
 	 * @brief Reads the module from a file.
@@ -118,9 +134,10 @@ public:
 	 * The previous contents of the module will be destroyed.
 	 *
 	 * @param fileName The name of the file to read from.
+	 * @param validation How much validation to perform on the module.
 	 * @return False if the module couldn't be read.
 	 */
-	bool read(const char* fileName);
+	bool read(const char* fileName, mslValidation validation = mslValidation_Full);
 
 	/**
 	 * @brief Reads the module from a file.
@@ -128,9 +145,69 @@ public:
 	 * The previous contents of the module will be destroyed.
 	 *
 	 * @param fileName The name of the file to read from.
+	 * @param validation How much validation to perform on the module.
 	 * @return False if the module couldn't be read.
 	 */
-	bool read(const std::string& fileName);
+	bool read(const std::string& fileName, mslValidation validation = mslValidation_Full);
+
+	/**
+	 * @brief Maps the module from a file.
+	 *
+	 * The file is memory mapped and verified in place rather than copied into memory. See
+	 * mslModule_mapFile() for details. The previous contents of the module will be destroyed.
+	 *
+	 * @param fileName The name of the file to map.
+	 * @param validation How much validation to perform on the module.
+	 * @return False if the module couldn't be mapped.
+	 */
+	bool mapFile(const char* fileName, mslValidation validation = mslValidation_Full);
+
+	/**
+	 * @brief Maps the module from a file.
+	 *
+	 * The file is memory mapped and verified in place rather than copied into memory. See
+	 * mslModule_mapFile() for details. The previous contents of the module will be destroyed.
+	 *
+	 * @param fileName The name of the file to map.
+	 * @param validation How much validation to perform on the module.
+	 * @return False if the module couldn't be mapped.
+	 */
+	bool mapFile(const std::string& fileName, mslValidation validation = mslValidation_Full);
+
+	/**
+	 * @brief Opens the module from a stream, reading the shaders on demand.
+	 *
+	 * For sectioned modules, only the reflection info is read up-front and shaders are read with
+	 * readShaderData(). The stream must remain valid until the module is destroyed. See
+	 * mslModule_openStream() for details. The previous contents of the module will be destroyed.
+	 *
+	 * @param stream The stream to read from.
+	 * @param validation How much validation to perform on the module.
+	 * @return False if the module couldn't be read.
+	 */
+	bool open(std::istream& stream, mslValidation validation = mslValidation_Full);
+
+	/**
+	 * @brief Opens the module from a file, reading the shaders on demand.
+	 *
+	 * See mslModule_openFile() for details. The previous contents of the module will be destroyed.
+	 *
+	 * @param fileName The name of the file to open.
+	 * @param validation How much validation to perform on the module.
+	 * @return False if the module couldn't be read.
+	 */
+	bool open(const char* fileName, mslValidation validation = mslValidation_Full);
+
+	/**
+	 * @brief Opens the module from a file, reading the shaders on demand.
+	 *
+	 * See mslModule_openFile() for details. The previous contents of the module will be destroyed.
+	 *
+	 * @param fileName The name of the file to open.
+	 * @param validation How much validation to perform on the module.
+	 * @return False if the module couldn't be read.
+	 */
+	bool open(const std::string& fileName, mslValidation validation = mslValidation_Full);
 
 	/**
 	 * @brief Gets the file version of the module.
@@ -156,6 +233,19 @@ public:
 	 */
 	bool adjustableBindings() const;
 
+	/**
+	 * @brief Gets whether or not the resources for each shader are placed in a Metal argument
+	 *     buffer.
+	 * @return True if argument buffers are used.
+	 */
+	bool argumentBuffers() const;
+
+	/**
+	 * @brief Gets how the data for each shader is interpreted.
+	 * @return The shader data format.
+	 */
+	mslShaderDataFormat shaderDataFormat() const;
+
 	/**
 	 * @brief Gets the number of pipelines within the shader module.
 	 * @return The number of pipelines.
@@ -170,6 +260,13 @@ public:
 	 */
 	bool pipeline(Pipeline& outPipeline, uint32_t pipelineIndex) const;
 
+	/**
+	 * @brief Finds a pipeline by name.
+	 * @param name The name of the pipeline.
+	 * @return The index of the pipeline, or unknown if not found.
+	 */
+	uint32_t findPipeline(const char* name) const;
+
 	/**
 	 * @brief Gets the info for a struct within a pipeline.
 	 * @param[out] outStruct The structure to hold the struct info.
@@ -179,6 +276,26 @@ public:
 	 */
 	bool pipelineStruct(Struct& outStruct, uint32_t pipelineIndex, uint32_t structIndex) const;
 
+	/**
+	 * @brief Gets the info for a range of structs within a pipeline in a single call.
+	 * @param[out] outStructs The array to hold the struct info. This must have at least structCount
+	 *     elements.
+	 * @param pipelineIndex The index of the pipeline.
+	 * @param firstStruct The index of the first struct.
+	 * @param structCount The number of structs to get.
+	 * @return False if the parameters are incorrect.
+	 */
+	bool pipelineStructs(Struct* outStructs, uint32_t pipelineIndex, uint32_t firstStruct,
+		uint32_t structCount) const;
+
+	/**
+	 * @brief Finds a struct within a pipeline by name.
+	 * @param pipelineIndex The index of the pipeline.
+	 * @param name The name of the struct.
+	 * @return The index of the struct, or unknown if not found.
+	 */
+	uint32_t findStruct(uint32_t pipelineIndex, const char* name) const;
+
 	/**
 	 * @brief Gets the info for a struct member within a pipeline.
 	 * @param[out] outStructMember The structure to hold the struct member info.
@@ -190,6 +307,19 @@ public:
 	bool structMember(StructMember& outStructMember, uint32_t pipelineIndex, uint32_t structIndex,
 		uint32_t structMemberIndex) const;
 
+	/**
+	 * @brief Gets the info for a range of members within a struct in a single call.
+	 * @param[out] outStructMembers The array to hold the struct member info. This must have at
+	 *     least memberCount elements.
+	 * @param pipelineIndex The index of the pipeline.
+	 * @param structIndex The index of the struct within the pipeline.
+	 * @param firstMember The index of the first struct member.
+	 * @param memberCount The number of members to get.
+	 * @return False if the parameters are incorrect.
+	 */
+	bool structMembers(StructMember* outStructMembers, uint32_t pipelineIndex, uint32_t structIndex,
+		uint32_t firstMember, uint32_t memberCount) const;
+
 	/**
 	 * @brief Gets the array info for a struct member within a pipeline.
 	 * @param[out] outArrayInfo The structure to hold the struct member array info.
@@ -221,6 +351,26 @@ public:
 	 */
 	bool uniform(Uniform& outUniform, uint32_t pipelineIndex, uint32_t uniformIndex) const;
 
+	/**
+	 * @brief Gets the info for a range of uniforms within a pipeline in a single call.
+	 * @param[out] outUniforms The array to hold the uniform info. This must have at least
+	 *     uniformCount elements.
+	 * @param pipelineIndex The index of the pipeline.
+	 * @param firstUniform The index of the first uniform.
+	 * @param uniformCount The number of uniforms to get.
+	 * @return False if the parameters are incorrect.
+	 */
+	bool uniforms(Uniform* outUniforms, uint32_t pipelineIndex, uint32_t firstUniform,
+		uint32_t uniformCount) const;
+
+	/**
+	 * @brief Finds a uniform within a pipeline by name.
+	 * @param pipelineIndex The index of the pipeline.
+	 * @param name The name of the uniform.
+	 * @return The index of the uniform, or unknown if not found.
+	 */
+	uint32_t findUniform(uint32_t pipelineIndex, const char* name) const;
+
 	/**
 	 * @brief Gets the array info for a uniform within a pipeline.
 	 * @param[out] outArrayInfo The structure to hold the uniform array info.
@@ -241,6 +391,26 @@ public:
 	 */
 	bool attribute(Attribute& outAttribute, uint32_t pipelineIndex, uint32_t attributeIndex) const;
 
+	/**
+	 * @brief Gets the info for a range of attributes within a pipeline in a single call.
+	 * @param[out] outAttributes The array to hold the attribute info. This must have at least
+	 *     attributeCount elements.
+	 * @param pipelineIndex The index of the pipeline.
+	 * @param firstAttribute The index of the first attribute.
+	 * @param attributeCount The number of attributes to get.
+	 * @return False if the parameters are incorrect.
+	 */
+	bool attributes(Attribute* outAttributes, uint32_t pipelineIndex, uint32_t firstAttribute,
+		uint32_t attributeCount) const;
+
+	/**
+	 * @brief Finds a vertex attribute within a pipeline by name.
+	 * @param pipelineIndex The index of the pipeline.
+	 * @param name The name of the attribute.
+	 * @return The index of the attribute, or unknown if not found.
+	 */
+	uint32_t findAttribute(uint32_t pipelineIndex, const char* name) const;
+
 	/**
 	 * @brief Gets the info for a fragment output within a pipeline.
 	 * @param[out] outOutput The structure to hold the fragment output info.
@@ -251,6 +421,28 @@ public:
 	bool fragmentOutput(FragmentOutput& outOutput, uint32_t pipelineIndex,
 		uint32_t outputIndex) const;
 
+	/**
+	 * @brief Gets the info for a range of fragment outputs within a pipeline in a single call.
+	 * @param[out] outOutputs The array to hold the fragment output info. This must have at least
+	 *     outputCount elements.
+	 * @param pipelineIndex The index of the pipeline.
+	 * @param firstOutput The index of the first fragment output.
+	 * @param outputCount The number of fragment outputs to get.
+	 * @return False if the parameters are incorrect.
+	 */
+	bool fragmentOutputs(FragmentOutput* outOutputs, uint32_t pipelineIndex, uint32_t firstOutput,
+		uint32_t outputCount) const;
+
+	/**
+	 * @brief Gets the info for a specialization constant within a pipeline.
+	 * @param[out] outConstant The structure to hold the specialization constant info.
+	 * @param pipelineIndex The index of the pipeline.
+	 * @param constantIndex The index of the specialization constant within the pipeline.
+	 * @return False if the parameters are incorrect.
+	 */
+	bool specializationConstant(SpecializationConstant& outConstant, uint32_t pipelineIndex,
+		uint32_t constantIndex) const;
+
 	/**
 	 * @brief Gets the array length for a vertex attribute within a pipeline.
 	 * @param pipelineIndex The index of the pipeline.
@@ -319,6 +511,38 @@ public:
 	bool setUniformBinding(uint32_t pipelineIndex, uint32_t uniformIndex, uint32_t descriptorSet,
 		uint32_t binding, SizedData shaderData[mslStage_Count]);
 
+	/**
+	 * @brief Sets the descriptor sets and bindings for all uniforms within a pipeline.
+	 *
+	 * This is equivalent to calling setUniformBinding() for each uniform, but only looks up the
+	 * shader data once.
+	 *
+	 * @param pipelineIndex The index of the pipeline.
+	 * @param descriptorSets The new descriptor set for each uniform. This must have
+	 *     uniformCount() elements.
+	 * @param bindings The new binding index for each uniform. This must have uniformCount()
+	 *     elements.
+	 * @return False if the parameters are incorrect or the bindings aren't adjustable.
+	 */
+	bool setUniformBindings(uint32_t pipelineIndex, const uint32_t* descriptorSets,
+		const uint32_t* bindings);
+
+	/**
+	 * @brief Sets the descriptor sets and bindings for all uniforms within a copy of the shader
+	 * data for a pipeline.
+	 *
+	 * @param pipelineIndex The index of the pipeline.
+	 * @param descriptorSets The new descriptor set for each uniform. This must have
+	 *     uniformCount() elements.
+	 * @param bindings The new binding index for each uniform. This must have uniformCount()
+	 *     elements.
+	 * @param shaderData The data for the shader stages. This must match have come from the original
+	 *     shader data.
+	 * @return False if the parameters are incorrect.
+	 */
+	bool setUniformBindings(uint32_t pipelineIndex, const uint32_t* descriptorSets,
+		const uint32_t* bindings, SizedData shaderData[mslStage_Count]);
+
 	/**
 	 * @brief Gets number of shaders within the module.
 	 * @return The number of shaders.
@@ -334,11 +558,40 @@ public:
 
 	/**
 	 * @brief Gets the data of a shader within the module.
+	 *
+	 * The contents depend on shaderDataFormat(). For Metal modules compiled with a shared library,
+	 * the data is the null-terminated name of the function within the MTLLibrary stored in
+	 * sharedData().
+	 *
 	 * @param shader The index of the shader.
-	 * @return The data for the shader.
+	 * @return The data for the shader, or nullptr if the shader is compressed, encoded, or hasn't
+	 *     been read for a module opened with open().
 	 */
 	const void* shaderData(uint32_t shader) const;
 
+	/**
+	 * @brief Gets the alignment guaranteed for the data of every shader within the module.
+	 *
+	 * This accounts for both the alignment the module was saved with and the alignment of the
+	 * memory the module was loaded into.
+	 *
+	 * @return The alignment in bytes. This will be 1 for modules saved without aligned shader
+	 *     data.
+	 */
+	uint32_t shaderAlignment() const;
+
+	/**
+	 * @brief Reads the data of a shader within the module into a buffer.
+	 *
+	 * This is primarily used for modules opened with open() to read the shader when it's used and
+	 * to decompress and decode compressed or encoded shaders.
+	 *
+	 * @param[out] outData The buffer to read into. This must have shaderSize() bytes.
+	 * @param shader The index of the shader.
+	 * @return False if the shader couldn't be read.
+	 */
+	bool readShaderData(void* outData, uint32_t shader) const;
+
 	/**
 	 * @brief Gets whether or not a shader uses push constants
 	 * @param shader The index of the shader.
@@ -354,14 +607,90 @@ public:
 
 	/**
 	 * @brief Gets the shared data within the module.
+	 *
+	 * This is the single MTLLibrary for every shader when shaderDataFormat() is
+	 * mslShaderDataFormat_LibraryFunction.
+	 *
 	 * @return The shared data.
 	 */
 	const void* sharedData() const;
 
+	/**
+	 * @brief Gets the number of keywords used to compile variants of the pipelines.
+	 * @return The number of variant keywords, or 0 if the module wasn't compiled with variants.
+	 */
+	uint32_t variantKeywordCount() const;
+
+	/**
+	 * @brief Gets the name of a variant keyword.
+	 * @param keywordIndex The index of the keyword.
+	 * @return The name of the keyword, or nullptr if the parameters are incorrect.
+	 */
+	const char* variantKeywordName(uint32_t keywordIndex) const;
+
+	/**
+	 * @brief Gets the number of values for a variant keyword.
+	 * @param keywordIndex The index of the keyword.
+	 * @return The number of values, or 0 if the parameters are incorrect.
+	 */
+	uint32_t variantKeywordValueCount(uint32_t keywordIndex) const;
+
+	/**
+	 * @brief Gets a value for a variant keyword.
+	 * @param keywordIndex The index of the keyword.
+	 * @param valueIndex The index of the value.
+	 * @return The value, or nullptr if the parameters are incorrect.
+	 */
+	const char* variantKeywordValue(uint32_t keywordIndex, uint32_t valueIndex) const;
+
+	/**
+	 * @brief Gets the number of permutations of the variant keyword values.
+	 * @return The number of permutations, or 0 if the module wasn't compiled with variants.
+	 */
+	uint32_t variantPermutationCount() const;
+
+	/**
+	 * @brief Gets the permutation index for a set of variant keyword values.
+	 * @param valueIndices The index of the value for each keyword. This must have
+	 *     variantKeywordCount() elements.
+	 * @return The permutation index, or unknown if the parameters are incorrect.
+	 */
+	uint32_t variantPermutationIndex(const uint32_t* valueIndices) const;
+
+	/**
+	 * @brief Gets the number of pipelines in the source file that variants were compiled for.
+	 * @return The number of variants.
+	 */
+	uint32_t variantCount() const;
+
+	/**
+	 * @brief Gets the name of the pipeline in the source file for a variant.
+	 * @param variantIndex The index of the variant.
+	 * @return The name of the pipeline, or nullptr if the parameters are incorrect.
+	 */
+	const char* variantName(uint32_t variantIndex) const;
+
+	/**
+	 * @brief Finds a variant by the name of the pipeline in the source file.
+	 * @param name The name of the pipeline.
+	 * @return The index of the variant, or unknown if not found.
+	 */
+	uint32_t findVariant(const char* name) const;
+
+	/**
+	 * @brief Gets the pipeline compiled for a permutation of a variant.
+	 * @param variantIndex The index of the variant.
+	 * @param permutationIndex The permutation index, as returned from variantPermutationIndex().
+	 * @return The index of the pipeline, or unknown if the parameters are incorrect or the
+	 *     pipeline doesn't exist for the permutation.
+	 */
+	uint32_t variantPipeline(uint32_t variantIndex, uint32_t permutationIndex) const;
+
 private:
 	static void* allocateFunc(void* userData, size_t size);
 	static void freeFunc(void* userData, void* ptr);
 	static size_t readFunc(void* userData, void* buffer, size_t size);
+	static bool seekFunc(void* userData, size_t offset);
 
 	mslModule* m_module;
 	size_t m_size;
@@ -445,7 +774,7 @@ const Allocator& BasicModule<Allocator>::allocator() const
 }
 
 template <typename Allocator>
-bool BasicModule<Allocator>::read(std::istream& stream)
+bool BasicModule<Allocator>::read(std::istream& stream, mslValidation validation)
 {
 	mslModule_destroy(m_module);
 	m_module = nullptr;
@@ -456,35 +785,48 @@ bool BasicModule<Allocator>::read(std::istream& stream)
 	if (!stream.seekg(0))
 		return false;
 
-	return read(stream, size);
+	return read(stream, size, validation);
 }
 
 template <typename Allocator>
-bool BasicModule<Allocator>::read(std::istream& stream, size_t size)
+bool BasicModule<Allocator>::read(std::istream& stream, size_t size, mslValidation validation)
 {
 	mslModule_destroy(m_module);
 	m_module = nullptr;
 
 	mslAllocator alloc = {&allocateFunc, &freeFunc, this};
 	m_size = mslModule_sizeof(size);
-	m_module = mslModule_readStream(&readFunc, &stream, size, &alloc);
+	m_module = mslModule_readStreamWithValidation(&readFunc, &stream, size, validation,
+		&alloc);
 	return m_module != nullptr;
 }
 
 template <typename Allocator>
-bool BasicModule<Allocator>::read(const void* data, size_t size)
+bool BasicModule<Allocator>::read(const void* data, size_t size, mslValidation validation)
 {
 	mslModule_destroy(m_module);
 	m_module = nullptr;
 
 	mslAllocator alloc = {&allocateFunc, &freeFunc, this};
 	m_size = mslModule_sizeof(size);
-	m_module = mslModule_readData(data, size, &alloc);
+	m_module = mslModule_readDataWithValidation(data, size, validation, &alloc);
+	return m_module != nullptr;
+}
+
+template <typename Allocator>
+bool BasicModule<Allocator>::wrap(const void* data, size_t size, mslValidation validation)
+{
+	mslModule_destroy(m_module);
+	m_module = nullptr;
+
+	// The allocated size depends on whether the data is copied, which is tracked in allocateFunc.
+	mslAllocator alloc = {&allocateFunc, &freeFunc, this};
+	m_module = mslModule_wrapData(data, size, validation, &alloc);
 	return m_module != nullptr;
 }
 
 template <typename Allocator>
-bool BasicModule<Allocator>::read(const char* fileName)
+bool BasicModule<Allocator>::read(const char* fileName, mslValidation validation)
 {
 	mslModule_destroy(m_module);
 	m_module = nullptr;
@@ -493,13 +835,68 @@ bool BasicModule<Allocator>::read(const char* fileName)
 	if (!stream.is_open())
 		return false;
 
-	return read(stream);
+	return read(stream, validation);
+}
+
+template <typename Allocator>
+bool BasicModule<Allocator>::read(const std::string& fileName, mslValidation validation)
+{
+	return read(fileName.c_str(), validation);
+}
+
+template <typename Allocator>
+bool BasicModule<Allocator>::mapFile(const char* fileName, mslValidation validation)
+{
+	mslModule_destroy(m_module);
+	m_module = nullptr;
+
+	mslAllocator alloc = {&allocateFunc, &freeFunc, this};
+	m_size = mslModule_sizeof(0);
+	m_module = mslModule_mapFile(fileName, validation, &alloc);
+	return m_module != nullptr;
 }
 
 template <typename Allocator>
-bool BasicModule<Allocator>::read(const std::string& fileName)
+bool BasicModule<Allocator>::mapFile(const std::string& fileName, mslValidation validation)
 {
-	return read(fileName.c_str());
+	return mapFile(fileName.c_str(), validation);
+}
+
+template <typename Allocator>
+bool BasicModule<Allocator>::open(std::istream& stream, mslValidation validation)
+{
+	mslModule_destroy(m_module);
+	m_module = nullptr;
+
+	if (!stream.seekg(0, std::istream::end))
+		return false;
+	size_t size = static_cast<size_t>(stream.tellg());
+	if (!stream.seekg(0))
+		return false;
+
+	// The allocated size depends on whether the module is sectioned, which is tracked in
+	// allocateFunc.
+	mslAllocator alloc = {&allocateFunc, &freeFunc, this};
+	m_module = mslModule_openStream(&readFunc, &seekFunc, &stream, size, validation,
+		&alloc);
+	return m_module != nullptr;
+}
+
+template <typename Allocator>
+bool BasicModule<Allocator>::open(const char* fileName, mslValidation validation)
+{
+	mslModule_destroy(m_module);
+	m_module = nullptr;
+
+	mslAllocator alloc = {&allocateFunc, &freeFunc, this};
+	m_module = mslModule_openFile(fileName, validation, &alloc);
+	return m_module != nullptr;
+}
+
+template <typename Allocator>
+bool BasicModule<Allocator>::open(const std::string& fileName, mslValidation validation)
+{
+	return open(fileName.c_str(), validation);
 }
 
 template <typename Allocator>
@@ -526,6 +923,18 @@ bool BasicModule<Allocator>::adjustableBindings() const
 	return mslModule_adjustableBindings(m_module);
 }
 
+template <typename Allocator>
+bool BasicModule<Allocator>::argumentBuffers() const
+{
+	return mslModule_argumentBuffers(m_module);
+}
+
+template <typename Allocator>
+mslShaderDataFormat BasicModule<Allocator>::shaderDataFormat() const
+{
+	return mslModule_shaderDataFormat(m_module);
+}
+
 template <typename Allocator>
 uint32_t BasicModule<Allocator>::pipelineCount() const
 {
@@ -539,6 +948,12 @@ bool BasicModule<Allocator>::pipeline(Pipeline& outPipeline, uint32_t pipelineIn
 		pipelineIndex);
 }
 
+template <typename Allocator>
+uint32_t BasicModule<Allocator>::findPipeline(const char* name) const
+{
+	return mslModule_findPipeline(m_module, name);
+}
+
 template <typename Allocator>
 bool BasicModule<Allocator>::pipelineStruct(Struct& outStruct, uint32_t pipelineIndex,
 	uint32_t structIndex) const
@@ -547,6 +962,20 @@ bool BasicModule<Allocator>::pipelineStruct(Struct& outStruct, uint32_t pipeline
 		structIndex);
 }
 
+template <typename Allocator>
+bool BasicModule<Allocator>::pipelineStructs(Struct* outStructs, uint32_t pipelineIndex,
+	uint32_t firstStruct, uint32_t structCount) const
+{
+	return mslModule_structs(reinterpret_cast<mslStruct*>(outStructs), m_module, pipelineIndex,
+		firstStruct, structCount);
+}
+
+template <typename Allocator>
+uint32_t BasicModule<Allocator>::findStruct(uint32_t pipelineIndex, const char* name) const
+{
+	return mslModule_findStruct(m_module, pipelineIndex, name);
+}
+
 template <typename Allocator>
 bool BasicModule<Allocator>::structMember(StructMember& outStructMember, uint32_t pipelineIndex,
 	uint32_t structIndex, uint32_t structMemberIndex) const
@@ -555,6 +984,14 @@ bool BasicModule<Allocator>::structMember(StructMember& outStructMember, uint32_
 		pipelineIndex, structIndex, structMemberIndex);
 }
 
+template <typename Allocator>
+bool BasicModule<Allocator>::structMembers(StructMember* outStructMembers, uint32_t pipelineIndex,
+	uint32_t structIndex, uint32_t firstMember, uint32_t memberCount) const
+{
+	return mslModule_structMembers(reinterpret_cast<mslStructMember*>(outStructMembers), m_module,
+		pipelineIndex, structIndex, firstMember, memberCount);
+}
+
 template <typename Allocator>
 bool BasicModule<Allocator>::structMemberArrayInfo(ArrayInfo& outArrayInfo, uint32_t pipelineIndex,
 	uint32_t structIndex, uint32_t structMemberIndex, uint32_t arrayElement) const
@@ -579,6 +1016,20 @@ bool BasicModule<Allocator>::uniform(Uniform& outUniform, uint32_t pipelineIndex
 		uniformIndex);
 }
 
+template <typename Allocator>
+bool BasicModule<Allocator>::uniforms(Uniform* outUniforms, uint32_t pipelineIndex,
+	uint32_t firstUniform, uint32_t uniformCount) const
+{
+	return mslModule_uniforms(reinterpret_cast<mslUniform*>(outUniforms), m_module, pipelineIndex,
+		firstUniform, uniformCount);
+}
+
+template <typename Allocator>
+uint32_t BasicModule<Allocator>::findUniform(uint32_t pipelineIndex, const char* name) const
+{
+	return mslModule_findUniform(m_module, pipelineIndex, name);
+}
+
 template <typename Allocator>
 bool BasicModule<Allocator>::uniformArrayInfo(ArrayInfo& outArrayInfo, uint32_t pipelineIndex,
 	uint32_t uniformIndex, uint32_t arrayElement) const
@@ -595,6 +1046,20 @@ bool BasicModule<Allocator>::attribute(Attribute& outAttribute, uint32_t pipelin
 		pipelineIndex, attributeIndex);
 }
 
+template <typename Allocator>
+bool BasicModule<Allocator>::attributes(Attribute* outAttributes, uint32_t pipelineIndex,
+	uint32_t firstAttribute, uint32_t attributeCount) const
+{
+	return mslModule_attributes(reinterpret_cast<mslAttribute*>(outAttributes), m_module,
+		pipelineIndex, firstAttribute, attributeCount);
+}
+
+template <typename Allocator>
+uint32_t BasicModule<Allocator>::findAttribute(uint32_t pipelineIndex, const char* name) const
+{
+	return mslModule_findAttribute(m_module, pipelineIndex, name);
+}
+
 template <typename Allocator>
 bool BasicModule<Allocator>::fragmentOutput(FragmentOutput& outOutput, uint32_t pipelineIndex,
 	uint32_t outputIndex) const
@@ -603,6 +1068,23 @@ bool BasicModule<Allocator>::fragmentOutput(FragmentOutput& outOutput, uint32_t
 		pipelineIndex, outputIndex);
 }
 
+template <typename Allocator>
+bool BasicModule<Allocator>::fragmentOutputs(FragmentOutput* outOutputs, uint32_t pipelineIndex,
+	uint32_t firstOutput, uint32_t outputCount) const
+{
+	return mslModule_fragmentOutputs(reinterpret_cast<mslFragmentOutput*>(outOutputs), m_module,
+		pipelineIndex, firstOutput, outputCount);
+}
+
+template <typename Allocator>
+bool BasicModule<Allocator>::specializationConstant(SpecializationConstant& outConstant,
+	uint32_t pipelineIndex, uint32_t constantIndex) const
+{
+	return mslModule_specializationConstant(
+		reinterpret_cast<mslSpecializationConstant*>(&outConstant), m_module, pipelineIndex,
+		constantIndex);
+}
+
 template <typename Allocator>
 uint32_t BasicModule<Allocator>::attributeArrayLength(uint32_t pipelineIndex,
 	uint32_t attributeIndex, uint32_t arrayElement) const
@@ -641,6 +1123,21 @@ bool BasicModule<Allocator>::setUniformBinding(uint32_t pipelineIndex, uint32_t
 		binding, reinterpret_cast<mslSizedData*>(shaderData));
 }
 
+template <typename Allocator>
+bool BasicModule<Allocator>::setUniformBindings(uint32_t pipelineIndex,
+	const uint32_t* descriptorSets, const uint32_t* bindings)
+{
+	return mslModule_setUniformBindings(m_module, pipelineIndex, descriptorSets, bindings);
+}
+
+template <typename Allocator>
+bool BasicModule<Allocator>::setUniformBindings(uint32_t pipelineIndex,
+	const uint32_t* descriptorSets, const uint32_t* bindings, SizedData shaderData[mslStage_Count])
+{
+	return mslModule_setUniformBindingsCopy(m_module, pipelineIndex, descriptorSets, bindings,
+		reinterpret_cast<mslSizedData*>(shaderData));
+}
+
 template <typename Allocator>
 uint32_t BasicModule<Allocator>::shaderCount() const
 {
@@ -659,6 +1156,18 @@ const void* BasicModule<Allocator>::shaderData(uint32_t shader) const
 	return mslModule_shaderData(m_module, shader);
 }
 
+template <typename Allocator>
+uint32_t BasicModule<Allocator>::shaderAlignment() const
+{
+	return mslModule_shaderAlignment(m_module);
+}
+
+template <typename Allocator>
+bool BasicModule<Allocator>::readShaderData(void* outData, uint32_t shader) const
+{
+	return mslModule_readShaderData(outData, m_module, shader);
+}
+
 template <typename Allocator>
 bool BasicModule<Allocator>::shaderUsesPushConstants(uint32_t shader) const
 {
@@ -677,10 +1186,74 @@ const void* BasicModule<Allocator>::sharedData() const
 	return mslModule_sharedData(m_module);
 }
 
+template <typename Allocator>
+uint32_t BasicModule<Allocator>::variantKeywordCount() const
+{
+	return mslModule_variantKeywordCount(m_module);
+}
+
+template <typename Allocator>
+const char* BasicModule<Allocator>::variantKeywordName(uint32_t keywordIndex) const
+{
+	return mslModule_variantKeywordName(m_module, keywordIndex);
+}
+
+template <typename Allocator>
+uint32_t BasicModule<Allocator>::variantKeywordValueCount(uint32_t keywordIndex) const
+{
+	return mslModule_variantKeywordValueCount(m_module, keywordIndex);
+}
+
+template <typename Allocator>
+const char* BasicModule<Allocator>::variantKeywordValue(uint32_t keywordIndex,
+	uint32_t valueIndex) const
+{
+	return mslModule_variantKeywordValue(m_module, keywordIndex, valueIndex);
+}
+
+template <typename Allocator>
+uint32_t BasicModule<Allocator>::variantPermutationCount() const
+{
+	return mslModule_variantPermutationCount(m_module);
+}
+
+template <typename Allocator>
+uint32_t BasicModule<Allocator>::variantPermutationIndex(const uint32_t* valueIndices) const
+{
+	return mslModule_variantPermutationIndex(m_module, valueIndices);
+}
+
+template <typename Allocator>
+uint32_t BasicModule<Allocator>::variantCount() const
+{
+	return mslModule_variantCount(m_module);
+}
+
+template <typename Allocator>
+const char* BasicModule<Allocator>::variantName(uint32_t variantIndex) const
+{
+	return mslModule_variantName(m_module, variantIndex);
+}
+
+template <typename Allocator>
+uint32_t BasicModule<Allocator>::findVariant(const char* name) const
+{
+	return mslModule_findVariant(m_module, name);
+}
+
+template <typename Allocator>
+uint32_t BasicModule<Allocator>::variantPipeline(uint32_t variantIndex,
+	uint32_t permutationIndex) const
+{
+	return mslModule_variantPipeline(m_module, variantIndex, permutationIndex);
+}
+
 template <typename Allocator>
 void* BasicModule<Allocator>::allocateFunc(void* userData, size_t size)
 {
-	return reinterpret_cast<AllocatorType*>(userData)->allocate(size);
+	BasicModule* thisPtr = reinterpret_cast<BasicModule*>(userData);
+	thisPtr->m_size = size;
+	return thisPtr->m_allocator.allocate(size);
 }
 
 template <typename Allocator>
@@ -698,4 +1271,12 @@ size_t BasicModule<Allocator>::readFunc(void* userData, void* buffer, size_t siz
 	return (size_t)stream.gcount();
 }
 
+template <typename Allocator>
+bool BasicModule<Allocator>::seekFunc(void* userData, size_t offset)
+{
+	std::istream& stream = *reinterpret_cast<std::istream*>(userData);
+	stream.clear();
+	return static_cast<bool>(stream.seekg(static_cast<std::streamoff>(offset)));
+}
+
 } // namespace msl
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2022 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -33,9 +33,12 @@ extern "C"
 #endif
 
 /**
- * @brief Constant for the current module file version.
+ * @brief Constant for the latest module file version that can be loaded.
+ *
+ * Version 1 adds sectioned modules, where the data for each shader is stored after the reflection
+ * info. Version 2 adds compressed shaders, and version 3 adds encoded SPIR-V.
  */
-#define MSL_MODULE_VERSION 0U
+#define MSL_MODULE_VERSION 3U
 
 /**
  * @brief Constant for no known value.
@@ -1048,6 +1051,39 @@ typedef struct mslFragmentOutput
 	uint32_t location;
 } mslFragmentOutput;
 
+/**
+ * @brief Structure describing a specialization constant.
+ *
+ * The value may be overridden when creating the pipeline without recompiling the shader. For
+ * Vulkan, the ID is the constant ID in VkSpecializationMapEntry. For Metal, the ID is the function
+ * constant index in MTLFunctionConstantValues. For GLSL, the value may be overridden by defining
+ * SPIRV_CROSS_CONSTANT_ID_<id> after the \#version line of the shader.
+ */
+typedef struct mslSpecializationConstant
+{
+	/**
+	 * @brief The name of the constant.
+	 */
+	const char* name;
+
+	/**
+	 * @brief The type of the constant.
+	 *
+	 * This will be Bool, Int, UInt, Float, or Double.
+	 */
+	mslType type;
+
+	/**
+	 * @brief The ID of the constant.
+	 */
+	uint32_t id;
+
+	/**
+	 * @brief The default value of the constant when not specialized.
+	 */
+	double defaultValue;
+} mslSpecializationConstant;
+
 /**
  * @brief Structure that holds the information about the a pipeline within the compiled result.
  */
@@ -1113,8 +1149,67 @@ typedef struct mslPipeline
 	 * @brief The local size for the compute stage along the X, Y, and Z dimensions.
 	 */
 	uint32_t computeLocalSize[3];
+
+	/**
+	 * @brief The number of specialization constants used within the pipeline.
+	 *
+	 * The info for each specialization constant can be queried from the API.
+	 */
+	uint32_t specializationConstantCount;
 } mslPipeline;
 
+/**
+ * @brief Enum for how much validation is performed when loading a module.
+ *
+ * This is passed to each function that loads a module, so different modules may be loaded with
+ * different levels of validation.
+ */
+typedef enum mslValidation
+{
+	/**
+	 * Fully validate the structure and contents of the module. This is the default and should be
+	 * used for any data that isn't trusted.
+	 */
+	mslValidation_Full,
+
+	/**
+	 * Only validate the module header and checksum stored when the module was saved. This detects
+	 * corrupted data, but not data that was deliberately modified, so it should only be used for
+	 * trusted modules. Modules without a checksum will be fully validated.
+	 */
+	mslValidation_Checksum,
+
+	/**
+	 * Only validate the module header. This should only be used for modules that are trusted and
+	 * have already been verified by other means, such as signed packages.
+	 */
+	mslValidation_None
+} mslValidation;
+
+/**
+ * @brief Enum for how the data for each shader in a module is interpreted.
+ */
+typedef enum mslShaderDataFormat
+{
+	/**
+	 * The native format for the target, such as SPIR-V, GLSL source, or a compiled MTLLibrary for
+	 * each shader.
+	 */
+	mslShaderDataFormat_Native,
+
+	/**
+	 * Null-terminated source to be compiled at runtime, such as with newLibraryWithSource for
+	 * Metal.
+	 */
+	mslShaderDataFormat_Source,
+
+	/**
+	 * Null-terminated name of the function within the library stored in the shared data, such as
+	 * a single MTLLibrary for all shaders.
+	 */
+	mslShaderDataFormat_LibraryFunction
+} mslShaderDataFormat;
+
 /**
  * @brief Typedef for a custom allocator function.
  *
@@ -1183,6 +1278,14 @@ typedef struct mslSizedData
  */
 typedef size_t (*mslReadFunction)(void* userData, void* buffer, size_t size);
 
+/**
+ * @brief Typedef for a custom function for seeking within a stream.
+ * @param userData The user data to seek within.
+ * @param offset The offset from the start of the stream.
+ * @return False if an error occurred.
+ */
+typedef bool (*mslSeekFunction)(void* userData, size_t offset);
+
 /**
  * @brief Type for a shader module.
  *
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2019 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -1050,6 +1050,39 @@ struct FragmentOutput
 	uint32_t location;
 };
 
+/**
+ * @brief Structure describing a specialization constant.
+ *
+ * The value may be overridden when creating the pipeline without recompiling the shader. For
+ * Vulkan, the ID is the constant ID in VkSpecializationMapEntry. For Metal, the ID is the function
+ * constant index in MTLFunctionConstantValues. For GLSL, the value may be overridden by defining
+ * SPIRV_CROSS_CONSTANT_ID_<id> after the \#version line of the shader.
+ */
+struct SpecializationConstant
+{
+	/**
+	 * @brief The name of the constant.
+	 */
+	const char* name;
+
+	/**
+	 * @brief The type of the constant.
+	 *
+	 * This will be Bool, Int, UInt, Float, or Double.
+	 */
+	Type type;
+
+	/**
+	 * @brief The ID of the constant.
+	 */
+	uint32_t id;
+
+	/**
+	 * @brief The default value of the constant when not specialized.
+	 */
+	double defaultValue;
+};
+
 /**
  * @brief Structure that holds the information about the a pipeline within the compiled result.
  */
@@ -1115,6 +1148,13 @@ struct Pipeline
 	 * @brief The local size for the compute stage along the X, Y, and Z dimensions.
 	 */
 	std::array<uint32_t, 3> computeLocalSize;
+
+	/**
+	 * @brief The number of specialization constants used within the pipeline.
+	 *
+	 * The info for each specialization constant can be queried from the API.
+	 */
+	uint32_t specializationConstantCount;
 };
 
 /**
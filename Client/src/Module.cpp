@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2023 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -32,11 +32,26 @@
 #pragma warning(pop)
 #endif
 
+#include "mslb_checksum.h"
+#include "mslb_compression.h"
+#include "mslb_sections.h"
+#include "mslb_spirv_encoding.h"
+
 #include <errno.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 
+#if MSL_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 static_assert(static_cast<unsigned int>(mslb::Type::MAX) == mslType_Count - 1,
 	"Type enum mismatch between flatbuffer and C.");
 static_assert(static_cast<int>(mslb::UniformType::MAX) ==
@@ -71,6 +86,9 @@ static_assert(static_cast<int>(mslb::AddressMode::MAX) == static_cast<int>(mslAd
 static_assert(static_cast<int>(mslb::BorderColor::MAX) ==
 	static_cast<int>(mslBorderColor_OpaqueIntOne),
 	"BorderColor enum mismatch between flatbuffer and C.");
+static_assert(static_cast<int>(mslb::ShaderDataFormat::MAX) ==
+	static_cast<int>(mslShaderDataFormat_LibraryFunction),
+	"ShaderDataFormat enum mismatch between flatbuffer and C.");
 
 static int invalidFormatErrno = EILSEQ;
 
@@ -149,10 +167,44 @@ static bool enumInRange(mslb::BorderColor value)
 	return value >= mslb::BorderColor::MIN && value <= mslb::BorderColor::MAX;
 }
 
+static bool enumInRange(mslb::Compression value)
+{
+	return value >= mslb::Compression::MIN && value <= mslb::Compression::MAX;
+}
+
+static bool enumInRange(mslb::Encoding value)
+{
+	return value >= mslb::Encoding::MIN && value <= mslb::Encoding::MAX;
+}
+
+static bool enumInRange(mslb::ShaderDataFormat value)
+{
+	return value >= mslb::ShaderDataFormat::MIN && value <= mslb::ShaderDataFormat::MAX;
+}
+
 struct mslModule
 {
 	mslAllocator allocator;
 	mslb::Module* module;
+	mslValidation validation;
+	void* mappedData;
+	size_t mappedSize;
+
+	// Caller's data referenced by mslModule_wrapData(), which is copied on the first modification.
+	const uint8_t* wrappedData;
+	size_t wrappedSize;
+	uint8_t* copiedData;
+
+	// Payload section for sectioned modules with the full data in memory.
+	uint8_t* payloadData;
+
+	// Stream to read the payloads from for sectioned modules opened without the shader data.
+	mslReadFunction readFunc;
+	mslSeekFunction seekFunc;
+	void* streamUserData;
+	FILE* file;
+	size_t payloadOffset;
+
 	uint8_t data[];
 };
 
@@ -161,7 +213,13 @@ static bool canUseAllocator(const mslAllocator* allocator)
 	return !allocator || allocator->allocateFunc;
 }
 
-static mslModule* createModule(size_t size, const mslAllocator* allocator)
+static bool isValidationValid(mslValidation validation)
+{
+	return validation >= mslValidation_Full && validation <= mslValidation_None;
+}
+
+static mslModule* createModule(size_t size, mslValidation validation,
+	const mslAllocator* allocator)
 {
 	size_t totalSize = sizeof(mslModule) + size;
 	mslModule* module;
@@ -183,26 +241,142 @@ static mslModule* createModule(size_t size, const mslAllocator* allocator)
 		memset(&module->allocator, 0, sizeof(module->allocator));
 	}
 
+	module->validation = validation;
+	module->mappedData = nullptr;
+	module->mappedSize = 0;
+	module->wrappedData = nullptr;
+	module->wrappedSize = 0;
+	module->copiedData = nullptr;
+	module->payloadData = nullptr;
+	module->readFunc = nullptr;
+	module->seekFunc = nullptr;
+	module->streamUserData = nullptr;
+	module->file = nullptr;
+	module->payloadOffset = 0;
 	return module;
 }
 
-static void fixupModule(mslModule* module)
+static bool copyWrappedData(mslModule* module)
+{
+	if (!module->wrappedData)
+		return true;
+
+	uint8_t* copiedData;
+	if (module->allocator.allocateFunc)
+	{
+		copiedData = reinterpret_cast<uint8_t*>(
+			module->allocator.allocateFunc(module->allocator.userData, module->wrappedSize));
+	}
+	else
+		copiedData = reinterpret_cast<uint8_t*>(malloc(module->wrappedSize));
+	if (!copiedData)
+		return false;
+
+	// Point to the same locations within the copy.
+	const uint8_t* wrappedData = module->wrappedData;
+	memcpy(copiedData, wrappedData, module->wrappedSize);
+	module->module = reinterpret_cast<mslb::Module*>(
+		copiedData + (reinterpret_cast<const uint8_t*>(module->module) - wrappedData));
+	if (module->payloadData)
+		module->payloadData = copiedData + (module->payloadData - wrappedData);
+
+	module->wrappedData = nullptr;
+	module->copiedData = copiedData;
+	return true;
+}
+
+static bool needsSwap(const mslb::Module* module)
 {
 	// Swap if big endian and SPIR-V since it uses 32-bit values.
-	bool swap = !FLATBUFFERS_LITTLEENDIAN &&
-		module->module->targetId() == MSL_CREATE_ID('S', 'P', 'R', 'V');
-	if (!swap)
+	return !FLATBUFFERS_LITTLEENDIAN && module->targetId() == MSL_CREATE_ID('S', 'P', 'R', 'V');
+}
+
+static uint32_t getStoredShaderSize(const mslb::ShaderData* shader)
+{
+	// Sectioned modules store the data in the payload section.
+	uint32_t payloadSize = shader->payloadSize();
+	return payloadSize > 0 ? payloadSize : shader->data()->size();
+}
+
+// Gets the size after decompressing, which is the size of the encoded data for encoded shaders.
+static uint32_t getDecompressedShaderSize(const mslb::ShaderData* shader)
+{
+	if (shader->compression() != mslb::Compression::None)
+		return shader->uncompressedSize();
+	return getStoredShaderSize(shader);
+}
+
+static uint32_t getShaderSize(const mslb::ShaderData* shader)
+{
+	if (shader->encoding() != mslb::Encoding::None)
+		return shader->decodedSize();
+	return getDecompressedShaderSize(shader);
+}
+
+static bool isShaderStored(const mslb::ShaderData* shader)
+{
+	return shader->compression() == mslb::Compression::None &&
+		shader->encoding() == mslb::Encoding::None;
+}
+
+// Gets the data as stored in the module, which may be compressed.
+static uint8_t* getStoredShaderData(const mslModule* module, uint32_t shaderIndex)
+{
+	const mslb::ShaderData* shader = (*module->module->shaders())[shaderIndex];
+	if (module->payloadData)
+		return module->payloadData + shader->payloadOffset();
+
+	// Only read on request when opened with a stream.
+	if (module->readFunc)
+		return nullptr;
+
+	return const_cast<uint8_t*>(shader->data()->data());
+}
+
+// Gets the data for the shader if it can be used directly.
+static uint8_t* getShaderData(const mslModule* module, uint32_t shaderIndex)
+{
+	const mslb::ShaderData* shader = (*module->module->shaders())[shaderIndex];
+	if (!isShaderStored(shader))
+		return nullptr;
+	return getStoredShaderData(module, shaderIndex);
+}
+
+static void swapShaderData(void* data, size_t size)
+{
+	uint32_t* data32 = reinterpret_cast<uint32_t*>(data);
+	size_t data32Size = size/sizeof(uint32_t);
+	for (size_t i = 0; i < data32Size; ++i)
+		data32[i] = flatbuffers::EndianScalar(data32[i]);
+}
+
+static void fixupModule(mslModule* module)
+{
+	if (!needsSwap(module->module))
 		return;
 
 	for (uint32_t i = 0; i < module->module->shaders()->size(); ++i)
 	{
-		auto& shaderData = *(*module->module->shaders())[i]->data();
-		uint32_t* shaderData32 = const_cast<uint32_t*>(
-			reinterpret_cast<const uint32_t*>(shaderData.data()));
-		size_t shaderData32Size = shaderData.size()/sizeof(uint32_t);
-		for (uint32_t j = 0; j < shaderData32Size; ++j)
-			shaderData32[j] = flatbuffers::EndianScalar(shaderData32[j]);
+		uint8_t* shaderData = getShaderData(module, i);
+		if (shaderData)
+			swapShaderData(shaderData, getShaderSize((*module->module->shaders())[i]));
+	}
+}
+
+static bool readStreamData(mslReadFunction readFunc, void* userData, void* buffer, size_t size)
+{
+	size_t readSize = 0;
+	while (readSize < size)
+	{
+		size_t thisRead = readFunc(userData, reinterpret_cast<uint8_t*>(buffer) + readSize,
+			size - readSize);
+		if (thisRead == 0)
+			return false;
+
+		readSize += thisRead;
 	}
+
+	return true;
 }
 
 static size_t readFile(void* userData, void* buffer, size_t size)
@@ -211,21 +385,482 @@ static size_t readFile(void* userData, void* buffer, size_t size)
 	return fread(buffer, sizeof(uint8_t), size, file);
 }
 
+static bool seekFile(void* userData, size_t offset)
+{
+	FILE* file = reinterpret_cast<FILE*>(userData);
+	return fseek(file, static_cast<long>(offset), SEEK_SET) == 0;
+}
+
+namespace
+{
+
+// Source to decompress a shader while reading it from a stream. The compressed data is read in
+// small blocks so it never needs to be held in full, computing the checksum as it's read.
+class StreamCompressionSource
+{
+public:
+	StreamCompressionSource(mslReadFunction readFunc, void* userData, size_t size)
+		: m_readFunc(readFunc)
+		, m_userData(userData)
+		, m_remaining(size)
+		, m_bufferPos(0)
+		, m_bufferSize(0)
+		, m_readFailed(false)
+	{
+	}
+
+	bool read(void* outData, size_t size)
+	{
+		uint8_t* bytes = reinterpret_cast<uint8_t*>(outData);
+		size_t buffered = m_bufferSize - m_bufferPos;
+		if (size > buffered + m_remaining)
+			return false;
+
+		size_t copySize = size < buffered ? size : buffered;
+		memcpy(bytes, m_buffer + m_bufferPos, copySize);
+		m_bufferPos += copySize;
+		bytes += copySize;
+		size -= copySize;
+		if (size == 0)
+			return true;
+
+		// Read large blocks of literals directly into the output.
+		if (size >= sizeof(m_buffer))
+			return readStream(bytes, size);
+
+		m_bufferSize = m_remaining < sizeof(m_buffer) ? m_remaining : sizeof(m_buffer);
+		m_bufferPos = size;
+		if (!readStream(m_buffer, m_bufferSize))
+			return false;
+
+		memcpy(bytes, m_buffer, size);
+		return true;
+	}
+
+	bool atEnd() const
+	{
+		return m_bufferPos == m_bufferSize && m_remaining == 0;
+	}
+
+	bool readFailed() const
+	{
+		return m_readFailed;
+	}
+
+	uint64_t checksum() const
+	{
+		return m_checksum.finish();
+	}
+
+private:
+	bool readStream(void* outData, size_t size)
+	{
+		m_remaining -= size;
+		if (!readStreamData(m_readFunc, m_userData, outData, size))
+		{
+			m_readFailed = true;
+			return false;
+		}
+
+		m_checksum.update(outData, size);
+		return true;
+	}
+
+	mslReadFunction m_readFunc;
+	void* m_userData;
+	size_t m_remaining;
+	uint8_t m_buffer[256];
+	size_t m_bufferPos;
+	size_t m_bufferSize;
+	bool m_readFailed;
+	mslb::StreamChecksum m_checksum;
+};
+
+} // namespace
+
+// Decompresses and decodes a shader that isn't stored as-is into outData. Encoded data that's also
+// compressed is decompressed to the end of outData and decoded in place.
+template <typename Source>
+static bool decodeShaderData(uint8_t* outData, uint32_t size, const mslb::ShaderData* shader,
+	Source& source)
+{
+	if (shader->encoding() == mslb::Encoding::None)
+		return mslb::decompress(outData, size, source);
+	else if (shader->compression() == mslb::Compression::None)
+		return mslb::decodeSpirV(outData, size, source);
+
+	uint32_t encodedSize = shader->uncompressedSize();
+	if (encodedSize > size)
+		return false;
+
+	uint8_t* encodedData = outData + size - encodedSize;
+	if (!mslb::decompress(encodedData, encodedSize, source))
+		return false;
+
+	mslb::MemoryCompressionSource encodedSource(encodedData, encodedSize);
+	return mslb::decodeSpirV(outData, size, encodedSource);
+}
+
+// The file is always mapped privately so modifications are never written back to the file.
+#if MSL_WINDOWS
+
+static int lastErrorToErrno()
+{
+	switch (GetLastError())
+	{
+		case ERROR_FILE_NOT_FOUND:
+		case ERROR_PATH_NOT_FOUND:
+			return ENOENT;
+		case ERROR_ACCESS_DENIED:
+			return EACCES;
+		case ERROR_NOT_ENOUGH_MEMORY:
+		case ERROR_OUTOFMEMORY:
+			return ENOMEM;
+		default:
+			return EIO;
+	}
+}
+
+static void* mapFileData(size_t& outSize, const char* fileName)
+{
+	HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		errno = lastErrorToErrno();
+		return nullptr;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		errno = lastErrorToErrno();
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	if (fileSize.QuadPart <= 0)
+	{
+		CloseHandle(file);
+		errno = invalidFormatErrno;
+		return nullptr;
+	}
+
+	// Views can't be made writable after the fact, so always map as copy-on-write. Pages are
+	// still shared with the file until they are written to.
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		errno = lastErrorToErrno();
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+	if (!data)
+		errno = lastErrorToErrno();
+
+	// The view keeps the mapping and file alive.
+	CloseHandle(mapping);
+	CloseHandle(file);
+	outSize = static_cast<size_t>(fileSize.QuadPart);
+	return data;
+}
+
+static bool makeMappingWritable(void*, size_t)
+{
+	return true;
+}
+
+static void unmapFileData(void* data, size_t)
+{
+	UnmapViewOfFile(data);
+}
+
+#else
+
+static void* mapFileData(size_t& outSize, const char* fileName)
+{
+	int file = open(fileName, O_RDONLY);
+	if (file < 0)
+		return nullptr;
+
+	struct stat fileInfo;
+	if (fstat(file, &fileInfo) != 0)
+	{
+		int errorCode = errno;
+		close(file);
+		errno = errorCode;
+		return nullptr;
+	}
+
+	if (fileInfo.st_size <= 0)
+	{
+		close(file);
+		errno = invalidFormatErrno;
+		return nullptr;
+	}
+
+	outSize = static_cast<size_t>(fileInfo.st_size);
+	void* data = mmap(nullptr, outSize, PROT_READ, MAP_PRIVATE, file, 0);
+	int errorCode = errno;
+	close(file);
+	if (data == MAP_FAILED)
+	{
+		errno = errorCode;
+		return nullptr;
+	}
+
+	return data;
+}
+
+static bool makeMappingWritable(void* data, size_t size)
+{
+	// Writes to a private mapping are copy-on-write, so only modified pages are copied.
+	return mprotect(data, size, PROT_READ | PROT_WRITE) == 0;
+}
+
+static void unmapFileData(void* data, size_t size)
+{
+	munmap(data, size);
+}
+
+#endif
+
 static bool isStencilOpStateValid(const mslb::StencilOpState& state)
 {
 	if (!enumInRange(state.failOp()))
 		return false;
 	if (!enumInRange(state.passOp()))
 		return false;
-	if (!enumInRange(state.depthFailOp()))
+	if (!enumInRange(state.depthFailOp()))
+		return false;
+	if (!enumInRange(state.compareOp()))
+		return false;
+	return true;
+}
+
+static uint32_t variantPermutationCount(const mslb::Module* module)
+{
+	auto keywords = module->variantKeywords();
+	if (!keywords || keywords->size() == 0)
+		return 0;
+
+	// Variants aren't validated when loading with a checksum or without validation, so check for
+	// overflow here.
+	uint64_t count = 1;
+	for (uint32_t i = 0; i < keywords->size(); ++i)
+	{
+		count *= (*keywords)[i]->values()->size();
+		if (count >= MSL_UNKNOWN)
+			return 0;
+	}
+	return static_cast<uint32_t>(count);
+}
+
+static bool areVariantsValid(const mslb::Module* module)
+{
+	auto keywords = module->variantKeywords();
+	auto variants = module->variants();
+	if (!keywords || keywords->size() == 0)
+		return !variants || variants->size() == 0;
+
+	uint64_t permutationCount = 1;
+	for (uint32_t i = 0; i < keywords->size(); ++i)
+	{
+		const mslb::VariantKeyword* keyword = (*keywords)[i];
+		if (!keyword || keyword->values()->size() == 0)
+			return false;
+
+		permutationCount *= keyword->values()->size();
+		if (permutationCount >= MSL_UNKNOWN)
+			return false;
+	}
+
+	if (!variants)
+		return false;
+
+	uint32_t pipelineCount = module->pipelines()->size();
+	for (uint32_t i = 0; i < variants->size(); ++i)
+	{
+		const mslb::Variant* variant = (*variants)[i];
+		if (!variant)
+			return false;
+
+		// Must be sorted to allow for binary searches.
+		if (i > 0 && strcmp((*variants)[i - 1]->name()->c_str(), variant->name()->c_str()) >= 0)
+			return false;
+
+		auto pipelines = variant->pipelines();
+		if (pipelines->size() != permutationCount)
+			return false;
+		for (uint32_t j = 0; j < pipelines->size(); ++j)
+		{
+			uint32_t pipeline = (*pipelines)[j];
+			if (pipeline != MSL_UNKNOWN && pipeline >= pipelineCount)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+template <typename T>
+static bool isNameOrderValid(const flatbuffers::Vector<flatbuffers::Offset<T>>& elements,
+	const flatbuffers::Vector<uint32_t>* nameOrder)
+{
+	if (!nameOrder)
+		return true;
+
+	uint32_t count = elements.size();
+	if (nameOrder->size() != count)
+		return false;
+
+	// Names must be strictly increasing, which also guarantees that no index is repeated so the
+	// order is a permutation of the elements.
+	const char* prevName = nullptr;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		uint32_t index = (*nameOrder)[i];
+		if (index >= count)
+			return false;
+
+		const char* name = elements[index]->name()->c_str();
+		if (prevName && strcmp(prevName, name) >= 0)
+			return false;
+		prevName = name;
+	}
+
+	return true;
+}
+
+template <typename T>
+static uint32_t findByName(const flatbuffers::Vector<flatbuffers::Offset<T>>& elements,
+	const char* name)
+{
+	uint32_t begin = 0;
+	uint32_t end = elements.size();
+	while (begin < end)
+	{
+		uint32_t mid = begin + (end - begin)/2;
+		int compare = strcmp(elements[mid]->name()->c_str(), name);
+		if (compare == 0)
+			return mid;
+		else if (compare < 0)
+			begin = mid + 1;
+		else
+			end = mid;
+	}
+
+	return MSL_UNKNOWN;
+}
+
+template <typename T>
+static uint32_t findByName(const flatbuffers::Vector<flatbuffers::Offset<T>>& elements,
+	const flatbuffers::Vector<uint32_t>* nameOrder, const char* name)
+{
+	if (!nameOrder)
+	{
+		for (uint32_t i = 0; i < elements.size(); ++i)
+		{
+			if (strcmp(elements[i]->name()->c_str(), name) == 0)
+				return i;
+		}
+
+		return MSL_UNKNOWN;
+	}
+
+	uint32_t begin = 0;
+	uint32_t end = nameOrder->size();
+	while (begin < end)
+	{
+		uint32_t mid = begin + (end - begin)/2;
+		uint32_t index = (*nameOrder)[mid];
+		int compare = strcmp(elements[index]->name()->c_str(), name);
+		if (compare == 0)
+			return index;
+		else if (compare < 0)
+			begin = mid + 1;
+		else
+			end = mid;
+	}
+
+	return MSL_UNKNOWN;
+}
+
+static bool areDecorationOffsetsValid(const flatbuffers::Vector<uint32_t>* offsets,
+	uint32_t uniformCount, uint32_t wordCount)
+{
+	if (!offsets)
+		return true;
+
+	if (offsets->size() != uniformCount)
+		return false;
+
+	for (uint32_t i = 0; i < uniformCount; ++i)
+	{
+		uint32_t offset = (*offsets)[i];
+		if (offset != MSL_UNKNOWN && offset >= wordCount)
+			return false;
+	}
+
+	return true;
+}
+
+static bool isHeaderValid(const void* data, size_t size, size_t& outChecksumOffset)
+{
+	// Only verify the scalar fields of the root table rather than the full structure.
+	flatbuffers::Verifier verifier(reinterpret_cast<const uint8_t*>(data), size);
+	if (size < FLATBUFFERS_MIN_BUFFER_SIZE || !verifier.VerifyOffset(0))
+		return false;
+
+	const flatbuffers::Table* table = flatbuffers::GetRoot<flatbuffers::Table>(data);
+	if (!table->VerifyTableStart(verifier) ||
+		!table->VerifyField<uint32_t>(verifier, mslb::Module::VT_VERSION, sizeof(uint32_t)) ||
+		!table->VerifyField<uint32_t>(verifier, mslb::Module::VT_TARGETID, sizeof(uint32_t)) ||
+		!table->VerifyField<uint32_t>(verifier, mslb::Module::VT_TARGETVERSION,
+			sizeof(uint32_t)) ||
+		!table->VerifyField<uint8_t>(verifier, mslb::Module::VT_ADJUSTABLEBINDINGS,
+			sizeof(uint8_t)) ||
+		!table->VerifyField<uint8_t>(verifier, mslb::Module::VT_ARGUMENTBUFFERS,
+			sizeof(uint8_t)) ||
+		!table->VerifyField<uint64_t>(verifier, mslb::Module::VT_CHECKSUM, sizeof(uint64_t)))
+	{
+		return false;
+	}
+
+	const mslb::Module* module = mslb::GetModule(data);
+	if (module->version() > MSL_MODULE_VERSION)
 		return false;
-	if (!enumInRange(state.compareOp()))
+
+	if (module->adjustableBindings() && module->targetId() != MSL_CREATE_ID('S', 'P', 'R', 'V'))
 		return false;
+
+	const uint8_t* checksumAddress = table->GetAddressOf(mslb::Module::VT_CHECKSUM);
+	if (checksumAddress)
+		outChecksumOffset = checksumAddress - reinterpret_cast<const uint8_t*>(data);
+	else
+		outChecksumOffset = 0;
 	return true;
 }
 
-static bool isValid(const void* data, size_t size)
+static bool isValid(const void* data, size_t size, bool sectioned, mslValidation validation)
 {
+	if (validation != mslValidation_Full)
+	{
+		size_t checksumOffset;
+		if (!isHeaderValid(data, size, checksumOffset))
+			return false;
+
+		if (validation == mslValidation_None)
+			return true;
+
+		// Fall back to full validation for modules saved without a checksum.
+		uint64_t checksum = mslb::GetModule(data)->checksum();
+		if (checksum != 0)
+			return checksum == mslb::computeChecksum(data, size, checksumOffset);
+	}
+
 	flatbuffers::Verifier verifier(reinterpret_cast<const uint8_t*>(data), size);
 	if (!mslb::VerifyModuleBuffer(verifier))
 		return false;
@@ -238,13 +873,73 @@ static bool isValid(const void* data, size_t size)
 	if (module->adjustableBindings() && !isSpirV)
 		return false;
 
+	// Only Metal targets have shader data other than the native format.
+	bool isMetal = module->targetId() == MSL_CREATE_ID('M', 'T', 'L', 'X') ||
+		module->targetId() == MSL_CREATE_ID('M', 'T', 'L', 'I');
+	if (!enumInRange(module->shaderDataFormat()) ||
+		(module->shaderDataFormat() != mslb::ShaderDataFormat::Native && !isMetal))
+	{
+		return false;
+	}
+
+	if (sectioned && module->version() < mslb::sectionedVersion)
+		return false;
+
+	uint32_t shaderAlignment = module->shaderAlignment();
+	if ((shaderAlignment & (shaderAlignment - 1)) != 0)
+		return false;
+
 	auto shaderData = module->shaders();
 	if (!shaderData)
 		return false;
 	for (uint32_t i = 0; i < shaderData->size(); ++i)
 	{
-		if (!(*shaderData)[i])
+		const mslb::ShaderData* shader = (*shaderData)[i];
+		if (!shader)
+			return false;
+
+		// Compressed shaders record the size once decompressed.
+		if (!enumInRange(shader->compression()))
+			return false;
+		if (shader->compression() == mslb::Compression::None)
+		{
+			if (shader->uncompressedSize() != 0)
+				return false;
+		}
+		else if (module->version() < mslb::compressionVersion || shader->uncompressedSize() == 0)
+			return false;
+
+		// Encoded shaders are decoded in place, so they can't be larger than the decoded shader.
+		if (!enumInRange(shader->encoding()))
+			return false;
+		if (shader->encoding() == mslb::Encoding::None)
+		{
+			if (shader->decodedSize() != 0)
+				return false;
+		}
+		else if (!isSpirV || module->version() < mslb::spirVEncodingVersion ||
+			shader->decodedSize() == 0 || shader->decodedSize() % sizeof(uint32_t) != 0 ||
+			getDecompressedShaderSize(shader) > shader->decodedSize())
+		{
+			return false;
+		}
+
+		// The data is either in the flatbuffer or the payload section, never both.
+		if (sectioned)
+		{
+			if (shader->data()->size() > 0)
+				return false;
+			continue;
+		}
+		else if (shader->payloadOffset() != 0 || shader->payloadSize() != 0)
 			return false;
+
+		if (shaderAlignment > 0 && shader->data()->size() > 0)
+		{
+			size_t offset = shader->data()->data() - reinterpret_cast<const uint8_t*>(data);
+			if (offset & (shaderAlignment - 1))
+				return false;
+		}
 	}
 
 	auto pipelines = module->pipelines();
@@ -259,6 +954,10 @@ static bool isValid(const void* data, size_t size)
 		if (!pipeline->name())
 			return false;
 
+		// Must be sorted to allow for binary searches.
+		if (i > 0 && strcmp((*pipelines)[i - 1]->name()->c_str(), pipeline->name()->c_str()) >= 0)
+			return false;
+
 		// Verify structs
 		auto structs = pipeline->structs();
 		if (!structs)
@@ -392,6 +1091,30 @@ static bool isValid(const void* data, size_t size)
 				return false;
 		}
 
+		// Verify specialization constants.
+		auto specializationConstants = pipeline->specializationConstants();
+		if (specializationConstants)
+		{
+			for (uint32_t j = 0; j < specializationConstants->size(); ++j)
+			{
+				const mslb::SpecializationConstant* specConstant = (*specializationConstants)[j];
+				if (!specConstant)
+					return false;
+				if (!specConstant->name())
+					return false;
+				if (!enumInRange(specConstant->type()))
+					return false;
+			}
+		}
+
+		// Verify name lookups.
+		if (!isNameOrderValid(*structs, pipeline->structNameOrder()) ||
+			!isNameOrderValid(*uniforms, pipeline->uniformNameOrder()) ||
+			!isNameOrderValid(*attributes, pipeline->attributeNameOrder()))
+		{
+			return false;
+		}
+
 		// Verify push constant
 		uint32_t pushConstantStruct = pipeline->pushConstantStruct();
 		if (pushConstantStruct != MSL_UNKNOWN && pushConstantStruct >= structs->size())
@@ -499,13 +1222,99 @@ static bool isValid(const void* data, size_t size)
 				auto uniformIds = shader->uniformIds();
 				if (!uniformIds || uniformIds->size() != uniforms->size())
 					return false;
+
+				uint32_t wordCount = getShaderSize((*shaderData)[shader->shader()])/
+					sizeof(uint32_t);
+				if (!areDecorationOffsetsValid(shader->descriptorSetOffsets(), uniforms->size(),
+						wordCount) ||
+					!areDecorationOffsetsValid(shader->bindingOffsets(), uniforms->size(),
+						wordCount))
+				{
+					return false;
+				}
 			}
 		}
 	}
 
+	return areVariantsValid(module);
+}
+
+static bool isPayloadChecksumValid(const mslb::ShaderData* shader, const void* data)
+{
+	uint64_t checksum = shader->payloadChecksum();
+	return checksum == 0 ||
+		checksum == mslb::computeChecksum(data, shader->payloadSize(), mslb::noChecksumOffset);
+}
+
+// Checks that each payload lies within the module and is aligned relative to the start of the
+// module. The checksum for each payload is also checked when the payload data is provided.
+static bool arePayloadsValid(const mslb::Module* module, size_t payloadOffset, size_t moduleSize,
+	const uint8_t* payloadData)
+{
+	uint32_t shaderAlignment = module->shaderAlignment();
+	size_t payloadSectionSize = moduleSize - payloadOffset;
+	auto& shaders = *module->shaders();
+	for (uint32_t i = 0; i < shaders.size(); ++i)
+	{
+		const mslb::ShaderData* shader = shaders[i];
+		if (shader->payloadOffset() > payloadSectionSize ||
+			shader->payloadSize() > payloadSectionSize - shader->payloadOffset())
+		{
+			return false;
+		}
+
+		if (shaderAlignment > 0 && shader->payloadSize() > 0 &&
+			((payloadOffset + shader->payloadOffset()) & (shaderAlignment - 1)))
+		{
+			return false;
+		}
+
+		if (payloadData && !isPayloadChecksumValid(shader, payloadData + shader->payloadOffset()))
+			return false;
+	}
+
 	return true;
 }
 
+// Validates a full module in memory, which may either be a single flatbuffer or sectioned. The
+// offsets of the index and payload sections are 0 when the module isn't sectioned.
+static bool isModuleValid(const void* data, size_t size, mslValidation validation,
+	size_t& outIndexOffset, size_t& outPayloadOffset)
+{
+	if (!mslb::isSectioned(data, size))
+	{
+		outIndexOffset = 0;
+		outPayloadOffset = 0;
+		return isValid(data, size, false, validation);
+	}
+
+	mslb::SectionedHeader header;
+	if (!mslb::readSectionedHeader(header, data, size))
+		return false;
+
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+	const uint8_t* index = bytes + mslb::sectionedHeaderSize;
+	if (!isValid(index, header.indexSize, true, validation))
+		return false;
+
+	outIndexOffset = mslb::sectionedHeaderSize;
+	outPayloadOffset = header.payloadOffset;
+	if (validation == mslValidation_None)
+		return true;
+
+	// The index checksum doesn't cover the payloads, so check them separately.
+	return arePayloadsValid(mslb::GetModule(index), header.payloadOffset, size,
+		bytes + header.payloadOffset);
+}
+
+static bool canSetUniformBinding(const mslb::Uniform* uniform)
+{
+	// Fields can only be modified in-place when they were written, rather than omitted as defaults.
+	auto table = reinterpret_cast<const flatbuffers::Table*>(uniform);
+	return table->GetAddressOf(mslb::Uniform::VT_DESCRIPTORSET) &&
+		table->GetAddressOf(mslb::Uniform::VT_BINDING);
+}
+
 static void setUniformBinding(const flatbuffers::Vector<flatbuffers::Offset<mslb::Shader>>& shaders,
 	mslSizedData shaderData[mslStage_Count], uint32_t uniformIndex, uint32_t descriptorSet,
 	uint32_t binding)
@@ -523,9 +1332,24 @@ static void setUniformBinding(const flatbuffers::Vector<flatbuffers::Offset<mslb
 		if (!shader || shader->shader() == MSL_UNKNOWN)
 			continue;
 
-		uint32_t id = (*shader->uniformIds())[uniformIndex];
-
 		uint32_t* spirV = reinterpret_cast<uint32_t*>(shaderData[i].data);
+
+		// Use the decoration offsets stored when the module was saved if available.
+		auto descriptorSetOffsets = shader->descriptorSetOffsets();
+		auto bindingOffsets = shader->bindingOffsets();
+		if (descriptorSetOffsets && bindingOffsets)
+		{
+			uint32_t descriptorSetOffset = (*descriptorSetOffsets)[uniformIndex];
+			if (descriptorSetOffset != MSL_UNKNOWN)
+				spirV[descriptorSetOffset] = descriptorSet;
+
+			uint32_t bindingOffset = (*bindingOffsets)[uniformIndex];
+			if (bindingOffset != MSL_UNKNOWN)
+				spirV[bindingOffset] = binding;
+			continue;
+		}
+
+		uint32_t id = (*shader->uniformIds())[uniformIndex];
 		uint32_t spirVSize = static_cast<uint32_t>(shaderData[i].size/sizeof(uint32_t));
 		for (uint32_t j = firstInstruction; j < spirVSize;)
 		{
@@ -549,84 +1373,391 @@ static void setUniformBinding(const flatbuffers::Vector<flatbuffers::Offset<mslb
 				}
 			}
 
-			j += wordCount;
-		}
+			j += wordCount;
+		}
+	}
+}
+
+static bool isRangeValid(uint32_t first, uint32_t count, uint32_t size)
+{
+	return first <= size && count <= size - first;
+}
+
+static void fillStruct(mslStruct* outStruct, const mslb::Struct* pipelineStruct)
+{
+	outStruct->name = pipelineStruct->name()->c_str();
+	outStruct->size = pipelineStruct->size();
+	outStruct->memberCount = pipelineStruct->members()->size();
+}
+
+static void fillStructMember(mslStructMember* outStructMember, const mslb::StructMember* member)
+{
+	outStructMember->name = member->name()->c_str();
+	outStructMember->offset = member->offset();
+	outStructMember->size = member->size();
+	outStructMember->type = static_cast<mslType>(member->type());
+	outStructMember->structIndex = member->structIndex();
+	auto arrayElements = member->arrayElements();
+	outStructMember->arrayElementCount = arrayElements ? arrayElements->size() : 0;
+	outStructMember->rowMajor = member->rowMajor();
+}
+
+static void fillUniform(mslUniform* outUniform, const mslb::Uniform* uniform)
+{
+	outUniform->name = uniform->name()->c_str();
+	outUniform->uniformType = static_cast<mslUniformType>(uniform->uniformType());
+	outUniform->type = static_cast<mslType>(uniform->type());
+	outUniform->structIndex = uniform->structIndex();
+	auto arrayElements = uniform->arrayElements();
+	outUniform->arrayElementCount = arrayElements ? arrayElements->size() : 0;
+	outUniform->descriptorSet = uniform->descriptorSet();
+	outUniform->binding = uniform->binding();
+	outUniform->inputAttachmentIndex = uniform->inputAttachmentIndex();
+	outUniform->samplerIndex = uniform->samplerIndex();
+}
+
+static void fillAttribute(mslAttribute* outAttribute, const mslb::Attribute* attribute)
+{
+	outAttribute->name = attribute->name()->c_str();
+	outAttribute->type = static_cast<mslType>(attribute->type());
+	auto arrayElements = attribute->arrayElements();
+	outAttribute->arrayElementCount = arrayElements ? arrayElements->size() : 0;
+	outAttribute->location = attribute->location();
+	outAttribute->component = attribute->component();
+}
+
+static void fillFragmentOutput(mslFragmentOutput* outOutput,
+	const mslb::FragmentOutput* fragmentOutput)
+{
+	outOutput->name = fragmentOutput->name()->c_str();
+	outOutput->location = fragmentOutput->location();
+}
+
+// Returns false if the data for any shader can't be modified directly, such as when it's
+// compressed or hasn't been loaded.
+static bool getPipelineShaderData(mslSizedData outShaderData[mslStage_Count],
+	const mslModule* module, const mslb::Pipeline* pipeline)
+{
+	const auto& shaderRefs = *pipeline->shaders();
+	auto& shaderData = *module->module->shaders();
+	for (int i = 0; i < mslStage_Count; ++i)
+	{
+		uint32_t shaderIndex = shaderRefs[i]->shader();
+		if (shaderIndex == MSL_UNKNOWN)
+		{
+			outShaderData[i].data = nullptr;
+			outShaderData[i].size = 0;
+			continue;
+		}
+
+		outShaderData[i].data = getShaderData(module, shaderIndex);
+		outShaderData[i].size = getShaderSize(shaderData[shaderIndex]);
+		if (!outShaderData[i].data)
+			return false;
+	}
+
+	return true;
+}
+
+static bool isShaderDataCopyValid(const mslModule* module, const mslb::Pipeline* pipeline,
+	const mslSizedData shaderData[mslStage_Count])
+{
+	const auto& expectedShaders = *pipeline->shaders();
+	const auto& expectedShaderData = *module->module->shaders();
+	for (int i = 0; i < mslStage_Count; ++i)
+	{
+		uint32_t shaderIndex = expectedShaders[i]->shader();
+		if (shaderIndex == MSL_UNKNOWN)
+		{
+			if (shaderData[i].size > 0)
+				return false;
+		}
+		else
+		{
+			if (shaderData[i].size != getShaderSize(expectedShaderData[shaderIndex]))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+extern "C"
+{
+
+void mslModule_setInvalidFormatErrno(int errorCode)
+{
+	invalidFormatErrno = errorCode;
+}
+
+size_t mslModule_sizeof(size_t dataSize)
+{
+	return sizeof(mslModule) + dataSize;
+}
+
+mslModule* mslModule_readStream(mslReadFunction readFunc, void* userData,
+	size_t size, const mslAllocator* allocator)
+{
+	return mslModule_readStreamWithValidation(readFunc, userData, size, mslValidation_Full,
+		allocator);
+}
+
+mslModule* mslModule_readStreamWithValidation(mslReadFunction readFunc, void* userData,
+	size_t size, mslValidation validation, const mslAllocator* allocator)
+{
+	if (!readFunc || size == 0 || !isValidationValid(validation) ||
+		(allocator && !allocator->allocateFunc))
+	{
+		errno = EINVAL;
+		return nullptr;
+	}
+
+	mslModule* module = createModule(size, validation, allocator);
+	if (!module)
+		return nullptr;
+
+	if (!readStreamData(readFunc, userData, module->data, size))
+	{
+		mslModule_destroy(module);
+		errno = EIO;
+		return nullptr;
+	}
+
+	size_t indexOffset, payloadOffset;
+	if (!isModuleValid(module->data, size, validation, indexOffset, payloadOffset))
+	{
+		mslModule_destroy(module);
+		errno = invalidFormatErrno;
+		return nullptr;
+	}
+
+	module->module = const_cast<mslb::Module*>(mslb::GetModule(module->data + indexOffset));
+	if (payloadOffset > 0)
+		module->payloadData = module->data + payloadOffset;
+	fixupModule(module);
+	return module;
+}
+
+mslModule* mslModule_readData(const void* data, size_t size, const mslAllocator* allocator)
+{
+	return mslModule_readDataWithValidation(data, size, mslValidation_Full, allocator);
+}
+
+mslModule* mslModule_readDataWithValidation(const void* data, size_t size,
+	mslValidation validation, const mslAllocator* allocator)
+{
+	if (!data || size == 0 || !isValidationValid(validation) || !canUseAllocator(allocator))
+	{
+		errno = EINVAL;
+		return nullptr;
+	}
+
+	size_t indexOffset, payloadOffset;
+	if (!isModuleValid(data, size, validation, indexOffset, payloadOffset))
+	{
+		errno = invalidFormatErrno;
+		return nullptr;
+	}
+
+	mslModule* module = createModule(size, validation, allocator);
+	if (!module)
+		return nullptr;
+
+	memcpy(module->data, data, size);
+	module->module = mslb::GetMutableModule(module->data + indexOffset);
+	if (module->module->version() > MSL_MODULE_VERSION)
+	{
+		mslModule_destroy(module);
+		errno = invalidFormatErrno;
+		return nullptr;
 	}
+
+	if (payloadOffset > 0)
+		module->payloadData = module->data + payloadOffset;
+	fixupModule(module);
+	return module;
 }
 
-extern "C"
+mslModule* mslModule_wrapData(const void* data, size_t size, mslValidation validation,
+	const mslAllocator* allocator)
 {
+	if (!data || size == 0 || !isValidationValid(validation) || !canUseAllocator(allocator))
+	{
+		errno = EINVAL;
+		return nullptr;
+	}
 
-void mslModule_setInvalidFormatErrno(int errorCode)
-{
-	invalidFormatErrno = errorCode;
+	size_t indexOffset, payloadOffset;
+	if (!isModuleValid(data, size, validation, indexOffset, payloadOffset))
+	{
+		errno = invalidFormatErrno;
+		return nullptr;
+	}
+
+	// The caller's data is never modified. Endian swapping always modifies the data so it's copied
+	// up-front, while adjusting bindings copies the data the first time a binding changes.
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+	const mslb::Module* dataModule = mslb::GetModule(bytes + indexOffset);
+	if (needsSwap(dataModule))
+		return mslModule_readDataWithValidation(data, size, validation, allocator);
+
+	mslModule* module = createModule(0, validation, allocator);
+	if (!module)
+		return nullptr;
+
+	module->module = const_cast<mslb::Module*>(dataModule);
+	if (payloadOffset > 0)
+		module->payloadData = const_cast<uint8_t*>(bytes + payloadOffset);
+	if (dataModule->adjustableBindings())
+	{
+		module->wrappedData = bytes;
+		module->wrappedSize = size;
+	}
+	return module;
 }
 
-size_t mslModule_sizeof(size_t dataSize)
+mslModule* mslModule_readFile(const char* fileName, const mslAllocator* allocator)
 {
-	return sizeof(mslModule) + dataSize;
+	return mslModule_readFileWithValidation(fileName, mslValidation_Full, allocator);
 }
 
-mslModule* mslModule_readStream(mslReadFunction readFunc, void* userData,
-	size_t size, const mslAllocator* allocator)
+mslModule* mslModule_readFileWithValidation(const char* fileName, mslValidation validation,
+	const mslAllocator* allocator)
 {
-	if (!readFunc || size == 0 || (allocator && !allocator->allocateFunc))
+	if (!fileName || !isValidationValid(validation) || !canUseAllocator(allocator))
 	{
 		errno = EINVAL;
 		return nullptr;
 	}
 
-	mslModule* module = createModule(size, allocator);
-	if (!module)
+	// Use FILE rather than fstream to make sure we don't have to link to the C++ library.
+	FILE* file = fopen(fileName, "rb");
+	if (!file)
 		return nullptr;
 
-	size_t readSize = 0;
-	do
+	if (fseek(file, 0, SEEK_END) != 0)
 	{
-		size_t thisRead = readFunc(userData, module->data + readSize, size - readSize);
-		if (thisRead == 0)
-		{
-			mslModule_destroy(module);
-			errno = EIO;
-			return nullptr;
-		}
+		fclose(file);
+		return nullptr;
+	}
 
-		readSize += thisRead;
-	} while (readSize < size);
+	size_t size = ftell(file);
+	if (fseek(file, 0, SEEK_SET) != 0)
+	{
+		fclose(file);
+		return nullptr;
+	}
+
+	mslModule* module = mslModule_readStreamWithValidation(&readFile, file, size, validation,
+		allocator);
+	fclose(file);
+	return module;
+}
 
-	if (!isValid(module->data, size))
+mslModule* mslModule_mapFile(const char* fileName, mslValidation validation,
+	const mslAllocator* allocator)
+{
+	if (!fileName || !isValidationValid(validation) || !canUseAllocator(allocator))
 	{
-		mslModule_destroy(module);
+		errno = EINVAL;
+		return nullptr;
+	}
+
+	size_t size = 0;
+	void* data = mapFileData(size, fileName);
+	if (!data)
+		return nullptr;
+
+	size_t indexOffset, payloadOffset;
+	if (!isModuleValid(data, size, validation, indexOffset, payloadOffset))
+	{
+		unmapFileData(data, size);
 		errno = invalidFormatErrno;
 		return nullptr;
 	}
 
-	module->module = const_cast<mslb::Module*>(mslb::GetModule(module->data));
+	// Data is modified in place when swapping or adjusting bindings.
+	uint8_t* bytes = reinterpret_cast<uint8_t*>(data);
+	const mslb::Module* fileModule = mslb::GetModule(bytes + indexOffset);
+	if ((needsSwap(fileModule) || fileModule->adjustableBindings()) &&
+		!makeMappingWritable(data, size))
+	{
+		int errorCode = errno;
+		unmapFileData(data, size);
+		errno = errorCode;
+		return nullptr;
+	}
+
+	mslModule* module = createModule(0, validation, allocator);
+	if (!module)
+	{
+		int errorCode = errno;
+		unmapFileData(data, size);
+		errno = errorCode;
+		return nullptr;
+	}
+
+	module->module = const_cast<mslb::Module*>(fileModule);
+	module->mappedData = data;
+	module->mappedSize = size;
+	if (payloadOffset > 0)
+		module->payloadData = bytes + payloadOffset;
 	fixupModule(module);
 	return module;
 }
 
-mslModule* mslModule_readData(const void* data, size_t size, const mslAllocator* allocator)
+mslModule* mslModule_openStream(mslReadFunction readFunc, mslSeekFunction seekFunc,
+	void* userData, size_t size, mslValidation validation, const mslAllocator* allocator)
 {
-	if (!data || size == 0 || !canUseAllocator(allocator))
+	if (!readFunc || !seekFunc || size == 0 || !isValidationValid(validation) ||
+		!canUseAllocator(allocator))
 	{
 		errno = EINVAL;
 		return nullptr;
 	}
 
-	if (!isValid(data, size))
+	uint8_t headerData[mslb::sectionedHeaderSize];
+	size_t headerSize = size < sizeof(headerData) ? size : sizeof(headerData);
+	if (!readStreamData(readFunc, userData, headerData, headerSize))
+	{
+		errno = EIO;
+		return nullptr;
+	}
+
+	// Modules that aren't sectioned need to be read in full.
+	if (!mslb::isSectioned(headerData, headerSize))
+	{
+		if (!seekFunc(userData, 0))
+		{
+			errno = EIO;
+			return nullptr;
+		}
+
+		return mslModule_readStreamWithValidation(readFunc, userData, size, validation,
+			allocator);
+	}
+
+	mslb::SectionedHeader header;
+	if (!mslb::readSectionedHeader(header, headerData, size))
 	{
 		errno = invalidFormatErrno;
 		return nullptr;
 	}
 
-	mslModule* module = createModule(size, allocator);
+	mslModule* module = createModule(header.indexSize, validation, allocator);
 	if (!module)
 		return nullptr;
 
-	memcpy(module->data, data, size);
-	module->module = mslb::GetMutableModule(module->data);
-	if (module->module->version() > MSL_MODULE_VERSION)
+	if (!readStreamData(readFunc, userData, module->data, header.indexSize))
+	{
+		mslModule_destroy(module);
+		errno = EIO;
+		return nullptr;
+	}
+
+	if (!isValid(module->data, header.indexSize, true, validation) ||
+		(validation != mslValidation_None && !arePayloadsValid(mslb::GetModule(module->data),
+			header.payloadOffset, size, nullptr)))
 	{
 		mslModule_destroy(module);
 		errno = invalidFormatErrno;
@@ -634,19 +1765,22 @@ mslModule* mslModule_readData(const void* data, size_t size, const mslAllocator*
 	}
 
 	module->module = const_cast<mslb::Module*>(mslb::GetModule(module->data));
-	fixupModule(module);
+	module->readFunc = readFunc;
+	module->seekFunc = seekFunc;
+	module->streamUserData = userData;
+	module->payloadOffset = header.payloadOffset;
 	return module;
 }
 
-mslModule* mslModule_readFile(const char* fileName, const mslAllocator* allocator)
+mslModule* mslModule_openFile(const char* fileName, mslValidation validation,
+	const mslAllocator* allocator)
 {
-	if (!fileName || !canUseAllocator(allocator))
+	if (!fileName || !isValidationValid(validation) || !canUseAllocator(allocator))
 	{
 		errno = EINVAL;
 		return nullptr;
 	}
 
-	// Use FILE rather than fstream to make sure we don't have to link to the C++ library.
 	FILE* file = fopen(fileName, "rb");
 	if (!file)
 		return nullptr;
@@ -664,8 +1798,18 @@ mslModule* mslModule_readFile(const char* fileName, const mslAllocator* allocato
 		return nullptr;
 	}
 
-	mslModule* module = mslModule_readStream(&readFile, file, size, allocator);
-	fclose(file);
+	// The file is kept open to read the shaders from if the module is sectioned.
+	mslModule* module = mslModule_openStream(&readFile, &seekFile, file, size, validation,
+		allocator);
+	if (!module || !module->readFunc)
+	{
+		int errorCode = errno;
+		fclose(file);
+		errno = errorCode;
+		return module;
+	}
+
+	module->file = file;
 	return module;
 }
 
@@ -701,6 +1845,22 @@ bool mslModule_adjustableBindings(const mslModule* module)
 	return module->module->adjustableBindings();
 }
 
+bool mslModule_argumentBuffers(const mslModule* module)
+{
+	if (!module)
+		return false;
+
+	return module->module->argumentBuffers();
+}
+
+mslShaderDataFormat mslModule_shaderDataFormat(const mslModule* module)
+{
+	if (!module)
+		return mslShaderDataFormat_Native;
+
+	return static_cast<mslShaderDataFormat>(module->module->shaderDataFormat());
+}
+
 uint32_t mslModule_pipelineCount(const mslModule* module)
 {
 	if (!module)
@@ -746,9 +1906,21 @@ bool mslModule_pipeline(mslPipeline* outPipeline, const mslModule* module,
 	for (int i = 0; i < mslStage_Count; ++i)
 		outPipeline->shaders[i] = shaders[i] ? shaders[i]->shader() : MSL_UNKNOWN;
 
+	auto specializationConstants = pipeline->specializationConstants();
+	outPipeline->specializationConstantCount =
+		specializationConstants ? specializationConstants->size() : 0;
+
 	return true;
 }
 
+uint32_t mslModule_findPipeline(const mslModule* module, const char* name)
+{
+	if (!module || !name)
+		return MSL_UNKNOWN;
+
+	return findByName(*module->module->pipelines(), name);
+}
+
 bool mslModule_struct(mslStruct* outStruct, const mslModule* module, uint32_t pipelineIndex,
 	uint32_t structIndex)
 {
@@ -762,13 +1934,41 @@ bool mslModule_struct(mslStruct* outStruct, const mslModule* module, uint32_t pi
 	if (structIndex >= structs.size())
 		return false;
 
-	const mslb::Struct* pipelineStruct = structs[structIndex];
-	outStruct->name = pipelineStruct->name()->c_str();
-	outStruct->size = pipelineStruct->size();
-	outStruct->memberCount = pipelineStruct->members()->size();
+	fillStruct(outStruct, structs[structIndex]);
+	return true;
+}
+
+bool mslModule_structs(mslStruct* outStructs, const mslModule* module, uint32_t pipelineIndex,
+	uint32_t firstStruct, uint32_t structCount)
+{
+	if ((!outStructs && structCount > 0) || !module)
+		return false;
+
+	auto& pipelines = *module->module->pipelines();
+	if (pipelineIndex >= pipelines.size())
+		return false;
+	auto& structs = *pipelines[pipelineIndex]->structs();
+	if (!isRangeValid(firstStruct, structCount, structs.size()))
+		return false;
+
+	for (uint32_t i = 0; i < structCount; ++i)
+		fillStruct(outStructs + i, structs[firstStruct + i]);
 	return true;
 }
 
+uint32_t mslModule_findStruct(const mslModule* module, uint32_t pipelineIndex, const char* name)
+{
+	if (!module || !name)
+		return MSL_UNKNOWN;
+
+	auto& pipelines = *module->module->pipelines();
+	if (pipelineIndex >= pipelines.size())
+		return MSL_UNKNOWN;
+
+	const mslb::Pipeline* pipeline = pipelines[pipelineIndex];
+	return findByName(*pipeline->structs(), pipeline->structNameOrder(), name);
+}
+
 bool mslModule_structMember(mslStructMember* outStructMember, const mslModule* module,
 	uint32_t pipelineIndex, uint32_t structIndex, uint32_t structMemberIndex)
 {
@@ -785,15 +1985,28 @@ bool mslModule_structMember(mslStructMember* outStructMember, const mslModule* m
 	if (structMemberIndex >= members.size())
 		return false;
 
-	const mslb::StructMember* member = members[structMemberIndex];
-	outStructMember->name = member->name()->c_str();
-	outStructMember->offset = member->offset();
-	outStructMember->size = member->size();
-	outStructMember->type = static_cast<mslType>(member->type());
-	outStructMember->structIndex = member->structIndex();
-	auto arrayElements = member->arrayElements();
-	outStructMember->arrayElementCount = arrayElements ? arrayElements->size() : 0;
-	outStructMember->rowMajor = member->rowMajor();
+	fillStructMember(outStructMember, members[structMemberIndex]);
+	return true;
+}
+
+bool mslModule_structMembers(mslStructMember* outStructMembers, const mslModule* module,
+	uint32_t pipelineIndex, uint32_t structIndex, uint32_t firstMember, uint32_t memberCount)
+{
+	if ((!outStructMembers && memberCount > 0) || !module)
+		return false;
+
+	auto& pipelines = *module->module->pipelines();
+	if (pipelineIndex >= pipelines.size())
+		return false;
+	auto& structs = *pipelines[pipelineIndex]->structs();
+	if (structIndex >= structs.size())
+		return false;
+	auto& members = *structs[structIndex]->members();
+	if (!isRangeValid(firstMember, memberCount, members.size()))
+		return false;
+
+	for (uint32_t i = 0; i < memberCount; ++i)
+		fillStructMember(outStructMembers + i, members[firstMember + i]);
 	return true;
 }
 
@@ -865,20 +2078,41 @@ bool mslModule_uniform(mslUniform* outUniform, const mslModule* module, uint32_t
 	if (uniformIndex >= uniforms.size())
 		return false;
 
-	const mslb::Uniform* uniform = uniforms[uniformIndex];
-	outUniform->name = uniform->name()->c_str();
-	outUniform->uniformType = static_cast<mslUniformType>(uniform->uniformType());
-	outUniform->type = static_cast<mslType>(uniform->type());
-	outUniform->structIndex = uniform->structIndex();
-	auto arrayElements = uniform->arrayElements();
-	outUniform->arrayElementCount = arrayElements ? arrayElements->size() : 0;
-	outUniform->descriptorSet = uniform->descriptorSet();
-	outUniform->binding = uniform->binding();
-	outUniform->inputAttachmentIndex = uniform->inputAttachmentIndex();
-	outUniform->samplerIndex = uniform->samplerIndex();
+	fillUniform(outUniform, uniforms[uniformIndex]);
+	return true;
+}
+
+bool mslModule_uniforms(mslUniform* outUniforms, const mslModule* module, uint32_t pipelineIndex,
+	uint32_t firstUniform, uint32_t uniformCount)
+{
+	if ((!outUniforms && uniformCount > 0) || !module)
+		return false;
+
+	auto& pipelines = *module->module->pipelines();
+	if (pipelineIndex >= pipelines.size())
+		return false;
+	auto& uniforms = *pipelines[pipelineIndex]->uniforms();
+	if (!isRangeValid(firstUniform, uniformCount, uniforms.size()))
+		return false;
+
+	for (uint32_t i = 0; i < uniformCount; ++i)
+		fillUniform(outUniforms + i, uniforms[firstUniform + i]);
 	return true;
 }
 
+uint32_t mslModule_findUniform(const mslModule* module, uint32_t pipelineIndex, const char* name)
+{
+	if (!module || !name)
+		return MSL_UNKNOWN;
+
+	auto& pipelines = *module->module->pipelines();
+	if (pipelineIndex >= pipelines.size())
+		return MSL_UNKNOWN;
+
+	const mslb::Pipeline* pipeline = pipelines[pipelineIndex];
+	return findByName(*pipeline->uniforms(), pipeline->uniformNameOrder(), name);
+}
+
 bool mslModule_uniformArrayInfo(mslArrayInfo* outArrayInfo, const mslModule* module,
 	uint32_t pipelineIndex, uint32_t uniformIndex, uint32_t arrayElement)
 {
@@ -914,32 +2148,95 @@ bool mslModule_attribute(mslAttribute* outAttribute, const mslModule* module,
 	if (attributeIndex >= attributes.size())
 		return false;
 
-	const mslb::Attribute* attribute = attributes[attributeIndex];
-	outAttribute->name = attribute->name()->c_str();
-	outAttribute->type = static_cast<mslType>(attribute->type());
-	auto arrayElements = attribute->arrayElements();
-	outAttribute->arrayElementCount = arrayElements ? arrayElements->size() : 0;
-	outAttribute->location = attribute->location();
-	outAttribute->component = attribute->component();
+	fillAttribute(outAttribute, attributes[attributeIndex]);
+	return true;
+}
+
+bool mslModule_attributes(mslAttribute* outAttributes, const mslModule* module,
+	uint32_t pipelineIndex, uint32_t firstAttribute, uint32_t attributeCount)
+{
+	if ((!outAttributes && attributeCount > 0) || !module)
+		return false;
+
+	auto& pipelines = *module->module->pipelines();
+	if (pipelineIndex >= pipelines.size())
+		return false;
+	auto& attributes = *pipelines[pipelineIndex]->attributes();
+	if (!isRangeValid(firstAttribute, attributeCount, attributes.size()))
+		return false;
+
+	for (uint32_t i = 0; i < attributeCount; ++i)
+		fillAttribute(outAttributes + i, attributes[firstAttribute + i]);
+	return true;
+}
+
+uint32_t mslModule_findAttribute(const mslModule* module, uint32_t pipelineIndex,
+	const char* name)
+{
+	if (!module || !name)
+		return MSL_UNKNOWN;
+
+	auto& pipelines = *module->module->pipelines();
+	if (pipelineIndex >= pipelines.size())
+		return MSL_UNKNOWN;
+
+	const mslb::Pipeline* pipeline = pipelines[pipelineIndex];
+	return findByName(*pipeline->attributes(), pipeline->attributeNameOrder(), name);
+}
+
+bool mslModule_fragmentOutput(mslFragmentOutput* outOutput, const mslModule* module,
+	uint32_t pipelineIndex, uint32_t outputIndex)
+{
+	if (!outOutput || !module)
+		return false;
+
+	auto& pipelines = *module->module->pipelines();
+	if (pipelineIndex >= pipelines.size())
+		return false;
+	auto& fragmentOutputs = *pipelines[pipelineIndex]->fragmentOutputs();
+	if (outputIndex >= fragmentOutputs.size())
+		return false;
+
+	fillFragmentOutput(outOutput, fragmentOutputs[outputIndex]);
+	return true;
+}
+
+bool mslModule_fragmentOutputs(mslFragmentOutput* outOutputs, const mslModule* module,
+	uint32_t pipelineIndex, uint32_t firstOutput, uint32_t outputCount)
+{
+	if ((!outOutputs && outputCount > 0) || !module)
+		return false;
+
+	auto& pipelines = *module->module->pipelines();
+	if (pipelineIndex >= pipelines.size())
+		return false;
+	auto& fragmentOutputs = *pipelines[pipelineIndex]->fragmentOutputs();
+	if (!isRangeValid(firstOutput, outputCount, fragmentOutputs.size()))
+		return false;
+
+	for (uint32_t i = 0; i < outputCount; ++i)
+		fillFragmentOutput(outOutputs + i, fragmentOutputs[firstOutput + i]);
 	return true;
 }
 
-bool mslModule_fragmentOutput(mslFragmentOutput* outOutput, const mslModule* module,
-	uint32_t pipelineIndex, uint32_t outputIndex)
+bool mslModule_specializationConstant(mslSpecializationConstant* outConstant,
+	const mslModule* module, uint32_t pipelineIndex, uint32_t constantIndex)
 {
-	if (!outOutput || !module)
+	if (!outConstant || !module)
 		return false;
 
 	auto& pipelines = *module->module->pipelines();
 	if (pipelineIndex >= pipelines.size())
 		return false;
-	auto& fragmentOutputs = *pipelines[pipelineIndex]->fragmentOutputs();
-	if (outputIndex >= fragmentOutputs.size())
+	auto specializationConstants = pipelines[pipelineIndex]->specializationConstants();
+	if (!specializationConstants || constantIndex >= specializationConstants->size())
 		return false;
 
-	const mslb::FragmentOutput* fragmentOutput = fragmentOutputs[outputIndex];
-	outOutput->name = fragmentOutput->name()->c_str();
-	outOutput->location = fragmentOutput->location();
+	const mslb::SpecializationConstant* specConstant = (*specializationConstants)[constantIndex];
+	outConstant->name = specConstant->name()->c_str();
+	outConstant->type = static_cast<mslType>(specConstant->type());
+	outConstant->id = specConstant->id();
+	outConstant->defaultValue = specConstant->defaultValue();
 	return true;
 }
 
@@ -1120,34 +2417,97 @@ bool mslModule_setUniformBinding(mslModule* module, uint32_t pipelineIndex, uint
 		return false;
 
 	const mslb::Pipeline* pipeline = pipelines[pipelineIndex];
-	auto& uniforms = *pipeline->uniforms();
-	if (uniformIndex >= uniforms.size())
+	if (uniformIndex >= pipeline->uniforms()->size() ||
+		!canSetUniformBinding((*pipeline->uniforms())[uniformIndex]))
+	{
 		return false;
-	mslb::Uniform* uniform = const_cast<mslb::Uniform*>(uniforms[uniformIndex]);
+	}
 
-	// Set the new indices.
-	if (!uniform->mutate_descriptorSet(descriptorSet))
-		return false;
-	if (!uniform->mutate_binding(binding))
+	mslSizedData shaderDataArray[mslStage_Count];
+	if (!getPipelineShaderData(shaderDataArray, module, pipeline))
 		return false;
 
-	// Modify the SPIR-V.
-	mslSizedData shaderDataArray[mslStage_Count] = {};
-	const auto& shaderRefs = *pipeline->shaders();
-	auto& shaderData = *module->module->shaders();
-	for (int i = 0; i < mslStage_Count; ++i)
+	// Wrapped data is only copied once a binding changes.
+	if (module->wrappedData)
 	{
-		uint32_t shaderIndex = shaderRefs[i]->shader();
-		if (shaderIndex == MSL_UNKNOWN)
-			continue;
+		const mslb::Uniform* uniform = (*pipeline->uniforms())[uniformIndex];
+		if (uniform->descriptorSet() == descriptorSet && uniform->binding() == binding)
+			return true;
+
+		if (!copyWrappedData(module))
+			return false;
 
-		shaderDataArray[i].data = const_cast<uint8_t*>(shaderData[shaderIndex]->data()->data());
-		shaderDataArray[i].size = shaderData[shaderIndex]->data()->size();
+		pipeline = (*module->module->pipelines())[pipelineIndex];
+		if (!getPipelineShaderData(shaderDataArray, module, pipeline))
+			return false;
 	}
+
+	// Set the new indices, which can't fail after checking the fields are present.
+	mslb::Uniform* uniform = const_cast<mslb::Uniform*>((*pipeline->uniforms())[uniformIndex]);
+	uniform->mutate_descriptorSet(descriptorSet);
+	uniform->mutate_binding(binding);
+
+	// Modify the SPIR-V.
 	setUniformBinding(*pipeline->shaders(), shaderDataArray, uniformIndex, descriptorSet, binding);
 	return true;
 }
 
+bool mslModule_setUniformBindings(mslModule* module, uint32_t pipelineIndex,
+	const uint32_t* descriptorSets, const uint32_t* bindings)
+{
+	if (!module || !module->module->adjustableBindings() || !descriptorSets || !bindings)
+		return false;
+
+	auto& pipelines = *module->module->pipelines();
+	if (pipelineIndex >= pipelines.size())
+		return false;
+
+	// Validate every uniform before writing anything so a failure doesn't leave the pipeline
+	// partially updated.
+	const mslb::Pipeline* pipeline = pipelines[pipelineIndex];
+	for (const mslb::Uniform* uniform : *pipeline->uniforms())
+	{
+		if (!canSetUniformBinding(uniform))
+			return false;
+	}
+
+	mslSizedData shaderDataArray[mslStage_Count];
+	if (!getPipelineShaderData(shaderDataArray, module, pipeline))
+		return false;
+
+	// Wrapped data is only copied once a binding changes.
+	if (module->wrappedData)
+	{
+		auto& uniforms = *pipeline->uniforms();
+		bool changed = false;
+		for (uint32_t i = 0; i < uniforms.size() && !changed; ++i)
+		{
+			changed = uniforms[i]->descriptorSet() != descriptorSets[i] ||
+				uniforms[i]->binding() != bindings[i];
+		}
+		if (!changed)
+			return true;
+
+		if (!copyWrappedData(module))
+			return false;
+
+		pipeline = (*module->module->pipelines())[pipelineIndex];
+		if (!getPipelineShaderData(shaderDataArray, module, pipeline))
+			return false;
+	}
+
+	auto& uniforms = *pipeline->uniforms();
+	for (uint32_t i = 0; i < uniforms.size(); ++i)
+	{
+		mslb::Uniform* uniform = const_cast<mslb::Uniform*>(uniforms[i]);
+		uniform->mutate_descriptorSet(descriptorSets[i]);
+		uniform->mutate_binding(bindings[i]);
+		setUniformBinding(*pipeline->shaders(), shaderDataArray, i, descriptorSets[i],
+			bindings[i]);
+	}
+	return true;
+}
+
 bool mslModule_setUniformBindingCopy(const mslModule* module, uint32_t pipelineIndex,
 	uint32_t uniformIndex, uint32_t descriptorSet, uint32_t binding,
 	mslSizedData shaderData[mslStage_Count])
@@ -1165,23 +2525,33 @@ bool mslModule_setUniformBindingCopy(const mslModule* module, uint32_t pipelineI
 		return false;
 
 	// Modify the SPIR-V.
-	const auto& expectedShaders = *pipeline->shaders();
-	const auto& expectedShaderData = *module->module->shaders();
-	for (int i = 0; i < mslStage_Count; ++i)
+	if (!isShaderDataCopyValid(module, pipeline, shaderData))
+		return false;
+	setUniformBinding(*pipeline->shaders(), shaderData, uniformIndex, descriptorSet, binding);
+	return true;
+}
+
+bool mslModule_setUniformBindingsCopy(const mslModule* module, uint32_t pipelineIndex,
+	const uint32_t* descriptorSets, const uint32_t* bindings,
+	mslSizedData shaderData[mslStage_Count])
+{
+	if (!module || !descriptorSets || !bindings)
+		return false;
+
+	auto& pipelines = *module->module->pipelines();
+	if (pipelineIndex >= pipelines.size())
+		return false;
+
+	const mslb::Pipeline* pipeline = pipelines[pipelineIndex];
+	if (!isShaderDataCopyValid(module, pipeline, shaderData))
+		return false;
+
+	uint32_t uniformCount = pipeline->uniforms()->size();
+	for (uint32_t i = 0; i < uniformCount; ++i)
 	{
-		uint32_t shaderIndex = expectedShaders[i]->shader();
-		if (shaderIndex == MSL_UNKNOWN)
-		{
-			if (shaderData[i].size > 0)
-				return false;
-		}
-		else
-		{
-			if (shaderData[i].size != expectedShaderData[shaderIndex]->data()->size())
-				return false;
-		}
+		setUniformBinding(*pipeline->shaders(), shaderData, i, descriptorSets[i],
+			bindings[i]);
 	}
-	setUniformBinding(*pipeline->shaders(), shaderData, uniformIndex, descriptorSet, binding);
 	return true;
 }
 
@@ -1202,7 +2572,7 @@ uint32_t mslModule_shaderSize(const mslModule* module, uint32_t shader)
 	if (shader >= shaders.size())
 		return 0;
 
-	return shaders[shader]->data()->size();
+	return getShaderSize(shaders[shader]);
 }
 
 const void* mslModule_shaderData(const mslModule* module, uint32_t shader)
@@ -1214,7 +2584,125 @@ const void* mslModule_shaderData(const mslModule* module, uint32_t shader)
 	if (shader >= shaders.size())
 		return nullptr;
 
-	return shaders[shader]->data()->data();
+	return getShaderData(module, shader);
+}
+
+bool mslModule_readShaderData(void* outData, const mslModule* module, uint32_t shader)
+{
+	if (!outData || !module)
+	{
+		errno = EINVAL;
+		return false;
+	}
+
+	auto& shaders = *module->module->shaders();
+	if (shader >= shaders.size())
+	{
+		errno = EINVAL;
+		return false;
+	}
+
+	const mslb::ShaderData* shaderData = shaders[shader];
+	uint32_t size = getShaderSize(shaderData);
+	if (!enumInRange(shaderData->compression()) || !enumInRange(shaderData->encoding()))
+	{
+		errno = invalidFormatErrno;
+		return false;
+	}
+
+	// Data stored as-is in memory has already been swapped and checked when loaded.
+	uint8_t* bytes = reinterpret_cast<uint8_t*>(outData);
+	bool stored = isShaderStored(shaderData);
+	const uint8_t* data = getStoredShaderData(module, shader);
+	if (data)
+	{
+		if (stored)
+		{
+			memcpy(outData, data, size);
+			return true;
+		}
+
+		mslb::MemoryCompressionSource source(data, getStoredShaderSize(shaderData));
+		if (!decodeShaderData(bytes, size, shaderData, source))
+		{
+			errno = invalidFormatErrno;
+			return false;
+		}
+	}
+	else
+	{
+		if (!module->seekFunc(module->streamUserData,
+				module->payloadOffset + shaderData->payloadOffset()))
+		{
+			errno = EIO;
+			return false;
+		}
+
+		if (stored)
+		{
+			if (!readStreamData(module->readFunc, module->streamUserData, outData, size))
+			{
+				errno = EIO;
+				return false;
+			}
+
+			if (module->validation != mslValidation_None &&
+				!isPayloadChecksumValid(shaderData, outData))
+			{
+				errno = invalidFormatErrno;
+				return false;
+			}
+		}
+		else
+		{
+			// Decompress while reading so the compressed data doesn't need a separate buffer.
+			StreamCompressionSource source(module->readFunc, module->streamUserData,
+				shaderData->payloadSize());
+			if (!decodeShaderData(bytes, size, shaderData, source))
+			{
+				errno = source.readFailed() ? EIO : invalidFormatErrno;
+				return false;
+			}
+
+			uint64_t checksum = shaderData->payloadChecksum();
+			if (module->validation != mslValidation_None && checksum != 0 &&
+				checksum != source.checksum())
+			{
+				errno = invalidFormatErrno;
+				return false;
+			}
+		}
+	}
+
+	if (needsSwap(module->module))
+		swapShaderData(outData, size);
+	return true;
+}
+
+uint32_t mslModule_shaderAlignment(const mslModule* module)
+{
+	if (!module)
+		return 0;
+
+	uint32_t alignment = module->module->shaderAlignment();
+	if (alignment == 0)
+		return 1;
+
+	// The alignment is relative to the start of the buffer, so reduce it if the memory the module
+	// was loaded into is less aligned.
+	auto& shaders = *module->module->shaders();
+	for (uint32_t i = 0; i < shaders.size(); ++i)
+	{
+		const uint8_t* data = getShaderData(module, i);
+		if (!data || getShaderSize(shaders[i]) == 0)
+			continue;
+
+		uintptr_t address = reinterpret_cast<uintptr_t>(data);
+		while (address & (alignment - 1))
+			alignment >>= 1;
+	}
+
+	return alignment;
 }
 
 bool mslModule_shaderUsesPushConstants(const mslModule* module, uint32_t shader)
@@ -1245,15 +2733,186 @@ const void* mslModule_sharedData(const mslModule* module)
 	return module->module->sharedData()->data();
 }
 
+uint32_t mslModule_variantKeywordCount(const mslModule* module)
+{
+	if (!module)
+		return 0;
+
+	auto keywords = module->module->variantKeywords();
+	return keywords ? keywords->size() : 0;
+}
+
+const char* mslModule_variantKeywordName(const mslModule* module, uint32_t keywordIndex)
+{
+	if (!module)
+		return nullptr;
+
+	auto keywords = module->module->variantKeywords();
+	if (!keywords || keywordIndex >= keywords->size())
+		return nullptr;
+
+	return (*keywords)[keywordIndex]->name()->c_str();
+}
+
+uint32_t mslModule_variantKeywordValueCount(const mslModule* module, uint32_t keywordIndex)
+{
+	if (!module)
+		return 0;
+
+	auto keywords = module->module->variantKeywords();
+	if (!keywords || keywordIndex >= keywords->size())
+		return 0;
+
+	return (*keywords)[keywordIndex]->values()->size();
+}
+
+const char* mslModule_variantKeywordValue(const mslModule* module, uint32_t keywordIndex,
+	uint32_t valueIndex)
+{
+	if (!module)
+		return nullptr;
+
+	auto keywords = module->module->variantKeywords();
+	if (!keywords || keywordIndex >= keywords->size())
+		return nullptr;
+
+	auto& values = *(*keywords)[keywordIndex]->values();
+	if (valueIndex >= values.size())
+		return nullptr;
+
+	return values[valueIndex]->c_str();
+}
+
+uint32_t mslModule_variantPermutationCount(const mslModule* module)
+{
+	if (!module)
+		return 0;
+
+	return variantPermutationCount(module->module);
+}
+
+uint32_t mslModule_variantPermutationIndex(const mslModule* module, const uint32_t* valueIndices)
+{
+	if (!module || !valueIndices)
+		return MSL_UNKNOWN;
+
+	auto keywords = module->module->variantKeywords();
+	if (!keywords || keywords->size() == 0)
+		return MSL_UNKNOWN;
+
+	uint64_t index = 0;
+	uint64_t stride = 1;
+	for (uint32_t i = 0; i < keywords->size(); ++i)
+	{
+		uint32_t valueCount = (*keywords)[i]->values()->size();
+		if (valueIndices[i] >= valueCount)
+			return MSL_UNKNOWN;
+
+		index += valueIndices[i]*stride;
+		stride *= valueCount;
+		if (stride >= MSL_UNKNOWN)
+			return MSL_UNKNOWN;
+	}
+
+	return static_cast<uint32_t>(index);
+}
+
+uint32_t mslModule_variantCount(const mslModule* module)
+{
+	if (!module)
+		return 0;
+
+	auto variants = module->module->variants();
+	return variants ? variants->size() : 0;
+}
+
+const char* mslModule_variantName(const mslModule* module, uint32_t variantIndex)
+{
+	if (!module)
+		return nullptr;
+
+	auto variants = module->module->variants();
+	if (!variants || variantIndex >= variants->size())
+		return nullptr;
+
+	return (*variants)[variantIndex]->name()->c_str();
+}
+
+uint32_t mslModule_findVariant(const mslModule* module, const char* name)
+{
+	if (!module || !name)
+		return MSL_UNKNOWN;
+
+	auto variants = module->module->variants();
+	if (!variants)
+		return MSL_UNKNOWN;
+
+	// Variants are sorted by name.
+	uint32_t begin = 0;
+	uint32_t end = variants->size();
+	while (begin < end)
+	{
+		uint32_t mid = begin + (end - begin)/2;
+		int compare = strcmp((*variants)[mid]->name()->c_str(), name);
+		if (compare == 0)
+			return mid;
+		else if (compare < 0)
+			begin = mid + 1;
+		else
+			end = mid;
+	}
+
+	return MSL_UNKNOWN;
+}
+
+uint32_t mslModule_variantPipeline(const mslModule* module, uint32_t variantIndex,
+	uint32_t permutationIndex)
+{
+	if (!module)
+		return MSL_UNKNOWN;
+
+	auto variants = module->module->variants();
+	if (!variants || variantIndex >= variants->size())
+		return MSL_UNKNOWN;
+
+	auto& pipelines = *(*variants)[variantIndex]->pipelines();
+	if (permutationIndex >= pipelines.size())
+		return MSL_UNKNOWN;
+
+	return pipelines[permutationIndex];
+}
+
 void mslModule_destroy(mslModule* module)
 {
-	if (!module || (module->allocator.allocateFunc && !module->allocator.freeFunc))
+	if (!module)
+		return;
+
+	if (module->mappedData)
+	{
+		unmapFileData(module->mappedData, module->mappedSize);
+		module->mappedData = nullptr;
+	}
+
+	if (module->file)
+	{
+		fclose(module->file);
+		module->file = nullptr;
+	}
+
+	if (module->allocator.allocateFunc && !module->allocator.freeFunc)
 		return;
 
 	if (module->allocator.freeFunc)
+	{
+		if (module->copiedData)
+			module->allocator.freeFunc(module->allocator.userData, module->copiedData);
 		module->allocator.freeFunc(module->allocator.userData, module);
+	}
 	else
+	{
+		free(module->copiedData);
 		free(module);
+	}
 }
 
 } // extern "C"
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2019 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -16,18 +16,123 @@
 
 #include <MSL/Client/ModuleCpp.h>
 #include "Helpers.h"
+
+#if MSL_GCC || MSL_CLANG
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wconversion"
+#elif MSL_MSC
+#pragma warning(push)
+#pragma warning(disable: 4244)
+#endif
+
+#include "mslb_generated.h"
+
+#if MSL_GCC || MSL_CLANG
+#pragma GCC diagnostic pop
+#elif MSL_MSC
+#pragma warning(pop)
+#endif
+
+#include "mslb_checksum.h"
+#include "mslb_compression.h"
+#include "mslb_sections.h"
+#include "mslb_spirv_encoding.h"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
+#include <sstream>
 #include <errno.h>
 
 namespace msl
 {
 
+static flatbuffers::Offset<mslb::Pipeline> createEmptyPipeline(
+	flatbuffers::FlatBufferBuilder& builder, const char* name,
+	flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<mslb::SpecializationConstant>>>
+		specializationConstants = 0,
+	flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<mslb::Attribute>>> attributes = 0,
+	flatbuffers::Offset<flatbuffers::Vector<uint32_t>> attributeNameOrder = 0,
+	flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<mslb::Uniform>>> uniforms = 0)
+{
+	if (attributes.IsNull())
+		attributes = builder.CreateVector(std::vector<flatbuffers::Offset<mslb::Attribute>>());
+	if (uniforms.IsNull())
+		uniforms = builder.CreateVector(std::vector<flatbuffers::Offset<mslb::Uniform>>());
+
+	mslb::RasterizationState rasterizationState;
+	mslb::MultisampleState multisampleState;
+	mslb::DepthStencilState depthStencilState;
+	std::vector<mslb::BlendAttachmentState> blendAttachments(MSL_MAX_ATTACHMENTS);
+	float blendConstants[4] = {};
+	auto blendState = mslb::CreateBlendState(builder, mslb::Bool::False, mslb::LogicOp::Clear,
+		mslb::Bool::False, builder.CreateVectorOfStructs(blendAttachments),
+		builder.CreateVector(blendConstants, 4));
+
+	std::vector<flatbuffers::Offset<mslb::Shader>> shaders;
+	for (int i = 0; i < mslStage_Count; ++i)
+		shaders.push_back(mslb::CreateShader(builder, unknown, 0));
+
+	mslb::ComputeLocalSize computeLocalSize;
+	return mslb::CreatePipeline(builder, builder.CreateString(name),
+		builder.CreateVector(std::vector<flatbuffers::Offset<mslb::Struct>>()),
+		builder.CreateVectorOfStructs(std::vector<mslb::SamplerState>()), uniforms, attributes,
+		builder.CreateVector(std::vector<flatbuffers::Offset<mslb::FragmentOutput>>()), unknown,
+		mslb::CreateRenderState(builder, &rasterizationState, &multisampleState,
+			&depthStencilState, blendState),
+		builder.CreateVector(shaders), &computeLocalSize, specializationConstants, 0, 0,
+		attributeNameOrder);
+}
+
+static std::vector<uint8_t> createVariantModule(bool sortedVariants = true,
+	bool checksum = false)
+{
+	flatbuffers::FlatBufferBuilder builder;
+	std::vector<flatbuffers::Offset<mslb::Pipeline>> pipelines;
+	const char* pipelineNames[] = {"Opaque", "Opaque[FOG=0,SHADOWS=HIGH]",
+		"Opaque[FOG=0,SHADOWS=LOW]", "Opaque[FOG=1,SHADOWS=LOW]", "Shadow"};
+	for (const char* name : pipelineNames)
+		pipelines.push_back(createEmptyPipeline(builder, name));
+
+	std::vector<flatbuffers::Offset<mslb::VariantKeyword>> keywords;
+	keywords.push_back(mslb::CreateVariantKeyword(builder, builder.CreateString("FOG"),
+		builder.CreateVectorOfStrings({"0", "1"})));
+	keywords.push_back(mslb::CreateVariantKeyword(builder, builder.CreateString("SHADOWS"),
+		builder.CreateVectorOfStrings({"LOW", "HIGH"})));
+
+	// The last permutation shares the pipeline with the first variant.
+	std::vector<flatbuffers::Offset<mslb::Variant>> variants;
+	variants.push_back(mslb::CreateVariant(builder, builder.CreateString("Opaque"),
+		builder.CreateVector(std::vector<uint32_t>{2, 3, 1, 2})));
+	variants.push_back(mslb::CreateVariant(builder, builder.CreateString("Shadow"),
+		builder.CreateVector(std::vector<uint32_t>{4, unknown, 4, unknown})));
+	if (!sortedVariants)
+		std::swap(variants[0], variants[1]);
+
+	builder.Finish(mslb::CreateModule(builder, moduleVersion, MSL_CREATE_ID('S', 'P', 'R', 'V'),
+		0x10000, false, builder.CreateVector(pipelines),
+		builder.CreateVector(std::vector<flatbuffers::Offset<mslb::ShaderData>>()),
+		builder.CreateVector(std::vector<uint8_t>()), builder.CreateVector(keywords),
+		builder.CreateVector(variants), false, checksum ? ~0ULL : 0));
+	std::vector<uint8_t> data(builder.GetBufferPointer(),
+		builder.GetBufferPointer() + builder.GetSize());
+	if (checksum)
+	{
+		const uint8_t* checksumAddress = flatbuffers::GetRoot<flatbuffers::Table>(data.data())
+			->GetAddressOf(mslb::Module::VT_CHECKSUM);
+		mslb::GetMutableModule(data.data())->mutate_checksum(mslb::computeChecksum(data.data(),
+			data.size(), checksumAddress - data.data()));
+	}
+	return data;
+}
+
 static void testContents(Module& module)
 {
-	EXPECT_EQ(moduleVersion, module.version());
+	EXPECT_EQ(0U, module.version());
 	EXPECT_EQ(MSL_CREATE_ID('S', 'P', 'R', 'V'), module.targetId());
 	EXPECT_LE(100U, module.targetVersion());
+	EXPECT_FALSE(module.argumentBuffers());
+	EXPECT_EQ(mslShaderDataFormat_Native, module.shaderDataFormat());
 
 	ASSERT_EQ(1U, module.pipelineCount());
 	Pipeline pipeline;
@@ -38,6 +143,7 @@ static void testContents(Module& module)
 	EXPECT_EQ(unknown, pipeline.shaders[static_cast<int>(Stage::TessellationEvaluation)]);
 	EXPECT_EQ(unknown, pipeline.shaders[static_cast<int>(Stage::Geometry)]);
 	EXPECT_EQ(1U, pipeline.shaders[static_cast<int>(Stage::Fragment)]);
+	EXPECT_EQ(0U, pipeline.specializationConstantCount);
 	EXPECT_EQ(unknown, pipeline.shaders[static_cast<int>(Stage::Compute)]);
 	EXPECT_EQ(1U, pipeline.computeLocalSize[0]);
 	EXPECT_EQ(1U, pipeline.computeLocalSize[1]);
@@ -175,9 +281,11 @@ static void testContents(Module& module)
 
 static void testContents(const mslModule* module)
 {
-	EXPECT_EQ(MSL_MODULE_VERSION, mslModule_version(module));
+	EXPECT_EQ(0U, mslModule_version(module));
 	EXPECT_EQ(MSL_CREATE_ID('S', 'P', 'R', 'V'), mslModule_targetId(module));
 	EXPECT_LE(100U, mslModule_targetVersion(module));
+	EXPECT_FALSE(mslModule_argumentBuffers(module));
+	EXPECT_EQ(mslShaderDataFormat_Native, mslModule_shaderDataFormat(module));
 
 	ASSERT_EQ(1U, mslModule_pipelineCount(module));
 	mslPipeline pipeline;
@@ -188,6 +296,7 @@ static void testContents(const mslModule* module)
 	EXPECT_EQ(MSL_UNKNOWN, pipeline.shaders[mslStage_TessellationEvaluation]);
 	EXPECT_EQ(MSL_UNKNOWN, pipeline.shaders[mslStage_Geometry]);
 	EXPECT_EQ(1U, pipeline.shaders[mslStage_Fragment]);
+	EXPECT_EQ(0U, pipeline.specializationConstantCount);
 	EXPECT_EQ(unknown, pipeline.shaders[mslStage_Compute]);
 	EXPECT_EQ(1U, pipeline.computeLocalSize[0]);
 	EXPECT_EQ(1U, pipeline.computeLocalSize[1]);
@@ -334,7 +443,7 @@ static void testContents(const mslModule* module)
 
 static void testComputeContents(Module& module)
 {
-	EXPECT_EQ(moduleVersion, module.version());
+	EXPECT_EQ(0U, module.version());
 	EXPECT_EQ(MSL_CREATE_ID('S', 'P', 'R', 'V'), module.targetId());
 	EXPECT_LE(100U, module.targetVersion());
 
@@ -412,6 +521,608 @@ TEST(ModuleTest, ReadData)
 	testContents(module);
 }
 
+TEST(ModuleTest, WrapData)
+{
+	std::vector<uint8_t> data = createVariantModule();
+	Module module;
+	ASSERT_TRUE(module.wrap(data.data(), data.size()));
+	EXPECT_EQ(5U, module.pipelineCount());
+
+	// The pipeline names reference the original buffer.
+	Pipeline pipeline;
+	EXPECT_TRUE(module.pipeline(pipeline, 0));
+	EXPECT_STREQ("Opaque", pipeline.name);
+	EXPECT_LE(data.data(), reinterpret_cast<const uint8_t*>(pipeline.name));
+	EXPECT_GT(data.data() + data.size(), reinterpret_cast<const uint8_t*>(pipeline.name));
+
+	EXPECT_FALSE(module.wrap(data.data(), data.size() - 18));
+	EXPECT_EQ(EILSEQ, errno);
+}
+
+static std::vector<uint8_t> createAlignedShaderModule(uint32_t alignment)
+{
+	flatbuffers::FlatBufferBuilder builder;
+	std::vector<flatbuffers::Offset<mslb::Pipeline>> pipelines;
+	pipelines.push_back(createEmptyPipeline(builder, "Test"));
+
+	std::vector<flatbuffers::Offset<mslb::ShaderData>> shaders;
+	const std::vector<uint8_t> shaderData[] = {{1, 2, 3, 4, 5}, {6, 7, 8, 9, 10, 11, 12, 13}};
+	for (const std::vector<uint8_t>& data : shaderData)
+	{
+		builder.PreAlign(data.size(), 64);
+		shaders.push_back(mslb::CreateShaderData(builder, builder.CreateVector(data)));
+	}
+
+	builder.Finish(mslb::CreateModule(builder, moduleVersion, MSL_CREATE_ID('S', 'P', 'R', 'V'),
+		0x10000, false, builder.CreateVector(pipelines), builder.CreateVector(shaders),
+		builder.CreateVector(std::vector<uint8_t>()), 0, 0, false, 0, alignment));
+	return std::vector<uint8_t>(builder.GetBufferPointer(),
+		builder.GetBufferPointer() + builder.GetSize());
+}
+
+TEST(ModuleTest, ShaderAlignment)
+{
+	std::vector<uint8_t> data = createAlignedShaderModule(64);
+
+	// Copy to a buffer with a known alignment.
+	std::vector<uint8_t> alignedStorage(data.size() + 128);
+	uint8_t* alignedData = alignedStorage.data() +
+		(64 - reinterpret_cast<uintptr_t>(alignedStorage.data()) % 64);
+	memcpy(alignedData, data.data(), data.size());
+
+	Module module;
+	ASSERT_TRUE(module.wrap(alignedData, data.size()));
+	EXPECT_EQ(64U, module.shaderAlignment());
+	ASSERT_EQ(2U, module.shaderCount());
+	EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(module.shaderData(0)) % 64);
+	EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(module.shaderData(1)) % 64);
+
+	// Limited by the alignment of the buffer.
+	memmove(alignedData + 8, alignedData, data.size());
+	ASSERT_TRUE(module.wrap(alignedData + 8, data.size()));
+	EXPECT_EQ(8U, module.shaderAlignment());
+
+	// Copied data is at least aligned to the stored alignment or the allocator's alignment.
+	ASSERT_TRUE(module.read(data.data(), data.size()));
+	EXPECT_LE(8U, module.shaderAlignment());
+	EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(module.shaderData(0)) % module.shaderAlignment());
+
+	// Alignment must be a power of two.
+	data = createAlignedShaderModule(48);
+	EXPECT_FALSE(module.read(data.data(), data.size()));
+	EXPECT_EQ(EILSEQ, errno);
+
+	// Modules without aligned data have no guarantee.
+	std::string fileName = pathStr(exeDir/"CompleteShader.mslb");
+	ASSERT_TRUE(module.read(fileName));
+	EXPECT_EQ(1U, module.shaderAlignment());
+}
+
+static std::vector<uint8_t> createSectionedModule(uint32_t version = moduleVersion)
+{
+	const uint32_t alignment = 16;
+	const std::vector<uint8_t> payloads[] = {{1, 2, 3, 4, 5, 6, 7, 8},
+		{9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20}};
+
+	flatbuffers::FlatBufferBuilder builder;
+	std::vector<flatbuffers::Offset<mslb::Pipeline>> pipelines;
+	pipelines.push_back(createEmptyPipeline(builder, "Test"));
+
+	std::vector<flatbuffers::Offset<mslb::ShaderData>> shaders;
+	uint32_t payloadOffset = 0;
+	for (const std::vector<uint8_t>& payload : payloads)
+	{
+		uint32_t payloadSize = static_cast<uint32_t>(payload.size());
+		shaders.push_back(mslb::CreateShaderData(builder,
+			builder.CreateVector(std::vector<uint8_t>()), false, payloadOffset, payloadSize,
+			mslb::computeChecksum(payload.data(), payload.size(), mslb::noChecksumOffset)));
+		payloadOffset += (payloadSize + alignment - 1) & ~(alignment - 1);
+	}
+
+	builder.Finish(mslb::CreateModule(builder, version, MSL_CREATE_ID('S', 'P', 'R', 'V'),
+		0x10000, false, builder.CreateVector(pipelines), builder.CreateVector(shaders),
+		builder.CreateVector(std::vector<uint8_t>()), 0, 0, false, 0, alignment));
+
+	mslb::SectionedHeader header;
+	header.indexSize = builder.GetSize();
+	header.payloadOffset = static_cast<uint32_t>(
+		(mslb::sectionedHeaderSize + header.indexSize + alignment - 1) & ~(alignment - 1));
+
+	std::vector<uint8_t> data(header.payloadOffset);
+	mslb::writeSectionedHeader(data.data(), header);
+	memcpy(data.data() + mslb::sectionedHeaderSize, builder.GetBufferPointer(),
+		header.indexSize);
+	for (const std::vector<uint8_t>& payload : payloads)
+	{
+		data.insert(data.end(), payload.begin(), payload.end());
+		data.resize((data.size() + alignment - 1) & ~(alignment - 1));
+	}
+	return data;
+}
+
+TEST(ModuleTest, SectionedData)
+{
+	std::vector<uint8_t> data = createSectionedModule();
+	const uint8_t expectedShader[] = {9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20};
+
+	Module module;
+	ASSERT_TRUE(module.read(data.data(), data.size()));
+	EXPECT_EQ(moduleVersion, module.version());
+	EXPECT_EQ(1U, module.pipelineCount());
+	ASSERT_EQ(2U, module.shaderCount());
+	EXPECT_EQ(8U, module.shaderSize(0));
+	ASSERT_EQ(sizeof(expectedShader), module.shaderSize(1));
+	ASSERT_NE(nullptr, module.shaderData(1));
+	EXPECT_EQ(0, memcmp(expectedShader, module.shaderData(1), sizeof(expectedShader)));
+
+	uint8_t shaderData[sizeof(expectedShader)];
+	EXPECT_TRUE(module.readShaderData(shaderData, 1));
+	EXPECT_EQ(0, memcmp(expectedShader, shaderData, sizeof(expectedShader)));
+
+	ASSERT_TRUE(module.wrap(data.data(), data.size()));
+	EXPECT_EQ(data.data() + data.size() - 16, module.shaderData(1));
+
+	// The payloads must be within the module.
+	EXPECT_FALSE(module.read(data.data(), data.size() - 16));
+	EXPECT_EQ(EILSEQ, errno);
+
+	// The payloads are covered by their own checksums.
+	std::vector<uint8_t> corruptData = data;
+	corruptData[corruptData.size() - 16] = 0;
+	EXPECT_FALSE(module.read(corruptData.data(), corruptData.size()));
+	EXPECT_EQ(EILSEQ, errno);
+
+	// Sectioned modules require a newer version.
+	data = createSectionedModule(0);
+	EXPECT_FALSE(module.read(data.data(), data.size()));
+	EXPECT_EQ(EILSEQ, errno);
+}
+
+TEST(ModuleTest, OpenSectionedStream)
+{
+	std::vector<uint8_t> data = createSectionedModule();
+	const uint8_t expectedShader[] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+	std::istringstream stream(std::string(data.begin(), data.end()));
+	Module module;
+	ASSERT_TRUE(module.open(stream));
+	EXPECT_EQ(1U, module.pipelineCount());
+	ASSERT_EQ(2U, module.shaderCount());
+	EXPECT_EQ(sizeof(expectedShader), module.shaderSize(0));
+
+	// Shaders are only read on request.
+	EXPECT_EQ(nullptr, module.shaderData(0));
+	uint8_t shaderData[sizeof(expectedShader)];
+	EXPECT_TRUE(module.readShaderData(shaderData, 0));
+	EXPECT_EQ(0, memcmp(expectedShader, shaderData, sizeof(expectedShader)));
+
+	// Bindings can't be adjusted in place without the shader data.
+	EXPECT_FALSE(module.setUniformBinding(0, 0, 1, 2));
+	EXPECT_FALSE(module.readShaderData(shaderData, 2));
+	EXPECT_EQ(EINVAL, errno);
+
+	// Corrupted payloads are detected when read.
+	std::vector<uint8_t> corruptData = data;
+	corruptData[corruptData.size() - 32] = 0;
+	std::istringstream corruptStream(std::string(corruptData.begin(), corruptData.end()));
+	ASSERT_TRUE(module.open(corruptStream));
+	EXPECT_FALSE(module.readShaderData(shaderData, 0));
+	EXPECT_EQ(EILSEQ, errno);
+
+	// The validation the module was opened with also applies when reading the shaders.
+	std::istringstream trustedStream(std::string(corruptData.begin(), corruptData.end()));
+	ASSERT_TRUE(module.open(trustedStream, mslValidation_None));
+	EXPECT_TRUE(module.readShaderData(shaderData, 0));
+
+	// Modules that aren't sectioned are read in full.
+	std::string fileName = pathStr(exeDir/"CompleteShader.mslb");
+	std::ifstream fileStream(fileName, std::ios_base::binary);
+	ASSERT_TRUE(module.open(fileStream));
+	testContents(module);
+}
+
+TEST(ModuleTest, OpenSectionedFile)
+{
+	std::vector<uint8_t> data = createSectionedModule();
+	std::string fileName = pathStr(exeDir/"Sectioned.mslb");
+	{
+		std::ofstream stream(fileName, std::ios_base::binary);
+		stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+	}
+
+	const uint8_t expectedShader[] = {9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20};
+	mslModule* module = mslModule_openFile(fileName.c_str(), mslValidation_Full, nullptr);
+	ASSERT_NE(nullptr, module);
+	EXPECT_EQ(nullptr, mslModule_shaderData(module, 1));
+
+	uint8_t shaderData[sizeof(expectedShader)];
+	EXPECT_TRUE(mslModule_readShaderData(shaderData, module, 1));
+	EXPECT_EQ(0, memcmp(expectedShader, shaderData, sizeof(expectedShader)));
+	mslModule_destroy(module);
+	std::remove(fileName.c_str());
+
+	fileName = pathStr(exeDir/"CompleteShader.mslb");
+	Module cppModule;
+	ASSERT_TRUE(cppModule.open(fileName));
+	testContents(cppModule);
+
+	EXPECT_EQ(nullptr, mslModule_openFile(nullptr, mslValidation_Full, nullptr));
+	EXPECT_EQ(EINVAL, errno);
+}
+
+static std::vector<uint8_t> createCompressibleShader()
+{
+	// Repeated instructions with small variations, similar to SPIR-V.
+	std::vector<uint8_t> data;
+	for (uint32_t i = 0; i < 256; ++i)
+	{
+		const uint32_t words[] = {0x00040047, i % 7, 33, i % 3};
+		for (uint32_t word : words)
+		{
+			for (unsigned int j = 0; j < 4; ++j)
+				data.push_back(static_cast<uint8_t>(word >> j*8));
+		}
+	}
+	return data;
+}
+
+static std::vector<uint8_t> createCompressedModule(bool sectioned,
+	uint32_t version = moduleVersion)
+{
+	std::vector<uint8_t> shader = createCompressibleShader();
+	std::vector<uint8_t> compressed(mslb::compressedSizeBound(shader.size()));
+	compressed.resize(mslb::compress(compressed.data(), shader.data(), shader.size()));
+
+	flatbuffers::FlatBufferBuilder builder;
+	std::vector<flatbuffers::Offset<mslb::Pipeline>> pipelines;
+	pipelines.push_back(createEmptyPipeline(builder, "Test"));
+
+	std::vector<flatbuffers::Offset<mslb::ShaderData>> shaders;
+	uint32_t compressedSize = static_cast<uint32_t>(compressed.size());
+	uint32_t uncompressedSize = static_cast<uint32_t>(shader.size());
+	if (sectioned)
+	{
+		shaders.push_back(mslb::CreateShaderData(builder,
+			builder.CreateVector(std::vector<uint8_t>()), false, 0, compressedSize,
+			mslb::computeChecksum(compressed.data(), compressed.size(), mslb::noChecksumOffset),
+			mslb::Compression::LZ4, uncompressedSize));
+	}
+	else
+	{
+		shaders.push_back(mslb::CreateShaderData(builder, builder.CreateVector(compressed), false,
+			0, 0, 0, mslb::Compression::LZ4, uncompressedSize));
+	}
+
+	builder.Finish(mslb::CreateModule(builder, version, MSL_CREATE_ID('S', 'P', 'R', 'V'),
+		0x10000, false, builder.CreateVector(pipelines), builder.CreateVector(shaders),
+		builder.CreateVector(std::vector<uint8_t>())));
+	std::vector<uint8_t> data(builder.GetBufferPointer(),
+		builder.GetBufferPointer() + builder.GetSize());
+	if (!sectioned)
+		return data;
+
+	mslb::SectionedHeader header;
+	header.indexSize = static_cast<uint32_t>(data.size());
+	header.payloadOffset = static_cast<uint32_t>(mslb::sectionedHeaderSize + data.size());
+	std::vector<uint8_t> sectionedData(mslb::sectionedHeaderSize);
+	mslb::writeSectionedHeader(sectionedData.data(), header);
+	sectionedData.insert(sectionedData.end(), data.begin(), data.end());
+	sectionedData.insert(sectionedData.end(), compressed.begin(), compressed.end());
+	return sectionedData;
+}
+
+TEST(ModuleTest, CompressionRoundTrip)
+{
+	std::vector<uint8_t> shader = createCompressibleShader();
+	std::vector<uint8_t> compressed(mslb::compressedSizeBound(shader.size()));
+	compressed.resize(mslb::compress(compressed.data(), shader.data(), shader.size()));
+	EXPECT_GT(shader.size()/4, compressed.size());
+
+	std::vector<uint8_t> decompressed(shader.size());
+	mslb::MemoryCompressionSource source(compressed.data(), compressed.size());
+	EXPECT_TRUE(mslb::decompress(decompressed.data(), decompressed.size(), source));
+	EXPECT_EQ(shader, decompressed);
+
+	// Data that can't be compressed still round trips within the bound.
+	std::vector<uint8_t> noise(1000);
+	uint32_t state = 1;
+	for (uint8_t& value : noise)
+	{
+		state = state*1664525U + 1013904223U;
+		value = static_cast<uint8_t>(state >> 24);
+	}
+	compressed.resize(mslb::compressedSizeBound(noise.size()));
+	compressed.resize(mslb::compress(compressed.data(), noise.data(), noise.size()));
+	EXPECT_GE(mslb::compressedSizeBound(noise.size()), compressed.size());
+
+	decompressed.resize(noise.size());
+	mslb::MemoryCompressionSource noiseSource(compressed.data(), compressed.size());
+	EXPECT_TRUE(mslb::decompress(decompressed.data(), decompressed.size(), noiseSource));
+	EXPECT_EQ(noise, decompressed);
+
+	// Truncated data or the wrong size is rejected.
+	mslb::MemoryCompressionSource truncatedSource(compressed.data(), compressed.size() - 1);
+	EXPECT_FALSE(mslb::decompress(decompressed.data(), decompressed.size(), truncatedSource));
+	mslb::MemoryCompressionSource shortSource(compressed.data(), compressed.size());
+	EXPECT_FALSE(mslb::decompress(decompressed.data(), decompressed.size() - 1, shortSource));
+}
+
+TEST(ModuleTest, StreamChecksum)
+{
+	std::vector<uint8_t> data = createCompressibleShader();
+	const std::size_t sizes[] = {0, 7, 31, 32, 33, 100, data.size()};
+	const std::size_t blockSizes[] = {1, 5, 32, 64};
+	for (std::size_t size : sizes)
+	{
+		uint64_t expectedChecksum = mslb::computeChecksum(data.data(), size,
+			mslb::noChecksumOffset);
+		for (std::size_t blockSize : blockSizes)
+		{
+			mslb::StreamChecksum checksum;
+			for (std::size_t offset = 0; offset < size; offset += blockSize)
+				checksum.update(data.data() + offset, std::min(blockSize, size - offset));
+			EXPECT_EQ(expectedChecksum, checksum.finish());
+		}
+	}
+}
+
+TEST(ModuleTest, CompressedShaders)
+{
+	std::vector<uint8_t> expectedShader = createCompressibleShader();
+	std::vector<uint8_t> data = createCompressedModule(false);
+
+	Module module;
+	ASSERT_TRUE(module.read(data.data(), data.size()));
+	ASSERT_EQ(1U, module.shaderCount());
+	EXPECT_EQ(expectedShader.size(), module.shaderSize(0));
+	EXPECT_EQ(nullptr, module.shaderData(0));
+
+	std::vector<uint8_t> shaderData(module.shaderSize(0));
+	EXPECT_TRUE(module.readShaderData(shaderData.data(), 0));
+	EXPECT_EQ(expectedShader, shaderData);
+
+	// Compressed shaders require a newer version.
+	data = createCompressedModule(false, mslb::sectionedVersion);
+	EXPECT_FALSE(module.read(data.data(), data.size()));
+	EXPECT_EQ(EILSEQ, errno);
+}
+
+TEST(ModuleTest, OpenCompressedStream)
+{
+	std::vector<uint8_t> expectedShader = createCompressibleShader();
+	std::vector<uint8_t> data = createCompressedModule(true);
+
+	// Decompressed while reading from the stream.
+	std::istringstream stream(std::string(data.begin(), data.end()));
+	Module module;
+	ASSERT_TRUE(module.open(stream));
+	ASSERT_EQ(1U, module.shaderCount());
+	EXPECT_EQ(nullptr, module.shaderData(0));
+
+	std::vector<uint8_t> shaderData(module.shaderSize(0));
+	EXPECT_TRUE(module.readShaderData(shaderData.data(), 0));
+	EXPECT_EQ(expectedShader, shaderData);
+
+	// Decompressed from memory.
+	ASSERT_TRUE(module.read(data.data(), data.size()));
+	std::fill(shaderData.begin(), shaderData.end(), 0);
+	EXPECT_TRUE(module.readShaderData(shaderData.data(), 0));
+	EXPECT_EQ(expectedShader, shaderData);
+
+	// The checksum of the compressed data is checked while reading.
+	data.back() ^= 0xFF;
+	std::istringstream corruptStream(std::string(data.begin(), data.end()));
+	ASSERT_TRUE(module.open(corruptStream));
+	EXPECT_FALSE(module.readShaderData(shaderData.data(), 0));
+	EXPECT_EQ(EILSEQ, errno);
+}
+
+static std::vector<uint8_t> createSpirVShader()
+{
+	// Header with the magic number, version, generator, ID bound, and schema.
+	const uint32_t header[] = {0x07230203, 0x10000, 0, 64, 0};
+	std::vector<uint8_t> data;
+	for (uint32_t word : header)
+	{
+		for (unsigned int j = 0; j < 4; ++j)
+			data.push_back(static_cast<uint8_t>(word >> j*8));
+	}
+
+	std::vector<uint8_t> instructions = createCompressibleShader();
+	data.insert(data.end(), instructions.begin(), instructions.end());
+	return data;
+}
+
+static std::vector<uint8_t> createEncodedModule(bool sectioned, bool compressed,
+	uint32_t version = moduleVersion)
+{
+	std::vector<uint8_t> shader = createSpirVShader();
+	std::vector<uint8_t> payload(mslb::encodedSpirVSizeBound(shader.size()));
+	payload.resize(mslb::encodeSpirV(payload.data(), shader.data(), shader.size()));
+	uint32_t encodedSize = static_cast<uint32_t>(payload.size());
+	mslb::Compression compression = mslb::Compression::None;
+	uint32_t uncompressedSize = 0;
+	if (compressed)
+	{
+		std::vector<uint8_t> compressedPayload(mslb::compressedSizeBound(payload.size()));
+		compressedPayload.resize(mslb::compress(compressedPayload.data(), payload.data(),
+			payload.size()));
+		payload = compressedPayload;
+		compression = mslb::Compression::LZ4;
+		uncompressedSize = encodedSize;
+	}
+
+	flatbuffers::FlatBufferBuilder builder;
+	std::vector<flatbuffers::Offset<mslb::Pipeline>> pipelines;
+	pipelines.push_back(createEmptyPipeline(builder, "Test"));
+
+	std::vector<flatbuffers::Offset<mslb::ShaderData>> shaders;
+	uint32_t decodedSize = static_cast<uint32_t>(shader.size());
+	if (sectioned)
+	{
+		shaders.push_back(mslb::CreateShaderData(builder,
+			builder.CreateVector(std::vector<uint8_t>()), false, 0,
+			static_cast<uint32_t>(payload.size()),
+			mslb::computeChecksum(payload.data(), payload.size(), mslb::noChecksumOffset),
+			compression, uncompressedSize, mslb::Encoding::SpirV, decodedSize));
+	}
+	else
+	{
+		shaders.push_back(mslb::CreateShaderData(builder, builder.CreateVector(payload), false,
+			0, 0, 0, compression, uncompressedSize, mslb::Encoding::SpirV, decodedSize));
+	}
+
+	builder.Finish(mslb::CreateModule(builder, version, MSL_CREATE_ID('S', 'P', 'R', 'V'),
+		0x10000, false, builder.CreateVector(pipelines), builder.CreateVector(shaders),
+		builder.CreateVector(std::vector<uint8_t>())));
+	std::vector<uint8_t> data(builder.GetBufferPointer(),
+		builder.GetBufferPointer() + builder.GetSize());
+	if (!sectioned)
+		return data;
+
+	mslb::SectionedHeader header;
+	header.indexSize = static_cast<uint32_t>(data.size());
+	header.payloadOffset = static_cast<uint32_t>(mslb::sectionedHeaderSize + data.size());
+	std::vector<uint8_t> sectionedData(mslb::sectionedHeaderSize);
+	mslb::writeSectionedHeader(sectionedData.data(), header);
+	sectionedData.insert(sectionedData.end(), data.begin(), data.end());
+	sectionedData.insert(sectionedData.end(), payload.begin(), payload.end());
+	return sectionedData;
+}
+
+TEST(ModuleTest, SpirVEncodingRoundTrip)
+{
+	std::vector<uint8_t> shader = createSpirVShader();
+	std::vector<uint8_t> encoded(mslb::encodedSpirVSizeBound(shader.size()));
+	encoded.resize(mslb::encodeSpirV(encoded.data(), shader.data(), shader.size()));
+	ASSERT_FALSE(encoded.empty());
+	EXPECT_GT(shader.size()/2, encoded.size());
+
+	std::vector<uint8_t> decoded(shader.size());
+	mslb::MemoryCompressionSource source(encoded.data(), encoded.size());
+	EXPECT_TRUE(mslb::decodeSpirV(decoded.data(), decoded.size(), source));
+	EXPECT_EQ(shader, decoded);
+
+	// Decoding in place from the end of the buffer.
+	std::fill(decoded.begin(), decoded.end(), 0);
+	uint8_t* inPlaceData = decoded.data() + decoded.size() - encoded.size();
+	std::copy(encoded.begin(), encoded.end(), inPlaceData);
+	mslb::MemoryCompressionSource inPlaceSource(inPlaceData, encoded.size());
+	EXPECT_TRUE(mslb::decodeSpirV(decoded.data(), decoded.size(), inPlaceSource));
+	EXPECT_EQ(shader, decoded);
+
+	// Encoding compresses better than the raw SPIR-V.
+	std::vector<uint8_t> compressed(mslb::compressedSizeBound(shader.size()));
+	std::size_t rawCompressedSize = mslb::compress(compressed.data(), shader.data(),
+		shader.size());
+	std::size_t encodedCompressedSize = mslb::compress(compressed.data(), encoded.data(),
+		encoded.size());
+	EXPECT_GT(rawCompressedSize, encodedCompressedSize);
+
+	// Truncated data or the wrong size is rejected.
+	mslb::MemoryCompressionSource truncatedSource(encoded.data(), encoded.size() - 1);
+	EXPECT_FALSE(mslb::decodeSpirV(decoded.data(), decoded.size(), truncatedSource));
+	mslb::MemoryCompressionSource shortSource(encoded.data(), encoded.size());
+	EXPECT_FALSE(mslb::decodeSpirV(decoded.data(), decoded.size() - 4, shortSource));
+
+	// Data that isn't SPIR-V isn't encoded.
+	std::vector<uint8_t> notSpirV = createCompressibleShader();
+	encoded.resize(mslb::encodedSpirVSizeBound(notSpirV.size()));
+	EXPECT_EQ(0U, mslb::encodeSpirV(encoded.data(), notSpirV.data(), notSpirV.size()));
+}
+
+TEST(ModuleTest, EncodedShaders)
+{
+	std::vector<uint8_t> expectedShader = createSpirVShader();
+	for (bool compressed : {false, true})
+	{
+		std::vector<uint8_t> data = createEncodedModule(false, compressed);
+		Module module;
+		ASSERT_TRUE(module.read(data.data(), data.size()));
+		ASSERT_EQ(1U, module.shaderCount());
+		EXPECT_EQ(expectedShader.size(), module.shaderSize(0));
+		EXPECT_EQ(nullptr, module.shaderData(0));
+
+		std::vector<uint8_t> shaderData(module.shaderSize(0));
+		EXPECT_TRUE(module.readShaderData(shaderData.data(), 0));
+		EXPECT_EQ(expectedShader, shaderData);
+
+		// Encoded shaders require a newer version.
+		data = createEncodedModule(false, compressed, mslb::compressionVersion);
+		EXPECT_FALSE(module.read(data.data(), data.size()));
+		EXPECT_EQ(EILSEQ, errno);
+	}
+}
+
+TEST(ModuleTest, OpenEncodedStream)
+{
+	std::vector<uint8_t> expectedShader = createSpirVShader();
+	for (bool compressed : {false, true})
+	{
+		std::vector<uint8_t> data = createEncodedModule(true, compressed);
+
+		// Decoded while reading from the stream.
+		std::istringstream stream(std::string(data.begin(), data.end()));
+		Module module;
+		ASSERT_TRUE(module.open(stream));
+		ASSERT_EQ(1U, module.shaderCount());
+		EXPECT_EQ(nullptr, module.shaderData(0));
+
+		std::vector<uint8_t> shaderData(module.shaderSize(0));
+		EXPECT_TRUE(module.readShaderData(shaderData.data(), 0));
+		EXPECT_EQ(expectedShader, shaderData);
+
+		// Decoded from memory.
+		ASSERT_TRUE(module.read(data.data(), data.size()));
+		std::fill(shaderData.begin(), shaderData.end(), 0);
+		EXPECT_TRUE(module.readShaderData(shaderData.data(), 0));
+		EXPECT_EQ(expectedShader, shaderData);
+
+		// The checksum of the encoded data is checked while reading.
+		data.back() ^= 0xFF;
+		std::istringstream corruptStream(std::string(data.begin(), data.end()));
+		ASSERT_TRUE(module.open(corruptStream));
+		EXPECT_FALSE(module.readShaderData(shaderData.data(), 0));
+		EXPECT_EQ(EILSEQ, errno);
+	}
+}
+
+TEST(ModuleTest, WrapAdjustableData)
+{
+	std::string fileName = pathStr(exeDir/"CompleteShader.mslb");
+	std::ifstream stream(fileName, std::ios_base::binary);
+	std::vector<std::uint8_t> data(std::istreambuf_iterator<char>(stream.rdbuf()),
+		std::istreambuf_iterator<char>());
+	std::vector<std::uint8_t> original = data;
+
+	Module module;
+	ASSERT_TRUE(module.wrap(data.data(), data.size()));
+	testContents(module);
+	const uint8_t* shaderData = reinterpret_cast<const uint8_t*>(module.shaderData(0));
+	EXPECT_LE(data.data(), shaderData);
+	EXPECT_GT(data.data() + data.size(), shaderData);
+
+	// The data isn't copied when the binding doesn't change.
+	Uniform uniform;
+	ASSERT_TRUE(module.uniform(uniform, 0, 0));
+	EXPECT_TRUE(module.setUniformBinding(0, 0, uniform.descriptorSet, uniform.binding));
+	EXPECT_EQ(shaderData, module.shaderData(0));
+
+	// Changing the binding requires modifying the data, so it will be copied.
+	EXPECT_TRUE(module.setUniformBinding(0, 0, 1, 2));
+	EXPECT_NE(shaderData, module.shaderData(0));
+	EXPECT_EQ(original, data);
+	ASSERT_TRUE(module.uniform(uniform, 0, 0));
+	EXPECT_EQ(1U, uniform.descriptorSet);
+	EXPECT_EQ(2U, uniform.binding);
+
+	// The copy is modified directly for later changes.
+	shaderData = reinterpret_cast<const uint8_t*>(module.shaderData(0));
+	EXPECT_TRUE(module.setUniformBinding(0, 0, 3, 4));
+	EXPECT_EQ(shaderData, module.shaderData(0));
+	EXPECT_EQ(original, data);
+}
+
 TEST(ModuleTest, ReadInvalidData)
 {
 	std::string fileName = pathStr(exeDir/"CompleteShader.mslb");
@@ -434,6 +1145,52 @@ TEST(ModuleTest, ReadFileC)
 	mslModule* module = mslModule_readFile(fileName.c_str(), nullptr);
 	testContents(module);
 	mslModule_destroy(module);
+
+	module = mslModule_readFileWithValidation(fileName.c_str(), mslValidation_Checksum, nullptr);
+	testContents(module);
+	mslModule_destroy(module);
+}
+
+TEST(ModuleTest, MapFile)
+{
+	std::string fileName = pathStr(exeDir/"CompleteShader.mslb");
+	Module module;
+	EXPECT_TRUE(module.mapFile(fileName));
+	testContents(module);
+}
+
+TEST(ModuleTest, MapFileC)
+{
+	std::string fileName = pathStr(exeDir/"CompleteShader.mslb");
+	mslModule* module = mslModule_mapFile(fileName.c_str(), mslValidation_Full, nullptr);
+	testContents(module);
+	mslModule_destroy(module);
+
+	EXPECT_EQ(nullptr, mslModule_mapFile(nullptr, mslValidation_Full, nullptr));
+	EXPECT_EQ(EINVAL, errno);
+
+	EXPECT_EQ(nullptr, mslModule_mapFile(pathStr(exeDir/"NotAFile.mslb").c_str(), mslValidation_Full, nullptr));
+	EXPECT_EQ(ENOENT, errno);
+}
+
+TEST(ModuleTest, MapFileSetUniformBinding)
+{
+	std::string fileName = pathStr(exeDir/"CompleteShader.mslb");
+	Module module;
+	ASSERT_TRUE(module.mapFile(fileName));
+
+	EXPECT_TRUE(module.setUniformBinding(0, 0, 1, 2));
+	Uniform transformUniform;
+	EXPECT_TRUE(module.uniform(transformUniform, 0, 0));
+	EXPECT_EQ(1U, transformUniform.descriptorSet);
+	EXPECT_EQ(2U, transformUniform.binding);
+
+	// The changes are private to the mapping and not written back to the file.
+	Module fileModule;
+	ASSERT_TRUE(fileModule.read(fileName));
+	EXPECT_TRUE(fileModule.uniform(transformUniform, 0, 0));
+	EXPECT_NE(1U, transformUniform.descriptorSet);
+	EXPECT_NE(2U, transformUniform.binding);
 }
 
 TEST(ModuleTest, ReadComputeFile)
@@ -458,7 +1215,7 @@ TEST(ModuleTest, SetUniformBinding)
 	Module module;
 	EXPECT_TRUE(module.read(fileName));
 
-	EXPECT_EQ(moduleVersion, module.version());
+	EXPECT_EQ(0U, module.version());
 	EXPECT_EQ(MSL_CREATE_ID('S', 'P', 'R', 'V'), module.targetId());
 	EXPECT_LE(100U, module.targetVersion());
 
@@ -483,7 +1240,7 @@ TEST(ModuleTest, SetUniformBindingCopy)
 	Module module;
 	EXPECT_TRUE(module.read(fileName));
 
-	EXPECT_EQ(moduleVersion, module.version());
+	EXPECT_EQ(0U, module.version());
 	EXPECT_EQ(MSL_CREATE_ID('S', 'P', 'R', 'V'), module.targetId());
 	EXPECT_LE(100U, module.targetVersion());
 
@@ -534,4 +1291,508 @@ TEST(ModuleTest, SetUniformBindingCopy)
 	EXPECT_NE(3U, texUniform.binding);
 }
 
+TEST(ModuleTest, SetUniformBindings)
+{
+	std::string fileName = pathStr(exeDir/"CompleteShader.mslb");
+	Module singleModule;
+	EXPECT_TRUE(singleModule.read(fileName));
+	Module batchModule;
+	EXPECT_TRUE(batchModule.read(fileName));
+
+	Pipeline pipeline;
+	ASSERT_TRUE(batchModule.pipeline(pipeline, 0));
+	std::vector<uint32_t> descriptorSets(pipeline.uniformCount);
+	std::vector<uint32_t> bindings(pipeline.uniformCount);
+	for (uint32_t i = 0; i < pipeline.uniformCount; ++i)
+	{
+		descriptorSets[i] = i + 1;
+		bindings[i] = i + 2;
+		EXPECT_TRUE(singleModule.setUniformBinding(0, i, descriptorSets[i], bindings[i]));
+	}
+
+	EXPECT_FALSE(batchModule.setUniformBindings(1, descriptorSets.data(), bindings.data()));
+	EXPECT_FALSE(batchModule.setUniformBindings(0, nullptr, bindings.data()));
+	EXPECT_TRUE(batchModule.setUniformBindings(0, descriptorSets.data(), bindings.data()));
+
+	for (uint32_t i = 0; i < pipeline.uniformCount; ++i)
+	{
+		Uniform uniform;
+		EXPECT_TRUE(batchModule.uniform(uniform, 0, i));
+		EXPECT_EQ(descriptorSets[i], uniform.descriptorSet);
+		EXPECT_EQ(bindings[i], uniform.binding);
+	}
+
+	SizedData shaderData[mslStage_Count] = {};
+	for (int i = 0; i < mslStage_Count; ++i)
+	{
+		uint32_t shaderIndex = pipeline.shaders[i];
+		if (shaderIndex == unknown)
+			continue;
+
+		ASSERT_EQ(singleModule.shaderSize(shaderIndex), batchModule.shaderSize(shaderIndex));
+		EXPECT_EQ(0, memcmp(singleModule.shaderData(shaderIndex),
+			batchModule.shaderData(shaderIndex), batchModule.shaderSize(shaderIndex)));
+
+		Module originalModule;
+		EXPECT_TRUE(originalModule.read(fileName));
+		shaderData[i].size = originalModule.shaderSize(shaderIndex);
+		shaderData[i].data = new uint8_t[shaderData[i].size];
+		memcpy(shaderData[i].data, originalModule.shaderData(shaderIndex), shaderData[i].size);
+	}
+
+	Module copyModule;
+	EXPECT_TRUE(copyModule.read(fileName));
+	EXPECT_TRUE(copyModule.setUniformBindings(0, descriptorSets.data(), bindings.data(),
+		shaderData));
+	for (int i = 0; i < mslStage_Count; ++i)
+	{
+		uint32_t shaderIndex = pipeline.shaders[i];
+		if (shaderIndex == unknown)
+			continue;
+
+		EXPECT_EQ(0, memcmp(shaderData[i].data, batchModule.shaderData(shaderIndex),
+			shaderData[i].size));
+		delete[] reinterpret_cast<uint8_t*>(shaderData[i].data);
+	}
+}
+
+TEST(ModuleTest, SetUniformBindingsUnchangedOnFailure)
+{
+	// The second uniform omits its default descriptor set and binding, so they can't be modified
+	// in-place.
+	flatbuffers::FlatBufferBuilder builder;
+	std::vector<flatbuffers::Offset<mslb::Uniform>> uniforms;
+	uniforms.push_back(mslb::CreateUniform(builder, builder.CreateString("First"),
+		mslb::UniformType::SampledImage, mslb::Type::Sampler2D, unknown, 0, 1, 2));
+	uniforms.push_back(mslb::CreateUniform(builder, builder.CreateString("Second"),
+		mslb::UniformType::SampledImage, mslb::Type::Sampler2D, unknown));
+	std::vector<flatbuffers::Offset<mslb::Pipeline>> pipelines;
+	pipelines.push_back(createEmptyPipeline(builder, "Test", 0, 0, 0,
+		builder.CreateVector(uniforms)));
+	builder.Finish(mslb::CreateModule(builder, moduleVersion, MSL_CREATE_ID('S', 'P', 'R', 'V'),
+		0x10000, true, builder.CreateVector(pipelines),
+		builder.CreateVector(std::vector<flatbuffers::Offset<mslb::ShaderData>>()),
+		builder.CreateVector(std::vector<uint8_t>())));
+
+	Module module;
+	ASSERT_TRUE(module.read(builder.GetBufferPointer(), builder.GetSize()));
+	EXPECT_TRUE(module.setUniformBinding(0, 0, 3, 4));
+	EXPECT_FALSE(module.setUniformBinding(0, 1, 3, 4));
+
+	const uint32_t descriptorSets[] = {5, 6};
+	const uint32_t bindings[] = {7, 8};
+	EXPECT_FALSE(module.setUniformBindings(0, descriptorSets, bindings));
+
+	Uniform uniform;
+	ASSERT_TRUE(module.uniform(uniform, 0, 0));
+	EXPECT_EQ(3U, uniform.descriptorSet);
+	EXPECT_EQ(4U, uniform.binding);
+	ASSERT_TRUE(module.uniform(uniform, 0, 1));
+	EXPECT_EQ(0U, uniform.descriptorSet);
+	EXPECT_EQ(0U, uniform.binding);
+}
+
+TEST(ModuleTest, Variants)
+{
+	std::vector<uint8_t> data = createVariantModule();
+	Module module;
+	ASSERT_TRUE(module.read(data.data(), data.size()));
+
+	ASSERT_EQ(2U, module.variantKeywordCount());
+	EXPECT_STREQ("FOG", module.variantKeywordName(0));
+	EXPECT_STREQ("SHADOWS", module.variantKeywordName(1));
+	EXPECT_EQ(nullptr, module.variantKeywordName(2));
+	ASSERT_EQ(2U, module.variantKeywordValueCount(1));
+	EXPECT_STREQ("LOW", module.variantKeywordValue(1, 0));
+	EXPECT_STREQ("HIGH", module.variantKeywordValue(1, 1));
+	EXPECT_EQ(nullptr, module.variantKeywordValue(1, 2));
+	EXPECT_EQ(4U, module.variantPermutationCount());
+
+	uint32_t valueIndices[] = {1, 0};
+	uint32_t permutation = module.variantPermutationIndex(valueIndices);
+	EXPECT_EQ(1U, permutation);
+	valueIndices[1] = 2;
+	EXPECT_EQ(unknown, module.variantPermutationIndex(valueIndices));
+
+	ASSERT_EQ(2U, module.variantCount());
+	EXPECT_STREQ("Opaque", module.variantName(0));
+	uint32_t opaque = module.findVariant("Opaque");
+	uint32_t shadow = module.findVariant("Shadow");
+	EXPECT_EQ(0U, opaque);
+	EXPECT_EQ(1U, shadow);
+	EXPECT_EQ(unknown, module.findVariant("Transparent"));
+
+	Pipeline pipeline;
+	ASSERT_TRUE(module.pipeline(pipeline, module.variantPipeline(opaque, permutation)));
+	EXPECT_STREQ("Opaque[FOG=1,SHADOWS=LOW]", pipeline.name);
+	EXPECT_EQ(2U, module.variantPipeline(opaque, 3));
+	EXPECT_EQ(unknown, module.variantPipeline(shadow, permutation));
+	EXPECT_EQ(unknown, module.variantPipeline(opaque, 4));
+}
+
+TEST(ModuleTest, NoVariants)
+{
+	std::string fileName = pathStr(exeDir/"CompleteShader.mslb");
+	mslModule* module = mslModule_readFile(fileName.c_str(), nullptr);
+	ASSERT_TRUE(module);
+	EXPECT_EQ(0U, mslModule_variantKeywordCount(module));
+	EXPECT_EQ(0U, mslModule_variantPermutationCount(module));
+	EXPECT_EQ(0U, mslModule_variantCount(module));
+	EXPECT_EQ(MSL_UNKNOWN, mslModule_findVariant(module, "Test"));
+	mslModule_destroy(module);
+}
+
+TEST(ModuleTest, InvalidVariants)
+{
+	std::vector<uint8_t> data = createVariantModule(false);
+	Module module;
+	EXPECT_FALSE(module.read(data.data(), data.size()));
+	EXPECT_EQ(EILSEQ, errno);
+}
+
+TEST(ModuleTest, VariantPermutationOverflow)
+{
+	// Three keywords with 2048 values each has more permutations than fit in 32 bits.
+	flatbuffers::FlatBufferBuilder builder;
+	std::vector<flatbuffers::Offset<mslb::Pipeline>> pipelines;
+	pipelines.push_back(createEmptyPipeline(builder, "Test"));
+
+	std::vector<flatbuffers::Offset<flatbuffers::String>> values(2048,
+		builder.CreateString("0"));
+	std::vector<flatbuffers::Offset<mslb::VariantKeyword>> keywords;
+	for (const char* name : {"A", "B", "C"})
+	{
+		keywords.push_back(mslb::CreateVariantKeyword(builder, builder.CreateString(name),
+			builder.CreateVector(values)));
+	}
+
+	builder.Finish(mslb::CreateModule(builder, moduleVersion, MSL_CREATE_ID('S', 'P', 'R', 'V'),
+		0x10000, false, builder.CreateVector(pipelines),
+		builder.CreateVector(std::vector<flatbuffers::Offset<mslb::ShaderData>>()),
+		builder.CreateVector(std::vector<uint8_t>()), builder.CreateVector(keywords),
+		builder.CreateVector(std::vector<flatbuffers::Offset<mslb::Variant>>())));
+
+	Module module;
+	EXPECT_FALSE(module.read(builder.GetBufferPointer(), builder.GetSize()));
+	EXPECT_EQ(EILSEQ, errno);
+
+	// The variants aren't validated, so the overflow must be checked when used.
+	ASSERT_TRUE(module.read(builder.GetBufferPointer(), builder.GetSize(), mslValidation_None));
+	EXPECT_EQ(0U, module.variantPermutationCount());
+	uint32_t valueIndices[] = {2047, 2047, 2047};
+	EXPECT_EQ(unknown, module.variantPermutationIndex(valueIndices));
+	valueIndices[2] = 0;
+	EXPECT_EQ(unknown, module.variantPermutationIndex(valueIndices));
+}
+
+TEST(ModuleTest, BulkReflection)
+{
+	std::string fileName = pathStr(exeDir/"CompleteShader.mslb");
+	Module module;
+	ASSERT_TRUE(module.read(fileName));
+
+	Pipeline pipeline;
+	ASSERT_TRUE(module.pipeline(pipeline, 0));
+
+	std::vector<Struct> structs(pipeline.structCount);
+	ASSERT_TRUE(module.pipelineStructs(structs.data(), 0, 0, pipeline.structCount));
+	for (uint32_t i = 0; i < pipeline.structCount; ++i)
+	{
+		Struct pipelineStruct;
+		ASSERT_TRUE(module.pipelineStruct(pipelineStruct, 0, i));
+		EXPECT_STREQ(pipelineStruct.name, structs[i].name);
+		EXPECT_EQ(pipelineStruct.size, structs[i].size);
+		EXPECT_EQ(pipelineStruct.memberCount, structs[i].memberCount);
+
+		std::vector<StructMember> members(pipelineStruct.memberCount);
+		ASSERT_TRUE(module.structMembers(members.data(), 0, i, 0, pipelineStruct.memberCount));
+		for (uint32_t j = 0; j < pipelineStruct.memberCount; ++j)
+		{
+			StructMember member;
+			ASSERT_TRUE(module.structMember(member, 0, i, j));
+			EXPECT_STREQ(member.name, members[j].name);
+			EXPECT_EQ(member.offset, members[j].offset);
+			EXPECT_EQ(member.type, members[j].type);
+		}
+	}
+
+	std::vector<Uniform> uniforms(pipeline.uniformCount);
+	ASSERT_TRUE(module.uniforms(uniforms.data(), 0, 0, pipeline.uniformCount));
+	for (uint32_t i = 0; i < pipeline.uniformCount; ++i)
+	{
+		Uniform uniform;
+		ASSERT_TRUE(module.uniform(uniform, 0, i));
+		EXPECT_STREQ(uniform.name, uniforms[i].name);
+		EXPECT_EQ(uniform.uniformType, uniforms[i].uniformType);
+		EXPECT_EQ(uniform.binding, uniforms[i].binding);
+	}
+
+	// Partial range.
+	Uniform lastUniform;
+	ASSERT_TRUE(module.uniforms(&lastUniform, 0, pipeline.uniformCount - 1, 1));
+	EXPECT_STREQ(uniforms.back().name, lastUniform.name);
+	EXPECT_TRUE(module.uniforms(nullptr, 0, pipeline.uniformCount, 0));
+	EXPECT_FALSE(module.uniforms(uniforms.data(), 0, 1, pipeline.uniformCount));
+	EXPECT_FALSE(module.uniforms(uniforms.data(), 1, 0, pipeline.uniformCount));
+
+	std::vector<Attribute> attributes(pipeline.attributeCount);
+	ASSERT_TRUE(module.attributes(attributes.data(), 0, 0, pipeline.attributeCount));
+	for (uint32_t i = 0; i < pipeline.attributeCount; ++i)
+	{
+		Attribute attribute;
+		ASSERT_TRUE(module.attribute(attribute, 0, i));
+		EXPECT_STREQ(attribute.name, attributes[i].name);
+		EXPECT_EQ(attribute.location, attributes[i].location);
+	}
+
+	std::vector<FragmentOutput> fragmentOutputs(pipeline.fragmentOutputCount);
+	ASSERT_TRUE(module.fragmentOutputs(fragmentOutputs.data(), 0, 0,
+		pipeline.fragmentOutputCount));
+	for (uint32_t i = 0; i < pipeline.fragmentOutputCount; ++i)
+	{
+		FragmentOutput fragmentOutput;
+		ASSERT_TRUE(module.fragmentOutput(fragmentOutput, 0, i));
+		EXPECT_STREQ(fragmentOutput.name, fragmentOutputs[i].name);
+		EXPECT_EQ(fragmentOutput.location, fragmentOutputs[i].location);
+	}
+}
+
+TEST(ModuleTest, FindByName)
+{
+	// Saved without name lookup tables, so will use a linear search.
+	std::string fileName = pathStr(exeDir/"CompleteShader.mslb");
+	Module module;
+	ASSERT_TRUE(module.read(fileName));
+
+	EXPECT_EQ(0U, module.findPipeline("Test"));
+	EXPECT_EQ(unknown, module.findPipeline("Foo"));
+	EXPECT_EQ(1U, module.findStruct(0, "Uniforms"));
+	EXPECT_EQ(unknown, module.findStruct(0, "Foo"));
+	EXPECT_EQ(2U, module.findUniform(0, "tex"));
+	EXPECT_EQ(unknown, module.findUniform(0, "Foo"));
+	EXPECT_EQ(1U, module.findAttribute(0, "color"));
+	EXPECT_EQ(unknown, module.findAttribute(0, "Foo"));
+	EXPECT_EQ(unknown, module.findUniform(1, "tex"));
+	EXPECT_EQ(unknown, module.findUniform(0, nullptr));
+}
+
+static std::vector<uint8_t> createFindByNameModule(const std::vector<const char*>& pipelineNames,
+	const std::vector<uint32_t>& attributeNameOrder)
+{
+	flatbuffers::FlatBufferBuilder builder;
+	std::vector<flatbuffers::Offset<mslb::Attribute>> attributes;
+	uint32_t location = 0;
+	for (const char* name : {"position", "color", "normal"})
+	{
+		attributes.push_back(mslb::CreateAttribute(builder, builder.CreateString(name),
+			mslb::Type::Vec4, 0, location++));
+	}
+
+	// Only the first pipeline has attributes to look up.
+	std::vector<flatbuffers::Offset<mslb::Pipeline>> pipelines;
+	pipelines.push_back(createEmptyPipeline(builder, pipelineNames[0], 0,
+		builder.CreateVector(attributes), builder.CreateVector(attributeNameOrder)));
+	for (std::size_t i = 1; i < pipelineNames.size(); ++i)
+		pipelines.push_back(createEmptyPipeline(builder, pipelineNames[i]));
+
+	builder.Finish(mslb::CreateModule(builder, moduleVersion, MSL_CREATE_ID('S', 'P', 'R', 'V'),
+		0x10000, false, builder.CreateVector(pipelines),
+		builder.CreateVector(std::vector<flatbuffers::Offset<mslb::ShaderData>>()),
+		builder.CreateVector(std::vector<uint8_t>())));
+	return std::vector<uint8_t>(builder.GetBufferPointer(),
+		builder.GetBufferPointer() + builder.GetSize());
+}
+
+TEST(ModuleTest, FindByNameSorted)
+{
+	std::vector<const char*> pipelineNames = {"Opaque", "Opaque[FOG=0,SHADOWS=HIGH]",
+		"Opaque[FOG=0,SHADOWS=LOW]", "Opaque[FOG=1,SHADOWS=LOW]", "Shadow"};
+	std::vector<uint8_t> data = createFindByNameModule(pipelineNames, {1, 2, 0});
+	Module module;
+	ASSERT_TRUE(module.read(data.data(), data.size()));
+	for (uint32_t i = 0; i < pipelineNames.size(); ++i)
+		EXPECT_EQ(i, module.findPipeline(pipelineNames[i]));
+	EXPECT_EQ(unknown, module.findPipeline("Opaque[FOG=1,SHADOWS=HIGH]"));
+	EXPECT_EQ(unknown, module.findPipeline("Transparent"));
+
+	EXPECT_EQ(0U, module.findAttribute(0, "position"));
+	EXPECT_EQ(1U, module.findAttribute(0, "color"));
+	EXPECT_EQ(2U, module.findAttribute(0, "normal"));
+	EXPECT_EQ(unknown, module.findAttribute(0, "texCoord"));
+
+	// Pipelines must be sorted and unique.
+	std::swap(pipelineNames[1], pipelineNames[2]);
+	data = createFindByNameModule(pipelineNames, {1, 2, 0});
+	EXPECT_FALSE(module.read(data.data(), data.size()));
+	EXPECT_EQ(EILSEQ, errno);
+
+	pipelineNames[1] = pipelineNames[2];
+	data = createFindByNameModule(pipelineNames, {1, 2, 0});
+	EXPECT_FALSE(module.read(data.data(), data.size()));
+	EXPECT_EQ(EILSEQ, errno);
+
+	// Name order tables must be a sorted permutation of the elements.
+	pipelineNames[1] = "Opaque[FOG=0,SHADOWS=HIGH]";
+	data = createFindByNameModule(pipelineNames, {1, 2});
+	EXPECT_FALSE(module.read(data.data(), data.size()));
+	EXPECT_EQ(EILSEQ, errno);
+
+	data = createFindByNameModule(pipelineNames, {1, 2, 3});
+	EXPECT_FALSE(module.read(data.data(), data.size()));
+	EXPECT_EQ(EILSEQ, errno);
+
+	data = createFindByNameModule(pipelineNames, {0, 1, 2});
+	EXPECT_FALSE(module.read(data.data(), data.size()));
+	EXPECT_EQ(EILSEQ, errno);
+
+	data = createFindByNameModule(pipelineNames, {1, 1, 0});
+	EXPECT_FALSE(module.read(data.data(), data.size()));
+	EXPECT_EQ(EILSEQ, errno);
+}
+
+TEST(ModuleTest, ChecksumValidation)
+{
+	// Deep validation is skipped when the checksum matches.
+	std::vector<uint8_t> data = createVariantModule(false, true);
+	Module module;
+	ASSERT_TRUE(module.read(data.data(), data.size(), mslValidation_Checksum));
+	EXPECT_EQ(5U, module.pipelineCount());
+
+	// Corrupted data that would pass full validation.
+	std::vector<uint8_t> corruptData = createVariantModule(true, true);
+	EXPECT_TRUE(module.read(corruptData.data(), corruptData.size(), mslValidation_Checksum));
+	const char shadowName[] = "Shadow";
+	auto shadowIt = std::search(corruptData.begin(), corruptData.end(), shadowName,
+		shadowName + sizeof(shadowName) - 1);
+	ASSERT_NE(corruptData.end(), shadowIt);
+	*shadowIt = 'W';
+	EXPECT_FALSE(module.read(corruptData.data(), corruptData.size(), mslValidation_Checksum));
+	EXPECT_EQ(EILSEQ, errno);
+
+	// The validation only applies to the module being loaded.
+	EXPECT_TRUE(module.read(corruptData.data(), corruptData.size()));
+
+	// Fully validated without a checksum.
+	data = createVariantModule(false);
+	EXPECT_FALSE(module.read(data.data(), data.size(), mslValidation_Checksum));
+	EXPECT_EQ(EILSEQ, errno);
+
+	data = createVariantModule(true);
+	EXPECT_TRUE(module.read(data.data(), data.size(), mslValidation_Checksum));
+
+	EXPECT_EQ(nullptr, mslModule_readDataWithValidation(data.data(), data.size(),
+		static_cast<mslValidation>(mslValidation_None + 1), nullptr));
+	EXPECT_EQ(EINVAL, errno);
+}
+
+TEST(ModuleTest, NoValidation)
+{
+	std::vector<uint8_t> data = createVariantModule(false);
+	Module module;
+	ASSERT_TRUE(module.read(data.data(), data.size(), mslValidation_None));
+	EXPECT_EQ(5U, module.pipelineCount());
+
+	// The header is still checked.
+	EXPECT_FALSE(module.read(data.data(), 2, mslValidation_None));
+	EXPECT_EQ(EILSEQ, errno);
+}
+
+TEST(ModuleTest, ArgumentBuffers)
+{
+	flatbuffers::FlatBufferBuilder builder;
+	std::vector<flatbuffers::Offset<mslb::Pipeline>> pipelines;
+	pipelines.push_back(createEmptyPipeline(builder, "Test"));
+	builder.Finish(mslb::CreateModule(builder, moduleVersion, MSL_CREATE_ID('M', 'T', 'L', 'X'),
+		200, false, builder.CreateVector(pipelines),
+		builder.CreateVector(std::vector<flatbuffers::Offset<mslb::ShaderData>>()),
+		builder.CreateVector(std::vector<uint8_t>()), 0, 0, true));
+
+	Module module;
+	EXPECT_TRUE(module.read(builder.GetBufferPointer(), builder.GetSize()));
+	EXPECT_TRUE(module.argumentBuffers());
+	EXPECT_FALSE(mslModule_argumentBuffers(nullptr));
+}
+
+static void createShaderDataFormatModule(flatbuffers::FlatBufferBuilder& builder,
+	uint32_t targetId, mslb::ShaderDataFormat shaderDataFormat)
+{
+	std::vector<flatbuffers::Offset<mslb::Pipeline>> pipelines;
+	pipelines.push_back(createEmptyPipeline(builder, "Test"));
+	builder.Finish(mslb::CreateModule(builder, moduleVersion, targetId, 200, false,
+		builder.CreateVector(pipelines),
+		builder.CreateVector(std::vector<flatbuffers::Offset<mslb::ShaderData>>()),
+		builder.CreateVector(std::vector<uint8_t>()), 0, 0, false, 0, 0, shaderDataFormat));
+}
+
+TEST(ModuleTest, ShaderDataFormat)
+{
+	flatbuffers::FlatBufferBuilder builder;
+	createShaderDataFormatModule(builder, MSL_CREATE_ID('M', 'T', 'L', 'X'),
+		mslb::ShaderDataFormat::LibraryFunction);
+	Module module;
+	EXPECT_TRUE(module.read(builder.GetBufferPointer(), builder.GetSize()));
+	EXPECT_EQ(mslShaderDataFormat_LibraryFunction, module.shaderDataFormat());
+	EXPECT_EQ(mslShaderDataFormat_Native, mslModule_shaderDataFormat(nullptr));
+
+	builder.Clear();
+	createShaderDataFormatModule(builder, MSL_CREATE_ID('M', 'T', 'L', 'I'),
+		mslb::ShaderDataFormat::Source);
+	EXPECT_TRUE(module.read(builder.GetBufferPointer(), builder.GetSize()));
+	EXPECT_EQ(mslShaderDataFormat_Source, module.shaderDataFormat());
+
+	// Only Metal has shader data that isn't in the native format.
+	builder.Clear();
+	createShaderDataFormatModule(builder, MSL_CREATE_ID('S', 'P', 'R', 'V'),
+		mslb::ShaderDataFormat::Source);
+	EXPECT_FALSE(module.read(builder.GetBufferPointer(), builder.GetSize()));
+	EXPECT_EQ(EILSEQ, errno);
+
+	builder.Clear();
+	createShaderDataFormatModule(builder, MSL_CREATE_ID('M', 'T', 'L', 'X'),
+		static_cast<mslb::ShaderDataFormat>(3));
+	EXPECT_FALSE(module.read(builder.GetBufferPointer(), builder.GetSize()));
+	EXPECT_EQ(EILSEQ, errno);
+}
+
+TEST(ModuleTest, SpecializationConstants)
+{
+	flatbuffers::FlatBufferBuilder builder;
+	std::vector<flatbuffers::Offset<mslb::SpecializationConstant>> specConstants;
+	specConstants.push_back(mslb::CreateSpecializationConstant(builder,
+		builder.CreateString("useFog"), mslb::Type::Bool, 0, 1.0));
+	specConstants.push_back(mslb::CreateSpecializationConstant(builder,
+		builder.CreateString("lightCount"), mslb::Type::Int, 3, -2.0));
+
+	std::vector<flatbuffers::Offset<mslb::Pipeline>> pipelines;
+	pipelines.push_back(createEmptyPipeline(builder, "Test",
+		builder.CreateVector(specConstants)));
+	builder.Finish(mslb::CreateModule(builder, moduleVersion, MSL_CREATE_ID('S', 'P', 'R', 'V'),
+		0x10000, false, builder.CreateVector(pipelines),
+		builder.CreateVector(std::vector<flatbuffers::Offset<mslb::ShaderData>>()),
+		builder.CreateVector(std::vector<uint8_t>())));
+
+	Module module;
+	ASSERT_TRUE(module.read(builder.GetBufferPointer(), builder.GetSize()));
+
+	Pipeline pipeline;
+	EXPECT_TRUE(module.pipeline(pipeline, 0));
+	ASSERT_EQ(2U, pipeline.specializationConstantCount);
+
+	SpecializationConstant specConstant;
+	EXPECT_TRUE(module.specializationConstant(specConstant, 0, 0));
+	EXPECT_STREQ("useFog", specConstant.name);
+	EXPECT_EQ(Type::Bool, specConstant.type);
+	EXPECT_EQ(0U, specConstant.id);
+	EXPECT_EQ(1.0, specConstant.defaultValue);
+
+	EXPECT_TRUE(module.specializationConstant(specConstant, 0, 1));
+	EXPECT_STREQ("lightCount", specConstant.name);
+	EXPECT_EQ(Type::Int, specConstant.type);
+	EXPECT_EQ(3U, specConstant.id);
+	EXPECT_EQ(-2.0, specConstant.defaultValue);
+
+	EXPECT_FALSE(module.specializationConstant(specConstant, 0, 2));
+	EXPECT_FALSE(module.specializationConstant(specConstant, 1, 0));
+}
+
 } // namespace msl
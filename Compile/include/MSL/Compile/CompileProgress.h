@@ -0,0 +1,127 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <MSL/Config.h>
+#include <MSL/Compile/Export.h>
+#include <MSL/Compile/Types.h>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+
+/**
+ * @file
+ * @brief Class for monitoring and cancelling a compile.
+ */
+
+namespace msl
+{
+
+/**
+ * @brief Class for monitoring and cancelling a compile.
+ *
+ * An instance may be passed to Target::compile() to receive progress events and to stop the
+ * compile early. Cancellation is cooperative: it is checked after preprocessing, after parsing,
+ * before each pipeline, and before each stage is compiled or cross-compiled. When cancelled,
+ * compile will return false with an error added to the output.
+ *
+ * cancel() and isCancelled() may be called from any thread. The callback is called on the thread
+ * performing the compile.
+ */
+class MSL_COMPILE_EXPORT CompileProgress
+{
+public:
+	/**
+	 * @brief Enum for the phase of compilation that was reached.
+	 */
+	enum class Phase
+	{
+		Preprocessed,    ///< The source file was preprocessed.
+		Parsed,          ///< The source file was parsed and the pipelines are known.
+		StageCompiled,   ///< A stage of a pipeline finished compiling.
+		PipelineCompiled ///< A pipeline finished compiling.
+	};
+
+	/**
+	 * @brief Struct describing a progress event.
+	 */
+	struct Event
+	{
+		/**
+		 * @brief The phase that was reached.
+		 */
+		Phase phase;
+
+		/**
+		 * @brief The name of the pipeline. This is empty for the Preprocessed and Parsed phases.
+		 */
+		std::string pipeline;
+
+		/**
+		 * @brief The stage that was compiled. This is only valid for the StageCompiled phase.
+		 */
+		compile::Stage stage;
+
+		/**
+		 * @brief The index of the pipeline being compiled.
+		 */
+		std::size_t pipelineIndex;
+
+		/**
+		 * @brief The number of pipelines in the file. This is 0 for the Preprocessed phase.
+		 */
+		std::size_t pipelineCount;
+	};
+
+	/**
+	 * @brief Function called for each progress event.
+	 */
+	using Callback = std::function<void(const Event& event)>;
+
+	/**
+	 * @brief Constructs this with an optional callback.
+	 * @param callback The function to call for each progress event. This may be empty.
+	 */
+	explicit CompileProgress(Callback callback = Callback());
+
+	CompileProgress(const CompileProgress&) = delete;
+	CompileProgress& operator=(const CompileProgress&) = delete;
+
+	/**
+	 * @brief Requests that the compile be stopped at the next opportunity.
+	 */
+	void cancel();
+
+	/**
+	 * @brief Returns whether or not cancel() was called.
+	 * @return True if cancelled.
+	 */
+	bool isCancelled() const;
+
+	/**
+	 * @brief Reports a progress event to the callback.
+	 * @param event The event to report.
+	 */
+	void report(const Event& event) const;
+
+private:
+	Callback m_callback;
+	std::atomic<bool> m_cancelled;
+};
+
+} // namespace msl
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <MSL/Config.h>
+#include <MSL/Compile/Export.h>
+#include <MSL/Compile/CompiledResult.h>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * @brief Class for incrementally re-compiling a shader file.
+ */
+
+namespace msl
+{
+
+class CompileProgress;
+class Output;
+class PipelineCache;
+class Target;
+
+/**
+ * @brief Class for incrementally re-compiling a shader file.
+ *
+ * This is intended for situations such as editors and hot reloading, where the same file is
+ * compiled repeatedly with small changes. The source is always preprocessed and parsed, but the
+ * compiled result for each pipeline is kept between compiles and re-used when the generated GLSL
+ * for each stage and other inputs for the pipeline haven't changed.
+ *
+ * Warnings for pipelines that weren't re-compiled won't be added to the output again.
+ *
+ * The cached pipelines assume that the configuration of the target doesn't change. If the target
+ * is modified, such as changing the optimization or strip settings, reset() should be called
+ * before the next compile.
+ *
+ * Unlike Target, a session may only be used by one thread at a time. Separate sessions may share
+ * the same target across threads.
+ */
+class MSL_COMPILE_EXPORT CompileSession
+{
+public:
+	/**
+	 * @brief Constructs this with the target to compile with.
+	 * @param target The target to compile with. This must remain alive for the lifetime of the
+	 *     session.
+	 */
+	explicit CompileSession(const Target& target);
+
+	~CompileSession();
+
+	CompileSession(const CompileSession&) = delete;
+	CompileSession& operator=(const CompileSession&) = delete;
+
+	/**
+	 * @brief Gets the target used for compiling.
+	 * @return The target.
+	 */
+	const Target& getTarget() const;
+
+	/**
+	 * @brief Compiles a shader, re-using previous results for unchanged pipelines.
+	 *
+	 * The result and the changed and removed pipelines are only replaced when compilation
+	 * succeeds, keeping those from the last successful compile otherwise. Target::finish() is
+	 * called automatically.
+	 *
+	 * @param output The output for warnings and errors.
+	 * @param fileName The name of the file to load.
+	 * @param progress The progress to report to and check for cancellation. This may be null.
+	 * @return False if compilation failed or was cancelled.
+	 */
+	bool compile(Output& output, const std::string& fileName,
+		CompileProgress* progress = nullptr);
+
+	/**
+	 * @brief Compiles a shader, re-using previous results for unchanged pipelines.
+	 *
+	 * The result and the changed and removed pipelines are only replaced when compilation
+	 * succeeds, keeping those from the last successful compile otherwise. Target::finish() is
+	 * called automatically.
+	 *
+	 * @param output The output for warnings and errors.
+	 * @param stream The stream to read from.
+	 * @param fileName The name of the file corresponding to the stream. This is used for error
+	 * outputs.
+	 * @param progress The progress to report to and check for cancellation. This may be null.
+	 * @return False if compilation failed or was cancelled.
+	 */
+	bool compile(Output& output, std::istream& stream, const std::string& fileName,
+		CompileProgress* progress = nullptr);
+
+	/**
+	 * @brief Gets the result of the last successful compile.
+	 * @return The compiled result.
+	 */
+	const CompiledResult& getResult() const;
+
+	/**
+	 * @brief Gets the names of the pipelines that were compiled during the last compile.
+	 *
+	 * This includes pipelines that were added since the previous compile. Pipelines that weren't
+	 * included were re-used from the previous compile.
+	 *
+	 * @return The changed pipelines.
+	 */
+	const std::vector<std::string>& getChangedPipelines() const;
+
+	/**
+	 * @brief Gets the names of the pipelines that were removed during the last compile.
+	 * @return The removed pipelines.
+	 */
+	const std::vector<std::string>& getRemovedPipelines() const;
+
+	/**
+	 * @brief Resets the session, forcing all pipelines to be compiled on the next compile.
+	 */
+	void reset();
+
+private:
+	bool compileImpl(Output& output, std::istream* stream, const std::string& fileName,
+		CompileProgress* progress);
+
+	const Target& m_target;
+	std::unique_ptr<PipelineCache> m_cache;
+	CompiledResult m_result;
+};
+
+} // namespace msl
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <MSL/Config.h>
+#include <MSL/Compile/Export.h>
+#include <MSL/Compile/CompiledResult.h>
+#include <MSL/Compile/CompileProgress.h>
+#include <MSL/Compile/Output.h>
+#include <chrono>
+#include <future>
+#include <istream>
+#include <memory>
+#include <string>
+
+/**
+ * @file
+ * @brief Class for compiling a shader asynchronously.
+ */
+
+namespace msl
+{
+
+class Target;
+
+/**
+ * @brief Class for compiling a shader asynchronously.
+ *
+ * The compile is started on a separate thread on construction and will be completed with
+ * Target::finish(). The target must remain alive and unmodified until the task completes. Multiple
+ * tasks may use the same target at the same time.
+ *
+ * A task that is still running when destroyed will be cancelled and waited on.
+ */
+class MSL_COMPILE_EXPORT CompileTask
+{
+public:
+	/**
+	 * @brief Starts compiling a shader file.
+	 * @param target The target to compile with.
+	 * @param fileName The name of the file to load.
+	 * @param callback The function to call for each progress event. This will be called on the
+	 *     compile thread.
+	 */
+	CompileTask(const Target& target, std::string fileName,
+		CompileProgress::Callback callback = CompileProgress::Callback());
+
+	/**
+	 * @brief Starts compiling a shader from a stream.
+	 * @param target The target to compile with.
+	 * @param stream The stream to read from. The task takes ownership of the stream.
+	 * @param fileName The name of the file corresponding to the stream. This is used for error
+	 *     outputs.
+	 * @param callback The function to call for each progress event. This will be called on the
+	 *     compile thread.
+	 */
+	CompileTask(const Target& target, std::unique_ptr<std::istream> stream, std::string fileName,
+		CompileProgress::Callback callback = CompileProgress::Callback());
+
+	~CompileTask();
+
+	CompileTask(const CompileTask&) = delete;
+	CompileTask& operator=(const CompileTask&) = delete;
+
+	/**
+	 * @brief Requests that the compile be stopped at the next opportunity.
+	 *
+	 * This may be called from any thread.
+	 */
+	void cancel();
+
+	/**
+	 * @brief Returns whether or not cancel() was called.
+	 * @return True if cancelled.
+	 */
+	bool isCancelled() const;
+
+	/**
+	 * @brief Returns whether or not the compile has completed.
+	 * @return True if completed.
+	 */
+	bool isReady() const;
+
+	/**
+	 * @brief Waits for the compile to complete.
+	 * @return False if compilation failed or was cancelled.
+	 */
+	bool wait();
+
+	/**
+	 * @brief Gets the compiled result.
+	 *
+	 * This may only be accessed after wait() has returned.
+	 *
+	 * @return The compiled result.
+	 */
+	CompiledResult& getResult();
+
+	/**
+	 * @brief Gets the output of the compile.
+	 *
+	 * This may only be accessed after wait() has returned.
+	 *
+	 * @return The output.
+	 */
+	Output& getOutput();
+
+private:
+	void start(const Target& target, std::unique_ptr<std::istream> stream, std::string fileName);
+
+	CompileProgress m_progress;
+	CompiledResult m_result;
+	Output m_output;
+	std::future<bool> m_future;
+	bool m_succeeded;
+	bool m_waited;
+};
+
+} // namespace msl
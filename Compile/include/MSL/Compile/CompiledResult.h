@@ -1,5 +1,5 @@
 /*
- * Copyright 2016 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <map>
 #include <ostream>
+#include <unordered_map>
 #include <vector>
 
 /**
@@ -48,6 +49,30 @@ public:
 	 */
 	static const std::uint32_t version = 0;
 
+	/**
+	 * @brief Constant for the file version of sectioned modules.
+	 *
+	 * Sectioned modules store the data for each shader after the reflection info, allowing
+	 * clients to load shaders on demand. See Target::setSectionedModules().
+	 */
+	static const std::uint32_t sectionedVersion = 1;
+
+	/**
+	 * @brief Constant for the file version of modules with compressed shaders.
+	 *
+	 * This is used when any shader is compressed, and may also be sectioned. See
+	 * Target::setCompression().
+	 */
+	static const std::uint32_t compressionVersion = 2;
+
+	/**
+	 * @brief Constant for the file version of modules with encoded SPIR-V.
+	 *
+	 * This is used when any shader is encoded, and may also be compressed or sectioned. See
+	 * Target::setEncodeSpirV().
+	 */
+	static const std::uint32_t spirVEncodingVersion = 3;
+
 	/**
 	 * @brief Struct with the data for a shader.
 	 */
@@ -102,6 +127,17 @@ public:
 	 */
 	inline const std::vector<std::uint8_t>& getSharedData() const;
 
+	/**
+	 * @brief Gets the variants of each pipeline when compiled with variant keywords.
+	 *
+	 * The first element is the name of the pipeline in the source file, the second element
+	 * contains the name of the compiled pipeline for each permutation of the variant keywords.
+	 * Permutations where the pipeline wasn't present have an empty name.
+	 *
+	 * @return The variants.
+	 */
+	inline const std::map<std::string, std::vector<std::string>>& getVariants() const;
+
 	/**
 	 * @brief Saves the compiled shader to a stream.
 	 * @param stream The stream to save to.
@@ -128,6 +164,10 @@ private:
 	std::map<std::string, compile::Pipeline> m_pipelines;
 	std::vector<ShaderData> m_shaders;
 	std::vector<std::uint8_t> m_sharedData;
+	std::map<std::string, std::vector<std::string>> m_variants;
+
+	// Hash of the shader data to the index in m_shaders for quickly finding duplicates.
+	std::unordered_multimap<std::size_t, std::size_t> m_shaderHashes;
 };
 
 inline const std::map<std::string, compile::Pipeline>& CompiledResult::getPipelines() const
@@ -145,4 +185,9 @@ inline const std::vector<std::uint8_t>& CompiledResult::getSharedData() const
 	return m_sharedData;
 }
 
+inline const std::map<std::string, std::vector<std::string>>& CompiledResult::getVariants() const
+{
+	return m_variants;
+}
+
 } // namespace msl
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -18,7 +18,10 @@
 
 #include <MSL/Config.h>
 #include <algorithm>
+#include <cstddef>
+#include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
 /**
@@ -31,6 +34,15 @@ namespace msl
 
 /**
  * @brief Class to hold a list of warnings and errors output from the compiler.
+ *
+ * By default messages are accumulated in a list. Alternatively, a callback may be set to stream
+ * each message as it's added instead of storing it, and a minimum level may be set to drop
+ * messages before they are stored or streamed. Dropped and streamed messages are still included
+ * in the warning and error counts.
+ *
+ * An instance may only be used by one thread at a time. When compiling on multiple threads, each
+ * thread should use its own output, which may then be combined with append() in a deterministic
+ * order without needing any locks while compiling.
  */
 class Output
 {
@@ -100,8 +112,56 @@ public:
 		std::string message;
 	};
 
+	/**
+	 * @brief Function called for each message that passes the minimum level.
+	 */
+	using Callback = std::function<void(const Message& message)>;
+
+	/**
+	 * @brief Constructs this to store the messages.
+	 */
+	inline Output();
+
+	/**
+	 * @brief Constructs this to stream the messages to a callback.
+	 * @param callback The function to call for each message. If empty, the messages will be
+	 *     stored.
+	 * @param minLevel The minimum level of messages to keep.
+	 */
+	inline explicit Output(Callback callback, Level minLevel = Level::Info);
+
+	/**
+	 * @brief Gets the callback the messages are streamed to.
+	 * @return The callback. This is empty if messages are stored.
+	 */
+	inline const Callback& getCallback() const;
+
+	/**
+	 * @brief Sets the callback to stream the messages to.
+	 * @param callback The function to call for each message. If empty, the messages will be
+	 *     stored.
+	 */
+	inline void setCallback(Callback callback);
+
+	/**
+	 * @brief Gets the minimum level of messages to keep.
+	 * @return The minimum level.
+	 */
+	inline Level getMinLevel() const;
+
+	/**
+	 * @brief Sets the minimum level of messages to keep.
+	 *
+	 * Messages below this level, including their continued messages, are dropped.
+	 *
+	 * @param minLevel The minimum level.
+	 */
+	inline void setMinLevel(Level minLevel);
+
 	/**
 	 * @brief Gets the list of messages to output.
+	 *
+	 * This will be empty when streaming the messages to a callback.
 	 */
 	inline const std::vector<Message>& getMessages() const;
 
@@ -113,13 +173,15 @@ public:
 
 	/**
 	 * @brief Gets the number of warnings.
-	 * @return The number of warnings. Continued messages aren't counted.
+	 * @return The number of warnings, including dropped and streamed warnings. Continued messages
+	 *     aren't counted.
 	 */
 	inline std::size_t getWarningCount() const;
 
 	/**
 	 * @brief Gets the number of errors.
-	 * @return The number of errors. Continued messages aren't counted.
+	 * @return The number of errors, including dropped and streamed errors. Continued messages
+	 *     aren't counted.
 	 */
 	inline std::size_t getErrorCount() const;
 
@@ -142,12 +204,29 @@ public:
 		bool continued, std::string message);
 
 	/**
-	 * @brief Clears the list of messages.
+	 * @brief Appends the messages from another output.
+	 *
+	 * The stored messages are added in order, applying the minimum level and callback for this
+	 * output, and the warning and error counts are combined.
+	 *
+	 * @param other The output to append. This will be cleared afterward.
+	 */
+	inline void append(Output&& other);
+
+	/**
+	 * @brief Clears the list of messages and the warning and error counts.
 	 */
 	inline void clear();
 
 private:
+	inline void handleMessage(Message&& message);
+
 	std::vector<Message> m_messages;
+	Callback m_callback;
+	Level m_minLevel;
+	bool m_droppedLast;
+	std::size_t m_warningCount;
+	std::size_t m_errorCount;
 };
 
 inline Output::Message::Message()
@@ -165,11 +244,47 @@ inline Output::Message::Message(Level level_, std::string file_, std::size_t lin
 	, line(line_)
 	, column(column_)
 	, continued(continued_)
-	, message(message_)
+	, message(std::move(message_))
+{
+}
 
+inline Output::Output()
+	: m_minLevel(Level::Info)
+	, m_droppedLast(false)
+	, m_warningCount(0)
+	, m_errorCount(0)
 {
 }
 
+inline Output::Output(Callback callback, Level minLevel)
+	: m_callback(std::move(callback))
+	, m_minLevel(minLevel)
+	, m_droppedLast(false)
+	, m_warningCount(0)
+	, m_errorCount(0)
+{
+}
+
+inline const Output::Callback& Output::getCallback() const
+{
+	return m_callback;
+}
+
+inline void Output::setCallback(Callback callback)
+{
+	m_callback = std::move(callback);
+}
+
+inline Output::Level Output::getMinLevel() const
+{
+	return m_minLevel;
+}
+
+inline void Output::setMinLevel(Level minLevel)
+{
+	m_minLevel = minLevel;
+}
+
 inline const std::vector<Output::Message>& Output::getMessages() const
 {
 	return m_messages;
@@ -182,40 +297,65 @@ inline bool Output::empty() const
 
 inline std::size_t Output::getWarningCount() const
 {
-	std::size_t count = 0;
-	for (const Message& message : m_messages)
-	{
-		if (message.level == Level::Warning && !message.continued)
-			++count;
-	}
-	return count;
+	return m_warningCount;
 }
 
 inline std::size_t Output::getErrorCount() const
 {
-	std::size_t count = 0;
-	for (const Message& message : m_messages)
-	{
-		if (message.level == Level::Error && !message.continued)
-			++count;
-	}
-	return count;
+	return m_errorCount;
 }
 
 inline void Output::addMessage(Message message)
 {
-	m_messages.push_back(std::move(message));
+	if (!message.continued)
+	{
+		if (message.level == Level::Warning)
+			++m_warningCount;
+		else if (message.level == Level::Error)
+			++m_errorCount;
+	}
+
+	handleMessage(std::move(message));
 }
 
 inline void Output::addMessage(Level level, std::string file, std::size_t line,
 	std::size_t column, bool continued, std::string message)
 {
-	m_messages.emplace_back(level, std::move(file), line, column, continued, std::move(message));
+	addMessage(Message(level, std::move(file), line, column, continued, std::move(message)));
+}
+
+inline void Output::append(Output&& other)
+{
+	for (Message& message : other.m_messages)
+		handleMessage(std::move(message));
+
+	m_warningCount += other.m_warningCount;
+	m_errorCount += other.m_errorCount;
+	other.clear();
 }
 
 inline void Output::clear()
 {
 	m_messages.clear();
+	m_droppedLast = false;
+	m_warningCount = 0;
+	m_errorCount = 0;
+}
+
+inline void Output::handleMessage(Message&& message)
+{
+	// Drop continued messages along with the message they continue.
+	if (message.continued ? m_droppedLast : message.level < m_minLevel)
+	{
+		m_droppedLast = true;
+		return;
+	}
+
+	m_droppedLast = false;
+	if (m_callback)
+		m_callback(message);
+	else
+		m_messages.push_back(std::move(message));
 }
 
 } // namespace msl
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2025 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -18,9 +18,12 @@
 
 #include <MSL/Config.h>
 #include <MSL/Compile/Export.h>
+#include <MSL/Compile/CompiledResult.h>
 #include <MSL/Compile/Types.h>
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <istream>
 #include <string>
 #include <vector>
@@ -33,10 +36,13 @@
 namespace msl
 {
 
-class CompiledResult;
+class CompileProgress;
 class Output;
 class Parser;
+class PipelineCache;
 class Preprocessor;
+class SpirVCache;
+struct CompiledSpirV;
 
 /**
  * @brief Base class for a target.
@@ -51,10 +57,27 @@ class Preprocessor;
  * - featureSupported(): determine whether or not a feature is supported by the target.
  * - getExtraDefines(): gets target-specific defines to automatically add during preprocessing.
  * - crossCompile(): convert SPIR-V to the target language.
+ *
+ * Once the target is configured, compile() and finish() may be called concurrently from multiple
+ * threads with the same target as long as each call uses a separate CompiledResult and Output.
+ * All state used during compilation is local to each call, so subclasses must ensure that
+ * crossCompile() and getSharedData() are also thread-safe. Modifying the configuration, such as
+ * adding defines or changing the optimization level, must not be done while compiling.
  */
 class MSL_COMPILE_EXPORT Target
 {
 public:
+	/**
+	 * @brief The minimum alignment of the data for each shader within a saved module.
+	 */
+	static const std::uint32_t minShaderAlignment = 4;
+
+	/**
+	 * @brief The maximum alignment of the data for each shader within a saved module.
+	 *
+	 * This is large enough to align to the page size on common platforms.
+	 */
+	static const std::uint32_t maxShaderAlignment = 65536;
 
 	/**
 	 * @brief List of features to query if they are supported.
@@ -128,6 +151,15 @@ public:
 		Full     ///< Full optimization passes.
 	};
 
+	/**
+	 * @brief Enum for how to compress the data for each shader when saving a module.
+	 */
+	enum class Compression
+	{
+		None, ///< Don't compress the shaders.
+		LZ4   ///< Compress each shader with the LZ4 block format.
+	};
+
 	/**
 	 * @brief Information about a feature.
 	 *
@@ -151,6 +183,67 @@ public:
 		const char* help;
 	};
 
+	/**
+	 * @brief Struct describing a keyword used to compile variants of each pipeline.
+	 */
+	struct VariantKeyword
+	{
+		/**
+		 * @brief The name of the keyword. This is the define set when compiling each variant.
+		 */
+		std::string name;
+
+		/**
+		 * @brief The possible values for the keyword.
+		 */
+		std::vector<std::string> values;
+	};
+
+	/**
+	 * @brief Struct describing the stage passed to a transform function.
+	 */
+	struct StageInfo
+	{
+		/**
+		 * @brief The file the entry point was declared in.
+		 */
+		const std::string& fileName;
+
+		/**
+		 * @brief The line of the entry point declaration.
+		 */
+		std::size_t line;
+
+		/**
+		 * @brief The column of the entry point declaration.
+		 */
+		std::size_t column;
+
+		/**
+		 * @brief The stage being transformed.
+		 */
+		compile::Stage stage;
+
+		/**
+		 * @brief The name of the entry point function.
+		 */
+		const std::string& entryPoint;
+
+		/**
+		 * @brief The name of the pipeline the stage belongs to.
+		 */
+		const std::string& pipeline;
+	};
+
+	/**
+	 * @brief Function to transform the SPIR-V for a stage in-process.
+	 *
+	 * The first parameter is the SPIR-V to modify in place, the second is the output to add
+	 * messages to, and the third describes the stage. Return false to fail compilation.
+	 */
+	using SpirVTransform = std::function<bool(std::vector<std::uint32_t>& spirv, Output& output,
+		const StageInfo& stage)>;
+
 	/**
 	 * @brief Gets information about a feature.
 	 * @param feature The feature to get the info for.
@@ -256,6 +349,18 @@ public:
 	 */
 	virtual std::vector<std::pair<std::string, std::string>> getExtraDefines() const;
 
+	/**
+	 * @brief Gets the format of the data for each shader saved in the module.
+	 * @return The shader data format. Default implementation returns ShaderDataFormat::Native.
+	 */
+	virtual compile::ShaderDataFormat getShaderDataFormat() const;
+
+	/**
+	 * @brief Gets whether or not resources are placed in an argument buffer.
+	 * @return True if argument buffers are used. Default implementation returns false.
+	 */
+	virtual bool getArgumentBuffers() const;
+
 	/**
 	 * @brief Clears the defines.
 	 */
@@ -292,7 +397,8 @@ public:
 	 * tool will be captured and added to the Output instance.
 	 *
 	 * The string $input will be replaced with the file name for the input file, while the string
-	 * $output will be replaced with the file name for the output file.
+	 * $output will be replaced with the file name for the output file. See
+	 * setBatchToolCommands() for running the command once for all stages.
 	 *
 	 * When empty, no command will be run.
 	 *
@@ -300,6 +406,75 @@ public:
 	 */
 	void setSpirVToolCommand(std::string command);
 
+	/**
+	 * @brief Gets the function to transform the output SPIR-V before cross-compiling.
+	 * @return The SPIR-V transform.
+	 */
+	const SpirVTransform& getSpirVTransform() const;
+
+	/**
+	 * @brief Sets the function to transform the output SPIR-V before cross-compiling.
+	 *
+	 * This is an in-process alternative to setSpirVToolCommand(), avoiding the cost of launching
+	 * a process for each stage. If both are set, the transform is run on the output of the tool
+	 * command.
+	 *
+	 * The transform may be called concurrently when compiling on multiple threads. It should
+	 * produce the same result for the same input, since compiled pipelines may be re-used for
+	 * variants and when compiling with CompileSession.
+	 *
+	 * @param transform The transform function. When empty, no transform will be run.
+	 */
+	void setSpirVTransform(SpirVTransform transform);
+
+	/**
+	 * @brief Gets the directory to cache the results of external commands in.
+	 * @return The command cache directory.
+	 */
+	const std::string& getCommandCacheDirectory() const;
+
+	/**
+	 * @brief Sets the directory to cache the results of external commands in.
+	 *
+	 * External commands, such as the SPIR-V tool command and the commands used to build Metal
+	 * libraries, are assumed to only depend on the command and the input data. When set, the
+	 * output of each successful command is stored in this directory keyed by a hash of the
+	 * command and input, and later runs with the same command and input will use the stored
+	 * output rather than running the command again. The directory may be shared between
+	 * processes.
+	 *
+	 * When empty, results won't be cached.
+	 *
+	 * @param directory The directory to store the results in. It will be created if it doesn't
+	 *     exist.
+	 */
+	void setCommandCacheDirectory(std::string directory);
+
+	/**
+	 * @brief Gets whether or not tool commands are run once for each compiled file.
+	 * @return True if tool commands are batched.
+	 */
+	bool getBatchToolCommands() const;
+
+	/**
+	 * @brief Sets whether or not tool commands are run once for each compiled file.
+	 *
+	 * By default tool commands are run once for each stage of each pipeline, which can be slow
+	 * for tools with a high startup cost. When batching, the command is run once with all of the
+	 * stages of the file. The inputs are written to separate files, and a manifest is written
+	 * with one line for each stage containing the input and output file names separated by a
+	 * tab. The string $manifest will be replaced with the file name for the manifest, otherwise
+	 * the manifest is written to stdin. The command must write each output file.
+	 *
+	 * Output from the tool that references the file names for a stage will be reported at the
+	 * location of that stage's entry point. When getCommandCacheDirectory() is set, the result
+	 * for each stage is cached separately and the command is only run for the stages that
+	 * weren't cached.
+	 *
+	 * @param batch True to batch tool commands.
+	 */
+	void setBatchToolCommands(bool batch);
+
 	/**
 	 * @brief Returns whether or not to remap the SPIR-V variables.
 	 *
@@ -370,12 +545,94 @@ public:
 	 *
 	 * This can be done for SPIR-V to assign the bndings at runtime before sending them to Vulkan.
 	 * This will modify the loaded module in place. No duplicate shader results will be removed to
-	 * ensure that each one can have the bindings set separately.
+	 * ensure that each one can have the bindings set separately. The shader data is also never
+	 * compressed or encoded, since it must be modified directly from the loaded module.
 	 *
 	 * @param adjustable True to use adjustable bindings.
 	 */
 	void setAdjustableBindings(bool adjustable);
 
+	/**
+	 * @brief Gets the alignment of the data for each shader within a saved module.
+	 * @return The shader alignment in bytes.
+	 */
+	std::uint32_t getShaderAlignment() const;
+
+	/**
+	 * @brief Sets the alignment of the data for each shader within a saved module.
+	 *
+	 * This allows the shader data to be passed directly to the graphics API from a loaded or
+	 * memory mapped module without first copying to an aligned buffer. Defaults to
+	 * minShaderAlignment.
+	 *
+	 * @param alignment The shader alignment in bytes. This must be a power of two between
+	 *     minShaderAlignment and maxShaderAlignment.
+	 * @return False if the alignment is invalid.
+	 */
+	bool setShaderAlignment(std::uint32_t alignment);
+
+	/**
+	 * @brief Gets whether or not to save sectioned modules.
+	 * @return True to save sectioned modules.
+	 */
+	bool getSectionedModules() const;
+
+	/**
+	 * @brief Sets whether or not to save sectioned modules.
+	 *
+	 * Sectioned modules place the data for each shader in a separate section after the
+	 * reflection info, which allows the client to load the reflection info first and only read
+	 * the shaders that are used. These require a client that supports
+	 * CompiledResult::sectionedVersion.
+	 *
+	 * @param sectioned True to save sectioned modules.
+	 */
+	void setSectionedModules(bool sectioned);
+
+	/**
+	 * @brief Gets how to compress the data for each shader.
+	 * @return The compression mode.
+	 */
+	Compression getCompression() const;
+
+	/**
+	 * @brief Sets how to compress the data for each shader.
+	 *
+	 * Each shader is compressed separately so the client can decompress individual shaders on
+	 * demand. Shaders that don't become smaller are stored uncompressed. Compressed shaders can't
+	 * be used directly from the loaded module, and must be read into a separate buffer with
+	 * mslModule_readShaderData(). This requires a client that supports
+	 * CompiledResult::compressionVersion.
+	 *
+	 * Compression is skipped for SPIR-V when getAdjustableBindings() is enabled, since the
+	 * bindings are adjusted in place within the stored shader data.
+	 *
+	 * @param compression The compression mode.
+	 */
+	void setCompression(Compression compression);
+
+	/**
+	 * @brief Gets whether or not to use a compact encoding for SPIR-V.
+	 * @return True to encode SPIR-V.
+	 */
+	bool getEncodeSpirV() const;
+
+	/**
+	 * @brief Sets whether or not to use a compact encoding for SPIR-V.
+	 *
+	 * This packs the opcodes and operands of each instruction into variable length integers,
+	 * storing IDs as the difference from related IDs. The result is smaller than the raw SPIR-V and
+	 * compresses much better when combined with setCompression() and setRemapVariables(). Encoded
+	 * shaders must be read with mslModule_readShaderData(). This only applies to SPIR-V targets,
+	 * and requires a client that supports CompiledResult::spirVEncodingVersion.
+	 *
+	 * Encoding is skipped when getAdjustableBindings() is enabled, since the bindings are adjusted
+	 * in place within the stored shader data.
+	 *
+	 * @param encode True to encode SPIR-V.
+	 */
+	void setEncodeSpirV(bool encode);
+
 	/**
 	 * @brief Gets the file name to a text file describing the resource limits.
 	 *
@@ -396,14 +653,74 @@ public:
 	 */
 	void setResourcesFileName(std::string fileName);
 
+	/**
+	 * @brief Adds a filter for the pipelines to compile.
+	 *
+	 * When any filters are set, only pipelines with names that match at least one filter will be
+	 * compiled and added to the result. The rest of the source is still preprocessed and parsed,
+	 * and the entry points for the other pipelines are checked, but they skip compiling to SPIR-V
+	 * and cross-compiling.
+	 *
+	 * @param filter The filter for the pipeline name. This may be an exact name or a glob pattern,
+	 *     where '*' matches any number of characters and '?' matches a single character.
+	 */
+	void addPipelineFilter(std::string filter);
+
+	/**
+	 * @brief Gets the pipeline filters.
+	 * @return The pipeline filters.
+	 */
+	const std::vector<std::string>& getPipelineFilters() const;
+
+	/**
+	 * @brief Clears the pipeline filters, compiling all pipelines.
+	 */
+	void clearPipelineFilters();
+
+	/**
+	 * @brief Returns whether or not a pipeline will be compiled based on the pipeline filters.
+	 * @param name The name of the pipeline.
+	 * @return True if the pipeline will be compiled.
+	 */
+	bool pipelineSelected(const std::string& name) const;
+
+	/**
+	 * @brief Adds a keyword to compile variants of each pipeline with.
+	 *
+	 * When variant keywords are present, each source file is compiled once for every permutation
+	 * of the keyword values, with each keyword set as a define. The pipelines for each permutation
+	 * are named "Name[KEYWORD1=value,KEYWORD2=value]", and a lookup table from the permutation to
+	 * the pipeline is stored in the module.
+	 *
+	 * Pipelines whose generated shaders are identical between permutations are only compiled
+	 * once, and identical shaders are only stored once in the module.
+	 *
+	 * @param name The name of the keyword.
+	 * @param values The possible values for the keyword. This must not be empty.
+	 */
+	void addVariantKeyword(std::string name, std::vector<std::string> values);
+
+	/**
+	 * @brief Gets the variant keywords.
+	 * @return The variant keywords.
+	 */
+	const std::vector<VariantKeyword>& getVariantKeywords() const;
+
+	/**
+	 * @brief Clears the variant keywords, compiling a single variant of each pipeline.
+	 */
+	void clearVariantKeywords();
+
 	/**
 	 * @brief Compiles a shader.
 	 * @param result The compiled result.
 	 * @param output The output for warnings and errors.
 	 * @param fileName The name of the file to load.
-	 * @return False if compilation failed.
+	 * @param progress The progress to report to and check for cancellation. This may be null.
+	 * @return False if compilation failed or was cancelled.
 	 */
-	bool compile(CompiledResult& result, Output& output, const std::string& fileName);
+	bool compile(CompiledResult& result, Output& output, const std::string& fileName,
+		CompileProgress* progress = nullptr) const;
 
 	/**
 	 * @brief Compiles a shader.
@@ -412,10 +729,11 @@ public:
 	 * @param stream The stream to read from.
 	 * @param fileName The name of the file corresponding to the stream. This is used for error
 	 * outputs.
-	 * @return False if compilation failed.
+	 * @param progress The progress to report to and check for cancellation. This may be null.
+	 * @return False if compilation failed or was cancelled.
 	 */
 	bool compile(CompiledResult& result, Output& output, std::istream& stream,
-		const std::string& fileName);
+		const std::string& fileName, CompileProgress* progress = nullptr) const;
 
 	/**
 	 * @brief Finishes compiling the shader.
@@ -423,7 +741,7 @@ public:
 	 * @param output The output for warnings and errors.
 	 * @return False if compilation failed.
 	 */
-	bool finish(CompiledResult& result, Output& output);
+	bool finish(CompiledResult& result, Output& output) const;
 
 protected:
 
@@ -443,9 +761,13 @@ protected:
 	virtual std::uint32_t getSpirVVersion() const;
 
 	/**
-	 * @brief Function called when about to compile a shader.
+	 * @brief Gets whether or not dummy bindings are required for the target to cross-compile.
+	 *
+	 * When true, dummy bindings will be added regardless of getDummyBindings().
+	 *
+	 * @return True if dummy bindings are required. Default implementation returns false.
 	 */
-	virtual void willCompile();
+	virtual bool requiresDummyBindings() const;
 
 	/**
 	 * @brief Cross-compiles SPIR-V to the final target.
@@ -454,6 +776,7 @@ protected:
 	 *
 	 * @param[out] data The data from cross-compiling.
 	 * @param output The output to add errors and warnings.
+	 * @param pipeline The name of the pipeline being compiled.
 	 * @param fileName The file name for the message of any output message.
 	 * @param line The line number for the message of any output message.
 	 * @param column The column number for the message of any output message.
@@ -470,12 +793,13 @@ protected:
 	 * @return False if the compilation failed.
 	 */
 	virtual bool crossCompile(std::vector<std::uint8_t>& data, Output& output,
-		const std::string& fileName, std::size_t line, std::size_t column,
+		const std::string& pipeline, const std::string& fileName, std::size_t line,
+		std::size_t column,
 		const std::array<bool, compile::stageCount>& pipelineStages, compile::Stage stage,
 		const std::vector<std::uint32_t>& spirv, const std::string& entryPoint,
 		const std::vector<compile::Uniform>& uniforms, std::vector<std::uint32_t>& uniformIds,
 		const std::vector<compile::FragmentInputGroup>& fragmentInputs,
-		std::uint32_t fragmentGroup) = 0;
+		std::uint32_t fragmentGroup) const = 0;
 
 	/**
 	 * @brief Gets the shared data for the compiled shader.
@@ -483,9 +807,68 @@ protected:
 	 * @param output The output to add errors and warnings.
 	 * @return False if the compilation failed.
 	 */
-	virtual bool getSharedData(std::vector<std::uint8_t>& data, Output& output);
+	virtual bool getSharedData(std::vector<std::uint8_t>& data, Output& output) const;
+
+	/**
+	 * @brief Struct describing a cross-compiled shader passed to postProcessShaders().
+	 */
+	struct CompiledShader
+	{
+		/**
+		 * @brief Information about the stage the shader was compiled for.
+		 */
+		StageInfo stageInfo;
+
+		/**
+		 * @brief The data from cross-compiling, which may be modified.
+		 */
+		std::vector<std::uint8_t> data;
+	};
+
+	/**
+	 * @brief Returns whether or not postProcessShaders() needs to be called.
+	 *
+	 * When true, the pipelines for a file are only added to the result once all of them have
+	 * been cross-compiled. Otherwise each pipeline is finished as soon as it's compiled.
+	 *
+	 * @return True if postProcessShaders() is needed. Default implementation returns false.
+	 */
+	virtual bool needsPostProcessShaders() const;
+
+	/**
+	 * @brief Processes the cross-compiled shaders for a file before they're added to the result.
+	 *
+	 * This is called once for each compiled file, or for each variant permutation, with all of
+	 * the shaders that were cross-compiled when needsPostProcessShaders() returns true. This can
+	 * be used to run tools on multiple shaders at once. Shaders re-used from previous compiles
+	 * aren't included.
+	 *
+	 * @param output The output to add errors and warnings.
+	 * @param[inout] shaders The shaders that were cross-compiled. The data for each shader may be
+	 *     modified.
+	 * @return False if processing failed. Default implementation returns true.
+	 */
+	virtual bool postProcessShaders(Output& output, std::vector<CompiledShader>& shaders) const;
+
+	/**
+	 * @brief Links the shaders of a compiled result when finishing.
+	 *
+	 * This is called from finish() before getSharedData() with all of the shaders in the result.
+	 * It may replace the data for each shader, such as to reference a library built from all of
+	 * the shaders that's stored in the shared data.
+	 *
+	 * @param[inout] shaders The shaders in the compiled result.
+	 * @param[out] sharedData The shared data for the compiled result.
+	 * @param output The output to add errors and warnings.
+	 * @return False if linking failed. Default implementation returns true.
+	 */
+	virtual bool linkShaders(std::vector<CompiledResult::ShaderData>& shaders,
+		std::vector<std::uint8_t>& sharedData, Output& output) const;
 
 private:
+	friend class CompileSession;
+	friend class TargetGroup;
+
 	enum class State
 	{
 		Default,
@@ -493,21 +876,63 @@ private:
 		Disabled
 	};
 
+	struct CompileContext;
+	struct VariantState;
+	struct PipelineSources;
+	struct PipelineState;
+
 	void setupPreprocessor(Preprocessor& preprocessor) const;
-	bool compileImpl(CompiledResult& result, Output& output, Parser& parser,
-		const std::string& fileName);
+	std::string getFrontEndKey() const;
+	bool compileImpl(CompiledResult& result, Output& output, std::istream* stream,
+		const std::string& fileName, PipelineCache* cache, CompileProgress* progress,
+		SpirVCache* spirvCache) const;
+	bool compileVariants(CompiledResult& result, Output& output, std::istream* stream,
+		const std::string& fileName, PipelineCache* cache, CompileProgress* progress,
+		SpirVCache* spirvCache) const;
+	bool compileSource(CompiledResult& result, Output& output, std::istream* stream,
+		const std::string& fileName, PipelineCache* cache, CompileProgress* progress,
+		VariantState* variant, SpirVCache* spirvCache) const;
+	bool preprocessAndParse(Parser& parser, Output& output, std::istream* stream,
+		const std::string& fileName, CompileProgress* progress,
+		const VariantState* variant) const;
+	bool compileParsed(CompiledResult& result, Output& output, const Parser& parser,
+		const std::string& fileName, PipelineCache* cache, CompileProgress* progress,
+		VariantState* variant, SpirVCache* spirvCache) const;
+	bool compileDeferredPipelines(std::vector<PipelineState>& pipelineStates,
+		CompiledResult& result, Output& output, const CompileContext& context) const;
+	bool preparePipeline(PipelineState& state, CompiledResult& result, Output& output,
+		const CompileContext& context, std::size_t pipelineIndex) const;
+	bool runBatchSpirVTool(std::vector<PipelineState>& pipelineStates, Output& output,
+		const CompileContext& context) const;
+	bool crossCompilePipeline(PipelineState& state, Output& output, const CompileContext& context,
+		std::size_t pipelineIndex) const;
+	bool finishPipeline(PipelineState& state, CompiledResult& result, Output& output,
+		const CompileContext& context, std::size_t pipelineIndex) const;
+	void addCompiledShaders(PipelineState& state, CompiledResult& result,
+		const CompileContext& context, std::size_t pipelineIndex) const;
+	bool compileSpirV(CompiledSpirV& compiled, Output& output, const CompileContext& context,
+		std::size_t pipelineIndex, const PipelineSources& sources) const;
 
 	std::array<State, featureCount> m_featureStates;
 	std::vector<std::string> m_includePaths;
 	std::vector<std::pair<std::string, std::string>> m_defines;
 	std::vector<std::string> m_preHeaderLines;
+	std::vector<std::string> m_pipelineFilters;
+	std::vector<VariantKeyword> m_variantKeywords;
 	std::string m_spirVToolCommand;
+	SpirVTransform m_spirVTransform;
+	std::string m_commandCacheDirectory;
 
 	bool m_remapVariables;
 	bool m_stripDebug;
 	bool m_dummyBindings;
 	bool m_adjustableBindings;
+	bool m_batchToolCommands;
+	bool m_sectionedModules;
+	bool m_encodeSpirV;
+	std::uint32_t m_shaderAlignment;
 	Optimize m_optimize;
+	Compression m_compression;
 	std::string m_resourcesFile;
 };
 
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2025 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -173,7 +173,9 @@ public:
 	 * tool will be captured and added to the Output instance.
 	 *
 	 * The string $input will be replaced with the file name for the input file, while the string
-	 * $output will be replaced with the file name for the output file.
+	 * $output will be replaced with the file name for the output file. When
+	 * setBatchToolCommands() is enabled, the command is instead run once for all shaders of the
+	 * stage in each file.
 	 *
 	 * When empty, no command will be run.
 	 *
@@ -182,6 +184,32 @@ public:
 	 */
 	void setGlslToolCommand(compile::Stage stage, std::string command);
 
+	/**
+	 * @brief Function to transform the output GLSL for a stage in-process.
+	 *
+	 * The first parameter is the GLSL to modify in place, the second is the output to add
+	 * messages to, and the third describes the stage. Return false to fail compilation.
+	 */
+	using GlslTransform = std::function<bool(std::string& glsl, Output& output,
+		const StageInfo& stage)>;
+
+	/**
+	 * @brief Gets the function to transform the output GLSL.
+	 * @return The GLSL transform.
+	 */
+	const GlslTransform& getGlslTransform() const;
+
+	/**
+	 * @brief Sets the function to transform the output GLSL.
+	 *
+	 * This is an in-process alternative to setGlslToolCommand(), avoiding the cost of launching a
+	 * process for each stage. The transform is run for all stages before the tool command for the
+	 * stage. It may be called concurrently when compiling on multiple threads.
+	 *
+	 * @param transform The transform function. When empty, no transform will be run.
+	 */
+	void setGlslTransform(GlslTransform transform);
+
 	std::uint32_t getId() const override;
 	std::uint32_t getVersion() const override;
 	bool featureSupported(Feature feature) const override;
@@ -190,12 +218,15 @@ public:
 protected:
 	std::uint32_t getSpirVVersion() const override;
 	bool crossCompile(std::vector<std::uint8_t>& data, Output& output,
-		const std::string& fileName, std::size_t line, std::size_t column,
+		const std::string& pipeline, const std::string& fileName, std::size_t line,
+		std::size_t column,
 		const std::array<bool, compile::stageCount>& pipelineStages, compile::Stage stage,
 		const std::vector<std::uint32_t>& spirv, const std::string& entryPoint,
 		const std::vector<compile::Uniform>& uniforms, std::vector<std::uint32_t>& uniformIds,
 		const std::vector<compile::FragmentInputGroup>& fragmentInputs,
-		std::uint32_t fragmentGroup) override;
+		std::uint32_t fragmentGroup) const override;
+	bool needsPostProcessShaders() const override;
+	bool postProcessShaders(Output& output, std::vector<CompiledShader>& shaders) const override;
 
 private:
 	std::uint32_t m_version;
@@ -207,6 +238,7 @@ private:
 	std::array<std::vector<std::string>, compile::stageCount> m_headerLines;
 	std::array<std::vector<std::string>, compile::stageCount> m_requiredExtensions;
 	std::array<std::string, compile::stageCount> m_glslToolCommand;
+	GlslTransform m_glslTransform;
 };
 
 } // namespace msl
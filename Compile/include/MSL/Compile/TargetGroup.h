@@ -0,0 +1,132 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <MSL/Config.h>
+#include <MSL/Compile/Export.h>
+#include <MSL/Compile/CompiledResult.h>
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * @brief Class for compiling a shader file for multiple targets at once.
+ */
+
+namespace msl
+{
+
+class CompileProgress;
+class Output;
+class Target;
+
+/**
+ * @brief Class for compiling a shader file for multiple targets at once.
+ *
+ * This produces the same results as compiling with each target separately, but shares as much
+ * work as possible between the targets:
+ * - Targets with the same enabled features, include paths, defines, and pre-header lines share
+ *   the preprocessed and parsed source.
+ * - Pipelines with the same generated GLSL share the compiled and processed SPIR-V for targets
+ *   that use the same SPIR-V version, optimization, strip, and binding settings. For example, a
+ *   SPIR-V target and a GLSL or Metal target with matching settings will only compile each
+ *   pipeline to SPIR-V once.
+ *
+ * Targets with variant keywords are preprocessed and parsed separately, though they may still
+ * share SPIR-V with the other targets.
+ *
+ * The targets must remain alive and unmodified while compiling. Like Target, compile() may be
+ * called concurrently from multiple threads as long as each call uses separate results and
+ * output.
+ */
+class MSL_COMPILE_EXPORT TargetGroup
+{
+public:
+	/**
+	 * @brief Adds a target to compile with.
+	 * @param target The target to add. This must remain alive for the lifetime of the group.
+	 */
+	void addTarget(const Target& target);
+
+	/**
+	 * @brief Gets the number of targets.
+	 * @return The number of targets.
+	 */
+	std::size_t getTargetCount() const;
+
+	/**
+	 * @brief Gets a target.
+	 * @param index The index of the target.
+	 * @return The target.
+	 */
+	const Target& getTarget(std::size_t index) const;
+
+	/**
+	 * @brief Clears the targets.
+	 */
+	void clearTargets();
+
+	/**
+	 * @brief Compiles a shader for each target.
+	 *
+	 * The Preprocessed and Parsed progress events are reported once for each group of targets
+	 * that share the parsed source.
+	 *
+	 * @param[inout] results The results to compile into, with one result for each target in the
+	 *     same order as the targets were added. This will be resized to the number of targets if
+	 *     the size doesn't match. The same results may be used for multiple files.
+	 * @param output The output for warnings and errors.
+	 * @param fileName The name of the file to load.
+	 * @param progress The progress to report to and check for cancellation. This may be null.
+	 * @return False if compilation failed for any target or was cancelled.
+	 */
+	bool compile(std::vector<CompiledResult>& results, Output& output,
+		const std::string& fileName, CompileProgress* progress = nullptr) const;
+
+	/**
+	 * @brief Compiles a shader for each target.
+	 * @param[inout] results The results to compile into, with one result for each target in the
+	 *     same order as the targets were added. This will be resized to the number of targets if
+	 *     the size doesn't match. The same results may be used for multiple files.
+	 * @param output The output for warnings and errors.
+	 * @param stream The stream to read from. This is only read once.
+	 * @param fileName The name of the file corresponding to the stream. This is used for error
+	 * outputs.
+	 * @param progress The progress to report to and check for cancellation. This may be null.
+	 * @return False if compilation failed for any target or was cancelled.
+	 */
+	bool compile(std::vector<CompiledResult>& results, Output& output, std::istream& stream,
+		const std::string& fileName, CompileProgress* progress = nullptr) const;
+
+	/**
+	 * @brief Finishes the results for each target.
+	 * @param[inout] results The results to finish, as passed to compile().
+	 * @param output The output for warnings and errors.
+	 * @return False if finishing failed for any target.
+	 */
+	bool finish(std::vector<CompiledResult>& results, Output& output) const;
+
+private:
+	bool compileImpl(std::vector<CompiledResult>& results, Output& output, std::istream* stream,
+		const std::string& fileName, CompileProgress* progress) const;
+
+	std::vector<const Target*> m_targets;
+};
+
+} // namespace msl
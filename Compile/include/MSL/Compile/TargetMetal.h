@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2025 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -41,8 +41,10 @@ namespace msl
  * - Version: the metal version times 10. For example, 10 is version 1.0, 11 is version 1.1.
  * - METAL_IOS_VERSION is defined to the version number when preprocesssing.
  *
- * The shared data contains the MTLLibrary data. The per-shader data is the name of the function
- * within the library.
+ * By default the per-shader data is a separate MTLLibrary for each shader and there's no shared
+ * data. When setSharedLibrary() is enabled, the shared data contains a single MTLLibrary for all
+ * shaders and the per-shader data is the null-terminated name of the function within the library.
+ * When setSourceOnly() is enabled, the per-shader data is the null-terminated Metal source instead.
  */
 class MSL_COMPILE_EXPORT TargetMetal : public Target
 {
@@ -74,10 +76,87 @@ public:
 	 */
 	Platform getPlatform() const;
 
+	/**
+	 * @brief Gets the command prefix used to run the Metal toolchain.
+	 * @return The toolchain command. When empty, xcrun is used with the SDK for the platform.
+	 */
+	const std::string& getToolchainCommand() const;
+
+	/**
+	 * @brief Sets the command prefix used to run the Metal toolchain.
+	 *
+	 * The tool name and arguments are appended to the command, such as "metal -c" to compile
+	 * and "metallib" to link. This can be used to select a specific toolchain, or to substitute
+	 * a stub compiler for testing.
+	 *
+	 * @param command The toolchain command. When empty, "xcrun -sdk <sdk>" is used with the SDK
+	 *     for the platform.
+	 */
+	void setToolchainCommand(std::string command);
+
+	/**
+	 * @brief Gets whether or not to build a single library for all shaders.
+	 * @return True to build a shared library.
+	 */
+	bool getSharedLibrary() const;
+
+	/**
+	 * @brief Sets whether or not to build a single library for all shaders.
+	 *
+	 * When enabled, the shaders for each compiled file are compiled to AIR objects in parallel,
+	 * and finish() links all of the objects into a single MTLLibrary stored in the shared data.
+	 * This avoids building a library for each stage of each pipeline. Each function is given a
+	 * unique name derived from the entry point and a hash of its source, which is stored as the
+	 * per-shader data.
+	 *
+	 * @param shared True to build a shared library.
+	 */
+	void setSharedLibrary(bool shared);
+
+	/**
+	 * @brief Gets whether or not to output the Metal source rather than compiled libraries.
+	 * @return True to output the Metal source.
+	 */
+	bool getSourceOnly() const;
+
+	/**
+	 * @brief Sets whether or not to output the Metal source rather than compiled libraries.
+	 *
+	 * When enabled, the Metal toolchain isn't run and the per-shader data is the null-terminated
+	 * source to be compiled at runtime, such as with newLibraryWithSource. The entry points keep
+	 * their original names and the uniform bindings are the same as for compiled libraries. This
+	 * is intended for fast development builds and may be used on platforms without the Metal
+	 * toolchain. The shared library setting is ignored.
+	 *
+	 * @param sourceOnly True to output the Metal source.
+	 */
+	void setSourceOnly(bool sourceOnly);
+
+	/**
+	 * @brief Gets whether or not resources are placed in an argument buffer.
+	 * @return True to use argument buffers.
+	 */
+	bool getArgumentBuffers() const override;
+
+	/**
+	 * @brief Sets whether or not resources are placed in an argument buffer.
+	 *
+	 * By default each buffer and texture is bound to a separate index. When enabled, all buffers,
+	 * textures, and samplers for a shader are placed in a single argument buffer so they may be
+	 * bound with one call. The argument buffer is bound at buffer index 1 if the shader uses push
+	 * constants, otherwise index 0. The uniform IDs for each shader are the IDs within the
+	 * argument buffer, where sampled images use the following ID for the sampler. This requires
+	 * Metal 2.0 or later.
+	 *
+	 * @param argumentBuffers True to use argument buffers.
+	 */
+	void setArgumentBuffers(bool argumentBuffers);
+
 	std::uint32_t getId() const override;
 	std::uint32_t getVersion() const override;
 	bool featureSupported(Feature feature) const override;
 	std::vector<std::pair<std::string, std::string>> getExtraDefines() const override;
+	compile::ShaderDataFormat getShaderDataFormat() const override;
 
 protected:
 	/**
@@ -96,23 +175,36 @@ protected:
 	 * @return False if the compilation failed.
 	 */
 	virtual bool compileMetal(
-		std::vector<std::uint8_t>& data, Output& output, const std::string& metal);
+		std::vector<std::uint8_t>& data, Output& output, const std::string& metal) const;
 
 	std::uint32_t getSpirVVersion() const override;
-	void willCompile() override;
-	bool crossCompile(std::vector<std::uint8_t>& data, Output& output, const std::string& fileName,
-		std::size_t line, std::size_t column,
+	bool requiresDummyBindings() const override;
+	bool crossCompile(std::vector<std::uint8_t>& data, Output& output,
+		const std::string& pipeline, const std::string& fileName, std::size_t line,
+		std::size_t column,
 		const std::array<bool, compile::stageCount>& pipelineStages, compile::Stage stage,
 		const std::vector<std::uint32_t>& spirv, const std::string& entryPoint,
 		const std::vector<compile::Uniform>& uniforms, std::vector<std::uint32_t>& uniformIds,
 		const std::vector<compile::FragmentInputGroup>& fragmentInputs,
-		std::uint32_t fragmentGroup) override;
+		std::uint32_t fragmentGroup) const override;
+	bool needsPostProcessShaders() const override;
+	bool postProcessShaders(Output& output, std::vector<CompiledShader>& shaders) const override;
+	bool linkShaders(std::vector<CompiledResult::ShaderData>& shaders,
+		std::vector<std::uint8_t>& sharedData, Output& output) const override;
 
 private:
 	std::string getSDK() const;
+	std::string getToolchainPrefix() const;
+	std::string getVersionOption() const;
+	bool compileAir(std::vector<std::uint8_t>& data, Output& output,
+		const std::string& metal) const;
 
 	std::uint32_t m_version;
 	Platform m_platform;
+	std::string m_toolchainCommand;
+	bool m_sharedLibrary;
+	bool m_sourceOnly;
+	bool m_argumentBuffers;
 };
 
 } // namespace msl
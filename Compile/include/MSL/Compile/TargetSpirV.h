@@ -54,12 +54,13 @@ protected:
 	bool needsReflectionNames() const override;
 	std::uint32_t getSpirVVersion() const override;
 	bool crossCompile(std::vector<std::uint8_t>& data, Output& output,
-		const std::string& fileName, std::size_t line, std::size_t column,
+		const std::string& pipeline, const std::string& fileName, std::size_t line,
+		std::size_t column,
 		const std::array<bool, compile::stageCount>& pipelineStages, compile::Stage stage,
 		const std::vector<std::uint32_t>& spirv, const std::string& entryPoint,
 		const std::vector<compile::Uniform>& uniforms, std::vector<std::uint32_t>& uniformIds,
 		const std::vector<compile::FragmentInputGroup>& fragmentInputs,
-		std::uint32_t fragmentGroup) override;
+		std::uint32_t fragmentGroup) const override;
 
 private:
 	std::uint32_t m_version;
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2022 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -451,6 +451,16 @@ enum class BorderColor
 	OpaqueIntOne        ///< All color channels and alpha as the int value 1.
 };
 
+/**
+ * @brief Enum for the format of the data for each shader within a saved module.
+ */
+enum class ShaderDataFormat
+{
+	Native,         ///< Native data for the target, such as SPIR-V or a compiled library.
+	Source,         ///< Null-terminated source to compile at runtime.
+	LibraryFunction ///< Null-terminated function name within the library in the shared data.
+};
+
 /**
  * @brief Structure holding the render states used for rasterization.
  */
@@ -1068,6 +1078,40 @@ struct FragmentInputGroup
 	std::vector<FragmentInput> inputs;
 };
 
+/**
+ * @brief Structure describing a specialization constant.
+ *
+ * These are declared with layout(constant_id = N) and may be overridden when creating the pipeline
+ * on the device without recompiling the shader.
+ */
+struct SpecializationConstant
+{
+	/**
+	 * @brief The name of the constant.
+	 */
+	std::string name;
+
+	/**
+	 * @brief The type of the constant.
+	 *
+	 * This will be Bool, Int, UInt, Float, or Double.
+	 */
+	Type type;
+
+	/**
+	 * @brief The ID of the constant.
+	 *
+	 * This is the constant ID for Vulkan and the function constant index for Metal. For GLSL, the
+	 * value can be overridden by defining SPIRV_CROSS_CONSTANT_ID_<id> after the #version line.
+	 */
+	std::uint32_t id;
+
+	/**
+	 * @brief The default value of the constant when not specialized.
+	 */
+	double defaultValue;
+};
+
 /**
  * @brief Structure defining a shader within the pipeline.
  */
@@ -1121,6 +1165,11 @@ struct Pipeline
 	 */
 	std::vector<FragmentOutput> fragmentOutputs;
 
+	/**
+	 * @brief The specialization constants used within the pipeline, sorted by ID.
+	 */
+	std::vector<SpecializationConstant> specializationConstants;
+
 	/**
 	 * @brief Index for the push constant structure.
 	 *
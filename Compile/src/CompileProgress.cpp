@@ -0,0 +1,45 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <MSL/Compile/CompileProgress.h>
+#include <utility>
+
+namespace msl
+{
+
+CompileProgress::CompileProgress(Callback callback)
+	: m_callback(std::move(callback))
+	, m_cancelled(false)
+{
+}
+
+void CompileProgress::cancel()
+{
+	m_cancelled = true;
+}
+
+bool CompileProgress::isCancelled() const
+{
+	return m_cancelled;
+}
+
+void CompileProgress::report(const Event& event) const
+{
+	if (m_callback)
+		m_callback(event);
+}
+
+} // namespace msl
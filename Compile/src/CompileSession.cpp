@@ -0,0 +1,93 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <MSL/Compile/CompileSession.h>
+#include <MSL/Compile/Target.h>
+#include "PipelineCache.h"
+#include <memory>
+#include <utility>
+
+namespace msl
+{
+
+CompileSession::CompileSession(const Target& target)
+	: m_target(target)
+	, m_cache(new PipelineCache)
+{
+}
+
+CompileSession::~CompileSession()
+{
+}
+
+const Target& CompileSession::getTarget() const
+{
+	return m_target;
+}
+
+bool CompileSession::compile(Output& output, const std::string& fileName,
+	CompileProgress* progress)
+{
+	return compileImpl(output, nullptr, fileName, progress);
+}
+
+bool CompileSession::compile(Output& output, std::istream& stream, const std::string& fileName,
+	CompileProgress* progress)
+{
+	return compileImpl(output, &stream, fileName, progress);
+}
+
+const CompiledResult& CompileSession::getResult() const
+{
+	return m_result;
+}
+
+const std::vector<std::string>& CompileSession::getChangedPipelines() const
+{
+	return m_cache->changedPipelines;
+}
+
+const std::vector<std::string>& CompileSession::getRemovedPipelines() const
+{
+	return m_cache->removedPipelines;
+}
+
+void CompileSession::reset()
+{
+	m_cache.reset(new PipelineCache);
+	m_result = CompiledResult();
+}
+
+bool CompileSession::compileImpl(Output& output, std::istream* stream,
+	const std::string& fileName, CompileProgress* progress)
+{
+	// Compile with a copy of the cache so it stays consistent with the previous result when
+	// compilation fails.
+	CompiledResult result;
+	std::unique_ptr<PipelineCache> cache(new PipelineCache(*m_cache));
+	if (!m_target.compileImpl(result, output, stream, fileName, cache.get(), progress,
+			nullptr) ||
+		!m_target.finish(result, output))
+	{
+		return false;
+	}
+
+	m_result = std::move(result);
+	m_cache = std::move(cache);
+	return true;
+}
+
+} // namespace msl
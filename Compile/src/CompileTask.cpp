@@ -0,0 +1,104 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <MSL/Compile/CompileTask.h>
+#include <MSL/Compile/Target.h>
+#include <utility>
+
+namespace msl
+{
+
+CompileTask::CompileTask(const Target& target, std::string fileName,
+	CompileProgress::Callback callback)
+	: m_progress(std::move(callback))
+	, m_succeeded(false)
+	, m_waited(false)
+{
+	start(target, nullptr, std::move(fileName));
+}
+
+CompileTask::CompileTask(const Target& target, std::unique_ptr<std::istream> stream,
+	std::string fileName, CompileProgress::Callback callback)
+	: m_progress(std::move(callback))
+	, m_succeeded(false)
+	, m_waited(false)
+{
+	start(target, std::move(stream), std::move(fileName));
+}
+
+CompileTask::~CompileTask()
+{
+	if (!m_waited)
+	{
+		m_progress.cancel();
+		m_future.wait();
+	}
+}
+
+void CompileTask::cancel()
+{
+	m_progress.cancel();
+}
+
+bool CompileTask::isCancelled() const
+{
+	return m_progress.isCancelled();
+}
+
+bool CompileTask::isReady() const
+{
+	return m_waited ||
+		m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+bool CompileTask::wait()
+{
+	if (!m_waited)
+	{
+		m_succeeded = m_future.get();
+		m_waited = true;
+	}
+
+	return m_succeeded;
+}
+
+CompiledResult& CompileTask::getResult()
+{
+	return m_result;
+}
+
+Output& CompileTask::getOutput()
+{
+	return m_output;
+}
+
+void CompileTask::start(const Target& target, std::unique_ptr<std::istream> stream,
+	std::string fileName)
+{
+	m_future = std::async(std::launch::async,
+		[this, &target, stream = std::move(stream), fileName = std::move(fileName)]()
+		{
+			bool success;
+			if (stream)
+				success = target.compile(m_result, m_output, *stream, fileName, &m_progress);
+			else
+				success = target.compile(m_result, m_output, fileName, &m_progress);
+
+			return success && target.finish(m_result, m_output);
+		});
+}
+
+} // namespace msl
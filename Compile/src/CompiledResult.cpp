@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2023 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -33,7 +33,16 @@
 #pragma warning(pop)
 #endif
 
+#include "mslb_checksum.h"
+#include "mslb_compression.h"
+#include "mslb_sections.h"
+#include "mslb_spirv_encoding.h"
+#include <spirv/unified1/spirv.hpp>
+#include <algorithm>
 #include <fstream>
+#include <numeric>
+#include <string_view>
+#include <unordered_map>
 
 namespace msl
 {
@@ -75,6 +84,76 @@ static_assert(static_cast<int>(mslb::BorderColor::MAX) ==
 	static_cast<int>(BorderColor::OpaqueIntOne),
 	"BorderColor enum mismatch between flatbuffer and C++.");
 
+template <typename T>
+static std::vector<std::uint32_t> getNameOrder(const std::vector<T>& elements)
+{
+	std::vector<std::uint32_t> order(elements.size());
+	std::iota(order.begin(), order.end(), 0U);
+	std::sort(order.begin(), order.end(), [&elements](std::uint32_t left, std::uint32_t right)
+		{
+			return elements[left].name < elements[right].name;
+		});
+	return order;
+}
+
+static std::size_t alignSize(std::size_t size, std::size_t alignment)
+{
+	return (size + alignment - 1) & ~(alignment - 1);
+}
+
+static void writePadding(std::ostream& stream, std::size_t size)
+{
+	const char padding[16] = {};
+	for (; size > sizeof(padding); size -= sizeof(padding))
+		stream.write(padding, sizeof(padding));
+	stream.write(padding, size);
+}
+
+static void getDecorationOffsets(std::vector<std::uint32_t>& outDescriptorSetOffsets,
+	std::vector<std::uint32_t>& outBindingOffsets, const std::vector<std::uint8_t>& spirv,
+	const std::vector<std::uint32_t>& uniformIds)
+{
+	std::unordered_map<std::uint32_t, std::size_t> uniformIndices;
+	for (std::size_t i = 0; i < uniformIds.size(); ++i)
+	{
+		if (uniformIds[i] != unknown)
+			uniformIndices.emplace(uniformIds[i], i);
+	}
+
+	outDescriptorSetOffsets.assign(uniformIds.size(), unknown);
+	outBindingOffsets.assign(uniformIds.size(), unknown);
+
+	const unsigned int firstInstruction = 5;
+	const std::uint32_t* words = reinterpret_cast<const std::uint32_t*>(spirv.data());
+	std::size_t wordCount = spirv.size()/sizeof(std::uint32_t);
+	for (std::size_t i = firstInstruction; i < wordCount;)
+	{
+		std::uint32_t op = words[i] & spv::OpCodeMask;
+		std::uint32_t instructionWords = words[i] >> spv::WordCountShift;
+		if (instructionWords == 0 || i + instructionWords > wordCount)
+			break;
+
+		// Decorations are all before the functions.
+		if (op == spv::OpFunction)
+			break;
+
+		if (op == spv::OpDecorate && instructionWords >= 4)
+		{
+			auto foundIt = uniformIndices.find(words[i + 1]);
+			if (foundIt != uniformIndices.end())
+			{
+				auto offset = static_cast<std::uint32_t>(i + 3);
+				if (words[i + 2] == spv::DecorationDescriptorSet)
+					outDescriptorSetOffsets[foundIt->second] = offset;
+				else if (words[i + 2] == spv::DecorationBinding)
+					outBindingOffsets[foundIt->second] = offset;
+			}
+		}
+
+		i += instructionWords;
+	}
+}
+
 CompiledResult::CompiledResult()
 	: m_target(nullptr)
 {
@@ -93,17 +172,23 @@ std::uint32_t CompiledResult::getTargetVersion() const
 std::size_t CompiledResult::addShader(std::vector<uint8_t> shader, bool usesPushConstants,
 	bool dontRemoveDuplicates)
 {
+	std::size_t hash = std::hash<std::string_view>()(std::string_view(
+		reinterpret_cast<const char*>(shader.data()), shader.size()));
 	if (!dontRemoveDuplicates)
 	{
-		for (std::size_t i = 0; i < m_shaders.size(); ++i)
+		auto range = m_shaderHashes.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it)
 		{
-			if (m_shaders[i].data == shader && m_shaders[i].usesPushConstants == usesPushConstants)
-				return i;
+			const ShaderData& otherShader = m_shaders[it->second];
+			if (otherShader.data == shader && otherShader.usesPushConstants == usesPushConstants)
+				return it->second;
 		}
 	}
 
+	std::size_t index = m_shaders.size();
 	m_shaders.push_back(ShaderData{std::move(shader), usesPushConstants});
-	return m_shaders.size() - 1;
+	m_shaderHashes.emplace(hash, index);
+	return index;
 }
 
 bool CompiledResult::save(std::ostream& stream) const
@@ -115,6 +200,8 @@ bool CompiledResult::save(std::ostream& stream) const
 	bool isMetal = m_target->getId() == MSL_CREATE_ID('M', 'T', 'L', 'I') ||
 		m_target->getId() == MSL_CREATE_ID('M', 'T', 'L', 'X');
 	bool adjustableBindings = m_target->getAdjustableBindings() && isSpirV;
+	bool argumentBuffers = m_target->getArgumentBuffers();
+	auto shaderDataFormat = static_cast<mslb::ShaderDataFormat>(m_target->getShaderDataFormat());
 	flatbuffers::FlatBufferBuilder builder;
 	builder.ForceDefaults(adjustableBindings);
 	std::vector<flatbuffers::Offset<mslb::Pipeline>> pipelines(m_pipelines.size());
@@ -126,9 +213,12 @@ bool CompiledResult::save(std::ostream& stream) const
 	std::vector<flatbuffers::Offset<mslb::Uniform>> uniforms;
 	std::vector<flatbuffers::Offset<mslb::Attribute>> attributes;
 	std::vector<flatbuffers::Offset<mslb::FragmentOutput>> fragmentOutputs;
+	std::vector<flatbuffers::Offset<mslb::SpecializationConstant>> specializationConstants;
 	std::vector<mslb::BlendAttachmentState> blendAttachments;
 	blendAttachments.reserve(maxAttachments);
 	std::vector<flatbuffers::Offset<mslb::Shader>> shaders(stageCount);
+	std::vector<std::uint32_t> descriptorSetOffsets;
+	std::vector<std::uint32_t> bindingOffsets;
 
 	std::size_t i = 0;
 	for (const auto& pipeline : m_pipelines)
@@ -223,6 +313,17 @@ bool CompiledResult::save(std::ostream& stream) const
 				builder.CreateString(fragmentOutput.name), fragmentOutput.location);
 		}
 
+		specializationConstants.resize(pipeline.second.specializationConstants.size());
+		for (std::size_t j = 0; j < specializationConstants.size(); ++j)
+		{
+			const SpecializationConstant& specConstant =
+				pipeline.second.specializationConstants[j];
+			specializationConstants[j] = mslb::CreateSpecializationConstant(builder,
+				builder.CreateString(specConstant.name),
+				static_cast<mslb::Type>(specConstant.type), specConstant.id,
+				specConstant.defaultValue);
+		}
+
 		const RenderState& renderState = pipeline.second.renderState;
 		mslb::RasterizationState rasterizationState(
 			static_cast<mslb::Bool>(renderState.rasterizationState.depthClampEnable),
@@ -305,8 +406,21 @@ bool CompiledResult::save(std::ostream& stream) const
 			else
 			{
 				assert(shader.shader < m_shaders.size());
+				flatbuffers::Offset<flatbuffers::Vector<std::uint32_t>> descriptorSetOffsetsOffset;
+				flatbuffers::Offset<flatbuffers::Vector<std::uint32_t>> bindingOffsetsOffset;
+				if (adjustableBindings)
+				{
+					// Store the decoration locations so bindings can be adjusted without scanning
+					// the SPIR-V.
+					getDecorationOffsets(descriptorSetOffsets, bindingOffsets,
+						m_shaders[shader.shader].data, shader.uniformIds);
+					descriptorSetOffsetsOffset = builder.CreateVector(descriptorSetOffsets);
+					bindingOffsetsOffset = builder.CreateVector(bindingOffsets);
+				}
+
 				shaders[j] = mslb::CreateShader(builder, static_cast<std::uint32_t>(shader.shader),
-					isSpirV || isMetal ? builder.CreateVector(shader.uniformIds) : 0);
+					isSpirV || isMetal ? builder.CreateVector(shader.uniformIds) : 0,
+					descriptorSetOffsetsOffset, bindingOffsetsOffset);
 			}
 		}
 
@@ -327,44 +441,220 @@ bool CompiledResult::save(std::ostream& stream) const
 				&depthStencilState, blendState, renderState.patchControlPoints,
 				renderState.clipDistanceCount, renderState.cullDistanceCount),
 			builder.CreateVector(shaders),
-			&computeLocalSize);
+			&computeLocalSize,
+			specializationConstants.empty() ? 0 : builder.CreateVector(specializationConstants),
+			builder.CreateVector(getNameOrder(pipeline.second.structs)),
+			builder.CreateVector(getNameOrder(pipeline.second.uniforms)),
+			builder.CreateVector(getNameOrder(pipeline.second.attributes)));
 
 		++i;
 	}
 
 	// Swap if big endian and SPIR-V since it uses 32-bit values.
 	bool swap = !FLATBUFFERS_LITTLEENDIAN && isSpirV;
-	std::vector<uint8_t> swapShader;
-	std::vector<flatbuffers::Offset<mslb::ShaderData>> shaderData(m_shaders.size());
+	std::vector<std::vector<uint8_t>> swapShaders(swap ? m_shaders.size() : 0);
+	std::vector<const std::vector<uint8_t>*> shaderPayloads(m_shaders.size());
 	for (i = 0; i < m_shaders.size(); ++i)
 	{
 		if (swap)
 		{
+			std::vector<uint8_t>& swapShader = swapShaders[i];
 			swapShader = m_shaders[i].data;
 			std::uint32_t* swapShader32 = reinterpret_cast<std::uint32_t*>(swapShader.data());
 			std::size_t swapShader32Size = swapShader.size()/sizeof(std::uint32_t);
 			for (std::size_t j = 0; j < swapShader32Size; ++j)
 				swapShader32[j] = flatbuffers::EndianScalar(swapShader[j]);
-			shaderData[i] = mslb::CreateShaderData(builder, builder.CreateVector(swapShader),
-				m_shaders[i].usesPushConstants);
+			shaderPayloads[i] = &swapShader;
+		}
+		else
+			shaderPayloads[i] = &m_shaders[i].data;
+	}
+
+	// SPIR-V is encoded before compression since the encoded bytes compress much better than the
+	// raw words. encodeSpirV() returns 0 when the result isn't smaller, keeping the original data.
+	// Adjustable bindings patch the stored SPIR-V in place, so it's kept as-is in that case.
+	bool encode = m_target->getEncodeSpirV() && isSpirV && !adjustableBindings;
+	bool anyEncoded = false;
+	std::vector<std::vector<uint8_t>> encodedShaders(encode ? m_shaders.size() : 0);
+	std::vector<mslb::Encoding> shaderEncoding(m_shaders.size(), mslb::Encoding::None);
+	for (i = 0; i < encodedShaders.size(); ++i)
+	{
+		const std::vector<uint8_t>& payload = *shaderPayloads[i];
+		std::vector<uint8_t>& encodedShader = encodedShaders[i];
+		encodedShader.resize(mslb::encodedSpirVSizeBound(payload.size()));
+		encodedShader.resize(mslb::encodeSpirV(encodedShader.data(), payload.data(),
+			payload.size()));
+		if (encodedShader.empty())
+			continue;
+
+		shaderPayloads[i] = &encodedShader;
+		shaderEncoding[i] = mslb::Encoding::SpirV;
+		anyEncoded = true;
+	}
+
+	// Each shader is compressed separately so they may be decompressed individually on demand.
+	// Keep the original data when it doesn't become smaller.
+	bool compress = m_target->getCompression() == Target::Compression::LZ4 && !adjustableBindings;
+	bool anyCompressed = false;
+	std::vector<std::vector<uint8_t>> compressedShaders(compress ? m_shaders.size() : 0);
+	std::vector<mslb::Compression> shaderCompression(m_shaders.size(), mslb::Compression::None);
+	for (i = 0; i < compressedShaders.size(); ++i)
+	{
+		const std::vector<uint8_t>& payload = *shaderPayloads[i];
+		std::vector<uint8_t>& compressedShader = compressedShaders[i];
+		compressedShader.resize(mslb::compressedSizeBound(payload.size()));
+		compressedShader.resize(mslb::compress(compressedShader.data(), payload.data(),
+			payload.size()));
+		if (compressedShader.size() >= payload.size())
+			continue;
+
+		shaderPayloads[i] = &compressedShader;
+		shaderCompression[i] = mslb::Compression::LZ4;
+		anyCompressed = true;
+	}
+
+	// Align the start of each shader's data so it may be used directly from the loaded module.
+	// PreAlign() is used rather than ForceVectorAlignment() to allow alignments up to the page
+	// size, beyond FLATBUFFERS_MAX_ALIGNMENT.
+	std::uint32_t shaderAlignment = m_target->getShaderAlignment();
+	bool sectioned = m_target->getSectionedModules();
+	std::vector<std::uint32_t> payloadOffsets(m_shaders.size());
+	std::size_t payloadSectionSize = 0;
+	std::vector<flatbuffers::Offset<mslb::ShaderData>> shaderData(m_shaders.size());
+	for (i = 0; i < m_shaders.size(); ++i)
+	{
+		const std::vector<uint8_t>& payload = *shaderPayloads[i];
+		std::uint32_t uncompressedSize = 0;
+		if (shaderCompression[i] != mslb::Compression::None)
+		{
+			uncompressedSize = static_cast<std::uint32_t>(
+				shaderEncoding[i] == mslb::Encoding::None ? m_shaders[i].data.size() :
+					encodedShaders[i].size());
+		}
+		std::uint32_t decodedSize = shaderEncoding[i] == mslb::Encoding::None ? 0 :
+			static_cast<std::uint32_t>(m_shaders[i].data.size());
+		if (sectioned)
+		{
+			// Sectioned modules store the data after the index, so it can be loaded separately.
+			payloadSectionSize = alignSize(payloadSectionSize, shaderAlignment);
+			payloadOffsets[i] = static_cast<std::uint32_t>(payloadSectionSize);
+			payloadSectionSize += payload.size();
+			shaderData[i] = mslb::CreateShaderData(builder,
+				builder.CreateVector(std::vector<uint8_t>()), m_shaders[i].usesPushConstants,
+				payloadOffsets[i], static_cast<std::uint32_t>(payload.size()),
+				mslb::computeChecksum(payload.data(), payload.size(), mslb::noChecksumOffset),
+				shaderCompression[i], uncompressedSize, shaderEncoding[i], decodedSize);
 		}
 		else
 		{
-			shaderData[i] = mslb::CreateShaderData(builder, builder.CreateVector(m_shaders[i].data),
-				m_shaders[i].usesPushConstants);
+			builder.PreAlign(payload.size(), shaderAlignment);
+			shaderData[i] = mslb::CreateShaderData(builder, builder.CreateVector(payload),
+				m_shaders[i].usesPushConstants, 0, 0, 0, shaderCompression[i], uncompressedSize,
+				shaderEncoding[i], decodedSize);
 		}
 	}
 
+	flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<mslb::VariantKeyword>>>
+		variantKeywordsOffset;
+	flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<mslb::Variant>>> variantsOffset;
+	const std::vector<Target::VariantKeyword>& variantKeywords = m_target->getVariantKeywords();
+	if (!variantKeywords.empty())
+	{
+		std::vector<flatbuffers::Offset<mslb::VariantKeyword>> keywords;
+		keywords.reserve(variantKeywords.size());
+		for (const Target::VariantKeyword& keyword : variantKeywords)
+		{
+			keywords.push_back(mslb::CreateVariantKeyword(builder,
+				builder.CreateString(keyword.name), builder.CreateVectorOfStrings(keyword.values)));
+		}
+		variantKeywordsOffset = builder.CreateVector(keywords);
+
+		std::unordered_map<std::string, std::uint32_t> pipelineIndices;
+		i = 0;
+		for (const auto& pipeline : m_pipelines)
+			pipelineIndices.emplace(pipeline.first, static_cast<std::uint32_t>(i++));
+
+		// Variants are in sorted order from the map.
+		std::vector<flatbuffers::Offset<mslb::Variant>> variants;
+		std::vector<std::uint32_t> variantPipelines;
+		variants.reserve(m_variants.size());
+		for (const auto& variant : m_variants)
+		{
+			variantPipelines.clear();
+			variantPipelines.reserve(variant.second.size());
+			for (const std::string& pipelineName : variant.second)
+			{
+				auto foundIt = pipelineIndices.find(pipelineName);
+				if (foundIt == pipelineIndices.end())
+					variantPipelines.push_back(unknown);
+				else
+					variantPipelines.push_back(foundIt->second);
+			}
+
+			variants.push_back(mslb::CreateVariant(builder, builder.CreateString(variant.first),
+				builder.CreateVector(variantPipelines)));
+		}
+		variantsOffset = builder.CreateVector(variants);
+	}
+
+	std::uint32_t moduleVersion = version;
+	if (anyEncoded)
+		moduleVersion = spirVEncodingVersion;
+	else if (anyCompressed)
+		moduleVersion = compressionVersion;
+	else if (sectioned)
+		moduleVersion = sectionedVersion;
+
 	builder.Finish(mslb::CreateModule(builder,
-		version,
+		moduleVersion,
 		m_target->getId(),
 		m_target->getVersion(),
 		adjustableBindings,
 		builder.CreateVector(pipelines),
 		builder.CreateVector(shaderData),
-		builder.CreateVector(m_sharedData)));
+		builder.CreateVector(m_sharedData),
+		variantKeywordsOffset,
+		variantsOffset,
+		argumentBuffers,
+		// Placeholder to ensure the checksum field is present to be filled in below.
+		~0ULL,
+		shaderAlignment,
+		shaderDataFormat));
+
+	// The checksum covers the final buffer, with the checksum field itself treated as 0.
+	std::uint8_t* buffer = builder.GetBufferPointer();
+	const std::uint8_t* checksumAddress =
+		flatbuffers::GetRoot<flatbuffers::Table>(buffer)->GetAddressOf(mslb::Module::VT_CHECKSUM);
+	mslb::GetMutableModule(buffer)->mutate_checksum(mslb::computeChecksum(buffer,
+		builder.GetSize(), static_cast<std::size_t>(checksumAddress - buffer)));
+
+	if (!sectioned)
+	{
+		stream.write(reinterpret_cast<const char*>(buffer), builder.GetSize());
+		return true;
+	}
+
+	// The payload section is aligned relative to the start of the module so the alignment is kept
+	// when the full module is loaded or mapped.
+	mslb::SectionedHeader header;
+	header.indexSize = static_cast<std::uint32_t>(builder.GetSize());
+	header.payloadOffset = static_cast<std::uint32_t>(
+		alignSize(mslb::sectionedHeaderSize + builder.GetSize(), shaderAlignment));
+	std::uint8_t headerData[mslb::sectionedHeaderSize];
+	mslb::writeSectionedHeader(headerData, header);
+	stream.write(reinterpret_cast<const char*>(headerData), sizeof(headerData));
+	stream.write(reinterpret_cast<const char*>(buffer), builder.GetSize());
 
-	stream.write(reinterpret_cast<const char*>(builder.GetBufferPointer()), builder.GetSize());
+	writePadding(stream, header.payloadOffset - mslb::sectionedHeaderSize - builder.GetSize());
+
+	std::size_t offset = 0;
+	for (i = 0; i < m_shaders.size(); ++i)
+	{
+		writePadding(stream, payloadOffsets[i] - offset);
+		const std::vector<uint8_t>& payload = *shaderPayloads[i];
+		stream.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+		offset = payloadOffsets[i] + payload.size();
+	}
 	return true;
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -16,8 +16,13 @@
 
 #include "ExecuteCommand.h"
 #include <MSL/Compile/Output.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <cstdio>
-#include <sstream>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 
 #if MSL_GCC || MSL_CLANG
 #pragma GCC diagnostic push
@@ -38,37 +43,804 @@
 #if MSL_WINDOWS
 #define popen _popen
 #define pclose _pclose
+#else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
 #endif
 
 namespace msl
 {
 
-ExecuteCommand::ExecuteCommand(std::string inputExtension)
+namespace
+{
+
+// Removes the temporary file when going out of scope.
+class TempFile
+{
+public:
+	TempFile() = default;
+	TempFile(const TempFile&) = delete;
+	TempFile& operator=(const TempFile&) = delete;
+
+	~TempFile()
+	{
+		if (!path.empty())
+		{
+			boost::system::error_code error;
+			boost::filesystem::remove(path, error);
+		}
+	}
+
+	void create(const std::string& extension)
+	{
+		path = (boost::filesystem::temp_directory_path()/
+			boost::filesystem::unique_path().replace_extension(extension)).string();
+	}
+
+	std::string path;
+};
+
+// Removes the temporary directory and its contents when going out of scope.
+class TempDirectory
+{
+public:
+	TempDirectory() = default;
+	TempDirectory(const TempDirectory&) = delete;
+	TempDirectory& operator=(const TempDirectory&) = delete;
+
+	~TempDirectory()
+	{
+		if (!path.empty())
+		{
+			boost::system::error_code error;
+			boost::filesystem::remove_all(path, error);
+		}
+	}
+
+	bool create()
+	{
+		path = boost::filesystem::temp_directory_path()/boost::filesystem::unique_path();
+		boost::system::error_code error;
+		if (!boost::filesystem::create_directories(path, error))
+		{
+			path.clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	boost::filesystem::path path;
+};
+
+#if !MSL_WINDOWS
+
+// Closes the file descriptors when going out of scope. The file descriptors are close on exec so
+// commands spawned concurrently on other threads don't inherit them, which would prevent reaching
+// the end of the stream until the unrelated commands exit.
+class Pipe
+{
+public:
+	Pipe()
+	{
+#if MSL_LINUX
+		if (pipe2(fds, O_CLOEXEC) != 0)
+			fds[0] = fds[1] = -1;
+#else
+		if (pipe(fds) != 0)
+			fds[0] = fds[1] = -1;
+		else
+		{
+			fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+			fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+		}
+#endif
+	}
+
+	Pipe(const Pipe&) = delete;
+	Pipe& operator=(const Pipe&) = delete;
+
+	~Pipe()
+	{
+		closeRead();
+		closeWrite();
+	}
+
+	bool isValid() const
+	{
+		return fds[0] >= 0;
+	}
+
+	void closeRead()
+	{
+		if (fds[0] >= 0)
+		{
+			close(fds[0]);
+			fds[0] = -1;
+		}
+	}
+
+	void closeWrite()
+	{
+		if (fds[1] >= 0)
+		{
+			close(fds[1]);
+			fds[1] = -1;
+		}
+	}
+
+	int fds[2];
+};
+
+// Blocks SIGPIPE on the current thread so writing to a command that exited early returns an
+// error rather than terminating the process.
+class BlockSigPipe
+{
+public:
+	BlockSigPipe()
+	{
+		sigset_t sigPipeSet;
+		sigemptyset(&sigPipeSet);
+		sigaddset(&sigPipeSet, SIGPIPE);
+		pthread_sigmask(SIG_BLOCK, &sigPipeSet, &m_oldSet);
+	}
+
+	BlockSigPipe(const BlockSigPipe&) = delete;
+	BlockSigPipe& operator=(const BlockSigPipe&) = delete;
+
+	~BlockSigPipe()
+	{
+		// Consume any SIGPIPE raised on this thread before restoring the mask.
+		sigset_t pending;
+		sigpending(&pending);
+		if (sigismember(&pending, SIGPIPE) && !sigismember(&m_oldSet, SIGPIPE))
+		{
+			sigset_t sigPipeSet;
+			sigemptyset(&sigPipeSet);
+			sigaddset(&sigPipeSet, SIGPIPE);
+			timespec timeout = {0, 0};
+			sigtimedwait(&sigPipeSet, nullptr, &timeout);
+		}
+		pthread_sigmask(SIG_SETMASK, &m_oldSet, nullptr);
+	}
+
+private:
+	sigset_t m_oldSet;
+};
+
+bool needsShell(const std::string& command)
+{
+	if (command.find_first_of("|&;<>()`\\\"'*?[]{}~#\n") != std::string::npos)
+		return true;
+
+	// Only $input and $output are substituted directly, other variables are expanded by the shell.
+	for (std::size_t i = command.find('$'); i != std::string::npos; i = command.find('$', i + 1))
+	{
+		if (command.compare(i, 6, "$input") != 0 && command.compare(i, 7, "$output") != 0)
+			return true;
+	}
+
+	// Environment variable assignments before the command are also handled by the shell.
+	std::size_t start = command.find_first_not_of(" \t");
+	if (start == std::string::npos)
+		return false;
+	return command.find('=', start) < command.find_first_of(" \t", start);
+}
+
+std::vector<std::string> splitArguments(const std::string& command, const std::string& inputPath,
+	const std::string& outputPath)
+{
+	std::vector<std::string> arguments;
+	std::size_t start = command.find_first_not_of(" \t");
+	while (start != std::string::npos)
+	{
+		std::size_t end = command.find_first_of(" \t", start);
+		arguments.push_back(command.substr(start, end - start));
+		boost::algorithm::replace_all(arguments.back(), "$input", inputPath);
+		boost::algorithm::replace_all(arguments.back(), "$output", outputPath);
+		start = command.find_first_not_of(" \t", end);
+	}
+	return arguments;
+}
+
+// Runs the command, feeding the input to stdin and reading stdout and stderr. Returns the exit
+// code, using 127 if the command couldn't be started to match the shell.
+int spawnCommand(std::vector<char>& stdoutData, std::string& stderrData,
+	std::vector<std::string>& arguments, const char* inputData, std::size_t inputSize)
+{
+	Pipe stdinPipe, stdoutPipe, stderrPipe;
+	if (!stdinPipe.isValid() || !stdoutPipe.isValid() || !stderrPipe.isValid())
+	{
+		stderrData = std::strerror(errno);
+		return 127;
+	}
+
+	// Only the duplicated file descriptors are inherited since the pipes are close on exec.
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_adddup2(&actions, stdinPipe.fds[0], STDIN_FILENO);
+	posix_spawn_file_actions_adddup2(&actions, stdoutPipe.fds[1], STDOUT_FILENO);
+	posix_spawn_file_actions_adddup2(&actions, stderrPipe.fds[1], STDERR_FILENO);
+
+	std::vector<char*> argv;
+	argv.reserve(arguments.size() + 1);
+	for (std::string& argument : arguments)
+		argv.push_back(&argument[0]);
+	argv.push_back(nullptr);
+
+	pid_t pid;
+	int spawnError = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+	posix_spawn_file_actions_destroy(&actions);
+	if (spawnError != 0)
+	{
+		stderrData = arguments[0] + ": " + std::strerror(spawnError);
+		return 127;
+	}
+
+	stdinPipe.closeRead();
+	stdoutPipe.closeWrite();
+	stderrPipe.closeWrite();
+	if (inputSize == 0)
+		stdinPipe.closeWrite();
+	else
+		fcntl(stdinPipe.fds[1], F_SETFL, fcntl(stdinPipe.fds[1], F_GETFL) | O_NONBLOCK);
+
+	// Write and read at the same time to avoid blocking when the pipe buffers are full.
+	BlockSigPipe blockSigPipe;
+	std::size_t inputOffset = 0;
+	char buffer[4096];
+	while (stdoutPipe.fds[0] >= 0 || stderrPipe.fds[0] >= 0)
+	{
+		pollfd pollFds[3] =
+		{
+			{stdinPipe.fds[1], POLLOUT, 0},
+			{stdoutPipe.fds[0], POLLIN, 0},
+			{stderrPipe.fds[0], POLLIN, 0}
+		};
+		if (poll(pollFds, 3, -1) < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		if (pollFds[0].revents)
+		{
+			ssize_t written = write(stdinPipe.fds[1], inputData + inputOffset,
+				inputSize - inputOffset);
+			if (written > 0)
+				inputOffset += static_cast<std::size_t>(written);
+			if ((written < 0 && errno != EAGAIN && errno != EINTR) || inputOffset == inputSize)
+				stdinPipe.closeWrite();
+		}
+
+		if (pollFds[1].revents)
+		{
+			ssize_t readSize = read(stdoutPipe.fds[0], buffer, sizeof(buffer));
+			if (readSize > 0)
+				stdoutData.insert(stdoutData.end(), buffer, buffer + readSize);
+			else if (readSize == 0 || errno != EINTR)
+				stdoutPipe.closeRead();
+		}
+
+		if (pollFds[2].revents)
+		{
+			ssize_t readSize = read(stderrPipe.fds[0], buffer, sizeof(buffer));
+			if (readSize > 0)
+				stderrData.append(buffer, static_cast<std::size_t>(readSize));
+			else if (readSize == 0 || errno != EINTR)
+				stderrPipe.closeRead();
+		}
+	}
+	stdinPipe.closeWrite();
+
+	int status;
+	while (waitpid(pid, &status, 0) < 0)
+	{
+		if (errno != EINTR)
+			return 127;
+	}
+
+	if (WIFEXITED(status))
+		return WEXITSTATUS(status);
+	else if (WIFSIGNALED(status))
+		return 128 + WTERMSIG(status);
+	return 127;
+}
+
+#endif
+
+std::uint64_t rotateLeft(std::uint64_t value, int count)
+{
+	return (value << count) | (value >> (64 - count));
+}
+
+std::uint64_t finalMix(std::uint64_t value)
+{
+	value ^= value >> 33;
+	value *= 0xFF51AFD7ED558CCDULL;
+	value ^= value >> 33;
+	value *= 0xC4CEB9FE1A85EC53ULL;
+	value ^= value >> 33;
+	return value;
+}
+
+// 128-bit MurmurHash3, with the previous hash as the seed so multiple buffers may be combined.
+std::array<std::uint64_t, 2> hashData(const void* data, std::size_t size,
+	const std::array<std::uint64_t, 2>& seed)
+{
+	const std::uint64_t c1 = 0x87C37B91114253D5ULL;
+	const std::uint64_t c2 = 0x4CF5AD432745937FULL;
+
+	const auto bytes = reinterpret_cast<const std::uint8_t*>(data);
+	std::uint64_t h1 = seed[0];
+	std::uint64_t h2 = seed[1];
+	std::size_t blockCount = size/16;
+	for (std::size_t i = 0; i < blockCount; ++i)
+	{
+		std::uint64_t k1, k2;
+		std::memcpy(&k1, bytes + i*16, sizeof(k1));
+		std::memcpy(&k2, bytes + i*16 + 8, sizeof(k2));
+
+		k1 *= c1;
+		k1 = rotateLeft(k1, 31);
+		k1 *= c2;
+		h1 ^= k1;
+		h1 = rotateLeft(h1, 27);
+		h1 += h2;
+		h1 = h1*5 + 0x52DCE729;
+
+		k2 *= c2;
+		k2 = rotateLeft(k2, 33);
+		k2 *= c1;
+		h2 ^= k2;
+		h2 = rotateLeft(h2, 31);
+		h2 += h1;
+		h2 = h2*5 + 0x38495AB5;
+	}
+
+	const std::uint8_t* tail = bytes + blockCount*16;
+	std::uint64_t k1 = 0;
+	std::uint64_t k2 = 0;
+	std::size_t tailSize = size & 15;
+	for (std::size_t i = tailSize; i-- > 8;)
+		k2 |= static_cast<std::uint64_t>(tail[i]) << ((i - 8)*8);
+	for (std::size_t i = std::min<std::size_t>(tailSize, 8); i-- > 0;)
+		k1 |= static_cast<std::uint64_t>(tail[i]) << (i*8);
+
+	if (tailSize > 8)
+	{
+		k2 *= c2;
+		k2 = rotateLeft(k2, 33);
+		k2 *= c1;
+		h2 ^= k2;
+	}
+
+	if (tailSize > 0)
+	{
+		k1 *= c1;
+		k1 = rotateLeft(k1, 31);
+		k1 *= c2;
+		h1 ^= k1;
+	}
+
+	h1 ^= size;
+	h2 ^= size;
+	h1 += h2;
+	h2 += h1;
+	h1 = finalMix(h1);
+	h2 = finalMix(h2);
+	h1 += h2;
+	h2 += h1;
+	return {{h1, h2}};
+}
+
+const char cacheMagic[] = {'M', 'S', 'L', 'X'};
+const std::uint32_t cacheVersion = 1;
+
+void writeString(std::ostream& stream, const char* data, std::size_t size)
+{
+	std::uint64_t size64 = size;
+	stream.write(reinterpret_cast<const char*>(&size64), sizeof(size64));
+	stream.write(data, static_cast<std::streamsize>(size));
+}
+
+bool readString(std::string& str, std::istream& stream)
+{
+	std::uint64_t size;
+	if (!stream.read(reinterpret_cast<char*>(&size), sizeof(size)) || size > (1ULL << 32))
+		return false;
+
+	str.resize(static_cast<std::size_t>(size));
+	return static_cast<bool>(stream.read(&str[0], static_cast<std::streamsize>(size)));
+}
+
+// Cache entries store the command and input size to guard against hash collisions.
+bool readCacheEntry(std::vector<char>& outputData, std::string& message,
+	const std::string& fileName, const std::string& command, std::size_t inputSize)
 {
-	m_inputFileName = (boost::filesystem::temp_directory_path()/
-		boost::filesystem::unique_path().replace_extension(inputExtension)).string();
-	m_outputFileName =
-		(boost::filesystem::temp_directory_path()/boost::filesystem::unique_path()).string();
+	std::ifstream stream(fileName, std::ios_base::binary);
+	if (!stream.is_open())
+		return false;
+
+	char magic[sizeof(cacheMagic)];
+	std::uint32_t version;
+	std::uint64_t storedInputSize;
+	std::string storedCommand, outputStr;
+	if (!stream.read(magic, sizeof(magic)) ||
+		std::memcmp(magic, cacheMagic, sizeof(magic)) != 0 ||
+		!stream.read(reinterpret_cast<char*>(&version), sizeof(version)) ||
+		version != cacheVersion ||
+		!stream.read(reinterpret_cast<char*>(&storedInputSize), sizeof(storedInputSize)) ||
+		storedInputSize != inputSize || !readString(storedCommand, stream) ||
+		storedCommand != command || !readString(message, stream) ||
+		!readString(outputStr, stream))
+	{
+		message.clear();
+		return false;
+	}
+
+	outputData.assign(outputStr.begin(), outputStr.end());
+	return true;
+}
+
+void writeCacheEntry(const std::string& fileName, const std::string& command,
+	std::size_t inputSize, const std::string& message, const std::vector<char>& outputData)
+{
+	// Write to a temporary file first so other processes never see a partial entry.
+	boost::system::error_code error;
+	boost::filesystem::path path(fileName);
+	boost::filesystem::create_directories(path.parent_path(), error);
+	boost::filesystem::path tempPath = path.parent_path()/boost::filesystem::unique_path();
+	{
+		std::ofstream stream(tempPath.string(), std::ios_base::trunc | std::ios_base::binary);
+		if (!stream.is_open())
+			return;
+
+		std::uint64_t inputSize64 = inputSize;
+		stream.write(cacheMagic, sizeof(cacheMagic));
+		stream.write(reinterpret_cast<const char*>(&cacheVersion), sizeof(cacheVersion));
+		stream.write(reinterpret_cast<const char*>(&inputSize64), sizeof(inputSize64));
+		writeString(stream, command.data(), command.size());
+		writeString(stream, message.data(), message.size());
+		writeString(stream, outputData.data(), outputData.size());
+		if (!stream)
+		{
+			stream.close();
+			boost::filesystem::remove(tempPath, error);
+			return;
+		}
+	}
 
-	m_input.open(m_inputFileName, std::ios_base::trunc | std::ofstream::binary);
+	boost::filesystem::rename(tempPath, path, error);
+	if (error)
+		boost::filesystem::remove(tempPath, error);
 }
 
-ExecuteCommand::~ExecuteCommand()
+// The extension is included since tools may change behavior based on it.
+std::string getCacheFileName(const std::string& directory, const std::string& extension,
+	const std::string& command, const void* inputData, std::size_t inputSize)
+{
+	std::array<std::uint64_t, 2> hash = hashData(inputData, inputSize,
+		hashData(command.data(), command.size(), hashData(extension.data(), extension.size(), {})));
+	char hashStr[33];
+	std::snprintf(hashStr, sizeof(hashStr), "%016llx%016llx",
+		static_cast<unsigned long long>(hash[0]), static_cast<unsigned long long>(hash[1]));
+	return (boost::filesystem::path(directory)/(std::string(hashStr) + ".cache")).string();
+}
+
+} // namespace
+
+ExecuteCommand::ExecuteCommand(std::string inputExtension)
+	: m_inputExtension(std::move(inputExtension))
+	, m_inputData(nullptr)
+	, m_inputSize(0)
 {
-	m_input.close();
-	boost::filesystem::remove(m_inputFileName);
-	m_output.close();
-	boost::filesystem::remove(m_outputFileName);
 }
 
 bool ExecuteCommand::execute(Output& output, const std::string& command)
 {
+	std::string inputStr;
+	const char* inputData = reinterpret_cast<const char*>(m_inputData);
+	std::size_t inputSize = m_inputSize;
+	if (!inputData)
+	{
+		inputStr = m_input.str();
+		inputData = inputStr.data();
+		inputSize = inputStr.size();
+	}
+
+	std::string messageStr;
+	std::string cacheFileName;
+	if (!m_cacheDirectory.empty())
+	{
+		cacheFileName = getCacheFileName(m_cacheDirectory, m_inputExtension, command, inputData,
+			inputSize);
+		if (readCacheEntry(m_outputData, messageStr, cacheFileName, command, inputSize))
+		{
+			if (!messageStr.empty())
+			{
+				output.addMessage(Output::Level::Info, "", 0, 0, false,
+					"output from running command: " + command + "\n" + messageStr);
+			}
+
+			m_output.str(std::string(m_outputData.begin(), m_outputData.end()));
+			m_output.clear();
+			return true;
+		}
+	}
+
+	if (!executeImpl(output, messageStr, command, inputData, inputSize))
+		return false;
+
+	// Failing to write the cache isn't an error since the command still succeeded.
+	if (!cacheFileName.empty())
+		writeCacheEntry(cacheFileName, command, inputSize, messageStr, m_outputData);
+	return true;
+}
+
+bool ExecuteCommand::executeBatch(Output& output, const std::string& command,
+	std::vector<BatchItem>& items)
+{
+	// Each item is cached separately, and only the items without a cached result are run. The
+	// cache is keyed separately from execute() since the command is run differently.
+	std::string cacheCommand = "batch\n" + command;
+	std::vector<std::string> cacheFileNames;
+	std::vector<BatchItem*> runItems;
+	for (BatchItem& item : items)
+	{
+		item.output.clear();
+		if (m_cacheDirectory.empty())
+		{
+			runItems.push_back(&item);
+			continue;
+		}
+
+		std::string messageStr;
+		std::string cacheFileName = getCacheFileName(m_cacheDirectory, m_inputExtension,
+			cacheCommand, item.data, item.size);
+		if (readCacheEntry(item.output, messageStr, cacheFileName, cacheCommand, item.size))
+		{
+			if (!messageStr.empty())
+			{
+				output.addMessage(Output::Level::Info, item.fileName, item.line, item.column,
+					false, "output from running command: " + command + "\n" + messageStr);
+			}
+			continue;
+		}
+
+		runItems.push_back(&item);
+		cacheFileNames.push_back(std::move(cacheFileName));
+	}
+
+	if (runItems.empty())
+		return true;
+
+	TempDirectory directory;
+	if (!directory.create())
+	{
+		output.addMessage(Output::Level::Error, "", 0, 0, false,
+			"could not create temporary directory for command: " + command);
+		return false;
+	}
+
+	// Items are named by index so the output can be matched back to them.
+	std::string manifest;
+	std::vector<std::string> outputPaths(runItems.size());
+	for (std::size_t i = 0; i < runItems.size(); ++i)
+	{
+		const BatchItem& item = *runItems[i];
+		std::string inputPath = (directory.path/(std::to_string(i) + m_inputExtension)).string();
+		outputPaths[i] = (directory.path/(std::to_string(i) + ".out")).string();
+		std::ofstream stream(inputPath, std::ios_base::trunc | std::ios_base::binary);
+		stream.write(reinterpret_cast<const char*>(item.data),
+			static_cast<std::streamsize>(item.size));
+		if (!stream)
+		{
+			output.addMessage(Output::Level::Error, item.fileName, item.line, item.column, false,
+				"could not write temporary file for command: " + command);
+			return false;
+		}
+
+		manifest += inputPath + '\t' + outputPaths[i] + '\n';
+	}
+
 	std::string finalCommand = command;
-	boost::algorithm::replace_all(finalCommand, "$input", m_inputFileName);
-	boost::algorithm::replace_all(finalCommand, "$output", m_outputFileName);
-	finalCommand += " 2>&1";
+	const char* inputData = manifest.data();
+	std::size_t inputSize = manifest.size();
+	if (command.find("$manifest") != std::string::npos)
+	{
+		std::string manifestPath = (directory.path/"manifest.txt").string();
+		std::ofstream stream(manifestPath, std::ios_base::trunc | std::ios_base::binary);
+		stream << manifest;
+		if (!stream)
+		{
+			output.addMessage(Output::Level::Error, "", 0, 0, false,
+				"could not write temporary file for command: " + command);
+			return false;
+		}
+
+		boost::algorithm::replace_all(finalCommand, "$manifest", manifestPath);
+		inputData = nullptr;
+		inputSize = 0;
+	}
+
+	// Messages are re-added below, attributed to the items they reference.
+	Output commandOutput;
+	std::string messageStr;
+	bool succeeded = executeImpl(commandOutput, messageStr, finalCommand, inputData, inputSize);
+
+	// Standard output doesn't hold a result when batching, so treat it as messages.
+	if (finalCommand.find("$output") == std::string::npos && !m_outputData.empty())
+	{
+		std::string stdoutStr(m_outputData.begin(), m_outputData.end());
+		boost::algorithm::trim(stdoutStr);
+		if (!messageStr.empty())
+			stdoutStr += '\n' + messageStr;
+		messageStr = std::move(stdoutStr);
+		m_outputData.clear();
+		m_output.str(std::string());
+	}
+
+	std::string directoryStr = directory.path.string();
+	std::vector<std::string> itemMessages(runItems.size());
+	std::string otherMessages;
+	std::size_t lineStart = 0;
+	while (lineStart < messageStr.size())
+	{
+		std::size_t lineEnd = messageStr.find('\n', lineStart);
+		if (lineEnd == std::string::npos)
+			lineEnd = messageStr.size();
+		std::string line = messageStr.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
 
-	m_input.close();
+		std::string* messages = &otherMessages;
+		std::size_t pathPos = line.find(directoryStr);
+		if (pathPos != std::string::npos)
+		{
+			std::size_t index = 0;
+			std::size_t digitCount = 0;
+			for (std::size_t i = pathPos + directoryStr.size() + 1;
+				i < line.size() && line[i] >= '0' && line[i] <= '9'; ++i, ++digitCount)
+			{
+				index = index*10 + static_cast<std::size_t>(line[i] - '0');
+			}
+
+			if (digitCount > 0 && index < runItems.size())
+				messages = &itemMessages[index];
+		}
+
+		if (!messages->empty())
+			*messages += '\n';
+		*messages += line;
+	}
+
+	if (!otherMessages.empty())
+	{
+		output.addMessage(Output::Level::Info, "", 0, 0, false, "output from running command: " +
+			command + "\n" + otherMessages);
+	}
+
+	for (std::size_t i = 0; i < runItems.size(); ++i)
+	{
+		if (itemMessages[i].empty())
+			continue;
+
+		const BatchItem& item = *runItems[i];
+		output.addMessage(Output::Level::Info, item.fileName, item.line, item.column, false,
+			"output from running command: " + command + "\n" + itemMessages[i]);
+	}
+
+	// Report errors for each item the tool's output referenced, only falling back to a generic
+	// error when the output couldn't be attributed to any item.
+	bool anyAttributed = std::any_of(itemMessages.begin(), itemMessages.end(),
+		[](const std::string& messages) { return !messages.empty(); });
+	for (const Output::Message& message : commandOutput.getMessages())
+	{
+		if (message.level != Output::Level::Error)
+			continue;
+
+		if (!anyAttributed)
+		{
+			output.addMessage(message.level, message.file, message.line, message.column,
+				message.continued, message.message);
+			continue;
+		}
+
+		for (std::size_t i = 0; i < runItems.size(); ++i)
+		{
+			if (itemMessages[i].empty())
+				continue;
+
+			const BatchItem& item = *runItems[i];
+			output.addMessage(message.level, item.fileName, item.line, item.column, false,
+				message.message);
+		}
+	}
+
+	if (!succeeded)
+		return false;
+
+	for (std::size_t i = 0; i < runItems.size(); ++i)
+	{
+		BatchItem& item = *runItems[i];
+		std::ifstream stream(outputPaths[i], std::ios_base::binary);
+		if (!stream.is_open())
+		{
+			output.addMessage(Output::Level::Error, item.fileName, item.line, item.column, false,
+				"command didn't write output: " + command);
+			succeeded = false;
+			continue;
+		}
+
+		item.output.assign(std::istreambuf_iterator<char>(stream),
+			std::istreambuf_iterator<char>());
+	}
+
+	// Failing to write the cache isn't an error since the command still succeeded.
+	if (succeeded && !cacheFileNames.empty())
+	{
+		for (std::size_t i = 0; i < runItems.size(); ++i)
+		{
+			writeCacheEntry(cacheFileNames[i], cacheCommand, runItems[i]->size, itemMessages[i],
+				runItems[i]->output);
+		}
+	}
+
+	return succeeded;
+}
+
+bool ExecuteCommand::executeImpl(Output& output, std::string& messageStr,
+	const std::string& command, const char* inputData, std::size_t inputSize)
+{
+	// Only use temporary files for the placeholders that need real paths.
+	TempFile inputFile, outputFile;
+	if (command.find("$input") != std::string::npos)
+	{
+		inputFile.create(m_inputExtension);
+		std::ofstream stream(inputFile.path, std::ios_base::trunc | std::ios_base::binary);
+		stream.write(inputData, static_cast<std::streamsize>(inputSize));
+		if (!stream)
+		{
+			output.addMessage(Output::Level::Error, "", 0, 0, false,
+				"could not write temporary file for command: " + command);
+			return false;
+		}
+	}
+
+	if (command.find("$output") != std::string::npos)
+		outputFile.create(std::string());
+
+	m_outputData.clear();
+	messageStr.clear();
+	int exitCode;
+#if MSL_WINDOWS
+	TempFile stdinFile, stdoutFile;
+	std::string finalCommand = command;
+	boost::algorithm::replace_all(finalCommand, "$input", inputFile.path);
+	boost::algorithm::replace_all(finalCommand, "$output", outputFile.path);
+	if (inputFile.path.empty())
+	{
+		stdinFile.create(std::string());
+		std::ofstream stream(stdinFile.path, std::ios_base::trunc | std::ios_base::binary);
+		stream.write(inputData, static_cast<std::streamsize>(inputSize));
+		finalCommand += " < \"" + stdinFile.path + '"';
+	}
+
+	finalCommand += " 2>&1";
+	if (outputFile.path.empty())
+	{
+		stdoutFile.create(std::string());
+		finalCommand += " > \"" + stdoutFile.path + '"';
+	}
 
 	FILE* pipe = popen(finalCommand.c_str(), "r");
 	if (!pipe)
@@ -80,32 +852,72 @@ bool ExecuteCommand::execute(Output& output, const std::string& command)
 
 	const unsigned int bufferSize = 1024;
 	char buffer[bufferSize];
-	std::vector<char> executeOutput;
 	while (!feof(pipe))
 	{
 		std::size_t readSize = fread(buffer, sizeof(char), bufferSize, pipe);
-		executeOutput.insert(executeOutput.end(), buffer, buffer + readSize);
+		messageStr.append(buffer, readSize);
 	}
-	int exitCode = pclose(pipe);
+	exitCode = pclose(pipe);
 
-	std::string outputStr(executeOutput.begin(), executeOutput.end());
-	boost::algorithm::trim(outputStr);
+	if (!stdoutFile.path.empty())
+	{
+		std::ifstream stream(stdoutFile.path, std::ios_base::binary);
+		m_outputData.assign(std::istreambuf_iterator<char>(stream),
+			std::istreambuf_iterator<char>());
+	}
+#else
+	std::vector<std::string> arguments;
+	if (needsShell(command))
+	{
+		std::string finalCommand = command;
+		boost::algorithm::replace_all(finalCommand, "$input", inputFile.path);
+		boost::algorithm::replace_all(finalCommand, "$output", outputFile.path);
+		arguments = {"/bin/sh", "-c", std::move(finalCommand)};
+	}
+	else
+		arguments = splitArguments(command, inputFile.path, outputFile.path);
+
+	if (arguments.empty())
+	{
+		output.addMessage(Output::Level::Error, "", 0, 0, false,
+			"could not execute command: " + command);
+		return false;
+	}
+
+	// Standard output is only used for messages when the result is written to a file.
+	std::vector<char> stdoutData;
+	std::string stderrData;
+	exitCode = spawnCommand(outputFile.path.empty() ? m_outputData : stdoutData, stderrData,
+		arguments, inputFile.path.empty() ? inputData : nullptr,
+		inputFile.path.empty() ? inputSize : 0);
+	messageStr.assign(stdoutData.begin(), stdoutData.end());
+	messageStr += stderrData;
+#endif
 
-	if (!outputStr.empty())
+	boost::algorithm::trim(messageStr);
+	if (!messageStr.empty())
 	{
 		output.addMessage(Output::Level::Info, "", 0, 0, false, "output from running command: " +
-			command + "\n" + outputStr);
+			command + "\n" + messageStr);
 	}
 
 	if (exitCode != 0)
 	{
-		std::stringstream stream;
-		stream << "command failed with exit code " << exitCode << ": " << command;
-		output.addMessage(Output::Level::Error, "", 0, 0, false, stream.str());
+		output.addMessage(Output::Level::Error, "", 0, 0, false, "command failed with exit code " +
+			std::to_string(exitCode) + ": " + command);
+		return false;
+	}
+
+	if (!outputFile.path.empty())
+	{
+		std::ifstream stream(outputFile.path, std::ios_base::binary);
+		m_outputData.assign(std::istreambuf_iterator<char>(stream),
+			std::istreambuf_iterator<char>());
 	}
 
-	m_output.open(m_outputFileName, std::ios_base::binary);
-	return exitCode == 0;
+	m_output.str(std::string(m_outputData.begin(), m_outputData.end()));
+	m_output.clear();
+	return true;
 }
 
 } // namespace
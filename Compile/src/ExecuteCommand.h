@@ -1,5 +1,5 @@
 /*
- * Copyright 2016 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -18,47 +18,102 @@
 
 #include <MSL/Config.h>
 #include <MSL/Compile/Export.h>
-#include <fstream>
+#include <cstddef>
+#include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace msl
 {
 
 class Output;
 
+// Runs an external command on a buffer of data.
+//
+// When the command doesn't reference $input, the input is written to the command's stdin, and
+// when it doesn't reference $output, the result is read from stdout. Temporary files are only
+// created for the placeholders that are used. Commands without shell syntax are run directly
+// rather than through a shell.
+//
+// When a cache directory is set, the result of successful commands is stored keyed by the
+// command and a hash of the input, and re-used without running the command again.
+//
 // Export for tests.
 class MSL_COMPILE_EXPORT ExecuteCommand
 {
 public:
 	explicit ExecuteCommand(std::string inputExtension = std::string());
-	~ExecuteCommand();
 
 	ExecuteCommand(const ExecuteCommand&) = delete;
 	ExecuteCommand& operator=(const ExecuteCommand&) = delete;
 
-	std::ofstream& getInput()
+	// Stream to write the input to. Ignored if setInputData() is called.
+	std::ostream& getInput()
 	{
 		return m_input;
 	}
 
-	std::ifstream& getOutput()
+	// Sets the directory to cache results in. The directory is created if it doesn't exist.
+	void setCacheDirectory(std::string directory)
+	{
+		m_cacheDirectory = std::move(directory);
+	}
+
+	// Sets the input without copying. The data must remain valid until execute() returns.
+	void setInputData(const void* data, std::size_t size)
+	{
+		m_inputData = data;
+		m_inputSize = size;
+	}
+
+	// Gets the result of the command after execute().
+	std::istream& getOutput()
 	{
 		return m_output;
 	}
 
-	const std::string& getOutputFileName() const
+	const std::vector<char>& getOutputData() const
 	{
-		return m_inputFileName;
+		return m_outputData;
 	}
 
 	bool execute(Output& output, const std::string& command);
 
+	// An input for executeBatch(). Messages for the item are reported at its location.
+	struct BatchItem
+	{
+		const void* data = nullptr;
+		std::size_t size = 0;
+		std::string fileName;
+		std::size_t line = 0;
+		std::size_t column = 0;
+
+		// The result of the command for this item.
+		std::vector<char> output;
+	};
+
+	// Runs the command once for multiple inputs. Each input is written to a temporary file, and a
+	// manifest with a line for each item containing the input and output file names separated by
+	// a tab replaces $manifest, or is written to stdin if not referenced. Output lines that
+	// reference an item's files are reported at that item's location, as is the error when the
+	// command fails, and it's an error for an output file to be missing. When a cache directory
+	// is set, each item is cached separately and the command is only run for the items without a
+	// cached result.
+	bool executeBatch(Output& output, const std::string& command, std::vector<BatchItem>& items);
+
 private:
-	std::string m_inputFileName;
-	std::ofstream m_input;
+	bool executeImpl(Output& output, std::string& message, const std::string& command,
+		const char* inputData, std::size_t inputSize);
+
+	std::string m_inputExtension;
+	std::string m_cacheDirectory;
+	std::stringstream m_input;
+	const void* m_inputData;
+	std::size_t m_inputSize;
 
-	std::string m_outputFileName;
-	std::ifstream m_output;
+	std::vector<char> m_outputData;
+	std::istringstream m_output;
 };
 
 } // namespace msl
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2025 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -33,7 +33,8 @@ namespace msl
 
 std::string MetalOutput::disassemble(Output& output, const Compiler::SpirV& spirv, Stage stage,
 	std::uint32_t version, bool ios, bool outputToBuffer, bool hasPushConstant,
-	std::uint32_t bufferCount, std::uint32_t textureCount, const std::string& fileName,
+	std::uint32_t bufferCount, std::uint32_t textureCount,
+	const std::vector<ArgumentBinding>* argumentBindings, const std::string& fileName,
 	std::size_t line, std::size_t column)
 {
 	spirv_cross::CompilerMSL::Options options;
@@ -42,6 +43,7 @@ std::string MetalOutput::disassemble(Output& output, const Compiler::SpirV& spir
 	options.msl_version = spirv_cross::CompilerMSL::Options::make_msl_version(version/100,
 		version%100);
 	options.capture_output_to_buffer = outputToBuffer;
+	options.argument_buffers = argumentBindings != nullptr;
 
 	spirv_cross::CompilerMSL compiler(spirv);
 	compiler.set_msl_options(options);
@@ -69,6 +71,43 @@ std::string MetalOutput::disassemble(Output& output, const Compiler::SpirV& spir
 			break;
 	}
 
+	if (argumentBindings)
+	{
+		if (hasPushConstant)
+		{
+			spirv_cross::MSLResourceBinding binding;
+			binding.stage = executionModel;
+			binding.desc_set = spirv_cross::kPushConstDescSet;
+			binding.binding = spirv_cross::kPushConstBinding;
+			binding.msl_buffer = 0;
+			compiler.add_msl_resource_binding(binding);
+		}
+
+		// The argument buffer itself is bound after the push constants.
+		spirv_cross::MSLResourceBinding bufferBinding;
+		bufferBinding.stage = executionModel;
+		bufferBinding.desc_set = 0;
+		bufferBinding.binding = spirv_cross::kArgumentBufferBinding;
+		bufferBinding.msl_buffer = hasPushConstant ? 1 : 0;
+		compiler.add_msl_resource_binding(bufferBinding);
+
+		for (const ArgumentBinding& argumentBinding : *argumentBindings)
+		{
+			spirv_cross::MSLResourceBinding binding;
+			binding.stage = executionModel;
+			binding.desc_set = 0;
+			binding.binding = argumentBinding.binding;
+			binding.msl_buffer = argumentBinding.bufferId;
+			binding.msl_texture = argumentBinding.textureId;
+			binding.msl_sampler = argumentBinding.samplerId;
+			compiler.add_msl_resource_binding(binding);
+		}
+
+		// Skip the individual bindings.
+		bufferCount = 0;
+		textureCount = 0;
+	}
+
 	for (std::uint32_t i = hasPushConstant ? 1 : 0; i < bufferCount; ++i)
 	{
 		spirv_cross::MSLResourceBinding binding;
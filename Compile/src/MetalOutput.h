@@ -1,5 +1,5 @@
 /*
- * Copyright 2016 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -25,9 +25,22 @@ namespace msl
 class MetalOutput
 {
 public:
+	// Resource in descriptor set 0 placed in the argument buffer. The IDs are unknown for the
+	// resource types that aren't used.
+	struct ArgumentBinding
+	{
+		std::uint32_t binding;
+		std::uint32_t bufferId;
+		std::uint32_t textureId;
+		std::uint32_t samplerId;
+	};
+
+	// When argumentBindings is set, the resources are placed in a single argument buffer bound
+	// after the push constants rather than bound individually.
 	static std::string disassemble(Output& output, const Compiler::SpirV& spirv, Stage stage,
 		std::uint32_t version, bool ios, bool outputToBuffer, bool hasPushConstant,
-		std::uint32_t bufferCount, std::uint32_t textureCount, const std::string& fileName,
+		std::uint32_t bufferCount, std::uint32_t textureCount,
+		const std::vector<ArgumentBinding>* argumentBindings, const std::string& fileName,
 		std::size_t line, std::size_t column);
 };
 
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <MSL/Config.h>
+#include <MSL/Compile/CompiledResult.h>
+#include <MSL/Compile/Types.h>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace msl
+{
+
+// Cache of compiled pipelines used by CompileSession to avoid recompiling pipelines whose
+// generated inputs haven't changed.
+class PipelineCache
+{
+public:
+	struct Entry
+	{
+		// Combination of the generated GLSL for each stage and other inputs that affect the
+		// compiled output.
+		std::string key;
+
+		// Pipeline before the render and sampler states are applied.
+		compile::Pipeline pipeline;
+		std::array<CompiledResult::ShaderData, compile::stageCount> shaders;
+		std::uint32_t clipDistanceCount = 0;
+		std::uint32_t cullDistanceCount = 0;
+	};
+
+	std::map<std::string, Entry> entries;
+	std::vector<std::string> changedPipelines;
+	std::vector<std::string> removedPipelines;
+};
+
+// Processed SPIR-V for a pipeline before it's cross-compiled for a target.
+struct CompiledSpirV
+{
+	// Pipeline before the shaders are added and the render and sampler states are applied.
+	compile::Pipeline pipeline;
+	std::array<std::vector<std::uint32_t>, compile::stageCount> spirv;
+	std::array<bool, compile::stageCount> usesPushConstants = {};
+	std::array<bool, compile::stageCount> pipelineStages = {};
+	std::uint32_t clipDistanceCount = 0;
+	std::uint32_t cullDistanceCount = 0;
+};
+
+// Cache of processed SPIR-V used by TargetGroup to share the front-end compile between targets.
+// Keys include the SPIR-V options for the target in addition to the pipeline cache key.
+class SpirVCache
+{
+public:
+	std::map<std::string, CompiledSpirV> entries;
+};
+
+} // namespace msl
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2025 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -109,6 +109,12 @@ struct MemberInfo
 	std::uint32_t component = unknown;
 };
 
+struct SpecConstantInfo
+{
+	Type type;
+	double defaultValue;
+};
+
 struct IntermediateData
 {
 	// Names
@@ -131,6 +137,7 @@ struct IntermediateData
 	std::unordered_map<std::uint32_t, std::uint32_t> inputAttachmentIndices;
 	std::unordered_map<std::uint32_t, std::uint32_t> locations;
 	std::unordered_map<std::uint32_t, std::uint32_t> components;
+	std::unordered_map<std::uint32_t, std::uint32_t> specIds;
 	std::unordered_set<std::uint32_t> inputOutputStructs;
 
 	// Variable declarations
@@ -143,6 +150,7 @@ struct IntermediateData
 	std::map<std::uint32_t, std::uint32_t> outputVars;
 	std::map<std::uint32_t, std::uint32_t> imageVars;
 	std::map<std::uint32_t, std::uint32_t> storageBufferVars;
+	std::map<std::uint32_t, SpecConstantInfo> specConstants;
 	std::pair<std::uint32_t, std::uint32_t> pushConstantPointer = std::make_pair(unknown, unknown);
 	std::pair<std::uint32_t, std::uint32_t> clipDistanceMember = std::make_pair(unknown, unknown);
 	std::pair<std::uint32_t, std::uint32_t> cullDistanceMember = std::make_pair(unknown, unknown);
@@ -169,6 +177,35 @@ unsigned int getWordCount(std::uint32_t value)
 	return value >> spv::WordCountShift;
 }
 
+double getSpecConstantValue(const std::vector<std::uint32_t>& spirv, std::size_t i, Type type)
+{
+	switch (type)
+	{
+		case Type::Int:
+			return static_cast<double>(static_cast<std::int32_t>(spirv[i + 3]));
+		case Type::UInt:
+			return static_cast<double>(spirv[i + 3]);
+		case Type::Float:
+		{
+			float value;
+			std::memcpy(&value, &spirv[i + 3], sizeof(float));
+			return value;
+		}
+		case Type::Double:
+		{
+			// Literals are stored with the low-order word first.
+			assert(getWordCount(spirv[i]) == 5);
+			std::uint64_t bits = spirv[i + 3] | static_cast<std::uint64_t>(spirv[i + 4]) << 32;
+			double value;
+			std::memcpy(&value, &bits, sizeof(double));
+			return value;
+		}
+		default:
+			assert(false);
+			return 0.0;
+	}
+}
+
 std::string readString(std::vector<char>& tempBuffer,
 	const std::vector<std::uint32_t>& spirv, std::size_t start, std::size_t wordCount,
 	std::size_t offset)
@@ -1404,6 +1441,33 @@ bool addOutputs(Output& output, SpirVProcessor& processor, IntermediateData& dat
 		data.outputVars);
 }
 
+void addSpecializationConstants(SpirVProcessor& processor, const IntermediateData& data)
+{
+	// Only constants with a SpecId can be set externally. Others are derived from operations on
+	// specialization constants.
+	for (const auto& specConstant : data.specConstants)
+	{
+		auto foundId = data.specIds.find(specConstant.first);
+		if (foundId == data.specIds.end())
+			continue;
+
+		SpecializationConstant addedConstant;
+		auto foundName = data.names.find(specConstant.first);
+		if (foundName != data.names.end())
+			addedConstant.name = foundName->second;
+		addedConstant.type = specConstant.second.type;
+		addedConstant.id = foundId->second;
+		addedConstant.defaultValue = specConstant.second.defaultValue;
+		processor.specializationConstants.push_back(std::move(addedConstant));
+	}
+
+	std::sort(processor.specializationConstants.begin(), processor.specializationConstants.end(),
+		[](const SpecializationConstant& left, const SpecializationConstant& right)
+		{
+			return left.id < right.id;
+		});
+}
+
 void addPushConstants(SpirVProcessor& processor, const IntermediateData& data)
 {
 	if (data.pushConstantPointer.first == unknown)
@@ -2083,6 +2147,10 @@ bool SpirVProcessor::extract(Output& output, const std::string& fileName, std::s
 						assert(wordCount == 4);
 						data.arrayStrides[id] = spirv[i + 3];
 						break;
+					case spv::DecorationSpecId:
+						assert(wordCount == 4);
+						data.specIds[id] = spirv[i + 3];
+						break;
 					case spv::DecorationBlock:
 						data.blocks.insert(id);
 						break;
@@ -2181,6 +2249,29 @@ bool SpirVProcessor::extract(Output& output, const std::string& fileName, std::s
 				break;
 			}
 
+			// Extract specialization constants.
+			case spv::OpSpecConstantTrue:
+			case spv::OpSpecConstantFalse:
+			{
+				assert(wordCount == 3);
+				SpecConstantInfo& info = data.specConstants[spirv[i + 2]];
+				info.type = Type::Bool;
+				info.defaultValue = op == spv::OpSpecConstantTrue ? 1.0 : 0.0;
+				break;
+			}
+			case spv::OpSpecConstant:
+			{
+				assert(wordCount > 3);
+				std::uint32_t typeId = spirv[i + 1];
+				std::uint32_t id = spirv[i + 2];
+				auto foundType = data.types.find(typeId);
+				assert(foundType != data.types.end());
+				SpecConstantInfo& info = data.specConstants[id];
+				info.type = foundType->second;
+				info.defaultValue = getSpecConstantValue(spirv, i, info.type);
+				break;
+			}
+
 			// Extract type declarations.
 			case spv::OpTypeBool:
 				assert(wordCount == 2);
@@ -2401,6 +2492,7 @@ bool SpirVProcessor::extract(Output& output, const std::string& fileName, std::s
 	if (!addOutputs(output, *this, data))
 		return false;
 	addPushConstants(*this, data);
+	addSpecializationConstants(*this, data);
 
 	// Get the clip and cull distance counts. Check if they are actually referenced, otherwise it
 	// will always have size 1 by default.
@@ -2443,6 +2535,18 @@ bool SpirVProcessor::extract(Output& output, const std::string& fileName, std::s
 		}
 	}
 
+	std::unordered_set<std::uint32_t> encounteredIds;
+	for (const SpecializationConstant& specConstant : specializationConstants)
+	{
+		if (!encounteredIds.insert(specConstant.id).second)
+		{
+			output.addMessage(Output::Level::Error, fileName, line, column, false,
+				"linker error: multiple specialization constants with ID " +
+				std::to_string(specConstant.id) + " declared");
+			return false;
+		}
+	}
+
 	encounteredNames.clear();
 	for (const InputOutput& stageInput : inputs)
 	{
@@ -2506,6 +2610,26 @@ bool SpirVProcessor::uniformsCompatible(Output& output, const SpirVProcessor& ot
 		}
 	}
 
+	// Specialization constants
+	for (const SpecializationConstant& specConstant : specializationConstants)
+	{
+		for (const SpecializationConstant& otherConstant : other.specializationConstants)
+		{
+			if (specConstant.name != otherConstant.name && specConstant.id != otherConstant.id)
+				continue;
+
+			if (specConstant.name != otherConstant.name || specConstant.id != otherConstant.id ||
+				specConstant.type != otherConstant.type ||
+				specConstant.defaultValue != otherConstant.defaultValue)
+			{
+				output.addMessage(Output::Level::Error, fileName, line, column, false,
+					"linker error: specialization constant " + specConstant.name +
+					" has different declarations between stages");
+				success = false;
+			}
+		}
+	}
+
 	// Structs
 	for (const Struct& thisStruct : structs)
 	{
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2019 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -78,6 +78,7 @@ public:
 	std::vector<std::uint32_t> inputIds;
 	std::vector<InputOutput> outputs;
 	std::vector<std::uint32_t> outputIds;
+	std::vector<SpecializationConstant> specializationConstants;
 	std::uint32_t pushConstantStruct = unknown;
 	std::array<std::uint32_t, 3> computeLocalSize = {{1, 1, 1}};
 	std::uint32_t clipDistanceCount = 0;
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2025 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -16,11 +16,13 @@
 
 #include <MSL/Compile/Target.h>
 #include <MSL/Compile/CompiledResult.h>
+#include <MSL/Compile/CompileProgress.h>
 #include <MSL/Compile/Output.h>
 
 #include "Compiler.h"
 #include "ExecuteCommand.h"
 #include "Parser.h"
+#include "PipelineCache.h"
 #include "Preprocessor.h"
 #include "SpirVProcessor.h"
 
@@ -36,6 +38,9 @@
 #include <cstdio>
 #include <cstring>
 #include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
 
 namespace msl
 {
@@ -352,6 +357,37 @@ static bool decodeResourceLimits(Output& output, TBuiltInResource& resources, st
 	return true;
 }
 
+static bool matchesGlob(const char* pattern, const char* str)
+{
+	// Iterative matching that backtracks to the last '*' on mismatch.
+	const char* starPattern = nullptr;
+	const char* starStr = nullptr;
+	while (*str)
+	{
+		if (*pattern == '*')
+		{
+			starPattern = ++pattern;
+			starStr = str;
+		}
+		else if (*pattern == '?' || *pattern == *str)
+		{
+			++pattern;
+			++str;
+		}
+		else if (starPattern)
+		{
+			pattern = starPattern;
+			str = ++starStr;
+		}
+		else
+			return false;
+	}
+
+	while (*pattern == '*')
+		++pattern;
+	return *pattern == 0;
+}
+
 static std::uint32_t addStruct(Pipeline& pipeline, const std::vector<Struct>& structs,
 	const Struct& addedStruct)
 {
@@ -427,6 +463,19 @@ static void addUniforms(Pipeline& pipeline, Stage stage, const SpirVProcessor& p
 	}
 }
 
+static void addSpecializationConstants(Pipeline& pipeline, const SpirVProcessor& processor)
+{
+	// Compatibility between stages was already checked, so only need to check the IDs.
+	for (const SpecializationConstant& specConstant : processor.specializationConstants)
+	{
+		auto foundIter = std::lower_bound(pipeline.specializationConstants.begin(),
+			pipeline.specializationConstants.end(), specConstant.id,
+			[](const SpecializationConstant& left, std::uint32_t id) {return left.id < id;});
+		if (foundIter == pipeline.specializationConstants.end() || foundIter->id != specConstant.id)
+			pipeline.specializationConstants.insert(foundIter, specConstant);
+	}
+}
+
 bool operator==(const SamplerState& s1, const SamplerState& s2)
 {
 	return s1.minFilter == s2.minFilter && s1.magFilter == s2.magFilter &&
@@ -449,6 +498,141 @@ static std::uint32_t addSampler(Pipeline& pipeline, const SamplerState& sampler)
 	return static_cast<std::uint32_t>(pipeline.samplerStates.size() - 1);
 }
 
+static std::string createCacheKey(const Parser::Pipeline& pipeline,
+	const std::array<std::string, stageCount>& glsl,
+	const std::vector<compile::FragmentInputGroup>& fragmentInputs)
+{
+	// Everything that affects the compiled output other than the render and sampler states, which
+	// are always re-applied.
+	std::string key = std::to_string(pipeline.renderState.fragmentGroup);
+	for (const compile::FragmentInputGroup& inputGroup : fragmentInputs)
+	{
+		key += '\n' + inputGroup.type + ' ' + inputGroup.name;
+		for (const compile::FragmentInput& input : inputGroup.inputs)
+		{
+			key += '\n' + input.name + ' ' + std::to_string(input.location) + ' ' +
+				std::to_string(input.fragmentGroup);
+		}
+	}
+
+	for (unsigned int i = 0; i < stageCount; ++i)
+	{
+		key += '\0';
+		key += pipeline.entryPoints[i].value;
+		key += '\0';
+		key += glsl[i];
+	}
+
+	return key;
+}
+
+static void setPipelineStates(Pipeline& addedPipeline, const Parser::Pipeline& pipeline,
+	const std::vector<Parser::Sampler>& samplers, std::uint32_t clipDistanceCount,
+	std::uint32_t cullDistanceCount)
+{
+	addedPipeline.renderState = pipeline.renderState;
+	addedPipeline.renderState.clipDistanceCount = std::max(
+		addedPipeline.renderState.clipDistanceCount, clipDistanceCount);
+	addedPipeline.renderState.cullDistanceCount = std::max(
+		addedPipeline.renderState.cullDistanceCount, cullDistanceCount);
+
+	addedPipeline.samplerStates.clear();
+	for (std::size_t i = 0; i < addedPipeline.uniforms.size(); ++i)
+	{
+		if (addedPipeline.uniforms[i].uniformType != UniformType::SampledImage)
+			continue;
+
+		addedPipeline.uniforms[i].samplerIndex = unknown;
+		for (std::size_t j = 0; j < samplers.size(); ++j)
+		{
+			if (samplers[j].name == addedPipeline.uniforms[i].name)
+			{
+				addedPipeline.uniforms[i].samplerIndex = addSampler(addedPipeline,
+					samplers[j].state);
+				break;
+			}
+		}
+	}
+}
+
+static bool addCancelledError(Output& output, const std::string& fileName)
+{
+	output.addMessage(Output::Level::Error, fileName, 0, 0, false, "compilation cancelled");
+	return false;
+}
+
+static bool reportProgress(Output& output, const CompileProgress* progress,
+	const std::string& fileName, CompileProgress::Phase phase,
+	std::string pipeline = std::string(), Stage stage = Stage::Vertex,
+	std::size_t pipelineIndex = 0, std::size_t pipelineCount = 0)
+{
+	if (!progress)
+		return true;
+
+	CompileProgress::Event event = {phase, std::move(pipeline), stage, pipelineIndex,
+		pipelineCount};
+	progress->report(event);
+	if (progress->isCancelled())
+		return addCancelledError(output, fileName);
+
+	return true;
+}
+
+struct Target::CompileContext
+{
+	CompileContext(const Parser& parser_, const std::string& fileName_)
+		: parser(parser_)
+		, fileName(fileName_)
+	{
+	}
+
+	const Parser& parser;
+	const std::string& fileName;
+	bool hasEarlyFragmentTests = false;
+	bool dummyBindings = false;
+	TBuiltInResource resources;
+	int processOptions = 0;
+	SpirVProcessor::Strip strip = SpirVProcessor::Strip::None;
+	std::vector<compile::FragmentInputGroup> fragmentInputs;
+	PipelineCache* cache = nullptr;
+	CompileProgress* progress = nullptr;
+	VariantState* variant = nullptr;
+	SpirVCache* spirvCache = nullptr;
+	std::string spirvKeyPrefix;
+};
+
+struct Target::PipelineSources
+{
+	std::array<std::string, stageCount> glsl;
+	std::array<std::vector<Parser::LineMapping>, stageCount> lineMappings;
+};
+
+struct Target::VariantState
+{
+	std::size_t permutation = 0;
+	std::size_t permutationCount = 0;
+	std::vector<std::pair<std::string, std::string>> defines;
+	std::string suffix;
+
+	// Pipelines compiled for previous permutations, keyed the same way as the pipeline cache.
+	std::map<std::string, PipelineCache::Entry> compiledPipelines;
+};
+
+struct Target::PipelineState
+{
+	std::string name;
+	// Null when the pipeline isn't selected.
+	Pipeline* pipeline = nullptr;
+	// Set when re-using a pipeline from the cache or a previous variant.
+	const PipelineCache::Entry* reusedEntry = nullptr;
+	PipelineCache::Entry* cacheEntry = nullptr;
+	std::string cacheKey;
+	CompiledSpirV localSpirV;
+	const CompiledSpirV* compiledSpirV = nullptr;
+	std::array<std::vector<std::uint32_t>, stageCount> toolSpirV;
+	std::array<std::vector<std::uint8_t>, stageCount> shaderData;
+};
+
 const Target::FeatureInfo& Target::getFeatureInfo(Target::Feature feature)
 {
 	return featureInfos[static_cast<unsigned int>(feature)];
@@ -459,7 +643,12 @@ Target::Target()
 	, m_stripDebug(false)
 	, m_dummyBindings(false)
 	, m_adjustableBindings(false)
+	, m_batchToolCommands(false)
+	, m_sectionedModules(false)
+	, m_encodeSpirV(false)
+	, m_shaderAlignment(minShaderAlignment)
 	, m_optimize(Optimize::None)
+	, m_compression(Compression::None)
 {
 	Compiler::initialize();
 	m_featureStates.fill(State::Default);
@@ -525,6 +714,16 @@ std::vector<std::pair<std::string, std::string>> Target::getExtraDefines() const
 	return std::vector<std::pair<std::string, std::string>>();
 }
 
+compile::ShaderDataFormat Target::getShaderDataFormat() const
+{
+	return compile::ShaderDataFormat::Native;
+}
+
+bool Target::getArgumentBuffers() const
+{
+	return false;
+}
+
 void Target::clearDefines()
 {
 	m_defines.clear();
@@ -556,6 +755,36 @@ void Target::setSpirVToolCommand(std::string command)
 	m_spirVToolCommand = std::move(command);
 }
 
+const Target::SpirVTransform& Target::getSpirVTransform() const
+{
+	return m_spirVTransform;
+}
+
+void Target::setSpirVTransform(SpirVTransform transform)
+{
+	m_spirVTransform = std::move(transform);
+}
+
+const std::string& Target::getCommandCacheDirectory() const
+{
+	return m_commandCacheDirectory;
+}
+
+void Target::setCommandCacheDirectory(std::string directory)
+{
+	m_commandCacheDirectory = std::move(directory);
+}
+
+bool Target::getBatchToolCommands() const
+{
+	return m_batchToolCommands;
+}
+
+void Target::setBatchToolCommands(bool batch)
+{
+	m_batchToolCommands = batch;
+}
+
 bool Target::getRemapVariables() const
 {
 	return m_remapVariables;
@@ -606,6 +835,53 @@ void Target::setAdjustableBindings(bool adjustable)
 	m_adjustableBindings = adjustable;
 }
 
+std::uint32_t Target::getShaderAlignment() const
+{
+	return m_shaderAlignment;
+}
+
+bool Target::setShaderAlignment(std::uint32_t alignment)
+{
+	if (alignment < minShaderAlignment || alignment > maxShaderAlignment ||
+		(alignment & (alignment - 1)) != 0)
+	{
+		return false;
+	}
+
+	m_shaderAlignment = alignment;
+	return true;
+}
+
+bool Target::getSectionedModules() const
+{
+	return m_sectionedModules;
+}
+
+void Target::setSectionedModules(bool sectioned)
+{
+	m_sectionedModules = sectioned;
+}
+
+Target::Compression Target::getCompression() const
+{
+	return m_compression;
+}
+
+void Target::setCompression(Compression compression)
+{
+	m_compression = compression;
+}
+
+bool Target::getEncodeSpirV() const
+{
+	return m_encodeSpirV;
+}
+
+void Target::setEncodeSpirV(bool encode)
+{
+	m_encodeSpirV = encode;
+}
+
 const std::string& Target::getResourcesFileName() const
 {
 	return m_resourcesFile;
@@ -616,36 +892,63 @@ void Target::setResourcesFileName(std::string fileName)
 	m_resourcesFile = std::move(fileName);
 }
 
-bool Target::compile(CompiledResult& result, Output& output, const std::string& fileName)
+void Target::addPipelineFilter(std::string filter)
 {
-	willCompile();
+	m_pipelineFilters.push_back(std::move(filter));
+}
 
-	Preprocessor preprocessor;
-	setupPreprocessor(preprocessor);
+const std::vector<std::string>& Target::getPipelineFilters() const
+{
+	return m_pipelineFilters;
+}
 
-	Parser parser;
-	if (!preprocessor.preprocess(parser.getTokens(), output, fileName, m_preHeaderLines))
-		return false;
+void Target::clearPipelineFilters()
+{
+	m_pipelineFilters.clear();
+}
+
+bool Target::pipelineSelected(const std::string& name) const
+{
+	if (m_pipelineFilters.empty())
+		return true;
+
+	for (const std::string& filter : m_pipelineFilters)
+	{
+		if (matchesGlob(filter.c_str(), name.c_str()))
+			return true;
+	}
 
-	return compileImpl(result, output, parser, fileName);
+	return false;
 }
 
-bool Target::compile(CompiledResult& result, Output& output, std::istream& stream,
-	const std::string& fileName)
+void Target::addVariantKeyword(std::string name, std::vector<std::string> values)
 {
-	willCompile();
+	m_variantKeywords.push_back(VariantKeyword{std::move(name), std::move(values)});
+}
 
-	Preprocessor preprocessor;
-	setupPreprocessor(preprocessor);
+const std::vector<Target::VariantKeyword>& Target::getVariantKeywords() const
+{
+	return m_variantKeywords;
+}
 
-	Parser parser;
-	if (!preprocessor.preprocess(parser.getTokens(), output, stream, fileName, m_preHeaderLines))
-		return false;
+void Target::clearVariantKeywords()
+{
+	m_variantKeywords.clear();
+}
 
-	return compileImpl(result, output, parser, fileName);
+bool Target::compile(CompiledResult& result, Output& output, const std::string& fileName,
+	CompileProgress* progress) const
+{
+	return compileImpl(result, output, nullptr, fileName, nullptr, progress, nullptr);
+}
+
+bool Target::compile(CompiledResult& result, Output& output, std::istream& stream,
+	const std::string& fileName, CompileProgress* progress) const
+{
+	return compileImpl(result, output, &stream, fileName, nullptr, progress, nullptr);
 }
 
-bool Target::finish(CompiledResult& result, Output& output)
+bool Target::finish(CompiledResult& result, Output& output) const
 {
 	if (result.m_target != this)
 	{
@@ -655,6 +958,9 @@ bool Target::finish(CompiledResult& result, Output& output)
 	}
 
 	result.m_sharedData.clear();
+	if (!linkShaders(result.m_shaders, result.m_sharedData, output))
+		return false;
+
 	if (!getSharedData(result.m_sharedData, output))
 		return false;
 
@@ -671,11 +977,28 @@ std::uint32_t Target::getSpirVVersion() const
 	return spv::Version;
 }
 
-void Target::willCompile()
+bool Target::requiresDummyBindings() const
+{
+	return false;
+}
+
+bool Target::getSharedData(std::vector<std::uint8_t>&, Output&) const
+{
+	return true;
+}
+
+bool Target::needsPostProcessShaders() const
+{
+	return false;
+}
+
+bool Target::postProcessShaders(Output&, std::vector<CompiledShader>&) const
 {
+	return true;
 }
 
-bool Target::getSharedData(std::vector<std::uint8_t>&, Output&)
+bool Target::linkShaders(std::vector<CompiledResult::ShaderData>&, std::vector<std::uint8_t>&,
+	Output&) const
 {
 	return true;
 }
@@ -702,19 +1025,209 @@ void Target::setupPreprocessor(Preprocessor& preprocessor) const
 	}
 }
 
-bool Target::compileImpl(CompiledResult& result, Output& output, Parser& parser,
-	const std::string& fileName)
+std::string Target::getFrontEndKey() const
+{
+	// Everything that affects the preprocessed and parsed source.
+	std::string key;
+	for (unsigned int i = 0; i < featureCount; ++i)
+		key += featureEnabled(static_cast<Feature>(i)) ? '1' : '0';
+
+	for (const std::string& include : m_includePaths)
+		key += "\ninclude " + include;
+
+	for (const auto& define : m_defines)
+		key += "\ndefine " + define.first + '=' + define.second;
+
+	for (const auto& define : getExtraDefines())
+		key += "\ndefine " + define.first + '=' + define.second;
+
+	for (const std::string& line : m_preHeaderLines)
+		key += "\nheader " + line;
+
+	return key;
+}
+
+bool Target::compileImpl(CompiledResult& result, Output& output, std::istream* stream,
+	const std::string& fileName, PipelineCache* cache, CompileProgress* progress,
+	SpirVCache* spirvCache) const
 {
+	if (cache)
+	{
+		cache->changedPipelines.clear();
+		cache->removedPipelines.clear();
+	}
+
+	bool success;
+	if (m_variantKeywords.empty())
+		success = compileSource(result, output, stream, fileName, cache, progress, nullptr,
+			spirvCache);
+	else
+		success = compileVariants(result, output, stream, fileName, cache, progress, spirvCache);
+	if (!success)
+		return false;
+
+	// Remove any cached pipelines that no longer exist.
+	if (cache)
+	{
+		for (auto it = cache->entries.begin(); it != cache->entries.end();)
+		{
+			if (result.m_pipelines.find(it->first) == result.m_pipelines.end())
+			{
+				cache->removedPipelines.push_back(it->first);
+				it = cache->entries.erase(it);
+			}
+			else
+				++it;
+		}
+	}
+
+	return true;
+}
+
+bool Target::compileVariants(CompiledResult& result, Output& output, std::istream* stream,
+	const std::string& fileName, PipelineCache* cache, CompileProgress* progress,
+	SpirVCache* spirvCache) const
+{
+	std::size_t permutationCount = 1;
+	for (std::size_t i = 0; i < m_variantKeywords.size(); ++i)
+	{
+		const VariantKeyword& keyword = m_variantKeywords[i];
+		if (keyword.values.empty())
+		{
+			output.addMessage(Output::Level::Error, fileName, 0, 0, false,
+				"variant keyword has no values: " + keyword.name);
+			return false;
+		}
+
+		for (std::size_t j = 0; j < i; ++j)
+		{
+			if (m_variantKeywords[j].name == keyword.name)
+			{
+				output.addMessage(Output::Level::Error, fileName, 0, 0, false,
+					"variant keyword declared multiple times: " + keyword.name);
+				return false;
+			}
+		}
+
+		permutationCount *= keyword.values.size();
+		if (permutationCount >= unknown)
+		{
+			output.addMessage(Output::Level::Error, fileName, 0, 0, false,
+				"too many variant permutations");
+			return false;
+		}
+	}
+
+	// Read the stream once so it may be re-used for each permutation.
+	std::string source;
+	if (stream)
+		source.assign(std::istreambuf_iterator<char>(*stream), std::istreambuf_iterator<char>());
+
+	VariantState variant;
+	variant.permutationCount = permutationCount;
+	for (std::size_t i = 0; i < permutationCount; ++i)
+	{
+		// The first keyword changes the fastest, matching the permutation index in the module.
+		variant.permutation = i;
+		variant.defines.clear();
+		variant.suffix = "[";
+		std::size_t remainingIndex = i;
+		for (std::size_t j = 0; j < m_variantKeywords.size(); ++j)
+		{
+			const VariantKeyword& keyword = m_variantKeywords[j];
+			const std::string& value = keyword.values[remainingIndex % keyword.values.size()];
+			remainingIndex /= keyword.values.size();
+
+			variant.defines.emplace_back(keyword.name, value);
+			if (j > 0)
+				variant.suffix += ',';
+			variant.suffix += keyword.name + '=' + value;
+		}
+		variant.suffix += ']';
+
+		bool success;
+		if (stream)
+		{
+			std::istringstream variantStream(source);
+			success = compileSource(result, output, &variantStream, fileName, cache, progress,
+				&variant, spirvCache);
+		}
+		else
+		{
+			success = compileSource(result, output, nullptr, fileName, cache, progress, &variant,
+				spirvCache);
+		}
+
+		if (!success)
+		{
+			output.addMessage(Output::Level::Error, fileName, 0, 0, true,
+				"while compiling variant " + variant.suffix);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool Target::compileSource(CompiledResult& result, Output& output, std::istream* stream,
+	const std::string& fileName, PipelineCache* cache, CompileProgress* progress,
+	VariantState* variant, SpirVCache* spirvCache) const
+{
+	Parser parser;
+	if (!preprocessAndParse(parser, output, stream, fileName, progress, variant))
+		return false;
+
+	return compileParsed(result, output, parser, fileName, cache, progress, variant, spirvCache);
+}
+
+bool Target::preprocessAndParse(Parser& parser, Output& output, std::istream* stream,
+	const std::string& fileName, CompileProgress* progress, const VariantState* variant) const
+{
+	Preprocessor preprocessor;
+	setupPreprocessor(preprocessor);
+	if (variant)
+	{
+		for (const auto& define : variant->defines)
+			preprocessor.addDefine(define.first, define.second);
+	}
+
+	if (stream)
+	{
+		if (!preprocessor.preprocess(parser.getTokens(), output, *stream, fileName,
+				m_preHeaderLines))
+		{
+			return false;
+		}
+	}
+	else if (!preprocessor.preprocess(parser.getTokens(), output, fileName, m_preHeaderLines))
+		return false;
+
+	if (!reportProgress(output, progress, fileName, CompileProgress::Phase::Preprocessed))
+		return false;
+
 	int options = 0;
 	if (!featureEnabled(Feature::UniformBlocks))
 		options |= Parser::RemoveUniformBlocks;
 	if (featureEnabled(Feature::FragmentInputs))
 		options |= Parser::SupportsFragmentInputs;
-	bool hasEarlyFragmentTests = featureEnabled(Feature::EarlyFragmentTests);
 
 	if (!parser.parse(output, options))
 		return false;
 
+	std::size_t pipelineCount = parser.getPipelines().size();
+	if (!reportProgress(output, progress, fileName, CompileProgress::Phase::Parsed, std::string(),
+			Stage::Vertex, 0, pipelineCount))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+bool Target::compileParsed(CompiledResult& result, Output& output, const Parser& parser,
+	const std::string& fileName, PipelineCache* cache, CompileProgress* progress,
+	VariantState* variant, SpirVCache* spirvCache) const
+{
 	// Set the target info on the result.
 	if (!result.m_target)
 		result.m_target = this;
@@ -725,14 +1238,22 @@ bool Target::compileImpl(CompiledResult& result, Output& output, Parser& parser,
 		return false;
 	}
 
+	CompileContext context(parser, fileName);
+	context.hasEarlyFragmentTests = featureEnabled(Feature::EarlyFragmentTests);
+	context.dummyBindings = m_dummyBindings || m_adjustableBindings || requiresDummyBindings();
+	context.cache = cache;
+	context.progress = progress;
+	context.variant = variant;
+	context.spirvCache = spirvCache;
+
 	// Read in the resource limits.
-	TBuiltInResource resources = *GetDefaultResources();
+	context.resources = *GetDefaultResources();
 	if (!m_resourcesFile.empty())
 	{
-		std::ifstream stream(m_resourcesFile);
-		if (stream.is_open())
+		std::ifstream resourcesStream(m_resourcesFile);
+		if (resourcesStream.is_open())
 		{
-			if (!decodeResourceLimits(output, resources, stream, m_resourcesFile))
+			if (!decodeResourceLimits(output, context.resources, resourcesStream, m_resourcesFile))
 				return false;
 		}
 		else
@@ -744,41 +1265,48 @@ bool Target::compileImpl(CompiledResult& result, Output& output, Parser& parser,
 	}
 
 	// Compile the pipelines.
-	int processOptions = 0;
+	context.processOptions = 0;
 	if (m_remapVariables)
-		processOptions |= Compiler::RemapVariables;
+		context.processOptions |= Compiler::RemapVariables;
 	switch (m_optimize)
 	{
 		case Optimize::None:
 			break;
 		case Optimize::Minimal:
-			processOptions |= Compiler::DeadCodeElimination;
+			context.processOptions |= Compiler::DeadCodeElimination;
 			break;
 		case Optimize::Full:
-			processOptions |= Compiler::DeadCodeElimination | Compiler::Optimize;
+			context.processOptions |= Compiler::DeadCodeElimination | Compiler::Optimize;
 			break;
 	}
 
-	SpirVProcessor::Strip strip;
 	if (m_stripDebug)
 	{
 		if (needsReflectionNames())
-			strip = SpirVProcessor::Strip::AllButReflection;
+			context.strip = SpirVProcessor::Strip::AllButReflection;
 		else
-			strip = SpirVProcessor::Strip::All;
+			context.strip = SpirVProcessor::Strip::All;
 	}
 	else
-		strip = SpirVProcessor::Strip::None;
+		context.strip = SpirVProcessor::Strip::None;
+
+	// Everything other than the generated GLSL that affects the processed SPIR-V.
+	if (spirvCache)
+	{
+		context.spirvKeyPrefix = std::to_string(getSpirVVersion()) + ' ' +
+			std::to_string(context.processOptions) + ' ' +
+			std::to_string(static_cast<int>(context.strip)) + ' ' +
+			std::to_string(context.dummyBindings) + ' ' + m_resourcesFile + '\0';
+	}
 
 	// Convert the fragment input groups.
 	const std::vector<Parser::FragmentInputGroup>& parsedFragmentInputs =
 		parser.getFragmentInputs();
-	std::vector<compile::FragmentInputGroup> fragmentInputs;
-	fragmentInputs.reserve(fragmentInputs.size());
+	context.fragmentInputs.reserve(parsedFragmentInputs.size());
 	for (const Parser::FragmentInputGroup& parsedInputGroup : parsedFragmentInputs)
 	{
-		fragmentInputs.emplace_back();
-		compile::FragmentInputGroup& inputGroup = fragmentInputs.back();
+		context.fragmentInputs.emplace_back();
+		compile::FragmentInputGroup& inputGroup = context.fragmentInputs.back();
 		inputGroup.type = parsedInputGroup.type;
 		inputGroup.name = parsedInputGroup.name;
 		inputGroup.inputs.reserve(parsedInputGroup.inputs.size());
@@ -792,259 +1320,590 @@ bool Target::compileImpl(CompiledResult& result, Output& output, Parser& parser,
 		}
 	}
 
-	// Compile each of the pipelines.
-	std::vector<char> tempData;
-	std::vector<std::uint8_t> shaderData;
-	std::vector<Parser::LineMapping> lineMappings;
-	for (const Parser::Pipeline& pipeline : parser.getPipelines())
+	// Tool commands that run once for all of the pipelines require each phase to be done for all
+	// pipelines before moving onto the next.
+	std::size_t pipelineCount = parser.getPipelines().size();
+	std::vector<PipelineState> pipelineStates(pipelineCount);
+	if ((m_batchToolCommands && !m_spirVToolCommand.empty()) || needsPostProcessShaders())
+		return compileDeferredPipelines(pipelineStates, result, output, context);
+
+	for (std::size_t i = 0; i < pipelineCount; ++i)
+	{
+		if (progress && progress->isCancelled())
+			return addCancelledError(output, fileName);
+
+		PipelineState& state = pipelineStates[i];
+		if (!preparePipeline(state, result, output, context, i) ||
+			!crossCompilePipeline(state, output, context, i) ||
+			!finishPipeline(state, result, output, context, i))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool Target::compileDeferredPipelines(std::vector<PipelineState>& pipelineStates,
+	CompiledResult& result, Output& output, const CompileContext& context) const
+{
+	for (std::size_t i = 0; i < pipelineStates.size(); ++i)
+	{
+		if (context.progress && context.progress->isCancelled())
+			return addCancelledError(output, context.fileName);
+
+		if (!preparePipeline(pipelineStates[i], result, output, context, i))
+			return false;
+	}
+
+	if (m_batchToolCommands && !m_spirVToolCommand.empty() &&
+		!runBatchSpirVTool(pipelineStates, output, context))
+	{
+		return false;
+	}
+
+	// The shader data is moved to the compiled shaders for processing and moved back afterward.
+	std::vector<CompiledShader> compiledShaders;
+	std::vector<std::vector<std::uint8_t>*> shaderData;
+	for (std::size_t i = 0; i < pipelineStates.size(); ++i)
+	{
+		PipelineState& state = pipelineStates[i];
+		if (!crossCompilePipeline(state, output, context, i))
+			return false;
+
+		if (!state.pipeline || state.reusedEntry)
+			continue;
+
+		const Parser::Pipeline& pipeline = context.parser.getPipelines()[i];
+		for (unsigned int j = 0; j < stageCount; ++j)
+		{
+			if (!state.compiledSpirV->pipelineStages[j])
+				continue;
+
+			const Token& entryPoint = pipeline.entryPoints[j];
+			StageInfo stageInfo = {entryPoint.fileName, entryPoint.line, entryPoint.column,
+				static_cast<Stage>(j), entryPoint.value, state.name};
+			compiledShaders.push_back({stageInfo, std::move(state.shaderData[j])});
+			shaderData.push_back(&state.shaderData[j]);
+		}
+	}
+
+	if (!compiledShaders.empty() && !postProcessShaders(output, compiledShaders))
+		return false;
+
+	for (std::size_t i = 0; i < compiledShaders.size(); ++i)
+		*shaderData[i] = std::move(compiledShaders[i].data);
+
+	for (std::size_t i = 0; i < pipelineStates.size(); ++i)
+	{
+		if (!finishPipeline(pipelineStates[i], result, output, context, i))
+			return false;
+	}
+
+	return true;
+}
+
+bool Target::preparePipeline(PipelineState& state, CompiledResult& result, Output& output,
+	const CompileContext& context, std::size_t pipelineIndex) const
+{
+	const Parser::Pipeline& pipeline = context.parser.getPipelines()[pipelineIndex];
+	state.name = pipeline.name;
+	if (context.variant)
+		state.name += context.variant->suffix;
+
+	// Add the current pipeline to the result. Pipelines that aren't selected are only validated,
+	// so they're never added.
+	bool selected = pipelineSelected(pipeline.name);
+	if (selected)
 	{
-		// Add the current pipeline to the result.
-		auto addPair = result.m_pipelines.emplace(pipeline.name, Pipeline());
+		auto addPair = result.m_pipelines.emplace(state.name, Pipeline());
 		if (!addPair.second)
 		{
-			output.addMessage(Output::Level::Error, pipeline.token->fileName, pipeline.token->line,
-				pipeline.token->column, false, "pipeline already declared: " + pipeline.name);
+			output.addMessage(Output::Level::Error, pipeline.token->fileName,
+				pipeline.token->line, pipeline.token->column, false,
+				"pipeline already declared: " + state.name);
 			output.addMessage(Output::Level::Error, addPair.first->second.file,
 				addPair.first->second.line, addPair.first->second.column, true,
 				"see previous declaration");
 			return false;
 		}
 
-		Pipeline& addedPipeline = addPair.first->second;
-		addedPipeline.file = pipeline.token->fileName;
-		addedPipeline.line = pipeline.token->line;
-		addedPipeline.column = pipeline.token->column;
+		state.pipeline = &addPair.first->second;
+	}
 
-		// Compile the stages.
-		Compiler::Stages stages;
-		for (unsigned int i = 0; i < stageCount; ++i)
-		{
-			auto stage = static_cast<Stage>(i);
-			if (pipeline.entryPoints[i].value.empty())
-				continue;
+	// Generate the GLSL for each stage.
+	PipelineSources sources;
+	for (unsigned int i = 0; i < stageCount; ++i)
+	{
+		auto stage = static_cast<Stage>(i);
+		if (pipeline.entryPoints[i].value.empty())
+			continue;
 
-			std::string glsl = parser.createShaderString(lineMappings, output, pipeline, stage,
-				false, hasEarlyFragmentTests &&
-					pipeline.renderState.earlyFragmentTests == Bool::True);
-			if (glsl.empty())
-				return false;
-			if (!Compiler::compile(stages, output, fileName, glsl, lineMappings, stage, resources,
-					getSpirVVersion()))
-			{
-				return false;
-			}
+		sources.glsl[i] = context.parser.createShaderString(sources.lineMappings[i], output,
+			pipeline, stage, false, context.hasEarlyFragmentTests &&
+				pipeline.renderState.earlyFragmentTests == Bool::True);
+		if (sources.glsl[i].empty())
+			return false;
+	}
+
+	if (!selected)
+		return true;
+
+	// Re-use the previously compiled pipeline if none of the generated inputs changed.
+	if (context.cache || context.variant || context.spirvCache)
+		state.cacheKey = createCacheKey(pipeline, sources.glsl, context.fragmentInputs);
+
+	if (context.cache)
+	{
+		state.cacheEntry = &context.cache->entries[state.name];
+		if (state.cacheEntry->key == state.cacheKey)
+		{
+			state.reusedEntry = state.cacheEntry;
+			return true;
 		}
 
-		// Link the program.
-		Compiler::Program program;
-		if (!Compiler::link(program, output, pipeline, stages))
-			return false;
+		// Invalidate the entry until the pipeline is successfully compiled.
+		state.cacheEntry->key.clear();
+		context.cache->changedPipelines.push_back(state.name);
+	}
 
-		// Compile the stages to SPIR-V.
-		std::array<Compiler::SpirV, stageCount> spirv;
-		std::array<SpirVProcessor, stageCount> processors;
-		for (unsigned int i = 0; i < stageCount; ++i)
+	// Re-use the pipeline from a previous variant if the defines didn't affect it.
+	if (context.variant)
+	{
+		auto foundIt = context.variant->compiledPipelines.find(state.cacheKey);
+		if (foundIt != context.variant->compiledPipelines.end())
 		{
-			auto stage = static_cast<Stage>(i);
-			if (!stages.shaders[i])
-				continue;
+			state.reusedEntry = &foundIt->second;
+			if (state.cacheEntry)
+				*state.cacheEntry = foundIt->second;
+			return true;
+		}
+	}
 
-			// Create SPIR-V.
-			spirv[i] = Compiler::assemble(output, program, stage, pipeline);
-			if (spirv[i].empty())
+	// Re-use the SPIR-V from another target if it was compiled with the same options.
+	state.compiledSpirV = &state.localSpirV;
+	if (context.spirvCache)
+	{
+		std::string spirvKey = context.spirvKeyPrefix + state.cacheKey;
+		auto foundIt = context.spirvCache->entries.find(spirvKey);
+		if (foundIt == context.spirvCache->entries.end())
+		{
+			if (!compileSpirV(state.localSpirV, output, context, pipelineIndex, sources))
 				return false;
 
-			// Process the SPIR-V first so that remapping IDs doesn't mess up our mappings.
-			Compiler::process(spirv[i], processOptions);
-			if (!processors[i].extract(output, pipeline.token->fileName, pipeline.token->line,
-				pipeline.token->column, spirv[i], stage))
-			{
-				return false;
-			}
+			foundIt = context.spirvCache->entries.emplace(std::move(spirvKey),
+				std::move(state.localSpirV)).first;
 		}
+		state.compiledSpirV = &foundIt->second;
+	}
+	else if (!compileSpirV(state.localSpirV, output, context, pipelineIndex, sources))
+		return false;
 
-		// Link the SPIR-V stages and process them.
-		std::array<bool, compile::stageCount> pipelineStages;
-		pipelineStages.fill(false);
-		const SpirVProcessor* lastStage = nullptr;
-		addedPipeline.pushConstantStruct = unknown;
-		for (unsigned int i = 0; i < stageCount; ++i)
+	Pipeline& addedPipeline = *state.pipeline;
+	addedPipeline = state.compiledSpirV->pipeline;
+	addedPipeline.file = pipeline.token->fileName;
+	addedPipeline.line = pipeline.token->line;
+	addedPipeline.column = pipeline.token->column;
+	return true;
+}
+
+bool Target::runBatchSpirVTool(std::vector<PipelineState>& pipelineStates, Output& output,
+	const CompileContext& context) const
+{
+	std::vector<ExecuteCommand::BatchItem> items;
+	std::vector<std::vector<std::uint32_t>*> toolSpirV;
+	for (std::size_t i = 0; i < pipelineStates.size(); ++i)
+	{
+		PipelineState& state = pipelineStates[i];
+		if (!state.pipeline || state.reusedEntry)
+			continue;
+
+		const Parser::Pipeline& pipeline = context.parser.getPipelines()[i];
+		for (unsigned int j = 0; j < stageCount; ++j)
 		{
-			auto stage = static_cast<Stage>(i);
-			if (!stages.shaders[i])
+			if (!state.compiledSpirV->pipelineStages[j])
 				continue;
 
-			// Make sure that the uniforms are compatible.
-			for (unsigned int j = i + 1; j < stageCount; ++j)
-			{
-				if (!stages.shaders[j])
-					continue;
+			const std::vector<std::uint32_t>& spirv = state.compiledSpirV->spirv[j];
+			const Token& entryPoint = pipeline.entryPoints[j];
+			ExecuteCommand::BatchItem item;
+			item.data = spirv.data();
+			item.size = spirv.size()*sizeof(std::uint32_t);
+			item.fileName = entryPoint.fileName;
+			item.line = entryPoint.line;
+			item.column = entryPoint.column;
+			items.push_back(std::move(item));
+			toolSpirV.push_back(&state.toolSpirV[j]);
+		}
+	}
 
-				if (!processors[i].uniformsCompatible(output, processors[j]))
-					return false;
-			}
+	if (items.empty())
+		return true;
 
-			// Outputs
-			if (!processors[i].assignOutputs(output))
-				return false;
+	ExecuteCommand command;
+	command.setCacheDirectory(m_commandCacheDirectory);
+	if (!command.executeBatch(output, m_spirVToolCommand, items))
+		return false;
 
-			// Inputs
-			if (lastStage)
+	for (std::size_t i = 0; i < items.size(); ++i)
+	{
+		const ExecuteCommand::BatchItem& item = items[i];
+		if ((item.output.size() % sizeof(std::uint32_t)) != 0)
+		{
+			output.addMessage(Output::Level::Error, item.fileName, item.line, item.column, false,
+				"command output invalid spir-v: " + m_spirVToolCommand);
+			return false;
+		}
+
+		toolSpirV[i]->resize(item.output.size()/sizeof(std::uint32_t));
+		std::memcpy(toolSpirV[i]->data(), item.output.data(), item.output.size());
+	}
+
+	return true;
+}
+
+bool Target::crossCompilePipeline(PipelineState& state, Output& output,
+	const CompileContext& context, std::size_t pipelineIndex) const
+{
+	if (!state.pipeline || state.reusedEntry)
+		return true;
+
+	const Parser::Pipeline& pipeline = context.parser.getPipelines()[pipelineIndex];
+	Pipeline& addedPipeline = *state.pipeline;
+	const CompiledSpirV& compiledSpirV = *state.compiledSpirV;
+	for (unsigned int i = 0; i < stageCount; ++i)
+	{
+		auto stage = static_cast<Stage>(i);
+		if (!compiledSpirV.pipelineStages[i])
+			continue;
+
+		if (context.progress && context.progress->isCancelled())
+			return addCancelledError(output, context.fileName);
+
+		// Use external command if set. When batching, the command was already run for all stages.
+		const std::vector<std::uint32_t>* spirv = &compiledSpirV.spirv[i];
+		std::vector<std::uint32_t>& toolSpirV = state.toolSpirV[i];
+		if (!m_spirVToolCommand.empty())
+		{
+			if (!m_batchToolCommands)
 			{
-				if (!processors[i].linkInputs(output, *lastStage))
+				ExecuteCommand command;
+				command.setCacheDirectory(m_commandCacheDirectory);
+				command.setInputData(spirv->data(), spirv->size()*sizeof(std::uint32_t));
+				if (!command.execute(output, m_spirVToolCommand))
+					return false;
+
+				const std::vector<char>& tempData = command.getOutputData();
+				if ((tempData.size() % sizeof(std::uint32_t)) != 0)
+				{
+					output.addMessage(Output::Level::Error, context.fileName, 0, 0, false,
+						"command output invalid spir-v: " + m_spirVToolCommand);
 					return false;
+				}
+
+				toolSpirV.resize(tempData.size()/sizeof(std::uint32_t));
+				std::memcpy(toolSpirV.data(), tempData.data(), tempData.size());
 			}
-			else if (stage == Stage::Vertex && !processors[i].assignInputs(output))
+			spirv = &toolSpirV;
+		}
+
+		const Token& entryPoint = pipeline.entryPoints[i];
+		if (m_spirVTransform)
+		{
+			// The compiled SPIR-V may be shared, so always transform a copy.
+			if (spirv != &toolSpirV)
+				toolSpirV = *spirv;
+
+			StageInfo stageInfo = {entryPoint.fileName, entryPoint.line, entryPoint.column, stage,
+				entryPoint.value, state.name};
+			if (!m_spirVTransform(toolSpirV, output, stageInfo))
 				return false;
 
-			// Add uniforms.
-			addUniforms(addedPipeline, stage, processors[i], fragmentInputs);
-			if (addedPipeline.pushConstantStruct == unknown &&
-				processors[i].pushConstantStruct != unknown)
-			{
-				addedPipeline.pushConstantStruct = addStruct(addedPipeline, processors[i].structs,
-					processors[i].structs[processors[i].pushConstantStruct]);
-			}
+			spirv = &toolSpirV;
+		}
+
+		if (!crossCompile(state.shaderData[i], output, state.name, entryPoint.fileName,
+				entryPoint.line, entryPoint.column, compiledSpirV.pipelineStages, stage, *spirv,
+				entryPoint.value, addedPipeline.uniforms, addedPipeline.shaders[i].uniformIds,
+				context.fragmentInputs, pipeline.renderState.fragmentGroup))
+		{
+			return false;
+		}
 
-			// Proces the SPIR-V.
-			spirv[i] = processors[i].process(strip, m_dummyBindings || m_adjustableBindings);
-			lastStage = &processors[i];
-			pipelineStages[i] = true;
+		// The SPIR-V is no longer needed.
+		toolSpirV = std::vector<std::uint32_t>();
 
-			if (stage == Stage::Compute)
-				addedPipeline.computeLocalSize = processors[i].computeLocalSize;
+		if (!reportProgress(output, context.progress, context.fileName,
+				CompileProgress::Phase::StageCompiled, state.name, stage, pipelineIndex,
+				context.parser.getPipelines().size()))
+		{
+			return false;
 		}
+	}
+
+	return true;
+}
+
+bool Target::finishPipeline(PipelineState& state, CompiledResult& result, Output& output,
+	const CompileContext& context, std::size_t pipelineIndex) const
+{
+	if (!state.pipeline)
+		return true;
+
+	const Parser::Pipeline& pipeline = context.parser.getPipelines()[pipelineIndex];
+	Pipeline& addedPipeline = *state.pipeline;
+	if (context.variant)
+	{
+		std::vector<std::string>& variantPipelines = result.m_variants[pipeline.name];
+		variantPipelines.resize(context.variant->permutationCount);
+		variantPipelines[context.variant->permutation] = state.name;
+	}
 
-		// Make sure all of the uniform ID vectors are the same size.
+	if (state.reusedEntry)
+	{
+		const PipelineCache::Entry& entry = *state.reusedEntry;
+		addedPipeline = entry.pipeline;
 		for (unsigned int i = 0; i < stageCount; ++i)
 		{
-			if (!stages.shaders[i])
+			if (addedPipeline.shaders[i].shader == noShader)
 				continue;
 
-			assert(addedPipeline.shaders[i].uniformIds.size() <= addedPipeline.uniforms.size());
-			addedPipeline.shaders[i].uniformIds.resize(addedPipeline.uniforms.size(), unknown);
+			const CompiledResult::ShaderData& shader = entry.shaders[i];
+			addedPipeline.shaders[i].shader = result.addShader(shader.data,
+				shader.usesPushConstants, m_adjustableBindings);
 		}
 
-		// Add vertex attributes.
-		if (stages.shaders[static_cast<unsigned int>(Stage::Vertex)])
+		addedPipeline.file = pipeline.token->fileName;
+		addedPipeline.line = pipeline.token->line;
+		addedPipeline.column = pipeline.token->column;
+		setPipelineStates(addedPipeline, pipeline, context.parser.getSamplers(),
+			entry.clipDistanceCount, entry.cullDistanceCount);
+	}
+	else
+		addCompiledShaders(state, result, context, pipelineIndex);
+
+	return reportProgress(output, context.progress, context.fileName,
+		CompileProgress::Phase::PipelineCompiled, state.name, Stage::Vertex, pipelineIndex,
+		context.parser.getPipelines().size());
+}
+
+void Target::addCompiledShaders(PipelineState& state, CompiledResult& result,
+	const CompileContext& context, std::size_t pipelineIndex) const
+{
+	const Parser::Pipeline& pipeline = context.parser.getPipelines()[pipelineIndex];
+	Pipeline& addedPipeline = *state.pipeline;
+	const CompiledSpirV& compiledSpirV = *state.compiledSpirV;
+	PipelineCache::Entry compiledEntry;
+	bool storeEntry = state.cacheEntry || context.variant;
+	for (unsigned int i = 0; i < stageCount; ++i)
+	{
+		if (!compiledSpirV.pipelineStages[i])
 		{
-			const SpirVProcessor& vertexProcessor =
-				processors[static_cast<unsigned int>(Stage::Vertex)];
-			const Token& entryPoint =
-				pipeline.entryPoints[static_cast<unsigned int>(Stage::Fragment)];
-			addedPipeline.attributes.resize(vertexProcessor.inputs.size());
-			for (std::size_t i = 0; i < vertexProcessor.inputs.size(); ++i)
-			{
-				addedPipeline.attributes[i].name = vertexProcessor.inputs[i].name;
-				if (vertexProcessor.inputs[i].type == Type::Struct)
-				{
-					output.addMessage(Output::Level::Error, entryPoint.fileName,
-						entryPoint.line, entryPoint.column, false,
-						"linker error: vertex inputs may not use interface blocks");
-					return false;
-				}
-				addedPipeline.attributes[i].type = vertexProcessor.inputs[i].type;
-				addedPipeline.attributes[i].arrayElements = vertexProcessor.inputs[i].arrayElements;
-				addedPipeline.attributes[i].location = vertexProcessor.inputs[i].location;
-				addedPipeline.attributes[i].component = vertexProcessor.inputs[i].component;
-			}
+			addedPipeline.shaders[i].shader = noShader;
+			continue;
 		}
 
-		// Add fragment outputs.
-		if (stages.shaders[static_cast<unsigned int>(Stage::Fragment)])
+		bool usesPushConstants = compiledSpirV.usesPushConstants[i];
+		if (storeEntry)
 		{
-			const SpirVProcessor& fragmentProcessor =
-				processors[static_cast<unsigned int>(Stage::Fragment)];
-			const Token& entryPoint =
-				pipeline.entryPoints[static_cast<unsigned int>(Stage::Fragment)];
-			addedPipeline.fragmentOutputs.resize(fragmentProcessor.outputs.size());
-			for (std::size_t i = 0; i < fragmentProcessor.outputs.size(); ++i)
-			{
-				addedPipeline.fragmentOutputs[i].name = fragmentProcessor.outputs[i].name;
-				if (fragmentProcessor.outputs[i].type == Type::Struct)
-				{
-					output.addMessage(Output::Level::Error, entryPoint.fileName,
-						entryPoint.line, entryPoint.column, false,
-						"linker error: fragment outputs may not use interface blocks");
-					return false;
-				}
-				addedPipeline.fragmentOutputs[i].location = fragmentProcessor.outputs[i].location;
-			}
+			compiledEntry.shaders[i].data = state.shaderData[i];
+			compiledEntry.shaders[i].usesPushConstants = usesPushConstants;
 		}
 
-		// Cross-compile the stages.
-		for (unsigned int i = 0; i < stageCount; ++i)
+		addedPipeline.shaders[i].shader = result.addShader(std::move(state.shaderData[i]),
+			usesPushConstants, m_adjustableBindings);
+	}
+
+	if (storeEntry)
+	{
+		compiledEntry.key = state.cacheKey;
+		compiledEntry.pipeline = addedPipeline;
+		compiledEntry.clipDistanceCount = compiledSpirV.clipDistanceCount;
+		compiledEntry.cullDistanceCount = compiledSpirV.cullDistanceCount;
+		if (context.variant)
 		{
-			auto stage = static_cast<Stage>(i);
-			if (!stages.shaders[i])
-			{
-				addedPipeline.shaders[i].shader = noShader;
-				continue;
-			}
+			if (state.cacheEntry)
+				*state.cacheEntry = compiledEntry;
+			context.variant->compiledPipelines.emplace(std::move(state.cacheKey),
+				std::move(compiledEntry));
+		}
+		else
+			*state.cacheEntry = std::move(compiledEntry);
+	}
 
-			// Use external command if set.
-			if (!m_spirVToolCommand.empty())
-			{
-				ExecuteCommand command;
-				command.getInput().write(reinterpret_cast<const char*>(spirv[i].data()),
-					spirv[i].size()*sizeof(std::uint32_t));
-				if (!command.execute(output, m_spirVToolCommand))
-					return false;
+	setPipelineStates(addedPipeline, pipeline, context.parser.getSamplers(),
+		compiledSpirV.clipDistanceCount, compiledSpirV.cullDistanceCount);
+}
 
-				tempData.assign(std::istreambuf_iterator<char>(command.getOutput().rdbuf()),
-					std::istreambuf_iterator<char>());
-				if ((tempData.size() % sizeof(std::uint32_t)) != 0)
-				{
-					output.addMessage(Output::Level::Error, fileName, 0, 0, false,
-						"command output invalid spir-v: " + m_spirVToolCommand);
-					return false;
-				}
+bool Target::compileSpirV(CompiledSpirV& compiled, Output& output,
+	const CompileContext& context, std::size_t pipelineIndex, const PipelineSources& sources) const
+{
+	const Parser::Pipeline& pipeline = context.parser.getPipelines()[pipelineIndex];
+	Pipeline& addedPipeline = compiled.pipeline;
 
-				spirv[i].reserve(tempData.size()/sizeof(std::uint32_t));
-				std::memcpy(spirv[i].data(), tempData.data(), tempData.size());
-			}
+	// Compile the stages.
+	Compiler::Stages stages;
+	for (unsigned int i = 0; i < stageCount; ++i)
+	{
+		auto stage = static_cast<Stage>(i);
+		if (sources.glsl[i].empty())
+			continue;
 
-			shaderData.clear();
-			const Token& entryPoint = pipeline.entryPoints[i];
-			if (!crossCompile(shaderData, output, entryPoint.fileName, entryPoint.line,
-					entryPoint.column, pipelineStages, stage, spirv[i], entryPoint.value,
-					addedPipeline.uniforms, addedPipeline.shaders[i].uniformIds, fragmentInputs,
-					pipeline.renderState.fragmentGroup))
-			{
-				return false;
-			}
+		if (context.progress && context.progress->isCancelled())
+			return addCancelledError(output, context.fileName);
 
-			addedPipeline.shaders[i].shader = result.addShader(std::move(shaderData),
-				processors[i].pushConstantStruct != unknown, m_adjustableBindings);
+		if (!Compiler::compile(stages, output, context.fileName, sources.glsl[i],
+				sources.lineMappings[i], stage, context.resources, getSpirVVersion()))
+		{
+			return false;
 		}
+	}
+
+	// Link the program.
+	Compiler::Program program;
+	if (!Compiler::link(program, output, pipeline, stages))
+		return false;
+
+	// Compile the stages to SPIR-V.
+	std::array<Compiler::SpirV, stageCount>& spirv = compiled.spirv;
+	std::array<SpirVProcessor, stageCount> processors;
+	for (unsigned int i = 0; i < stageCount; ++i)
+	{
+		auto stage = static_cast<Stage>(i);
+		if (!stages.shaders[i])
+			continue;
+
+		// Create SPIR-V.
+		spirv[i] = Compiler::assemble(output, program, stage, pipeline);
+		if (spirv[i].empty())
+			return false;
 
-		// Set the render and sampler states.
-		addedPipeline.renderState = pipeline.renderState;
-		for (const SpirVProcessor& processor : processors)
+		// Process the SPIR-V first so that remapping IDs doesn't mess up our mappings.
+		Compiler::process(spirv[i], context.processOptions);
+		if (!processors[i].extract(output, pipeline.token->fileName, pipeline.token->line,
+			pipeline.token->column, spirv[i], stage))
 		{
-			addedPipeline.renderState.clipDistanceCount = std::max(
-				addedPipeline.renderState.clipDistanceCount, processor.clipDistanceCount);
-			addedPipeline.renderState.cullDistanceCount = std::max(
-				addedPipeline.renderState.cullDistanceCount, processor.cullDistanceCount);
+			return false;
 		}
-		for (std::size_t i = 0; i < addedPipeline.uniforms.size(); ++i)
+	}
+
+	// Link the SPIR-V stages and process them.
+	const SpirVProcessor* lastStage = nullptr;
+	addedPipeline.pushConstantStruct = unknown;
+	for (unsigned int i = 0; i < stageCount; ++i)
+	{
+		auto stage = static_cast<Stage>(i);
+		if (!stages.shaders[i])
+			continue;
+
+		// Make sure that the uniforms are compatible.
+		for (unsigned int j = i + 1; j < stageCount; ++j)
 		{
-			if (addedPipeline.uniforms[i].uniformType != UniformType::SampledImage)
+			if (!stages.shaders[j])
 				continue;
 
-			const std::vector<Parser::Sampler>& samplers = parser.getSamplers();
-			for (std::size_t j = 0; j < samplers.size(); ++j)
+			if (!processors[i].uniformsCompatible(output, processors[j]))
+				return false;
+		}
+
+		// Outputs
+		if (!processors[i].assignOutputs(output))
+			return false;
+
+		// Inputs
+		if (lastStage)
+		{
+			if (!processors[i].linkInputs(output, *lastStage))
+				return false;
+		}
+		else if (stage == Stage::Vertex && !processors[i].assignInputs(output))
+			return false;
+
+		// Add uniforms.
+		addUniforms(addedPipeline, stage, processors[i], context.fragmentInputs);
+		addSpecializationConstants(addedPipeline, processors[i]);
+		if (addedPipeline.pushConstantStruct == unknown &&
+			processors[i].pushConstantStruct != unknown)
+		{
+			addedPipeline.pushConstantStruct = addStruct(addedPipeline, processors[i].structs,
+				processors[i].structs[processors[i].pushConstantStruct]);
+		}
+
+		// Proces the SPIR-V.
+		spirv[i] = processors[i].process(context.strip, context.dummyBindings);
+		lastStage = &processors[i];
+		compiled.usesPushConstants[i] = processors[i].pushConstantStruct != unknown;
+		compiled.pipelineStages[i] = true;
+
+		if (stage == Stage::Compute)
+			addedPipeline.computeLocalSize = processors[i].computeLocalSize;
+	}
+
+	// Make sure all of the uniform ID vectors are the same size.
+	for (unsigned int i = 0; i < stageCount; ++i)
+	{
+		if (!stages.shaders[i])
+			continue;
+
+		assert(addedPipeline.shaders[i].uniformIds.size() <= addedPipeline.uniforms.size());
+		addedPipeline.shaders[i].uniformIds.resize(addedPipeline.uniforms.size(), unknown);
+	}
+
+	// Add vertex attributes.
+	if (stages.shaders[static_cast<unsigned int>(Stage::Vertex)])
+	{
+		const SpirVProcessor& vertexProcessor =
+			processors[static_cast<unsigned int>(Stage::Vertex)];
+		const Token& entryPoint =
+			pipeline.entryPoints[static_cast<unsigned int>(Stage::Fragment)];
+		addedPipeline.attributes.resize(vertexProcessor.inputs.size());
+		for (std::size_t i = 0; i < vertexProcessor.inputs.size(); ++i)
+		{
+			addedPipeline.attributes[i].name = vertexProcessor.inputs[i].name;
+			if (vertexProcessor.inputs[i].type == Type::Struct)
 			{
-				if (samplers[j].name == addedPipeline.uniforms[i].name)
-				{
-					addedPipeline.uniforms[i].samplerIndex = addSampler(addedPipeline,
-						samplers[j].state);
-					break;
-				}
+				output.addMessage(Output::Level::Error, entryPoint.fileName,
+					entryPoint.line, entryPoint.column, false,
+					"linker error: vertex inputs may not use interface blocks");
+				return false;
 			}
+			addedPipeline.attributes[i].type = vertexProcessor.inputs[i].type;
+			addedPipeline.attributes[i].arrayElements = vertexProcessor.inputs[i].arrayElements;
+			addedPipeline.attributes[i].location = vertexProcessor.inputs[i].location;
+			addedPipeline.attributes[i].component = vertexProcessor.inputs[i].component;
 		}
 	}
 
+	// Add fragment outputs.
+	if (stages.shaders[static_cast<unsigned int>(Stage::Fragment)])
+	{
+		const SpirVProcessor& fragmentProcessor =
+			processors[static_cast<unsigned int>(Stage::Fragment)];
+		const Token& entryPoint =
+			pipeline.entryPoints[static_cast<unsigned int>(Stage::Fragment)];
+		addedPipeline.fragmentOutputs.resize(fragmentProcessor.outputs.size());
+		for (std::size_t i = 0; i < fragmentProcessor.outputs.size(); ++i)
+		{
+			addedPipeline.fragmentOutputs[i].name = fragmentProcessor.outputs[i].name;
+			if (fragmentProcessor.outputs[i].type == Type::Struct)
+			{
+				output.addMessage(Output::Level::Error, entryPoint.fileName,
+					entryPoint.line, entryPoint.column, false,
+					"linker error: fragment outputs may not use interface blocks");
+				return false;
+			}
+			addedPipeline.fragmentOutputs[i].location = fragmentProcessor.outputs[i].location;
+		}
+	}
+
+	for (const SpirVProcessor& processor : processors)
+	{
+		compiled.clipDistanceCount = std::max(compiled.clipDistanceCount,
+			processor.clipDistanceCount);
+		compiled.cullDistanceCount = std::max(compiled.cullDistanceCount,
+			processor.cullDistanceCount);
+	}
+
 	return true;
 }
 
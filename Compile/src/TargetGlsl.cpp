@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2025 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -18,6 +18,7 @@
 #include <MSL/Compile/Output.h>
 #include "ExecuteCommand.h"
 #include "GlslOutput.h"
+#include <algorithm>
 #include <sstream>
 
 namespace msl
@@ -123,6 +124,16 @@ void TargetGlsl::setGlslToolCommand(Stage stage, std::string command)
 	m_glslToolCommand[static_cast<std::size_t>(stage)] = std::move(command);
 }
 
+const TargetGlsl::GlslTransform& TargetGlsl::getGlslTransform() const
+{
+	return m_glslTransform;
+}
+
+void TargetGlsl::setGlslTransform(GlslTransform transform)
+{
+	m_glslTransform = std::move(transform);
+}
+
 std::uint32_t TargetGlsl::getId() const
 {
 	if (m_es)
@@ -343,11 +354,11 @@ std::uint32_t TargetGlsl::getSpirVVersion() const
 }
 
 bool TargetGlsl::crossCompile(std::vector<std::uint8_t>& data, Output& output,
-	const std::string& fileName, std::size_t line, std::size_t column,
+	const std::string& pipeline, const std::string& fileName, std::size_t line, std::size_t column,
 	const std::array<bool, compile::stageCount>&, Stage stage,
-	const std::vector<std::uint32_t>& spirv, const std::string&,
+	const std::vector<std::uint32_t>& spirv, const std::string& entryPoint,
 	const std::vector<compile::Uniform>&, std::vector<std::uint32_t>&,
-	const std::vector<compile::FragmentInputGroup>&, std::uint32_t)
+	const std::vector<compile::FragmentInputGroup>&, std::uint32_t) const
 {
 	std::size_t stageIndex = static_cast<std::size_t>(stage);
 
@@ -360,18 +371,24 @@ bool TargetGlsl::crossCompile(std::vector<std::uint8_t>& data, Output& output,
 	options.headerLines = m_headerLines[stageIndex];
 	options.requiredExtensions = m_requiredExtensions[stageIndex];
 	std::string glsl = GlslOutput::disassemble(output, spirv, options, fileName, line, column);
+	if (m_glslTransform && !glsl.empty())
+	{
+		StageInfo stageInfo = {fileName, line, column, stage, entryPoint, pipeline};
+		if (!m_glslTransform(glsl, output, stageInfo))
+			return false;
+	}
 	data.assign(glsl.begin(), glsl.end());
 
-	// Use external command if set.
-	if (!m_glslToolCommand[stageIndex].empty() && !data.empty())
+	// Use external command if set. When batching, this is run from postProcessShaders().
+	if (!m_glslToolCommand[stageIndex].empty() && !data.empty() && !getBatchToolCommands())
 	{
 		ExecuteCommand command;
-		command.getInput().write(reinterpret_cast<const char*>(data.data()), data.size());
+		command.setCacheDirectory(getCommandCacheDirectory());
+		command.setInputData(glsl.data(), glsl.size());
 		if (!command.execute(output, m_glslToolCommand[stageIndex]))
 			return false;
 
-		data.assign(std::istreambuf_iterator<char>(command.getOutput().rdbuf()),
-			std::istreambuf_iterator<char>());
+		data.assign(command.getOutputData().begin(), command.getOutputData().end());
 	}
 
 	// Add null terminator so it can be used as a string.
@@ -381,4 +398,60 @@ bool TargetGlsl::crossCompile(std::vector<std::uint8_t>& data, Output& output,
 	return !data.empty();
 }
 
+bool TargetGlsl::needsPostProcessShaders() const
+{
+	if (!getBatchToolCommands())
+		return false;
+
+	return std::any_of(m_glslToolCommand.begin(), m_glslToolCommand.end(),
+		[](const std::string& command) {return !command.empty();});
+}
+
+bool TargetGlsl::postProcessShaders(Output& output, std::vector<CompiledShader>& shaders) const
+{
+	if (!getBatchToolCommands())
+		return true;
+
+	for (unsigned int i = 0; i < compile::stageCount; ++i)
+	{
+		const std::string& toolCommand = m_glslToolCommand[i];
+		if (toolCommand.empty())
+			continue;
+
+		// Run the command once for all shaders of this stage, excluding the null terminator.
+		std::vector<ExecuteCommand::BatchItem> items;
+		std::vector<std::vector<std::uint8_t>*> itemData;
+		for (CompiledShader& shader : shaders)
+		{
+			if (shader.stageInfo.stage != static_cast<Stage>(i) || shader.data.empty())
+				continue;
+
+			ExecuteCommand::BatchItem item;
+			item.data = shader.data.data();
+			item.size = shader.data.size() - 1;
+			item.fileName = shader.stageInfo.fileName;
+			item.line = shader.stageInfo.line;
+			item.column = shader.stageInfo.column;
+			items.push_back(std::move(item));
+			itemData.push_back(&shader.data);
+		}
+
+		if (items.empty())
+			continue;
+
+		ExecuteCommand command;
+		command.setCacheDirectory(getCommandCacheDirectory());
+		if (!command.executeBatch(output, toolCommand, items))
+			return false;
+
+		for (std::size_t j = 0; j < items.size(); ++j)
+		{
+			itemData[j]->assign(items[j].output.begin(), items[j].output.end());
+			itemData[j]->push_back(0);
+		}
+	}
+
+	return true;
+}
+
 } // namespace msl
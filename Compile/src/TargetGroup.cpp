@@ -0,0 +1,153 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <MSL/Compile/TargetGroup.h>
+#include <MSL/Compile/Target.h>
+#include "Parser.h"
+#include "PipelineCache.h"
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <utility>
+
+namespace msl
+{
+
+void TargetGroup::addTarget(const Target& target)
+{
+	m_targets.push_back(&target);
+}
+
+std::size_t TargetGroup::getTargetCount() const
+{
+	return m_targets.size();
+}
+
+const Target& TargetGroup::getTarget(std::size_t index) const
+{
+	assert(index < m_targets.size());
+	return *m_targets[index];
+}
+
+void TargetGroup::clearTargets()
+{
+	m_targets.clear();
+}
+
+bool TargetGroup::compile(std::vector<CompiledResult>& results, Output& output,
+	const std::string& fileName, CompileProgress* progress) const
+{
+	return compileImpl(results, output, nullptr, fileName, progress);
+}
+
+bool TargetGroup::compile(std::vector<CompiledResult>& results, Output& output,
+	std::istream& stream, const std::string& fileName, CompileProgress* progress) const
+{
+	return compileImpl(results, output, &stream, fileName, progress);
+}
+
+bool TargetGroup::finish(std::vector<CompiledResult>& results, Output& output) const
+{
+	assert(results.size() == m_targets.size());
+	bool success = true;
+	for (std::size_t i = 0; i < m_targets.size(); ++i)
+	{
+		if (!m_targets[i]->finish(results[i], output))
+			success = false;
+	}
+
+	return success;
+}
+
+bool TargetGroup::compileImpl(std::vector<CompiledResult>& results, Output& output,
+	std::istream* stream, const std::string& fileName, CompileProgress* progress) const
+{
+	if (results.size() != m_targets.size())
+		results.resize(m_targets.size());
+
+	// Group the targets that can share the parsed source, preserving the original order.
+	std::vector<std::pair<std::string, std::vector<std::size_t>>> frontEndGroups;
+	for (std::size_t i = 0; i < m_targets.size(); ++i)
+	{
+		const Target& target = *m_targets[i];
+		if (!target.getVariantKeywords().empty())
+		{
+			frontEndGroups.emplace_back(std::string(), std::vector<std::size_t>{i});
+			continue;
+		}
+
+		std::string key = target.getFrontEndKey();
+		auto foundIt = frontEndGroups.begin();
+		for (; foundIt != frontEndGroups.end(); ++foundIt)
+		{
+			if (foundIt->first == key &&
+				m_targets[foundIt->second.front()]->getVariantKeywords().empty())
+			{
+				break;
+			}
+		}
+
+		if (foundIt == frontEndGroups.end())
+			frontEndGroups.emplace_back(std::move(key), std::vector<std::size_t>{i});
+		else
+			foundIt->second.push_back(i);
+	}
+
+	// Read the stream once so it may be re-used for each group.
+	std::string source;
+	if (stream)
+		source.assign(std::istreambuf_iterator<char>(*stream), std::istreambuf_iterator<char>());
+
+	SpirVCache spirvCache;
+	for (const auto& group : frontEndGroups)
+	{
+		std::unique_ptr<std::istringstream> groupStream;
+		if (stream)
+			groupStream.reset(new std::istringstream(source));
+
+		const Target& firstTarget = *m_targets[group.second.front()];
+		if (group.second.size() == 1)
+		{
+			if (!firstTarget.compileImpl(results[group.second.front()], output, groupStream.get(),
+					fileName, nullptr, progress, &spirvCache))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		Parser parser;
+		if (!firstTarget.preprocessAndParse(parser, output, groupStream.get(), fileName, progress,
+				nullptr))
+		{
+			return false;
+		}
+
+		for (std::size_t index : group.second)
+		{
+			if (!m_targets[index]->compileParsed(results[index], output, parser, fileName,
+					nullptr, progress, nullptr, &spirvCache))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+} // namespace msl
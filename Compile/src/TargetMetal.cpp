@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2025 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -19,9 +19,13 @@
 #include "ExecuteCommand.h"
 #include "MetalOutput.h"
 #include <spirv/unified1/spirv.hpp>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdio>
 #include <fstream>
 #include <sstream>
+#include <thread>
 
 #if MSL_GCC || MSL_CLANG
 #pragma GCC diagnostic push
@@ -87,7 +91,8 @@ static void setBinding(
 
 static std::vector<std::uint32_t> setBindingIndices(const std::vector<std::uint32_t>& spirv,
 	const std::vector<Uniform>& uniforms, std::vector<std::uint32_t>& uniformIds,
-	bool& hasPushConstant, std::uint32_t& bufferCount, std::uint32_t& textureCount)
+	bool& hasPushConstant, std::uint32_t& bufferCount, std::uint32_t& textureCount,
+	std::vector<MetalOutput::ArgumentBinding>* argumentBindings)
 {
 	std::vector<std::uint32_t> adjustedSpirv = spirv;
 
@@ -101,6 +106,52 @@ static std::vector<std::uint32_t> setBindingIndices(const std::vector<std::uint3
 		}
 	}
 
+	// All resources are placed in descriptor set 0 for the argument buffer. The uniform IDs are
+	// the IDs within the argument buffer, where sampled images use the following ID for the
+	// sampler.
+	if (argumentBindings)
+	{
+		std::uint32_t argumentId = 0;
+		for (std::size_t i = 0; i < uniforms.size(); ++i)
+		{
+			if (uniformIds[i] == unknown)
+				continue;
+
+			if (uniforms[i].uniformType == UniformType::PushConstant)
+			{
+				uniformIds[i] = 0;
+				continue;
+			}
+
+			MetalOutput::ArgumentBinding binding = {static_cast<std::uint32_t>(
+				argumentBindings->size()), unknown, unknown, unknown};
+			setBinding(adjustedSpirv, uniformIds[i], 0, binding.binding);
+			uniformIds[i] = argumentId;
+			switch (uniforms[i].uniformType)
+			{
+				case UniformType::PushConstant:
+					break;
+				case UniformType::Block:
+				case UniformType::BlockBuffer:
+					binding.bufferId = argumentId++;
+					break;
+				case UniformType::Image:
+				case UniformType::SubpassInput:
+					binding.textureId = argumentId++;
+					break;
+				case UniformType::SampledImage:
+					binding.textureId = argumentId++;
+					binding.samplerId = argumentId++;
+					break;
+			}
+			argumentBindings->push_back(binding);
+		}
+
+		bufferCount = hasPushConstant + 1;
+		textureCount = 0;
+		return adjustedSpirv;
+	}
+
 	std::uint32_t bufferIndex = hasPushConstant;
 	std::uint32_t textureIndex = 0;
 	for (std::size_t i = 0; i < uniforms.size(); ++i)
@@ -215,9 +266,53 @@ static std::string patchFragmentInputs(const std::string& metal,
 	return result;
 }
 
+// Stable hash so the function names are the same across platforms.
+static std::string hashSource(const std::string& source)
+{
+	std::uint64_t hash = 0xCBF29CE484222325ULL;
+	for (char c : source)
+	{
+		hash ^= static_cast<std::uint8_t>(c);
+		hash *= 0x100000001B3ULL;
+	}
+
+	char hashStr[17];
+	std::snprintf(hashStr, sizeof(hashStr), "%016llx", static_cast<unsigned long long>(hash));
+	return hashStr;
+}
+
+// The function name is stored before the source or object with a null terminator.
+static std::size_t findNameEnd(const std::vector<std::uint8_t>& data)
+{
+	return std::find(data.begin(), data.end(), 0) - data.begin();
+}
+
+template <typename Func>
+static void runParallel(std::size_t count, Func&& func)
+{
+	std::size_t threadCount = std::min<std::size_t>(
+		std::max(std::thread::hardware_concurrency(), 1U), count);
+	std::atomic<std::size_t> nextIndex(0);
+	auto worker = [&]()
+	{
+		for (std::size_t i = nextIndex++; i < count; i = nextIndex++)
+			func(i);
+	};
+
+	std::vector<std::thread> threads;
+	for (std::size_t i = 1; i < threadCount; ++i)
+		threads.emplace_back(worker);
+	worker();
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
 TargetMetal::TargetMetal(std::uint32_t version, Platform platform)
 	: m_version(version)
 	, m_platform(platform)
+	, m_sharedLibrary(false)
+	, m_sourceOnly(false)
+	, m_argumentBuffers(false)
 {
 }
 
@@ -230,6 +325,46 @@ TargetMetal::Platform TargetMetal::getPlatform() const
 	return m_platform;
 }
 
+const std::string& TargetMetal::getToolchainCommand() const
+{
+	return m_toolchainCommand;
+}
+
+void TargetMetal::setToolchainCommand(std::string command)
+{
+	m_toolchainCommand = std::move(command);
+}
+
+bool TargetMetal::getSharedLibrary() const
+{
+	return m_sharedLibrary;
+}
+
+void TargetMetal::setSharedLibrary(bool shared)
+{
+	m_sharedLibrary = shared;
+}
+
+bool TargetMetal::getSourceOnly() const
+{
+	return m_sourceOnly;
+}
+
+void TargetMetal::setSourceOnly(bool sourceOnly)
+{
+	m_sourceOnly = sourceOnly;
+}
+
+bool TargetMetal::getArgumentBuffers() const
+{
+	return m_argumentBuffers;
+}
+
+void TargetMetal::setArgumentBuffers(bool argumentBuffers)
+{
+	m_argumentBuffers = argumentBuffers;
+}
+
 std::uint32_t TargetMetal::getId() const
 {
 	if (m_platform == Platform::MacOS)
@@ -280,6 +415,15 @@ std::vector<std::pair<std::string, std::string>> TargetMetal::getExtraDefines()
 	return defines;
 }
 
+compile::ShaderDataFormat TargetMetal::getShaderDataFormat() const
+{
+	if (m_sourceOnly)
+		return compile::ShaderDataFormat::Source;
+	else if (m_sharedLibrary)
+		return compile::ShaderDataFormat::LibraryFunction;
+	return compile::ShaderDataFormat::Native;
+}
+
 std::uint32_t TargetMetal::getSpirVVersion() const
 {
 	// SPV_EXT_demote_to_helper_invocation is core with SPIRV 1.6 and breaks discard operations
@@ -289,91 +433,189 @@ std::uint32_t TargetMetal::getSpirVVersion() const
 	return spv::Version;
 }
 
-void TargetMetal::willCompile()
+bool TargetMetal::requiresDummyBindings() const
 {
 	// Need dummy bindings for internal usage.
-	setDummyBindings(true);
+	return true;
 }
 
 bool TargetMetal::compileMetal(
-	std::vector<std::uint8_t>& data, Output& output, const std::string& metal)
+	std::vector<std::uint8_t>& data, Output& output, const std::string& metal) const
 {
-	// Compile this entry point.
-	std::stringstream versionStr;
-	if (m_platform != Platform::MacOS)
-		versionStr << "-std=ios-metal";
-	else
-		versionStr << "-std=macos-metal";
-	versionStr << m_version/100 << '.' << m_version % 100;
-
-	std::string extraOptions;
-	if (!getStripDebug())
-		extraOptions += " -gline-tables-only -MO";
-
-	// The output sometimes contains warnings that we can't control or make sense of in the final
-	// generated output.
-	extraOptions += " -w";
-
-	ExecuteCommand compile(".metal");
-	compile.getInput().write(metal.data(), metal.size());
-	if (!compile.execute(output, "xcrun -sdk " + getSDK() + " metal -c $input " + versionStr.str() +
-		" -o $output" + extraOptions))
-	{
+	std::vector<std::uint8_t> air;
+	if (!compileAir(air, output, metal))
 		return false;
-	}
 
 	ExecuteCommand archive;
-	archive.getInput() << compile.getOutput().rdbuf();
-	if (!archive.execute(output, "xcrun -sdk " + getSDK() + " metal-ar rcs $output $input"))
+	archive.setCacheDirectory(getCommandCacheDirectory());
+	archive.setInputData(air.data(), air.size());
+	if (!archive.execute(output, getToolchainPrefix() + " metal-ar rcs $output $input"))
 		return false;
 
 	ExecuteCommand createLib;
-	createLib.getInput() << archive.getOutput().rdbuf();
-	if (!createLib.execute(output, "xcrun -sdk " + getSDK() + " metallib $input -o $output"))
+	createLib.setCacheDirectory(getCommandCacheDirectory());
+	createLib.setInputData(archive.getOutputData().data(), archive.getOutputData().size());
+	if (!createLib.execute(output, getToolchainPrefix() + " metallib $input -o $output"))
 		return false;
 
-	data.assign(std::istreambuf_iterator<char>(createLib.getOutput().rdbuf()),
-		std::istreambuf_iterator<char>());
+	data.assign(createLib.getOutputData().begin(), createLib.getOutputData().end());
 	return true;
 }
 
 bool TargetMetal::crossCompile(std::vector<std::uint8_t>& data, Output& output,
-	const std::string& fileName, std::size_t line, std::size_t column,
+	const std::string&, const std::string& fileName, std::size_t line, std::size_t column,
 	const std::array<bool, compile::stageCount>& pipelineStages, compile::Stage stage,
 	const std::vector<std::uint32_t>& spirv, const std::string& entryPoint,
 	const std::vector<compile::Uniform>& uniforms, std::vector<std::uint32_t>& uniformIds,
 	const std::vector<compile::FragmentInputGroup>& fragmentInputs,
-	std::uint32_t fragmentGroup)
+	std::uint32_t fragmentGroup) const
 {
 	bool outputToBuffer = stage == Stage::Vertex &&
 		(pipelineStages[static_cast<int>(Stage::TessellationControl)] ||
 			pipelineStages[static_cast<int>(Stage::TessellationEvaluation)]);
 
+	if (m_argumentBuffers && m_version < 200)
+	{
+		output.addMessage(Output::Level::Error, fileName, line, column, false,
+			"argument buffers require Metal 2.0 or later");
+		return false;
+	}
+
 	bool hasPushConstant;
 	std::uint32_t bufferCount, textureCount;
+	std::vector<MetalOutput::ArgumentBinding> argumentBindings;
 	std::vector<std::uint32_t> adjustedSpirv = setBindingIndices(spirv, uniforms, uniformIds,
-		hasPushConstant, bufferCount, textureCount);
+		hasPushConstant, bufferCount, textureCount,
+		m_argumentBuffers ? &argumentBindings : nullptr);
 
 	bool ios = m_platform != Platform::MacOS;
 	std::string metal = MetalOutput::disassemble(output, adjustedSpirv, stage, m_version, ios,
-		outputToBuffer, hasPushConstant, bufferCount, textureCount, fileName, line, column);
+		outputToBuffer, hasPushConstant, bufferCount, textureCount,
+		m_argumentBuffers ? &argumentBindings : nullptr, fileName, line, column);
 	if (metal.empty())
 		return false;
 
-	// Set the entry point back to its original value. The function main0 was set by SPIRV-Cross.
-	boost::algorithm::replace_all(metal, "main0", entryPoint);
-
-	// Need to patch the generated Metal source code when using frament inputs.
+	// Need to patch the generated Metal source code when using frament inputs. The function main0
+	// was set by SPIRV-Cross.
 	if (stage == Stage::Fragment && featureEnabled(Feature::FragmentInputs))
 	{
 		if (fragmentGroup != unknown)
-			metal = setFragmentGroup(metal, entryPoint, fragmentGroup);
+			metal = setFragmentGroup(metal, "main0", fragmentGroup);
 
 		for (const FragmentInputGroup& inputGroup : fragmentInputs)
 			metal = patchFragmentInputs(metal, inputGroup);
 	}
 
-	return compileMetal(data, output, metal);
+	if (m_sourceOnly)
+	{
+		// Add null terminator so it can be used as a string.
+		boost::algorithm::replace_all(metal, "main0", entryPoint);
+		data.assign(metal.begin(), metal.end());
+		data.push_back(0);
+		return true;
+	}
+
+	if (!m_sharedLibrary)
+	{
+		// Set the entry point back to its original value.
+		boost::algorithm::replace_all(metal, "main0", entryPoint);
+		return compileMetal(data, output, metal);
+	}
+
+	// Function names must be unique within the shared library, so add a hash of the source. The
+	// source is compiled in postProcessShaders() so the shaders can be compiled in parallel.
+	std::string functionName = entryPoint + '_' + hashSource(metal);
+	boost::algorithm::replace_all(metal, "main0", functionName);
+	data.assign(functionName.begin(), functionName.end());
+	data.push_back(0);
+	data.insert(data.end(), metal.begin(), metal.end());
+	return true;
+}
+
+bool TargetMetal::needsPostProcessShaders() const
+{
+	return m_sharedLibrary && !m_sourceOnly;
+}
+
+bool TargetMetal::postProcessShaders(Output& output, std::vector<CompiledShader>& shaders) const
+{
+	if (!m_sharedLibrary || m_sourceOnly)
+		return true;
+
+	// Output isn't thread-safe, so collect the messages for each shader separately.
+	std::vector<Output> shaderOutputs(shaders.size());
+	std::vector<char> succeeded(shaders.size(), false);
+	runParallel(shaders.size(), [&](std::size_t i)
+		{
+			std::vector<std::uint8_t>& data = shaders[i].data;
+			std::size_t nameEnd = findNameEnd(data);
+			std::string metal(data.begin() + nameEnd + 1, data.end());
+			std::vector<std::uint8_t> air;
+			if (!compileAir(air, shaderOutputs[i], metal))
+				return;
+
+			data.resize(nameEnd + 1);
+			data.insert(data.end(), air.begin(), air.end());
+			succeeded[i] = true;
+		});
+
+	for (Output& shaderOutput : shaderOutputs)
+		output.append(std::move(shaderOutput));
+	return std::find(succeeded.begin(), succeeded.end(), false) == succeeded.end();
+}
+
+bool TargetMetal::linkShaders(std::vector<CompiledResult::ShaderData>& shaders,
+	std::vector<std::uint8_t>& sharedData, Output& output) const
+{
+	if (!m_sharedLibrary || m_sourceOnly || shaders.empty())
+		return true;
+
+	boost::filesystem::path tempDir = boost::filesystem::temp_directory_path()/
+		boost::filesystem::unique_path();
+	boost::system::error_code error;
+	if (!boost::filesystem::create_directories(tempDir, error))
+	{
+		output.addMessage(Output::Level::Error, "", 0, 0, false,
+			"could not create temporary directory for Metal library");
+		return false;
+	}
+
+	// Link all of the compiled objects into a single library.
+	std::string command = getToolchainPrefix() + " metallib";
+	bool written = true;
+	for (std::size_t i = 0; i < shaders.size() && written; ++i)
+	{
+		const std::vector<std::uint8_t>& data = shaders[i].data;
+		std::size_t nameEnd = findNameEnd(data);
+		std::string airPath = (tempDir/(std::to_string(i) + ".air")).string();
+		std::ofstream stream(airPath, std::ios_base::trunc | std::ios_base::binary);
+		if (nameEnd < data.size())
+		{
+			stream.write(reinterpret_cast<const char*>(data.data() + nameEnd + 1),
+				static_cast<std::streamsize>(data.size() - nameEnd - 1));
+		}
+		written = static_cast<bool>(stream);
+		command += ' ' + airPath;
+	}
+	command += " -o $output";
+
+	bool linked = false;
+	ExecuteCommand createLib;
+	if (!written)
+	{
+		output.addMessage(Output::Level::Error, "", 0, 0, false,
+			"could not write temporary file for Metal library");
+	}
+	else
+		linked = createLib.execute(output, command);
+	boost::filesystem::remove_all(tempDir, error);
+	if (!linked)
+		return false;
+
+	sharedData.assign(createLib.getOutputData().begin(), createLib.getOutputData().end());
+	for (CompiledResult::ShaderData& shader : shaders)
+		shader.data.resize(findNameEnd(shader.data) + 1);
+	return true;
 }
 
 std::string TargetMetal::getSDK() const
@@ -390,4 +632,47 @@ std::string TargetMetal::getSDK() const
 	return "";
 }
 
+std::string TargetMetal::getToolchainPrefix() const
+{
+	if (!m_toolchainCommand.empty())
+		return m_toolchainCommand;
+
+	return "xcrun -sdk " + getSDK();
+}
+
+std::string TargetMetal::getVersionOption() const
+{
+	std::stringstream versionStr;
+	if (m_platform != Platform::MacOS)
+		versionStr << "-std=ios-metal";
+	else
+		versionStr << "-std=macos-metal";
+	versionStr << m_version/100 << '.' << m_version % 100;
+	return versionStr.str();
+}
+
+bool TargetMetal::compileAir(std::vector<std::uint8_t>& data, Output& output,
+	const std::string& metal) const
+{
+	std::string extraOptions;
+	if (!getStripDebug())
+		extraOptions += " -gline-tables-only -MO";
+
+	// The output sometimes contains warnings that we can't control or make sense of in the final
+	// generated output.
+	extraOptions += " -w";
+
+	ExecuteCommand compile(".metal");
+	compile.setCacheDirectory(getCommandCacheDirectory());
+	compile.setInputData(metal.data(), metal.size());
+	if (!compile.execute(output, getToolchainPrefix() + " metal -c $input " +
+			getVersionOption() + " -o $output" + extraOptions))
+	{
+		return false;
+	}
+
+	data.assign(compile.getOutputData().begin(), compile.getOutputData().end());
+	return true;
+}
+
 } // namespace msl
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <MSL/Compile/CompileSession.h>
+#include <MSL/Compile/Output.h>
+#include <MSL/Compile/TargetSpirV.h>
+#include <gtest/gtest.h>
+#include <sstream>
+
+namespace msl
+{
+
+using namespace compile;
+
+static std::string createSource(const std::string& secondColor, bool thirdPipeline)
+{
+	std::string source =
+		"[[fragment]] out vec4 color;\n"
+		"[[vertex]]\n"
+		"void vertShader()\n"
+		"{\n"
+		"	gl_Position = vec4(0.0);\n"
+		"}\n"
+		"[[fragment]]\n"
+		"void firstFrag()\n"
+		"{\n"
+		"	color = vec4(1.0);\n"
+		"}\n"
+		"[[fragment]]\n"
+		"void secondFrag()\n"
+		"{\n"
+		"	color = " + secondColor + ";\n"
+		"}\n"
+		"pipeline First\n"
+		"{\n"
+		"	vertex = vertShader;\n"
+		"	fragment = firstFrag;\n"
+		"}\n"
+		"pipeline Second\n"
+		"{\n"
+		"	vertex = vertShader;\n"
+		"	fragment = secondFrag;\n"
+		"}\n";
+	if (thirdPipeline)
+	{
+		source +=
+			"pipeline Third\n"
+			"{\n"
+			"	vertex = vertShader;\n"
+			"	fragment = firstFrag;\n"
+			"	cull_mode = back;\n"
+			"}\n";
+	}
+	return source;
+}
+
+static bool compileSource(CompileSession& session, Output& output, const std::string& source)
+{
+	std::istringstream stream(source);
+	return session.compile(output, stream, "test.msl");
+}
+
+TEST(CompileSessionTest, RecompileChangedPipelines)
+{
+	TargetSpirV target(0x10000);
+	CompileSession session(target);
+
+	Output output;
+	EXPECT_TRUE(compileSource(session, output, createSource("vec4(0.0)", false)));
+	EXPECT_EQ(0U, output.getMessages().size());
+	EXPECT_EQ((std::vector<std::string>{"First", "Second"}), session.getChangedPipelines());
+	EXPECT_TRUE(session.getRemovedPipelines().empty());
+	EXPECT_EQ(2U, session.getResult().getPipelines().size());
+	std::vector<CompiledResult::ShaderData> firstShaders = session.getResult().getShaders();
+
+	// Nothing changed.
+	EXPECT_TRUE(compileSource(session, output, createSource("vec4(0.0)", false)));
+	EXPECT_TRUE(session.getChangedPipelines().empty());
+	EXPECT_TRUE(session.getRemovedPipelines().empty());
+	ASSERT_EQ(firstShaders.size(), session.getResult().getShaders().size());
+	for (std::size_t i = 0; i < firstShaders.size(); ++i)
+		EXPECT_EQ(firstShaders[i].data, session.getResult().getShaders()[i].data);
+
+	// Only the second pipeline uses the changed function.
+	EXPECT_TRUE(compileSource(session, output, createSource("vec4(0.5)", true)));
+	EXPECT_EQ((std::vector<std::string>{"Second", "Third"}), session.getChangedPipelines());
+	EXPECT_TRUE(session.getRemovedPipelines().empty());
+	ASSERT_EQ(3U, session.getResult().getPipelines().size());
+
+	auto thirdPipeline = session.getResult().getPipelines().find("Third");
+	ASSERT_NE(session.getResult().getPipelines().end(), thirdPipeline);
+	EXPECT_EQ(CullMode::Back, thirdPipeline->second.renderState.rasterizationState.cullMode);
+
+	// Compile errors keep the previous result and changes.
+	EXPECT_FALSE(compileSource(session, output, createSource("asdf", true)));
+	EXPECT_LT(0U, output.getErrorCount());
+	EXPECT_EQ(3U, session.getResult().getPipelines().size());
+	EXPECT_EQ((std::vector<std::string>{"Second", "Third"}), session.getChangedPipelines());
+
+	// Pipelines compiled before an error are still compared against the previous result.
+	std::string brokenPipeline =
+		"[[fragment]]\n"
+		"void brokenFrag()\n"
+		"{\n"
+		"	color = asdf;\n"
+		"}\n"
+		"pipeline Broken\n"
+		"{\n"
+		"	vertex = vertShader;\n"
+		"	fragment = brokenFrag;\n"
+		"}\n";
+	output.clear();
+	EXPECT_FALSE(compileSource(session, output,
+		createSource("vec4(0.25)", true) + brokenPipeline));
+	EXPECT_LT(0U, output.getErrorCount());
+	EXPECT_EQ(3U, session.getResult().getPipelines().size());
+
+	output.clear();
+	EXPECT_TRUE(compileSource(session, output, createSource("vec4(0.25)", false)));
+	EXPECT_EQ((std::vector<std::string>{"Second"}), session.getChangedPipelines());
+	EXPECT_EQ((std::vector<std::string>{"Third"}), session.getRemovedPipelines());
+	EXPECT_EQ(2U, session.getResult().getPipelines().size());
+
+	session.reset();
+	EXPECT_TRUE(compileSource(session, output, createSource("vec4(0.5)", false)));
+	EXPECT_EQ((std::vector<std::string>{"First", "Second"}), session.getChangedPipelines());
+}
+
+} // namespace msl
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Helpers.h"
+#include <MSL/Compile/CompileTask.h>
+#include <MSL/Compile/TargetSpirV.h>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+
+namespace msl
+{
+
+using namespace compile;
+
+TEST(CompileTaskTest, ProgressEvents)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"CompleteShader.msl");
+
+	TargetSpirV target(0x10000);
+	target.addIncludePath(inputDir.string());
+
+	std::vector<CompileProgress::Event> events;
+	CompileTask task(target, shaderName,
+		[&events](const CompileProgress::Event& event) {events.push_back(event);});
+	EXPECT_TRUE(task.wait());
+	EXPECT_TRUE(task.isReady());
+	EXPECT_FALSE(task.isCancelled());
+	EXPECT_EQ(0U, task.getOutput().getErrorCount());
+	EXPECT_EQ(1U, task.getResult().getPipelines().size());
+
+	ASSERT_EQ(5U, events.size());
+	EXPECT_EQ(CompileProgress::Phase::Preprocessed, events[0].phase);
+
+	EXPECT_EQ(CompileProgress::Phase::Parsed, events[1].phase);
+	EXPECT_EQ(1U, events[1].pipelineCount);
+
+	EXPECT_EQ(CompileProgress::Phase::StageCompiled, events[2].phase);
+	EXPECT_EQ("Test", events[2].pipeline);
+	EXPECT_EQ(Stage::Vertex, events[2].stage);
+
+	EXPECT_EQ(CompileProgress::Phase::StageCompiled, events[3].phase);
+	EXPECT_EQ("Test", events[3].pipeline);
+	EXPECT_EQ(Stage::Fragment, events[3].stage);
+
+	EXPECT_EQ(CompileProgress::Phase::PipelineCompiled, events[4].phase);
+	EXPECT_EQ("Test", events[4].pipeline);
+	EXPECT_EQ(0U, events[4].pipelineIndex);
+	EXPECT_EQ(1U, events[4].pipelineCount);
+}
+
+TEST(CompileTaskTest, ProgressEventsPerPipeline)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"CompleteShader.msl");
+
+	TargetSpirV target(0x10000);
+	target.addIncludePath(inputDir.string());
+
+	// Each pipeline is reported as soon as it's compiled rather than after all pipelines.
+	std::unique_ptr<std::istream> stream(new std::stringstream(readFile(shaderName) +
+		"\npipeline Test2\n{\n\tvertex = vertShader;\n\tfragment = fragShader;\n}\n"));
+	std::vector<CompileProgress::Event> events;
+	CompileTask task(target, std::move(stream), shaderName,
+		[&events](const CompileProgress::Event& event) {events.push_back(event);});
+	EXPECT_TRUE(task.wait());
+	EXPECT_EQ(2U, task.getResult().getPipelines().size());
+
+	ASSERT_EQ(8U, events.size());
+	EXPECT_EQ(CompileProgress::Phase::Preprocessed, events[0].phase);
+	EXPECT_EQ(CompileProgress::Phase::Parsed, events[1].phase);
+	for (unsigned int i = 0; i < 2; ++i)
+	{
+		const char* pipelineName = i == 0 ? "Test" : "Test2";
+		EXPECT_EQ(CompileProgress::Phase::StageCompiled, events[2 + i*3].phase);
+		EXPECT_EQ(pipelineName, events[2 + i*3].pipeline);
+		EXPECT_EQ(CompileProgress::Phase::StageCompiled, events[3 + i*3].phase);
+		EXPECT_EQ(pipelineName, events[3 + i*3].pipeline);
+		EXPECT_EQ(CompileProgress::Phase::PipelineCompiled, events[4 + i*3].phase);
+		EXPECT_EQ(pipelineName, events[4 + i*3].pipeline);
+		EXPECT_EQ(i, events[4 + i*3].pipelineIndex);
+	}
+}
+
+TEST(CompileTaskTest, Stream)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"CompleteShader.msl");
+
+	TargetSpirV target(0x10000);
+	target.addIncludePath(inputDir.string());
+
+	std::unique_ptr<std::istream> stream(new std::stringstream(readFile(shaderName)));
+	CompileTask task(target, std::move(stream), shaderName);
+	EXPECT_TRUE(task.wait());
+	EXPECT_EQ(1U, task.getResult().getPipelines().size());
+}
+
+TEST(CompileTaskTest, Cancel)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"CompleteShader.msl");
+
+	TargetSpirV target(0x10000);
+	target.addIncludePath(inputDir.string());
+
+	std::vector<CompileProgress::Event> events;
+	CompileTask* taskPtr = nullptr;
+	std::promise<void> started;
+	std::shared_future<void> startedFuture = started.get_future().share();
+	CompileTask task(target, shaderName,
+		[&](const CompileProgress::Event& event)
+		{
+			// Wait until the task pointer is available on the main thread.
+			startedFuture.wait();
+			events.push_back(event);
+			if (event.phase == CompileProgress::Phase::Parsed)
+				taskPtr->cancel();
+		});
+	taskPtr = &task;
+	started.set_value();
+
+	EXPECT_FALSE(task.wait());
+	EXPECT_TRUE(task.isCancelled());
+	EXPECT_TRUE(task.getResult().getPipelines().empty());
+	ASSERT_EQ(2U, events.size());
+	EXPECT_EQ(CompileProgress::Phase::Parsed, events.back().phase);
+
+	const std::vector<Output::Message>& messages = task.getOutput().getMessages();
+	ASSERT_EQ(1U, messages.size());
+	EXPECT_EQ(Output::Level::Error, messages[0].level);
+	EXPECT_EQ("compilation cancelled", messages[0].message);
+}
+
+TEST(CompileTaskTest, CancelSynchronous)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"CompleteShader.msl");
+
+	TargetSpirV target(0x10000);
+	target.addIncludePath(inputDir.string());
+
+	CompileProgress progress;
+	progress.cancel();
+
+	Output output;
+	CompiledResult result;
+	EXPECT_FALSE(target.compile(result, output, shaderName, &progress));
+	EXPECT_EQ(1U, output.getErrorCount());
+}
+
+} // namespace msl
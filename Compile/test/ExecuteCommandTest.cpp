@@ -1,5 +1,5 @@
 /*
- * Copyright 2016 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,7 +17,12 @@
 #include "ExecuteCommand.h"
 #include <MSL/Compile/Output.h>
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem.hpp>
 #include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace msl
 {
@@ -48,6 +53,316 @@ TEST(ExecuteCommandTest, InputToOutput)
 		output.getMessages()[0].message);
 }
 
+TEST(ExecuteCommandTest, Pipes)
+{
+	Output output;
+	ExecuteCommand command;
+	std::string input = "testing 123";
+	command.setInputData(input.data(), input.size());
+	EXPECT_TRUE(command.execute(output, "tr a-z A-Z"));
+	EXPECT_EQ("TESTING 123", std::string(command.getOutputData().begin(),
+		command.getOutputData().end()));
+	EXPECT_TRUE(output.empty());
+}
+
+TEST(ExecuteCommandTest, LargePipes)
+{
+	// Larger than the pipe buffers to make sure reading and writing don't block each other.
+	Output output;
+	ExecuteCommand command;
+	std::string input(1024*1024, 'a');
+	command.setInputData(input.data(), input.size());
+	EXPECT_TRUE(command.execute(output, "cat"));
+	EXPECT_EQ(input.size(), command.getOutputData().size());
+	EXPECT_TRUE(output.empty());
+}
+
+TEST(ExecuteCommandTest, ConcurrentPipes)
+{
+	// Commands on other threads must not inherit the pipes, otherwise they won't see the end of
+	// their input until the other commands exit.
+	const unsigned int threadCount = 8;
+	const unsigned int iterations = 4;
+	// Not std::vector<bool> since each thread writes its own element.
+	std::vector<char> results(threadCount);
+	std::vector<std::thread> threads;
+	for (unsigned int i = 0; i < threadCount; ++i)
+	{
+		threads.emplace_back([i, &results]()
+			{
+				std::string input(256*1024, static_cast<char>('a' + i));
+				bool success = true;
+				for (unsigned int j = 0; j < iterations; ++j)
+				{
+					Output output;
+					ExecuteCommand command;
+					command.setInputData(input.data(), input.size());
+					success = success && command.execute(output, "cat") &&
+						std::string(command.getOutputData().begin(),
+							command.getOutputData().end()) == input;
+				}
+				results[i] = success;
+			});
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
+	for (unsigned int i = 0; i < threadCount; ++i)
+		EXPECT_TRUE(results[i]) << "thread " << i;
+}
+
+TEST(ExecuteCommandTest, InputFileToPipe)
+{
+	Output output;
+	ExecuteCommand command;
+	command.getInput() << "testing 123";
+	EXPECT_TRUE(command.execute(output, "cat $input"));
+	std::string outputStr(std::istreambuf_iterator<char>(command.getOutput().rdbuf()),
+		std::istreambuf_iterator<char>());
+	EXPECT_EQ("testing 123", outputStr);
+	EXPECT_TRUE(output.empty());
+}
+
+TEST(ExecuteCommandTest, EnvironmentVariables)
+{
+	// Variables other than $input and $output are expanded by the shell.
+	Output output;
+	ExecuteCommand command;
+	EXPECT_TRUE(command.execute(output, "printf testing$MSL_EXECUTE_COMMAND_UNSET"));
+	EXPECT_EQ("testing", std::string(command.getOutputData().begin(),
+		command.getOutputData().end()));
+	EXPECT_TRUE(output.empty());
+}
+
+TEST(ExecuteCommandTest, EnvironmentAssignment)
+{
+	Output output;
+	ExecuteCommand command;
+	EXPECT_TRUE(command.execute(output,
+		"MSL_EXECUTE_COMMAND_TEST=testing printenv MSL_EXECUTE_COMMAND_TEST"));
+	EXPECT_EQ("testing\n", std::string(command.getOutputData().begin(),
+		command.getOutputData().end()));
+	EXPECT_TRUE(output.empty());
+}
+
+TEST(ExecuteCommandTest, Cache)
+{
+	boost::filesystem::path tempDir = boost::filesystem::temp_directory_path()/
+		boost::filesystem::unique_path();
+	std::string cacheDir = (tempDir/"cache").string();
+	std::string countFile = (tempDir/"count").string();
+	boost::filesystem::create_directories(tempDir);
+
+	// Count the number of times the command was actually run.
+	std::string commandStr = "sh -c 'echo run >> " + countFile + "; echo note >&2; cat'";
+	auto runCount = [&countFile]()
+	{
+		std::ifstream stream(countFile);
+		std::string line;
+		unsigned int count = 0;
+		while (std::getline(stream, line))
+			++count;
+		return count;
+	};
+
+	for (unsigned int i = 0; i < 2; ++i)
+	{
+		Output output;
+		ExecuteCommand command;
+		command.setCacheDirectory(cacheDir);
+		command.getInput() << "testing 123";
+		EXPECT_TRUE(command.execute(output, commandStr));
+		EXPECT_EQ("testing 123", std::string(command.getOutputData().begin(),
+			command.getOutputData().end()));
+		ASSERT_EQ(1U, output.getMessages().size());
+		EXPECT_EQ("output from running command: " + commandStr + "\nnote",
+			output.getMessages()[0].message);
+		EXPECT_EQ(1U, runCount());
+	}
+
+	Output output;
+	ExecuteCommand command;
+	command.setCacheDirectory(cacheDir);
+	command.getInput() << "testing 456";
+	EXPECT_TRUE(command.execute(output, commandStr));
+	EXPECT_EQ("testing 456", std::string(command.getOutputData().begin(),
+		command.getOutputData().end()));
+	EXPECT_EQ(2U, runCount());
+
+	boost::filesystem::remove_all(tempDir);
+}
+
+TEST(ExecuteCommandTest, ErrorOutput)
+{
+	Output output;
+	ExecuteCommand command;
+	EXPECT_FALSE(command.execute(output, "sh -c 'echo failed >&2; exit 3'"));
+	ASSERT_EQ(2U, output.getMessages().size());
+	EXPECT_EQ("output from running command: sh -c 'echo failed >&2; exit 3'\nfailed",
+		output.getMessages()[0].message);
+	EXPECT_EQ("command failed with exit code 3: sh -c 'echo failed >&2; exit 3'",
+		output.getMessages()[1].message);
+}
+
+TEST(ExecuteCommandTest, Batch)
+{
+	std::string input1 = "testing 123";
+	std::string input2 = "testing 456";
+	std::vector<ExecuteCommand::BatchItem> items(2);
+	items[0].data = input1.data();
+	items[0].size = input1.size();
+	items[1].data = input2.data();
+	items[1].size = input2.size();
+
+	Output output;
+	ExecuteCommand command;
+	EXPECT_TRUE(command.executeBatch(output,
+		"while read -r in out; do tr a-z A-Z < \"$in\" > \"$out\"; done", items));
+	EXPECT_TRUE(output.getMessages().empty());
+	EXPECT_EQ("TESTING 123", std::string(items[0].output.begin(), items[0].output.end()));
+	EXPECT_EQ("TESTING 456", std::string(items[1].output.begin(), items[1].output.end()));
+
+	EXPECT_TRUE(command.executeBatch(output,
+		"while read -r in out; do rev < \"$in\" > \"$out\"; done < $manifest", items));
+	EXPECT_TRUE(output.getMessages().empty());
+	EXPECT_EQ("321 gnitset", std::string(items[0].output.begin(), items[0].output.end()));
+	EXPECT_EQ("654 gnitset", std::string(items[1].output.begin(), items[1].output.end()));
+}
+
+TEST(ExecuteCommandTest, BatchCache)
+{
+	boost::filesystem::path tempDir = boost::filesystem::temp_directory_path()/
+		boost::filesystem::unique_path();
+	std::string cacheDir = (tempDir/"cache").string();
+	std::string countFile = (tempDir/"count").string();
+	boost::filesystem::create_directories(tempDir);
+
+	// Count the number of items the command was actually run for.
+	std::string commandStr = "while read -r in out; do echo run >> " + countFile +
+		"; tr a-z A-Z < \"$in\" > \"$out\"; done";
+	auto runCount = [&countFile]()
+	{
+		std::ifstream stream(countFile);
+		std::string line;
+		unsigned int count = 0;
+		while (std::getline(stream, line))
+			++count;
+		return count;
+	};
+
+	std::string input1 = "testing 123";
+	std::string input2 = "testing 456";
+	std::vector<ExecuteCommand::BatchItem> items(2);
+	items[0].data = input1.data();
+	items[0].size = input1.size();
+	items[1].data = input2.data();
+	items[1].size = input2.size();
+	for (unsigned int i = 0; i < 2; ++i)
+	{
+		Output output;
+		ExecuteCommand command;
+		command.setCacheDirectory(cacheDir);
+		EXPECT_TRUE(command.executeBatch(output, commandStr, items));
+		EXPECT_TRUE(output.getMessages().empty());
+		EXPECT_EQ("TESTING 123", std::string(items[0].output.begin(), items[0].output.end()));
+		EXPECT_EQ("TESTING 456", std::string(items[1].output.begin(), items[1].output.end()));
+		EXPECT_EQ(2U, runCount());
+	}
+
+	// Only the changed item is run.
+	std::string input3 = "testing 789";
+	items[1].data = input3.data();
+	items[1].size = input3.size();
+	Output output;
+	ExecuteCommand command;
+	command.setCacheDirectory(cacheDir);
+	EXPECT_TRUE(command.executeBatch(output, commandStr, items));
+	EXPECT_EQ("TESTING 123", std::string(items[0].output.begin(), items[0].output.end()));
+	EXPECT_EQ("TESTING 789", std::string(items[1].output.begin(), items[1].output.end()));
+	EXPECT_EQ(3U, runCount());
+
+	boost::filesystem::remove_all(tempDir);
+}
+
+TEST(ExecuteCommandTest, BatchErrors)
+{
+	std::string input = "testing";
+	std::vector<ExecuteCommand::BatchItem> items(2);
+	for (std::size_t i = 0; i < items.size(); ++i)
+	{
+		items[i].data = input.data();
+		items[i].size = input.size();
+		items[i].fileName = "test.msl";
+		items[i].line = i + 1;
+		items[i].column = 2;
+	}
+
+	// Only the first item reports a problem and skips writing its output.
+	std::string commandStr = "while read -r in out; do case \"$in\" in */0) echo \"$in: bad\";; "
+		"*) cp \"$in\" \"$out\";; esac; done";
+	Output output;
+	ExecuteCommand command;
+	EXPECT_FALSE(command.executeBatch(output, commandStr, items));
+	EXPECT_EQ("testing", std::string(items[1].output.begin(), items[1].output.end()));
+
+	const std::vector<Output::Message>& messages = output.getMessages();
+	ASSERT_EQ(2U, messages.size());
+	EXPECT_EQ(Output::Level::Info, messages[0].level);
+	EXPECT_EQ(1U, messages[0].line);
+	EXPECT_TRUE(boost::algorithm::starts_with(messages[0].message,
+		"output from running command: " + commandStr + "\n"));
+	EXPECT_TRUE(boost::algorithm::ends_with(messages[0].message, "0: bad"));
+
+	EXPECT_EQ(Output::Level::Error, messages[1].level);
+	EXPECT_EQ("test.msl", messages[1].file);
+	EXPECT_EQ(1U, messages[1].line);
+	EXPECT_EQ(2U, messages[1].column);
+	EXPECT_EQ("command didn't write output: " + commandStr, messages[1].message);
+}
+
+TEST(ExecuteCommandTest, BatchFailure)
+{
+	std::string input = "testing";
+	std::vector<ExecuteCommand::BatchItem> items(3);
+	for (std::size_t i = 0; i < items.size(); ++i)
+	{
+		items[i].data = input.data();
+		items[i].size = input.size();
+		items[i].fileName = "test.msl";
+		items[i].line = i + 1;
+		items[i].column = 2;
+	}
+
+	// The failure is reported for the item the output references.
+	std::string commandStr = "while read -r in out; do case \"$in\" in */1) echo \"$in: bad\"; "
+		"exit 1;; *) cp \"$in\" \"$out\";; esac; done";
+	Output output;
+	ExecuteCommand command;
+	EXPECT_FALSE(command.executeBatch(output, commandStr, items));
+
+	const std::vector<Output::Message>& messages = output.getMessages();
+	ASSERT_EQ(2U, messages.size());
+	EXPECT_EQ(Output::Level::Info, messages[0].level);
+	EXPECT_EQ(2U, messages[0].line);
+	EXPECT_TRUE(boost::algorithm::ends_with(messages[0].message, "1: bad"));
+
+	EXPECT_EQ(Output::Level::Error, messages[1].level);
+	EXPECT_EQ("test.msl", messages[1].file);
+	EXPECT_EQ(2U, messages[1].line);
+	EXPECT_EQ(2U, messages[1].column);
+	EXPECT_TRUE(boost::algorithm::starts_with(messages[1].message,
+		"command failed with exit code 1: "));
+
+	// Without output to attribute the failure to, a single error is reported.
+	output.clear();
+	EXPECT_FALSE(command.executeBatch(output, "cat > /dev/null; exit 2", items));
+	ASSERT_EQ(1U, output.getMessages().size());
+	EXPECT_EQ(Output::Level::Error, output.getMessages()[0].level);
+	EXPECT_TRUE(output.getMessages()[0].file.empty());
+	EXPECT_EQ("command failed with exit code 2: cat > /dev/null; exit 2",
+		output.getMessages()[0].message);
+}
+
 #endif
 
 } // namespace msl
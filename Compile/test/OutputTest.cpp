@@ -1,5 +1,5 @@
 /*
- * Copyright 2016 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -16,6 +16,8 @@
 
 #include <MSL/Compile/Output.h>
 #include <gtest/gtest.h>
+#include <string>
+#include <vector>
 
 namespace msl
 {
@@ -69,6 +71,69 @@ TEST(OutputTest, CountWarningsErrors)
 
 	EXPECT_EQ(4U, output.getWarningCount());
 	EXPECT_EQ(2U, output.getErrorCount());
+
+	output.clear();
+	EXPECT_EQ(0U, output.getWarningCount());
+	EXPECT_EQ(0U, output.getErrorCount());
+}
+
+TEST(OutputTest, Callback)
+{
+	std::vector<std::string> messages;
+	Output output([&messages](const Output::Message& message)
+		{
+			messages.push_back(message.message);
+		});
+	output.addMessage(Output::Level::Warning, "test1", 1, 2, false, "message 1");
+	output.addMessage(Output::Level::Error, "test2", 3, 4, true, "message 2");
+
+	EXPECT_TRUE(output.empty());
+	EXPECT_EQ(1U, output.getWarningCount());
+	ASSERT_EQ(2U, messages.size());
+	EXPECT_EQ("message 1", messages[0]);
+	EXPECT_EQ("message 2", messages[1]);
+}
+
+TEST(OutputTest, MinLevel)
+{
+	Output output;
+	output.setMinLevel(Output::Level::Error);
+	output.addMessage(Output::Level::Info, "test1", 1, 2, false, "info");
+	output.addMessage(Output::Level::Warning, "test1", 1, 2, false, "warning");
+	output.addMessage(Output::Level::Info, "test1", 1, 2, true, "warning note");
+	output.addMessage(Output::Level::Error, "test1", 1, 2, false, "error");
+	output.addMessage(Output::Level::Info, "test1", 1, 2, true, "error note");
+
+	const std::vector<Output::Message>& messages = output.getMessages();
+	ASSERT_EQ(2U, messages.size());
+	EXPECT_EQ("error", messages[0].message);
+	EXPECT_EQ("error note", messages[1].message);
+	EXPECT_EQ(1U, output.getWarningCount());
+	EXPECT_EQ(1U, output.getErrorCount());
+}
+
+TEST(OutputTest, Append)
+{
+	Output first;
+	first.addMessage(Output::Level::Warning, "test1", 1, 2, false, "warning 1");
+
+	Output second;
+	second.setMinLevel(Output::Level::Error);
+	second.addMessage(Output::Level::Warning, "test2", 3, 4, false, "warning 2");
+	second.addMessage(Output::Level::Error, "test2", 5, 6, false, "error 1");
+
+	Output output;
+	output.append(std::move(first));
+	output.append(std::move(second));
+	EXPECT_TRUE(first.empty());
+	EXPECT_TRUE(second.empty());
+
+	const std::vector<Output::Message>& messages = output.getMessages();
+	ASSERT_EQ(2U, messages.size());
+	EXPECT_EQ("warning 1", messages[0].message);
+	EXPECT_EQ("error 1", messages[1].message);
+	EXPECT_EQ(2U, output.getWarningCount());
+	EXPECT_EQ(1U, output.getErrorCount());
 }
 
 } // namespace msl
@@ -2739,6 +2739,125 @@ TEST_F(SpirVProcessorTest, ClipAndCullDistances)
 	EXPECT_EQ(4U, vertexProcessor.cullDistanceCount);
 }
 
+TEST_F(SpirVProcessorTest, SpecializationConstants)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"SpecializationConstants.msl");
+
+	Parser parser;
+	Preprocessor preprocessor;
+	Output output;
+	EXPECT_TRUE(preprocessor.preprocess(parser.getTokens(), output, shaderName));
+	EXPECT_TRUE(parser.parse(output));
+
+	ASSERT_EQ(1U, parser.getPipelines().size());
+	const Parser::Pipeline& pipeline = parser.getPipelines()[0];
+	Compiler::Stages stages;
+	bool compiledStage = false;
+	for (unsigned int i = 0; i < stageCount; ++i)
+	{
+		if (pipeline.entryPoints[i].value.empty())
+			continue;
+
+		auto stage = static_cast<Stage>(i);
+		std::vector<Parser::LineMapping> lineMappings;
+		std::string glsl =
+			parser.createShaderString(lineMappings, output, pipeline, stage, false, false);
+		EXPECT_TRUE(Compiler::compile(stages, output, shaderName, glsl, lineMappings, stage,
+			Compiler::getDefaultResources(), spirvVersion));
+		compiledStage = true;
+	}
+	EXPECT_TRUE(compiledStage);
+
+	Compiler::Program program;
+	EXPECT_TRUE(Compiler::link(program, output, pipeline, stages));
+	Compiler::SpirV vertexSpirv = Compiler::assemble(output, program, Stage::Vertex, pipeline);
+	Compiler::SpirV fragmentSpirv = Compiler::assemble(output, program, Stage::Fragment, pipeline);
+
+	SpirVProcessor vertexProcessor;
+	EXPECT_TRUE(vertexProcessor.extract(output, pipeline.token->fileName, pipeline.token->line,
+		pipeline.token->column, vertexSpirv, Stage::Vertex));
+
+	SpirVProcessor fragmentProcessor;
+	EXPECT_TRUE(fragmentProcessor.extract(output, pipeline.token->fileName, pipeline.token->line,
+		pipeline.token->column, fragmentSpirv, Stage::Fragment));
+
+	// Sorted by ID.
+	ASSERT_EQ(2U, vertexProcessor.specializationConstants.size());
+	EXPECT_EQ("useFog", vertexProcessor.specializationConstants[0].name);
+	EXPECT_EQ(Type::Bool, vertexProcessor.specializationConstants[0].type);
+	EXPECT_EQ(0U, vertexProcessor.specializationConstants[0].id);
+	EXPECT_EQ(1.0, vertexProcessor.specializationConstants[0].defaultValue);
+
+	EXPECT_EQ("lightCount", vertexProcessor.specializationConstants[1].name);
+	EXPECT_EQ(Type::Int, vertexProcessor.specializationConstants[1].type);
+	EXPECT_EQ(3U, vertexProcessor.specializationConstants[1].id);
+	EXPECT_EQ(-2.0, vertexProcessor.specializationConstants[1].defaultValue);
+
+	ASSERT_EQ(3U, fragmentProcessor.specializationConstants.size());
+	EXPECT_EQ("useFog", fragmentProcessor.specializationConstants[0].name);
+	EXPECT_EQ("fogScale", fragmentProcessor.specializationConstants[1].name);
+	EXPECT_EQ(Type::Float, fragmentProcessor.specializationConstants[1].type);
+	EXPECT_EQ(1U, fragmentProcessor.specializationConstants[1].id);
+	EXPECT_EQ(0.5, fragmentProcessor.specializationConstants[1].defaultValue);
+	EXPECT_EQ("lightCount", fragmentProcessor.specializationConstants[2].name);
+
+	EXPECT_TRUE(vertexProcessor.uniformsCompatible(output, fragmentProcessor));
+	EXPECT_TRUE(output.getMessages().empty());
+}
+
+TEST_F(SpirVProcessorTest, SpecializationConstantMismatch)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"SpecializationConstantMismatch.msl");
+
+	Parser parser;
+	Preprocessor preprocessor;
+	Output output;
+	EXPECT_TRUE(preprocessor.preprocess(parser.getTokens(), output, shaderName));
+	EXPECT_TRUE(parser.parse(output));
+
+	ASSERT_EQ(1U, parser.getPipelines().size());
+	const Parser::Pipeline& pipeline = parser.getPipelines()[0];
+	Compiler::Stages stages;
+	bool compiledStage = false;
+	for (unsigned int i = 0; i < stageCount; ++i)
+	{
+		if (pipeline.entryPoints[i].value.empty())
+			continue;
+
+		auto stage = static_cast<Stage>(i);
+		std::vector<Parser::LineMapping> lineMappings;
+		std::string glsl =
+			parser.createShaderString(lineMappings, output, pipeline, stage, false, false);
+		EXPECT_TRUE(Compiler::compile(stages, output, shaderName, glsl, lineMappings, stage,
+			Compiler::getDefaultResources(), spirvVersion));
+		compiledStage = true;
+	}
+	EXPECT_TRUE(compiledStage);
+
+	Compiler::Program program;
+	EXPECT_TRUE(Compiler::link(program, output, pipeline, stages));
+	Compiler::SpirV vertexSpirv = Compiler::assemble(output, program, Stage::Vertex, pipeline);
+	Compiler::SpirV fragmentSpirv = Compiler::assemble(output, program, Stage::Fragment, pipeline);
+
+	SpirVProcessor vertexProcessor;
+	EXPECT_TRUE(vertexProcessor.extract(output, pipeline.token->fileName, pipeline.token->line,
+		pipeline.token->column, vertexSpirv, Stage::Vertex));
+
+	SpirVProcessor fragmentProcessor;
+	EXPECT_TRUE(fragmentProcessor.extract(output, pipeline.token->fileName, pipeline.token->line,
+		pipeline.token->column, fragmentSpirv, Stage::Fragment));
+
+	EXPECT_FALSE(vertexProcessor.uniformsCompatible(output, fragmentProcessor));
+
+	const std::vector<Output::Message>& messages = output.getMessages();
+	ASSERT_EQ(1U, messages.size());
+	EXPECT_EQ(Output::Level::Error, messages[0].level);
+	EXPECT_EQ("linker error: specialization constant lightCount has different declarations "
+		"between stages", messages[0].message);
+}
+
 TEST_F(SpirVProcessorTest, LinkDifferentType)
 {
 	boost::filesystem::path inputDir = exeDir/"inputs";
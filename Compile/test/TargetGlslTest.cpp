@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2022 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -936,4 +936,54 @@ TEST(TargetGlslTest, DuplicateEntryPoint)
 	EXPECT_EQ("entry point 'fragShader' found multiple times", messages[0].message);
 }
 
+TEST(TargetGlslTest, GlslTransform)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"CompleteShader.msl");
+
+	TargetGlsl target(450, false);
+	target.addIncludePath(inputDir.string());
+	target.setGlslTransform([](std::string& glsl, Output&, const Target::StageInfo& stage)
+		{
+			glsl += "// " + stage.pipeline + ' ' + stage.entryPoint + '\n';
+			return true;
+		});
+
+	Output output;
+	CompiledResult result;
+	EXPECT_TRUE(target.compile(result, output, shaderName));
+	ASSERT_EQ(2U, result.getShaders().size());
+
+	std::string vertex = reinterpret_cast<const char*>(result.getShaders()[0].data.data());
+	std::string fragment = reinterpret_cast<const char*>(result.getShaders()[1].data.data());
+	EXPECT_TRUE(boost::algorithm::ends_with(vertex, "// Test vertShader\n"));
+	EXPECT_TRUE(boost::algorithm::ends_with(fragment, "// Test fragShader\n"));
+}
+
+#if !MSL_WINDOWS
+
+TEST(TargetGlslTest, BatchToolCommands)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"CompleteShader.msl");
+
+	TargetGlsl target(450, false);
+	target.addIncludePath(inputDir.string());
+	target.setBatchToolCommands(true);
+	target.setGlslToolCommand(Stage::Fragment, "while read -r in out; do "
+		"cat \"$in\" > \"$out\"; echo '// batched' >> \"$out\"; done < $manifest");
+
+	Output output;
+	CompiledResult result;
+	EXPECT_TRUE(target.compile(result, output, shaderName));
+	ASSERT_EQ(2U, result.getShaders().size());
+
+	std::string vertex = reinterpret_cast<const char*>(result.getShaders()[0].data.data());
+	std::string fragment = reinterpret_cast<const char*>(result.getShaders()[1].data.data());
+	EXPECT_FALSE(boost::algorithm::ends_with(vertex, "// batched\n"));
+	EXPECT_TRUE(boost::algorithm::ends_with(fragment, "// batched\n"));
+}
+
+#endif
+
 } // namespace msl
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Helpers.h"
+#include <MSL/Compile/Output.h>
+#include <MSL/Compile/TargetGlsl.h>
+#include <MSL/Compile/TargetGroup.h>
+#include <MSL/Compile/TargetSpirV.h>
+#include <gtest/gtest.h>
+#include <sstream>
+
+namespace msl
+{
+
+using namespace compile;
+
+static void expectResultsEqual(const CompiledResult& expected, const CompiledResult& result)
+{
+	EXPECT_EQ(expected.getTargetId(), result.getTargetId());
+	ASSERT_EQ(expected.getPipelines().size(), result.getPipelines().size());
+	for (const auto& pipeline : expected.getPipelines())
+	{
+		auto foundIt = result.getPipelines().find(pipeline.first);
+		ASSERT_NE(result.getPipelines().end(), foundIt);
+		for (unsigned int i = 0; i < stageCount; ++i)
+		{
+			EXPECT_EQ(pipeline.second.shaders[i].shader, foundIt->second.shaders[i].shader);
+			EXPECT_EQ(pipeline.second.shaders[i].uniformIds,
+				foundIt->second.shaders[i].uniformIds);
+		}
+		EXPECT_EQ(pipeline.second.uniforms.size(), foundIt->second.uniforms.size());
+		EXPECT_EQ(pipeline.second.attributes.size(), foundIt->second.attributes.size());
+	}
+
+	ASSERT_EQ(expected.getShaders().size(), result.getShaders().size());
+	for (std::size_t i = 0; i < expected.getShaders().size(); ++i)
+		EXPECT_EQ(expected.getShaders()[i].data, result.getShaders()[i].data);
+}
+
+TEST(TargetGroupTest, MatchesSeparateCompiles)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"CompleteShader.msl");
+
+	// The first two targets share the parsed source, while all share the SPIR-V.
+	TargetSpirV spirvTarget(0x10000);
+	spirvTarget.addIncludePath(inputDir.string());
+
+	TargetSpirV strippedTarget(0x10000);
+	strippedTarget.addIncludePath(inputDir.string());
+	strippedTarget.setStripDebug(true);
+
+	TargetGlsl glslTarget(450, false);
+	glslTarget.addIncludePath(inputDir.string());
+
+	TargetGroup group;
+	group.addTarget(spirvTarget);
+	group.addTarget(strippedTarget);
+	group.addTarget(glslTarget);
+	ASSERT_EQ(3U, group.getTargetCount());
+	EXPECT_EQ(&glslTarget, &group.getTarget(2));
+
+	Output output;
+	std::vector<CompiledResult> results;
+	EXPECT_TRUE(group.compile(results, output, shaderName));
+	EXPECT_TRUE(group.finish(results, output));
+	EXPECT_EQ(0U, output.getErrorCount());
+	ASSERT_EQ(3U, results.size());
+
+	for (std::size_t i = 0; i < group.getTargetCount(); ++i)
+	{
+		Output separateOutput;
+		CompiledResult separateResult;
+		const Target& target = group.getTarget(i);
+		EXPECT_TRUE(target.compile(separateResult, separateOutput, shaderName));
+		EXPECT_TRUE(target.finish(separateResult, separateOutput));
+		expectResultsEqual(separateResult, results[i]);
+	}
+}
+
+TEST(TargetGroupTest, Stream)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"CompleteShader.msl");
+
+	TargetSpirV spirvTarget(0x10000);
+	spirvTarget.addIncludePath(inputDir.string());
+
+	TargetGlsl glslTarget(450, false);
+	glslTarget.addIncludePath(inputDir.string());
+
+	TargetGroup group;
+	group.addTarget(spirvTarget);
+	group.addTarget(glslTarget);
+
+	Output output;
+	std::vector<CompiledResult> results;
+	std::istringstream stream(readFile(shaderName));
+	EXPECT_TRUE(group.compile(results, output, stream, shaderName));
+	ASSERT_EQ(2U, results.size());
+	EXPECT_EQ(1U, results[0].getPipelines().size());
+	EXPECT_EQ(1U, results[1].getPipelines().size());
+}
+
+TEST(TargetGroupTest, Error)
+{
+	TargetSpirV spirvTarget(0x10000);
+	TargetGlsl glslTarget(450, false);
+
+	TargetGroup group;
+	group.addTarget(spirvTarget);
+	group.addTarget(glslTarget);
+
+	Output output;
+	std::vector<CompiledResult> results;
+	std::istringstream stream("pipeline Test {vertex = missing;}");
+	EXPECT_FALSE(group.compile(results, output, stream, "test.msl"));
+	EXPECT_LT(0U, output.getErrorCount());
+}
+
+} // namespace msl
@@ -20,6 +20,7 @@
 #include <MSL/Compile/TargetMetal.h>
 #include <boost/algorithm/string/predicate.hpp>
 #include <gtest/gtest.h>
+#include <fstream>
 
 namespace msl
 {
@@ -36,7 +37,8 @@ public:
 	}
 
 protected:
-	bool compileMetal(std::vector<std::uint8_t>& data, Output&, const std::string& metal) override
+	bool compileMetal(std::vector<std::uint8_t>& data, Output&,
+		const std::string& metal) const override
 	{
 		data.assign(metal.begin(), metal.end());
 		return true;
@@ -277,4 +279,158 @@ TEST(TargetMetalTest, FragmentInputsStripDebug)
 		fragmentShaderStr);
 }
 
+TEST(TargetMetalTest, SourceOnly)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	boost::filesystem::path outputDir = exeDir/"outputs";
+	std::string shaderName = pathStr(inputDir/"CompleteFragmentInputShader.msl");
+
+	// Use the real target to make sure the toolchain isn't run.
+	TargetMetal target(203, TargetMetal::Platform::MacOS);
+	target.setToolchainCommand("false");
+	target.setSourceOnly(true);
+	EXPECT_EQ(ShaderDataFormat::Source, target.getShaderDataFormat());
+
+	Output output;
+	CompiledResult result;
+	EXPECT_TRUE(target.compile(result, output, shaderName));
+	EXPECT_TRUE(target.finish(result, output));
+	EXPECT_EQ(0U, output.getMessages().size());
+	EXPECT_TRUE(result.getSharedData().empty());
+
+	auto pipeline = result.getPipelines().find("Test");
+	ASSERT_NE(pipeline, result.getPipelines().end());
+	std::size_t fragmentShaderIndex =
+		pipeline->second.shaders[static_cast<int>(Stage::Fragment)].shader;
+	ASSERT_EQ(1U, fragmentShaderIndex);
+
+	const CompiledResult::ShaderData& fragmentShader = result.getShaders()[fragmentShaderIndex];
+	ASSERT_FALSE(fragmentShader.data.empty());
+	EXPECT_EQ(0, fragmentShader.data.back());
+	EXPECT_EQ(readFile(outputDir/"CompleteFragmentInputShaderStripped.frag.metal"),
+		reinterpret_cast<const char*>(fragmentShader.data.data()));
+}
+
+TEST(TargetMetalTest, ArgumentBuffers)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"CompleteShader.msl");
+
+	MockTargetMetal target(200, TargetMetal::Platform::MacOS);
+	EXPECT_FALSE(static_cast<const Target&>(target).getArgumentBuffers());
+	target.setArgumentBuffers(true);
+	EXPECT_TRUE(static_cast<const Target&>(target).getArgumentBuffers());
+
+	Output output;
+	CompiledResult result;
+	EXPECT_TRUE(target.compile(result, output, shaderName));
+	EXPECT_TRUE(target.finish(result, output));
+	EXPECT_EQ(0U, output.getMessages().size());
+
+	auto pipeline = result.getPipelines().find("Test");
+	ASSERT_NE(pipeline, result.getPipelines().end());
+	const std::vector<Uniform>& uniforms = pipeline->second.uniforms;
+	ASSERT_EQ(2U, uniforms.size());
+	std::size_t texIndex = uniforms[0].name == "tex" ? 0 : 1;
+	std::size_t blockIndex = 1 - texIndex;
+
+	// Each stage has its own argument buffer with the resources it uses.
+	const Shader& vertex = pipeline->second.shaders[static_cast<int>(Stage::Vertex)];
+	ASSERT_EQ(2U, vertex.uniformIds.size());
+	EXPECT_EQ(unknown, vertex.uniformIds[texIndex]);
+	EXPECT_EQ(0U, vertex.uniformIds[blockIndex]);
+
+	const Shader& fragment = pipeline->second.shaders[static_cast<int>(Stage::Fragment)];
+	ASSERT_LE(1U, fragment.uniformIds.size());
+	EXPECT_EQ(0U, fragment.uniformIds[texIndex]);
+
+	const std::vector<std::uint8_t>& vertexData = result.getShaders()[vertex.shader].data;
+	std::string vertexStr(vertexData.begin(), vertexData.end());
+	EXPECT_NE(std::string::npos, vertexStr.find("spvDescriptorSetBuffer0"));
+	EXPECT_NE(std::string::npos, vertexStr.find("[[buffer(0)]]"));
+	EXPECT_NE(std::string::npos, vertexStr.find("[[id(0)]]"));
+
+	const std::vector<std::uint8_t>& fragmentData = result.getShaders()[fragment.shader].data;
+	std::string fragmentStr(fragmentData.begin(), fragmentData.end());
+	EXPECT_NE(std::string::npos, fragmentStr.find("spvDescriptorSetBuffer0"));
+	EXPECT_NE(std::string::npos, fragmentStr.find("[[id(0)]]"));
+	EXPECT_NE(std::string::npos, fragmentStr.find("[[id(1)]]"));
+	EXPECT_EQ(std::string::npos, fragmentStr.find("[[texture("));
+}
+
+TEST(TargetMetalTest, ArgumentBuffersOlderVersion)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"CompleteShader.msl");
+
+	MockTargetMetal target(110, TargetMetal::Platform::MacOS);
+	target.setArgumentBuffers(true);
+
+	Output output;
+	CompiledResult result;
+	EXPECT_FALSE(target.compile(result, output, shaderName));
+	ASSERT_LE(1U, output.getMessages().size());
+	EXPECT_EQ("argument buffers require Metal 2.0 or later", output.getMessages()[0].message);
+}
+
+#if !MSL_WINDOWS
+
+TEST(TargetMetalTest, SharedLibrary)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"CompleteFragmentInputShader.msl");
+
+	// Stub toolchain that copies the source when compiling and concatenates the objects when
+	// linking.
+	boost::filesystem::path tempDir = boost::filesystem::temp_directory_path()/
+		boost::filesystem::unique_path();
+	boost::filesystem::create_directories(tempDir);
+	std::string toolchain = pathStr(tempDir/"toolchain.sh");
+	{
+		std::ofstream stream(toolchain);
+		stream << "tool=$1\nshift\ninputs=\n"
+			"while [ $# -gt 0 ]; do\n"
+			"\tcase \"$1\" in\n"
+			"\t\t-c) input=$2; shift;;\n"
+			"\t\t-o) output=$2; shift;;\n"
+			"\t\t-*) ;;\n"
+			"\t\t*) inputs=\"$inputs $1\";;\n"
+			"\tesac\n"
+			"\tshift\n"
+			"done\n"
+			"if [ \"$tool\" = metal ]; then cp \"$input\" \"$output\"; "
+			"else cat $inputs > \"$output\"; fi\n";
+	}
+
+	TargetMetal target(203, TargetMetal::Platform::MacOS);
+	target.setToolchainCommand("sh " + toolchain);
+	EXPECT_EQ(ShaderDataFormat::Native, target.getShaderDataFormat());
+	target.setSharedLibrary(true);
+	EXPECT_EQ(ShaderDataFormat::LibraryFunction, target.getShaderDataFormat());
+
+	Output output;
+	CompiledResult result;
+	EXPECT_TRUE(target.compile(result, output, shaderName));
+	EXPECT_TRUE(target.finish(result, output));
+	EXPECT_EQ(0U, output.getMessages().size());
+	boost::filesystem::remove_all(tempDir);
+
+	// Each shader is the function name within the shared library.
+	std::string library(result.getSharedData().begin(), result.getSharedData().end());
+	ASSERT_EQ(2U, result.getShaders().size());
+	for (const CompiledResult::ShaderData& shader : result.getShaders())
+	{
+		ASSERT_FALSE(shader.data.empty());
+		EXPECT_EQ(0, shader.data.back());
+		std::string functionName = reinterpret_cast<const char*>(shader.data.data());
+		EXPECT_NE(std::string::npos, library.find(" " + functionName + "("));
+	}
+
+	std::string vertexName = reinterpret_cast<const char*>(result.getShaders()[0].data.data());
+	EXPECT_TRUE(boost::algorithm::starts_with(vertexName, "vertShader_"));
+	EXPECT_EQ(std::string::npos, library.find("main0"));
+}
+
+#endif
+
 } // namespace msl
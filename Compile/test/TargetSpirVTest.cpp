@@ -20,7 +20,9 @@
 #include <MSL/Compile/TargetSpirV.h>
 #include <boost/algorithm/string/predicate.hpp>
 #include <gtest/gtest.h>
+#include <cstring>
 #include <sstream>
+#include <thread>
 
 namespace msl
 {
@@ -539,4 +541,225 @@ TEST(TargetSpirVTest, DuplicatePipeline)
 	EXPECT_EQ("see previous declaration", messages[1].message);
 }
 
+TEST(TargetSpirVTest, ConcurrentCompile)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"CompleteShader.msl");
+
+	TargetSpirV target(spirvVersion);
+	target.addIncludePath(inputDir.string());
+	const TargetSpirV& constTarget = target;
+
+	Output expectedOutput;
+	CompiledResult expectedResult;
+	ASSERT_TRUE(constTarget.compile(expectedResult, expectedOutput, shaderName));
+	ASSERT_TRUE(constTarget.finish(expectedResult, expectedOutput));
+	std::stringstream expectedStream;
+	ASSERT_TRUE(expectedResult.save(expectedStream));
+
+	const unsigned int threadCount = 4;
+	std::array<std::string, threadCount> savedResults;
+	std::array<bool, threadCount> succeeded = {};
+	std::vector<std::thread> threads;
+	for (unsigned int i = 0; i < threadCount; ++i)
+	{
+		threads.emplace_back([&, i]()
+			{
+				Output output;
+				CompiledResult result;
+				std::stringstream stream;
+				succeeded[i] = constTarget.compile(result, output, shaderName) &&
+					constTarget.finish(result, output) && result.save(stream);
+				savedResults[i] = stream.str();
+			});
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	for (unsigned int i = 0; i < threadCount; ++i)
+	{
+		EXPECT_TRUE(succeeded[i]);
+		EXPECT_EQ(expectedStream.str(), savedResults[i]);
+	}
+}
+
+TEST(TargetSpirVTest, PipelineFilter)
+{
+	// The second pipeline would fail to compile if it wasn't skipped.
+	std::string source =
+		"[[fragment]] out vec4 color;\n"
+		"[[vertex]] void vertShader() {gl_Position = vec4(0.0);}\n"
+		"[[fragment]] void goodFrag() {color = vec4(1.0);}\n"
+		"[[fragment]] void badFrag() {color = asdf;}\n"
+		"pipeline GoodPipeline {vertex = vertShader; fragment = goodFrag;}\n"
+		"pipeline BadPipeline {vertex = vertShader; fragment = badFrag;}\n";
+
+	TargetSpirV target(spirvVersion);
+	EXPECT_TRUE(target.pipelineSelected("BadPipeline"));
+
+	target.addPipelineFilter("G*Pipe?ine");
+	ASSERT_EQ(1U, target.getPipelineFilters().size());
+	EXPECT_TRUE(target.pipelineSelected("GoodPipeline"));
+	EXPECT_FALSE(target.pipelineSelected("BadPipeline"));
+	EXPECT_FALSE(target.pipelineSelected("GoodPipelines"));
+
+	Output output;
+	CompiledResult result;
+	std::istringstream stream(source);
+	EXPECT_TRUE(target.compile(result, output, stream, "test.msl"));
+	EXPECT_EQ(0U, output.getMessages().size());
+	ASSERT_EQ(1U, result.getPipelines().size());
+	EXPECT_EQ("GoodPipeline", result.getPipelines().begin()->first);
+
+	// Unselected pipelines are still validated.
+	std::istringstream missingEntryPointStream(source +
+		"pipeline MissingPipeline {vertex = vertShader; fragment = missingFrag;}\n");
+	CompiledResult missingEntryPointResult;
+	EXPECT_FALSE(target.compile(missingEntryPointResult, output, missingEntryPointStream,
+		"test.msl"));
+	EXPECT_LT(0U, output.getErrorCount());
+
+	output.clear();
+	target.clearPipelineFilters();
+	CompiledResult fullResult;
+	stream.clear();
+	stream.seekg(0);
+	EXPECT_FALSE(target.compile(fullResult, output, stream, "test.msl"));
+	EXPECT_LT(0U, output.getErrorCount());
+}
+
+TEST(TargetSpirVTest, Variants)
+{
+	std::string source =
+		"[[fragment]] out vec4 color;\n"
+		"[[vertex]] void vertShader() {gl_Position = vec4(0.0);}\n"
+		"[[fragment]] void fogFrag()\n"
+		"{\n"
+		"#if FOG\n"
+		"	color = vec4(0.5);\n"
+		"#else\n"
+		"	color = vec4(1.0);\n"
+		"#endif\n"
+		"}\n"
+		"[[fragment]] void plainFrag() {color = vec4(0.25);}\n"
+		"pipeline Fog {vertex = vertShader; fragment = fogFrag;}\n"
+		"pipeline Plain {vertex = vertShader; fragment = plainFrag;}\n";
+
+	TargetSpirV target(spirvVersion);
+	target.addVariantKeyword("FOG", {"0", "1"});
+
+	Output output;
+	CompiledResult result;
+	std::istringstream stream(source);
+	EXPECT_TRUE(target.compile(result, output, stream, "test.msl"));
+	EXPECT_EQ(0U, output.getMessages().size());
+
+	const auto& pipelines = result.getPipelines();
+	ASSERT_EQ(4U, pipelines.size());
+	auto fog0 = pipelines.find("Fog[FOG=0]");
+	auto fog1 = pipelines.find("Fog[FOG=1]");
+	auto plain0 = pipelines.find("Plain[FOG=0]");
+	auto plain1 = pipelines.find("Plain[FOG=1]");
+	ASSERT_NE(pipelines.end(), fog0);
+	ASSERT_NE(pipelines.end(), fog1);
+	ASSERT_NE(pipelines.end(), plain0);
+	ASSERT_NE(pipelines.end(), plain1);
+
+	// Shaders unaffected by the keyword are shared.
+	auto vertex = static_cast<unsigned int>(Stage::Vertex);
+	auto fragment = static_cast<unsigned int>(Stage::Fragment);
+	EXPECT_EQ(fog0->second.shaders[vertex].shader, fog1->second.shaders[vertex].shader);
+	EXPECT_NE(fog0->second.shaders[fragment].shader, fog1->second.shaders[fragment].shader);
+	EXPECT_EQ(plain0->second.shaders[fragment].shader, plain1->second.shaders[fragment].shader);
+
+	const auto& variants = result.getVariants();
+	ASSERT_EQ(2U, variants.size());
+	auto fogVariant = variants.find("Fog");
+	ASSERT_NE(variants.end(), fogVariant);
+	ASSERT_EQ(2U, fogVariant->second.size());
+	EXPECT_EQ("Fog[FOG=0]", fogVariant->second[0]);
+	EXPECT_EQ("Fog[FOG=1]", fogVariant->second[1]);
+
+	std::stringstream saveStream;
+	EXPECT_TRUE(result.save(saveStream));
+}
+
+TEST(TargetSpirVTest, InvalidVariant)
+{
+	TargetSpirV target(spirvVersion);
+	target.addVariantKeyword("FOG", {});
+
+	Output output;
+	CompiledResult result;
+	std::istringstream stream("pipeline Empty {}\n");
+	EXPECT_FALSE(target.compile(result, output, stream, "test.msl"));
+	ASSERT_EQ(1U, output.getMessages().size());
+	EXPECT_EQ("variant keyword has no values: FOG", output.getMessages()[0].message);
+}
+
+TEST(TargetSpirVTest, SpirVTransform)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"CompleteShader.msl");
+
+	TargetSpirV target(0x10000);
+	target.addIncludePath(inputDir.string());
+
+	std::vector<Stage> stages;
+	std::vector<std::string> entryPoints;
+	std::vector<std::string> pipelines;
+	target.setSpirVTransform([&](std::vector<std::uint32_t>& spirv, Output&,
+		const Target::StageInfo& stage)
+		{
+			stages.push_back(stage.stage);
+			entryPoints.push_back(stage.entryPoint);
+			pipelines.push_back(stage.pipeline);
+			// Add an extra nop at the end to check the transformed result is used.
+			spirv.push_back((1 << 16) | 0);
+			return true;
+		});
+
+	Output output;
+	CompiledResult result;
+	EXPECT_TRUE(target.compile(result, output, shaderName));
+	ASSERT_EQ(2U, stages.size());
+	EXPECT_EQ(Stage::Vertex, stages[0]);
+	EXPECT_EQ("vertShader", entryPoints[0]);
+	EXPECT_EQ("Test", pipelines[0]);
+	EXPECT_EQ(Stage::Fragment, stages[1]);
+	EXPECT_EQ("fragShader", entryPoints[1]);
+	EXPECT_EQ("Test", pipelines[1]);
+
+	ASSERT_EQ(2U, result.getShaders().size());
+	const std::vector<std::uint8_t>& data = result.getShaders()[0].data;
+	ASSERT_LE(sizeof(std::uint32_t), data.size());
+	std::uint32_t lastWord;
+	std::memcpy(&lastWord, data.data() + data.size() - sizeof(std::uint32_t),
+		sizeof(std::uint32_t));
+	EXPECT_EQ((1U << 16) | 0U, lastWord);
+}
+
+TEST(TargetSpirVTest, SpirVTransformError)
+{
+	boost::filesystem::path inputDir = exeDir/"inputs";
+	std::string shaderName = pathStr(inputDir/"CompleteShader.msl");
+
+	TargetSpirV target(0x10000);
+	target.addIncludePath(inputDir.string());
+	target.setSpirVTransform([](std::vector<std::uint32_t>&, Output& output,
+		const Target::StageInfo& stage)
+		{
+			output.addMessage(Output::Level::Error, stage.fileName, stage.line, stage.column,
+				false, "transform failed");
+			return false;
+		});
+
+	Output output;
+	CompiledResult result;
+	EXPECT_FALSE(target.compile(result, output, shaderName));
+	ASSERT_EQ(1U, output.getMessages().size());
+	EXPECT_EQ("transform failed", output.getMessages()[0].message);
+}
+
 } // namespace msl
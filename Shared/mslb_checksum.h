@@ -0,0 +1,220 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Checksum for the contents of a module, shared between the compiler when saving and the client
+// when loading. This is XXH64 with a seed of 0, treating the 8 bytes of the checksum field itself
+// as 0 so the checksum can be stored inside of the buffer it covers.
+namespace mslb
+{
+
+namespace detail
+{
+
+const std::uint64_t checksumPrime1 = 0x9E3779B185EBCA87ULL;
+const std::uint64_t checksumPrime2 = 0xC2B2AE3D27D4EB4FULL;
+const std::uint64_t checksumPrime3 = 0x165667B19E3779F9ULL;
+const std::uint64_t checksumPrime4 = 0x85EBCA77C2B2AE63ULL;
+const std::uint64_t checksumPrime5 = 0x27D4EB2F165667C5ULL;
+
+inline std::uint64_t rotateLeft(std::uint64_t value, unsigned int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+inline std::uint32_t readLittleEndian32(const std::uint8_t* data)
+{
+	return static_cast<std::uint32_t>(data[0]) | (static_cast<std::uint32_t>(data[1]) << 8) |
+		(static_cast<std::uint32_t>(data[2]) << 16) | (static_cast<std::uint32_t>(data[3]) << 24);
+}
+
+inline std::uint64_t readChecksumWord(const std::uint8_t* data, std::size_t offset,
+	std::size_t checksumOffset)
+{
+	if (offset == checksumOffset)
+		return 0;
+
+	return static_cast<std::uint64_t>(readLittleEndian32(data + offset)) |
+		(static_cast<std::uint64_t>(readLittleEndian32(data + offset + 4)) << 32);
+}
+
+inline std::uint64_t checksumRound(std::uint64_t accumulator, std::uint64_t input)
+{
+	accumulator += input*checksumPrime2;
+	accumulator = rotateLeft(accumulator, 31);
+	return accumulator*checksumPrime1;
+}
+
+inline std::uint64_t checksumMergeRound(std::uint64_t accumulator, std::uint64_t value)
+{
+	accumulator ^= checksumRound(0, value);
+	return accumulator*checksumPrime1 + checksumPrime4;
+}
+
+// Processes the final bytes after the 32 byte stripes and applies the final mix.
+inline std::uint64_t finishChecksum(std::uint64_t hash, const std::uint8_t* bytes,
+	std::size_t size, std::size_t offset, std::size_t checksumOffset)
+{
+	for (; offset + 8 <= size; offset += 8)
+	{
+		hash ^= checksumRound(0, readChecksumWord(bytes, offset, checksumOffset));
+		hash = rotateLeft(hash, 27)*checksumPrime1 + checksumPrime4;
+	}
+
+	if (offset + 4 <= size)
+	{
+		hash ^= static_cast<std::uint64_t>(readLittleEndian32(bytes + offset))*checksumPrime1;
+		hash = rotateLeft(hash, 23)*checksumPrime2 + checksumPrime3;
+		offset += 4;
+	}
+
+	for (; offset < size; ++offset)
+	{
+		hash ^= bytes[offset]*checksumPrime5;
+		hash = rotateLeft(hash, 11)*checksumPrime1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= checksumPrime2;
+	hash ^= hash >> 29;
+	hash *= checksumPrime3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+} // namespace detail
+
+// Value for checksumOffset when the checksum isn't stored within the data being checked, such as
+// for the shader payloads of sectioned modules.
+const std::size_t noChecksumOffset = static_cast<std::size_t>(-1);
+
+// Computes the checksum for a module buffer. checksumOffset is the offset of the checksum field
+// within the buffer, which must be a multiple of 8.
+inline std::uint64_t computeChecksum(const void* data, std::size_t size,
+	std::size_t checksumOffset)
+{
+	using namespace detail;
+	const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(data);
+	std::size_t offset = 0;
+	std::uint64_t hash;
+	if (size >= 32)
+	{
+		std::uint64_t v1 = checksumPrime1 + checksumPrime2;
+		std::uint64_t v2 = checksumPrime2;
+		std::uint64_t v3 = 0;
+		std::uint64_t v4 = 0 - checksumPrime1;
+		for (; offset + 32 <= size; offset += 32)
+		{
+			v1 = checksumRound(v1, readChecksumWord(bytes, offset, checksumOffset));
+			v2 = checksumRound(v2, readChecksumWord(bytes, offset + 8, checksumOffset));
+			v3 = checksumRound(v3, readChecksumWord(bytes, offset + 16, checksumOffset));
+			v4 = checksumRound(v4, readChecksumWord(bytes, offset + 24, checksumOffset));
+		}
+
+		hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+		hash = checksumMergeRound(hash, v1);
+		hash = checksumMergeRound(hash, v2);
+		hash = checksumMergeRound(hash, v3);
+		hash = checksumMergeRound(hash, v4);
+	}
+	else
+		hash = checksumPrime5;
+
+	hash += size;
+	return finishChecksum(hash, bytes, size, offset, checksumOffset);
+}
+
+// Computes the same checksum as computeChecksum() with noChecksumOffset for data that is provided
+// incrementally, such as when reading from a stream.
+class StreamChecksum
+{
+public:
+	StreamChecksum()
+		: m_bufferSize(0)
+		, m_totalSize(0)
+	{
+		m_accumulators[0] = detail::checksumPrime1 + detail::checksumPrime2;
+		m_accumulators[1] = detail::checksumPrime2;
+		m_accumulators[2] = 0;
+		m_accumulators[3] = 0 - detail::checksumPrime1;
+	}
+
+	void update(const void* data, std::size_t size)
+	{
+		const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(data);
+		m_totalSize += size;
+		if (m_bufferSize > 0)
+		{
+			std::size_t bufferRemaining = sizeof(m_buffer) - m_bufferSize;
+			std::size_t copySize = size < bufferRemaining ? size : bufferRemaining;
+			std::memcpy(m_buffer + m_bufferSize, bytes, copySize);
+			m_bufferSize += copySize;
+			bytes += copySize;
+			size -= copySize;
+			if (m_bufferSize < sizeof(m_buffer))
+				return;
+
+			processStripe(m_buffer);
+			m_bufferSize = 0;
+		}
+
+		for (; size >= sizeof(m_buffer); bytes += sizeof(m_buffer), size -= sizeof(m_buffer))
+			processStripe(bytes);
+
+		std::memcpy(m_buffer, bytes, size);
+		m_bufferSize = size;
+	}
+
+	std::uint64_t finish() const
+	{
+		using namespace detail;
+		std::uint64_t hash;
+		if (m_totalSize >= sizeof(m_buffer))
+		{
+			hash = rotateLeft(m_accumulators[0], 1) + rotateLeft(m_accumulators[1], 7) +
+				rotateLeft(m_accumulators[2], 12) + rotateLeft(m_accumulators[3], 18);
+			for (std::uint64_t accumulator : m_accumulators)
+				hash = checksumMergeRound(hash, accumulator);
+		}
+		else
+			hash = checksumPrime5;
+
+		hash += m_totalSize;
+		return finishChecksum(hash, m_buffer, m_bufferSize, 0, noChecksumOffset);
+	}
+
+private:
+	void processStripe(const std::uint8_t* data)
+	{
+		for (unsigned int i = 0; i < 4; ++i)
+		{
+			m_accumulators[i] = detail::checksumRound(m_accumulators[i],
+				detail::readChecksumWord(data, i*8, noChecksumOffset));
+		}
+	}
+
+	std::uint64_t m_accumulators[4];
+	std::uint8_t m_buffer[32];
+	std::size_t m_bufferSize;
+	std::uint64_t m_totalSize;
+};
+
+} // namespace mslb
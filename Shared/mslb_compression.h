@@ -0,0 +1,309 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+// Compression for the data of each shader, shared between the compiler when saving and the client
+// when loading. This uses the LZ4 block format: a series of sequences, each with a token holding
+// the literal and match lengths, the literal bytes, and a 16-bit offset to copy the match from
+// earlier in the output. The final sequence only contains literals.
+//
+// Since matches only reference the output, the decompressor reads the compressed data strictly in
+// order, allowing shaders to be decompressed while being read from a stream.
+namespace mslb
+{
+
+// The first module version that may contain compressed shaders.
+const std::uint32_t compressionVersion = 2;
+
+namespace detail
+{
+
+const std::size_t compressionMinMatch = 4;
+const std::size_t compressionLastLiterals = 5;
+const std::size_t compressionMatchLimit = 12;
+const std::size_t compressionMaxOffset = 0xFFFF;
+const unsigned int compressionHashBits = 16;
+const std::size_t compressionHashSize = std::size_t(1) << compressionHashBits;
+const std::size_t compressionWindowSize = 0x10000;
+const unsigned int compressionMaxAttempts = 32;
+const std::uint8_t compressionLengthMask = 0xF;
+
+inline std::uint32_t readCompressionWord(const std::uint8_t* data)
+{
+	std::uint32_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+inline std::uint32_t compressionHash(std::uint32_t value)
+{
+	return (value*2654435761U) >> (32 - compressionHashBits);
+}
+
+inline std::uint8_t* writeCompressionLength(std::uint8_t* outData, std::size_t length)
+{
+	for (; length >= 0xFF; length -= 0xFF)
+		*outData++ = 0xFF;
+	*outData++ = static_cast<std::uint8_t>(length);
+	return outData;
+}
+
+inline std::uint8_t* writeLiterals(std::uint8_t* outData, const std::uint8_t* literals,
+	std::size_t literalLength, std::size_t matchLength)
+{
+	std::uint8_t literalToken = static_cast<std::uint8_t>(
+		literalLength < compressionLengthMask ? literalLength : compressionLengthMask);
+	std::uint8_t matchToken = static_cast<std::uint8_t>(
+		matchLength < compressionLengthMask ? matchLength : compressionLengthMask);
+	*outData++ = static_cast<std::uint8_t>(literalToken << 4 | matchToken);
+	if (literalLength >= compressionLengthMask)
+		outData = writeCompressionLength(outData, literalLength - compressionLengthMask);
+
+	if (literalLength > 0)
+		std::memcpy(outData, literals, literalLength);
+	return outData + literalLength;
+}
+
+template <typename Source>
+bool readCompressionLength(std::size_t& length, Source& source, std::size_t maxLength)
+{
+	std::uint8_t value;
+	do
+	{
+		if (!source.read(&value, 1))
+			return false;
+
+		length += value;
+		if (length > maxLength)
+			return false;
+	} while (value == 0xFF);
+
+	return true;
+}
+
+} // namespace detail
+
+// Source to decompress data already in memory.
+class MemoryCompressionSource
+{
+public:
+	MemoryCompressionSource(const void* data, std::size_t size)
+		: m_data(reinterpret_cast<const std::uint8_t*>(data))
+		, m_remaining(size)
+	{
+	}
+
+	bool read(void* outData, std::size_t size)
+	{
+		if (size > m_remaining)
+			return false;
+		else if (size == 0)
+			return true;
+
+		std::memcpy(outData, m_data, size);
+		m_data += size;
+		m_remaining -= size;
+		return true;
+	}
+
+	bool atEnd() const
+	{
+		return m_remaining == 0;
+	}
+
+private:
+	const std::uint8_t* m_data;
+	std::size_t m_remaining;
+};
+
+// Gets the maximum size of the compressed data for an input size.
+inline std::size_t compressedSizeBound(std::size_t size)
+{
+	return size + size/0xFF + 16;
+}
+
+// Compresses data into outData, which must have at least compressedSizeBound(size) bytes. Returns
+// the size of the compressed data.
+//
+// Positions with the same hash are chained together so several candidates can be checked for the
+// longest match. This is slower than only checking the most recent candidate, but compression is
+// only done once when saving the module and SPIR-V has many short repeated sequences.
+inline std::size_t compress(std::uint8_t* outData, const void* data, std::size_t size)
+{
+	using namespace detail;
+	const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(data);
+	std::uint8_t* outStart = outData;
+	std::size_t anchor = 0;
+	if (size > compressionMatchLimit)
+	{
+		// Positions are stored offset by 1 so 0 is an empty entry. The chain holds the distance to
+		// the previous position with the same hash within the window of the maximum offset.
+		std::unique_ptr<std::uint32_t[]> hashTable(
+			new std::uint32_t[compressionHashSize]());
+		std::unique_ptr<std::uint16_t[]> chain(new std::uint16_t[compressionWindowSize]());
+		std::size_t matchEnd = size - compressionMatchLimit;
+		std::size_t lengthEnd = size - compressionLastLiterals;
+		std::size_t insertPos = 0;
+		auto insert = [&](std::size_t end)
+		{
+			for (; insertPos < end; ++insertPos)
+			{
+				std::uint32_t& entry = hashTable[compressionHash(
+					readCompressionWord(bytes + insertPos))];
+				std::size_t distance = entry == 0 ? 0 : insertPos - (entry - 1);
+				chain[insertPos & (compressionWindowSize - 1)] =
+					static_cast<std::uint16_t>(distance > compressionMaxOffset ? 0 : distance);
+				entry = static_cast<std::uint32_t>(insertPos + 1);
+			}
+		};
+
+		std::size_t pos = 0;
+		while (pos < matchEnd)
+		{
+			insert(pos);
+			std::uint32_t value = readCompressionWord(bytes + pos);
+			std::size_t candidate = hashTable[compressionHash(value)];
+			std::size_t match = 0;
+			std::size_t length = 0;
+			for (unsigned int i = 0; i < compressionMaxAttempts && candidate > 0; ++i)
+			{
+				std::size_t candidatePos = candidate - 1;
+				if (pos - candidatePos > compressionMaxOffset)
+					break;
+
+				if (readCompressionWord(bytes + candidatePos) == value)
+				{
+					std::size_t candidateLength = compressionMinMatch;
+					while (pos + candidateLength < lengthEnd &&
+						bytes[pos + candidateLength] == bytes[candidatePos + candidateLength])
+					{
+						++candidateLength;
+					}
+
+					if (candidateLength > length)
+					{
+						match = candidatePos;
+						length = candidateLength;
+					}
+				}
+
+				std::size_t distance = chain[candidatePos & (compressionWindowSize - 1)];
+				candidate = distance == 0 ? 0 : candidate - distance;
+			}
+
+			if (length == 0)
+			{
+				++pos;
+				continue;
+			}
+
+			while (pos > anchor && match > 0 && bytes[pos - 1] == bytes[match - 1])
+			{
+				--pos;
+				--match;
+				++length;
+			}
+
+			std::size_t offset = pos - match;
+			outData = writeLiterals(outData, bytes + anchor, pos - anchor,
+				length - compressionMinMatch);
+			*outData++ = static_cast<std::uint8_t>(offset);
+			*outData++ = static_cast<std::uint8_t>(offset >> 8);
+			if (length - compressionMinMatch >= compressionLengthMask)
+			{
+				outData = writeCompressionLength(outData,
+					length - compressionMinMatch - compressionLengthMask);
+			}
+
+			pos += length;
+			anchor = pos;
+			insert(pos < matchEnd ? pos : matchEnd);
+		}
+	}
+
+	outData = writeLiterals(outData, bytes + anchor, size - anchor, 0);
+	return outData - outStart;
+}
+
+// Decompresses data from source into outData, which is exactly outSize bytes. Source must provide
+// the functions bool read(void* outData, std::size_t size) and bool atEnd() const. Returns false
+// if the compressed data is invalid.
+template <typename Source>
+bool decompress(void* outData, std::size_t outSize, Source& source)
+{
+	using namespace detail;
+	std::uint8_t* bytes = reinterpret_cast<std::uint8_t*>(outData);
+	std::size_t pos = 0;
+	while (true)
+	{
+		std::uint8_t token;
+		if (!source.read(&token, 1))
+			return false;
+
+		std::size_t literalLength = token >> 4;
+		if (literalLength == compressionLengthMask &&
+			!readCompressionLength(literalLength, source, outSize - pos))
+		{
+			return false;
+		}
+
+		if (literalLength > outSize - pos || !source.read(bytes + pos, literalLength))
+			return false;
+
+		pos += literalLength;
+		if (pos == outSize)
+			return source.atEnd();
+
+		std::uint8_t offsetBytes[2];
+		if (!source.read(offsetBytes, sizeof(offsetBytes)))
+			return false;
+
+		std::size_t offset = offsetBytes[0] | offsetBytes[1] << 8;
+		if (offset == 0 || offset > pos)
+			return false;
+
+		std::size_t length = token & compressionLengthMask;
+		if (length == compressionLengthMask &&
+			!readCompressionLength(length, source, outSize - pos))
+		{
+			return false;
+		}
+
+		length += compressionMinMatch;
+		if (length > outSize - pos)
+			return false;
+
+		// Matches may overlap with the output being written, in which case copy byte by byte to
+		// repeat the pattern.
+		const std::uint8_t* match = bytes + pos - offset;
+		if (offset >= length)
+			std::memcpy(bytes + pos, match, length);
+		else
+		{
+			for (std::size_t i = 0; i < length; ++i)
+				bytes[pos + i] = match[i];
+		}
+		pos += length;
+	}
+}
+
+} // namespace mslb
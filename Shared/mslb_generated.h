@@ -50,6 +50,9 @@ struct AttributeBuilder;
 struct FragmentOutput;
 struct FragmentOutputBuilder;
 
+struct SpecializationConstant;
+struct SpecializationConstantBuilder;
+
 struct Shader;
 struct ShaderBuilder;
 
@@ -61,6 +64,12 @@ struct PipelineBuilder;
 struct ShaderData;
 struct ShaderDataBuilder;
 
+struct VariantKeyword;
+struct VariantKeywordBuilder;
+
+struct Variant;
+struct VariantBuilder;
+
 struct Module;
 struct ModuleBuilder;
 
@@ -1142,6 +1151,99 @@ inline const char *EnumNameBorderColor(BorderColor e) {
   return EnumNamesBorderColor()[index];
 }
 
+enum class Compression : uint8_t {
+  None = 0,
+  LZ4 = 1,
+  MIN = None,
+  MAX = LZ4
+};
+
+inline const Compression (&EnumValuesCompression())[2] {
+  static const Compression values[] = {
+    Compression::None,
+    Compression::LZ4
+  };
+  return values;
+}
+
+inline const char * const *EnumNamesCompression() {
+  static const char * const names[3] = {
+    "None",
+    "LZ4",
+    nullptr
+  };
+  return names;
+}
+
+inline const char *EnumNameCompression(Compression e) {
+  if (::flatbuffers::IsOutRange(e, Compression::None, Compression::LZ4)) return "";
+  const size_t index = static_cast<size_t>(e);
+  return EnumNamesCompression()[index];
+}
+
+enum class Encoding : uint8_t {
+  None = 0,
+  SpirV = 1,
+  MIN = None,
+  MAX = SpirV
+};
+
+inline const Encoding (&EnumValuesEncoding())[2] {
+  static const Encoding values[] = {
+    Encoding::None,
+    Encoding::SpirV
+  };
+  return values;
+}
+
+inline const char * const *EnumNamesEncoding() {
+  static const char * const names[3] = {
+    "None",
+    "SpirV",
+    nullptr
+  };
+  return names;
+}
+
+inline const char *EnumNameEncoding(Encoding e) {
+  if (::flatbuffers::IsOutRange(e, Encoding::None, Encoding::SpirV)) return "";
+  const size_t index = static_cast<size_t>(e);
+  return EnumNamesEncoding()[index];
+}
+
+enum class ShaderDataFormat : uint8_t {
+  Native = 0,
+  Source = 1,
+  LibraryFunction = 2,
+  MIN = Native,
+  MAX = LibraryFunction
+};
+
+inline const ShaderDataFormat (&EnumValuesShaderDataFormat())[3] {
+  static const ShaderDataFormat values[] = {
+    ShaderDataFormat::Native,
+    ShaderDataFormat::Source,
+    ShaderDataFormat::LibraryFunction
+  };
+  return values;
+}
+
+inline const char * const *EnumNamesShaderDataFormat() {
+  static const char * const names[4] = {
+    "Native",
+    "Source",
+    "LibraryFunction",
+    nullptr
+  };
+  return names;
+}
+
+inline const char *EnumNameShaderDataFormat(ShaderDataFormat e) {
+  if (::flatbuffers::IsOutRange(e, ShaderDataFormat::Native, ShaderDataFormat::LibraryFunction)) return "";
+  const size_t index = static_cast<size_t>(e);
+  return EnumNamesShaderDataFormat()[index];
+}
+
 FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(4) RasterizationState FLATBUFFERS_FINAL_CLASS {
  private:
   int8_t depthClampEnable_;
@@ -2637,11 +2739,114 @@ inline ::flatbuffers::Offset<FragmentOutput> CreateFragmentOutputDirect(
       location);
 }
 
+struct SpecializationConstant FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
+  typedef SpecializationConstantBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_NAME = 4,
+    VT_TYPE = 6,
+    VT_ID = 8,
+    VT_DEFAULTVALUE = 10
+  };
+  const ::flatbuffers::String *name() const {
+    return GetPointer<const ::flatbuffers::String *>(VT_NAME);
+  }
+  ::flatbuffers::String *mutable_name() {
+    return GetPointer<::flatbuffers::String *>(VT_NAME);
+  }
+  mslb::Type type() const {
+    return static_cast<mslb::Type>(GetField<uint8_t>(VT_TYPE, 0));
+  }
+  bool mutate_type(mslb::Type _type = static_cast<mslb::Type>(0)) {
+    return SetField<uint8_t>(VT_TYPE, static_cast<uint8_t>(_type), 0);
+  }
+  uint32_t id() const {
+    return GetField<uint32_t>(VT_ID, 0);
+  }
+  bool mutate_id(uint32_t _id = 0) {
+    return SetField<uint32_t>(VT_ID, _id, 0);
+  }
+  double defaultValue() const {
+    return GetField<double>(VT_DEFAULTVALUE, 0.0);
+  }
+  bool mutate_defaultValue(double _defaultValue = 0.0) {
+    return SetField<double>(VT_DEFAULTVALUE, _defaultValue, 0.0);
+  }
+  template <bool B = false>
+  bool Verify(::flatbuffers::VerifierTemplate<B> &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffsetRequired(verifier, VT_NAME) &&
+           verifier.VerifyString(name()) &&
+           VerifyField<uint8_t>(verifier, VT_TYPE, 1) &&
+           VerifyField<uint32_t>(verifier, VT_ID, 4) &&
+           VerifyField<double>(verifier, VT_DEFAULTVALUE, 8) &&
+           verifier.EndTable();
+  }
+};
+
+struct SpecializationConstantBuilder {
+  typedef SpecializationConstant Table;
+  ::flatbuffers::FlatBufferBuilder &fbb_;
+  ::flatbuffers::uoffset_t start_;
+  void add_name(::flatbuffers::Offset<::flatbuffers::String> name) {
+    fbb_.AddOffset(SpecializationConstant::VT_NAME, name);
+  }
+  void add_type(mslb::Type type) {
+    fbb_.AddElement<uint8_t>(SpecializationConstant::VT_TYPE, static_cast<uint8_t>(type), 0);
+  }
+  void add_id(uint32_t id) {
+    fbb_.AddElement<uint32_t>(SpecializationConstant::VT_ID, id, 0);
+  }
+  void add_defaultValue(double defaultValue) {
+    fbb_.AddElement<double>(SpecializationConstant::VT_DEFAULTVALUE, defaultValue, 0.0);
+  }
+  explicit SpecializationConstantBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ::flatbuffers::Offset<SpecializationConstant> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = ::flatbuffers::Offset<SpecializationConstant>(end);
+    fbb_.Required(o, SpecializationConstant::VT_NAME);
+    return o;
+  }
+};
+
+inline ::flatbuffers::Offset<SpecializationConstant> CreateSpecializationConstant(
+    ::flatbuffers::FlatBufferBuilder &_fbb,
+    ::flatbuffers::Offset<::flatbuffers::String> name = 0,
+    mslb::Type type = mslb::Type::Float,
+    uint32_t id = 0,
+    double defaultValue = 0.0) {
+  SpecializationConstantBuilder builder_(_fbb);
+  builder_.add_defaultValue(defaultValue);
+  builder_.add_id(id);
+  builder_.add_name(name);
+  builder_.add_type(type);
+  return builder_.Finish();
+}
+
+inline ::flatbuffers::Offset<SpecializationConstant> CreateSpecializationConstantDirect(
+    ::flatbuffers::FlatBufferBuilder &_fbb,
+    const char *name = nullptr,
+    mslb::Type type = mslb::Type::Float,
+    uint32_t id = 0,
+    double defaultValue = 0.0) {
+  auto name__ = name ? _fbb.CreateString(name) : 0;
+  return mslb::CreateSpecializationConstant(
+      _fbb,
+      name__,
+      type,
+      id,
+      defaultValue);
+}
+
 struct Shader FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   typedef ShaderBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
     VT_SHADER = 4,
-    VT_UNIFORMIDS = 6
+    VT_UNIFORMIDS = 6,
+    VT_DESCRIPTORSETOFFSETS = 8,
+    VT_BINDINGOFFSETS = 10
   };
   uint32_t shader() const {
     return GetField<uint32_t>(VT_SHADER, 0);
@@ -2655,12 +2860,28 @@ struct Shader FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   ::flatbuffers::Vector<uint32_t> *mutable_uniformIds() {
     return GetPointer<::flatbuffers::Vector<uint32_t> *>(VT_UNIFORMIDS);
   }
+  const ::flatbuffers::Vector<uint32_t> *descriptorSetOffsets() const {
+    return GetPointer<const ::flatbuffers::Vector<uint32_t> *>(VT_DESCRIPTORSETOFFSETS);
+  }
+  ::flatbuffers::Vector<uint32_t> *mutable_descriptorSetOffsets() {
+    return GetPointer<::flatbuffers::Vector<uint32_t> *>(VT_DESCRIPTORSETOFFSETS);
+  }
+  const ::flatbuffers::Vector<uint32_t> *bindingOffsets() const {
+    return GetPointer<const ::flatbuffers::Vector<uint32_t> *>(VT_BINDINGOFFSETS);
+  }
+  ::flatbuffers::Vector<uint32_t> *mutable_bindingOffsets() {
+    return GetPointer<::flatbuffers::Vector<uint32_t> *>(VT_BINDINGOFFSETS);
+  }
   template <bool B = false>
   bool Verify(::flatbuffers::VerifierTemplate<B> &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<uint32_t>(verifier, VT_SHADER, 4) &&
            VerifyOffset(verifier, VT_UNIFORMIDS) &&
            verifier.VerifyVector(uniformIds()) &&
+           VerifyOffset(verifier, VT_DESCRIPTORSETOFFSETS) &&
+           verifier.VerifyVector(descriptorSetOffsets()) &&
+           VerifyOffset(verifier, VT_BINDINGOFFSETS) &&
+           verifier.VerifyVector(bindingOffsets()) &&
            verifier.EndTable();
   }
 };
@@ -2675,6 +2896,12 @@ struct ShaderBuilder {
   void add_uniformIds(::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> uniformIds) {
     fbb_.AddOffset(Shader::VT_UNIFORMIDS, uniformIds);
   }
+  void add_descriptorSetOffsets(::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> descriptorSetOffsets) {
+    fbb_.AddOffset(Shader::VT_DESCRIPTORSETOFFSETS, descriptorSetOffsets);
+  }
+  void add_bindingOffsets(::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> bindingOffsets) {
+    fbb_.AddOffset(Shader::VT_BINDINGOFFSETS, bindingOffsets);
+  }
   explicit ShaderBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -2689,8 +2916,12 @@ struct ShaderBuilder {
 inline ::flatbuffers::Offset<Shader> CreateShader(
     ::flatbuffers::FlatBufferBuilder &_fbb,
     uint32_t shader = 0,
-    ::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> uniformIds = 0) {
+    ::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> uniformIds = 0,
+    ::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> descriptorSetOffsets = 0,
+    ::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> bindingOffsets = 0) {
   ShaderBuilder builder_(_fbb);
+  builder_.add_bindingOffsets(bindingOffsets);
+  builder_.add_descriptorSetOffsets(descriptorSetOffsets);
   builder_.add_uniformIds(uniformIds);
   builder_.add_shader(shader);
   return builder_.Finish();
@@ -2699,12 +2930,18 @@ inline ::flatbuffers::Offset<Shader> CreateShader(
 inline ::flatbuffers::Offset<Shader> CreateShaderDirect(
     ::flatbuffers::FlatBufferBuilder &_fbb,
     uint32_t shader = 0,
-    const std::vector<uint32_t> *uniformIds = nullptr) {
+    const std::vector<uint32_t> *uniformIds = nullptr,
+    const std::vector<uint32_t> *descriptorSetOffsets = nullptr,
+    const std::vector<uint32_t> *bindingOffsets = nullptr) {
   auto uniformIds__ = uniformIds ? _fbb.CreateVector<uint32_t>(*uniformIds) : 0;
+  auto descriptorSetOffsets__ = descriptorSetOffsets ? _fbb.CreateVector<uint32_t>(*descriptorSetOffsets) : 0;
+  auto bindingOffsets__ = bindingOffsets ? _fbb.CreateVector<uint32_t>(*bindingOffsets) : 0;
   return mslb::CreateShader(
       _fbb,
       shader,
-      uniformIds__);
+      uniformIds__,
+      descriptorSetOffsets__,
+      bindingOffsets__);
 }
 
 struct Pipeline FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
@@ -2719,7 +2956,11 @@ struct Pipeline FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
     VT_PUSHCONSTANTSTRUCT = 16,
     VT_RENDERSTATE = 18,
     VT_SHADERS = 20,
-    VT_COMPUTLOCALSIZE = 22
+    VT_COMPUTLOCALSIZE = 22,
+    VT_SPECIALIZATIONCONSTANTS = 24,
+    VT_STRUCTNAMEORDER = 26,
+    VT_UNIFORMNAMEORDER = 28,
+    VT_ATTRIBUTENAMEORDER = 30
   };
   const ::flatbuffers::String *name() const {
     return GetPointer<const ::flatbuffers::String *>(VT_NAME);
@@ -2781,6 +3022,30 @@ struct Pipeline FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   mslb::ComputeLocalSize *mutable_computLocalSize() {
     return GetStruct<mslb::ComputeLocalSize *>(VT_COMPUTLOCALSIZE);
   }
+  const ::flatbuffers::Vector<::flatbuffers::Offset<mslb::SpecializationConstant>> *specializationConstants() const {
+    return GetPointer<const ::flatbuffers::Vector<::flatbuffers::Offset<mslb::SpecializationConstant>> *>(VT_SPECIALIZATIONCONSTANTS);
+  }
+  ::flatbuffers::Vector<::flatbuffers::Offset<mslb::SpecializationConstant>> *mutable_specializationConstants() {
+    return GetPointer<::flatbuffers::Vector<::flatbuffers::Offset<mslb::SpecializationConstant>> *>(VT_SPECIALIZATIONCONSTANTS);
+  }
+  const ::flatbuffers::Vector<uint32_t> *structNameOrder() const {
+    return GetPointer<const ::flatbuffers::Vector<uint32_t> *>(VT_STRUCTNAMEORDER);
+  }
+  ::flatbuffers::Vector<uint32_t> *mutable_structNameOrder() {
+    return GetPointer<::flatbuffers::Vector<uint32_t> *>(VT_STRUCTNAMEORDER);
+  }
+  const ::flatbuffers::Vector<uint32_t> *uniformNameOrder() const {
+    return GetPointer<const ::flatbuffers::Vector<uint32_t> *>(VT_UNIFORMNAMEORDER);
+  }
+  ::flatbuffers::Vector<uint32_t> *mutable_uniformNameOrder() {
+    return GetPointer<::flatbuffers::Vector<uint32_t> *>(VT_UNIFORMNAMEORDER);
+  }
+  const ::flatbuffers::Vector<uint32_t> *attributeNameOrder() const {
+    return GetPointer<const ::flatbuffers::Vector<uint32_t> *>(VT_ATTRIBUTENAMEORDER);
+  }
+  ::flatbuffers::Vector<uint32_t> *mutable_attributeNameOrder() {
+    return GetPointer<::flatbuffers::Vector<uint32_t> *>(VT_ATTRIBUTENAMEORDER);
+  }
   template <bool B = false>
   bool Verify(::flatbuffers::VerifierTemplate<B> &verifier) const {
     return VerifyTableStart(verifier) &&
@@ -2807,6 +3072,15 @@ struct Pipeline FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
            verifier.VerifyVector(shaders()) &&
            verifier.VerifyVectorOfTables(shaders()) &&
            VerifyField<mslb::ComputeLocalSize>(verifier, VT_COMPUTLOCALSIZE, 4) &&
+           VerifyOffset(verifier, VT_SPECIALIZATIONCONSTANTS) &&
+           verifier.VerifyVector(specializationConstants()) &&
+           verifier.VerifyVectorOfTables(specializationConstants()) &&
+           VerifyOffset(verifier, VT_STRUCTNAMEORDER) &&
+           verifier.VerifyVector(structNameOrder()) &&
+           VerifyOffset(verifier, VT_UNIFORMNAMEORDER) &&
+           verifier.VerifyVector(uniformNameOrder()) &&
+           VerifyOffset(verifier, VT_ATTRIBUTENAMEORDER) &&
+           verifier.VerifyVector(attributeNameOrder()) &&
            verifier.EndTable();
   }
 };
@@ -2845,6 +3119,18 @@ struct PipelineBuilder {
   void add_computLocalSize(const mslb::ComputeLocalSize *computLocalSize) {
     fbb_.AddStruct(Pipeline::VT_COMPUTLOCALSIZE, computLocalSize);
   }
+  void add_specializationConstants(::flatbuffers::Offset<::flatbuffers::Vector<::flatbuffers::Offset<mslb::SpecializationConstant>>> specializationConstants) {
+    fbb_.AddOffset(Pipeline::VT_SPECIALIZATIONCONSTANTS, specializationConstants);
+  }
+  void add_structNameOrder(::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> structNameOrder) {
+    fbb_.AddOffset(Pipeline::VT_STRUCTNAMEORDER, structNameOrder);
+  }
+  void add_uniformNameOrder(::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> uniformNameOrder) {
+    fbb_.AddOffset(Pipeline::VT_UNIFORMNAMEORDER, uniformNameOrder);
+  }
+  void add_attributeNameOrder(::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> attributeNameOrder) {
+    fbb_.AddOffset(Pipeline::VT_ATTRIBUTENAMEORDER, attributeNameOrder);
+  }
   explicit PipelineBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -2875,8 +3161,16 @@ inline ::flatbuffers::Offset<Pipeline> CreatePipeline(
     uint32_t pushConstantStruct = 0,
     ::flatbuffers::Offset<mslb::RenderState> renderState = 0,
     ::flatbuffers::Offset<::flatbuffers::Vector<::flatbuffers::Offset<mslb::Shader>>> shaders = 0,
-    const mslb::ComputeLocalSize *computLocalSize = nullptr) {
+    const mslb::ComputeLocalSize *computLocalSize = nullptr,
+    ::flatbuffers::Offset<::flatbuffers::Vector<::flatbuffers::Offset<mslb::SpecializationConstant>>> specializationConstants = 0,
+    ::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> structNameOrder = 0,
+    ::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> uniformNameOrder = 0,
+    ::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> attributeNameOrder = 0) {
   PipelineBuilder builder_(_fbb);
+  builder_.add_attributeNameOrder(attributeNameOrder);
+  builder_.add_uniformNameOrder(uniformNameOrder);
+  builder_.add_structNameOrder(structNameOrder);
+  builder_.add_specializationConstants(specializationConstants);
   builder_.add_computLocalSize(computLocalSize);
   builder_.add_shaders(shaders);
   builder_.add_renderState(renderState);
@@ -2901,7 +3195,11 @@ inline ::flatbuffers::Offset<Pipeline> CreatePipelineDirect(
     uint32_t pushConstantStruct = 0,
     ::flatbuffers::Offset<mslb::RenderState> renderState = 0,
     const std::vector<::flatbuffers::Offset<mslb::Shader>> *shaders = nullptr,
-    const mslb::ComputeLocalSize *computLocalSize = nullptr) {
+    const mslb::ComputeLocalSize *computLocalSize = nullptr,
+    const std::vector<::flatbuffers::Offset<mslb::SpecializationConstant>> *specializationConstants = nullptr,
+    const std::vector<uint32_t> *structNameOrder = nullptr,
+    const std::vector<uint32_t> *uniformNameOrder = nullptr,
+    const std::vector<uint32_t> *attributeNameOrder = nullptr) {
   auto name__ = name ? _fbb.CreateString(name) : 0;
   auto structs__ = structs ? _fbb.CreateVector<::flatbuffers::Offset<mslb::Struct>>(*structs) : 0;
   auto samplerStates__ = samplerStates ? _fbb.CreateVectorOfStructs<mslb::SamplerState>(*samplerStates) : 0;
@@ -2909,6 +3207,10 @@ inline ::flatbuffers::Offset<Pipeline> CreatePipelineDirect(
   auto attributes__ = attributes ? _fbb.CreateVector<::flatbuffers::Offset<mslb::Attribute>>(*attributes) : 0;
   auto fragmentOutputs__ = fragmentOutputs ? _fbb.CreateVector<::flatbuffers::Offset<mslb::FragmentOutput>>(*fragmentOutputs) : 0;
   auto shaders__ = shaders ? _fbb.CreateVector<::flatbuffers::Offset<mslb::Shader>>(*shaders) : 0;
+  auto specializationConstants__ = specializationConstants ? _fbb.CreateVector<::flatbuffers::Offset<mslb::SpecializationConstant>>(*specializationConstants) : 0;
+  auto structNameOrder__ = structNameOrder ? _fbb.CreateVector<uint32_t>(*structNameOrder) : 0;
+  auto uniformNameOrder__ = uniformNameOrder ? _fbb.CreateVector<uint32_t>(*uniformNameOrder) : 0;
+  auto attributeNameOrder__ = attributeNameOrder ? _fbb.CreateVector<uint32_t>(*attributeNameOrder) : 0;
   return mslb::CreatePipeline(
       _fbb,
       name__,
@@ -2920,14 +3222,25 @@ inline ::flatbuffers::Offset<Pipeline> CreatePipelineDirect(
       pushConstantStruct,
       renderState,
       shaders__,
-      computLocalSize);
+      computLocalSize,
+      specializationConstants__,
+      structNameOrder__,
+      uniformNameOrder__,
+      attributeNameOrder__);
 }
 
 struct ShaderData FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   typedef ShaderDataBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
     VT_DATA = 4,
-    VT_USESPUSHCONSTANTS = 6
+    VT_USESPUSHCONSTANTS = 6,
+    VT_PAYLOADOFFSET = 8,
+    VT_PAYLOADSIZE = 10,
+    VT_PAYLOADCHECKSUM = 12,
+    VT_COMPRESSION = 14,
+    VT_UNCOMPRESSEDSIZE = 16,
+    VT_ENCODING = 18,
+    VT_DECODEDSIZE = 20
   };
   const ::flatbuffers::Vector<uint8_t> *data() const {
     return GetPointer<const ::flatbuffers::Vector<uint8_t> *>(VT_DATA);
@@ -2941,12 +3254,61 @@ struct ShaderData FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   bool mutate_usesPushConstants(bool _usesPushConstants = 1) {
     return SetField<uint8_t>(VT_USESPUSHCONSTANTS, static_cast<uint8_t>(_usesPushConstants), 1);
   }
+  uint32_t payloadOffset() const {
+    return GetField<uint32_t>(VT_PAYLOADOFFSET, 0);
+  }
+  bool mutate_payloadOffset(uint32_t _payloadOffset = 0) {
+    return SetField<uint32_t>(VT_PAYLOADOFFSET, _payloadOffset, 0);
+  }
+  uint32_t payloadSize() const {
+    return GetField<uint32_t>(VT_PAYLOADSIZE, 0);
+  }
+  bool mutate_payloadSize(uint32_t _payloadSize = 0) {
+    return SetField<uint32_t>(VT_PAYLOADSIZE, _payloadSize, 0);
+  }
+  uint64_t payloadChecksum() const {
+    return GetField<uint64_t>(VT_PAYLOADCHECKSUM, 0);
+  }
+  bool mutate_payloadChecksum(uint64_t _payloadChecksum = 0) {
+    return SetField<uint64_t>(VT_PAYLOADCHECKSUM, _payloadChecksum, 0);
+  }
+  mslb::Compression compression() const {
+    return static_cast<mslb::Compression>(GetField<uint8_t>(VT_COMPRESSION, 0));
+  }
+  bool mutate_compression(mslb::Compression _compression = static_cast<mslb::Compression>(0)) {
+    return SetField<uint8_t>(VT_COMPRESSION, static_cast<uint8_t>(_compression), 0);
+  }
+  uint32_t uncompressedSize() const {
+    return GetField<uint32_t>(VT_UNCOMPRESSEDSIZE, 0);
+  }
+  bool mutate_uncompressedSize(uint32_t _uncompressedSize = 0) {
+    return SetField<uint32_t>(VT_UNCOMPRESSEDSIZE, _uncompressedSize, 0);
+  }
+  mslb::Encoding encoding() const {
+    return static_cast<mslb::Encoding>(GetField<uint8_t>(VT_ENCODING, 0));
+  }
+  bool mutate_encoding(mslb::Encoding _encoding = static_cast<mslb::Encoding>(0)) {
+    return SetField<uint8_t>(VT_ENCODING, static_cast<uint8_t>(_encoding), 0);
+  }
+  uint32_t decodedSize() const {
+    return GetField<uint32_t>(VT_DECODEDSIZE, 0);
+  }
+  bool mutate_decodedSize(uint32_t _decodedSize = 0) {
+    return SetField<uint32_t>(VT_DECODEDSIZE, _decodedSize, 0);
+  }
   template <bool B = false>
   bool Verify(::flatbuffers::VerifierTemplate<B> &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyOffsetRequired(verifier, VT_DATA) &&
            verifier.VerifyVector(data()) &&
            VerifyField<uint8_t>(verifier, VT_USESPUSHCONSTANTS, 1) &&
+           VerifyField<uint32_t>(verifier, VT_PAYLOADOFFSET, 4) &&
+           VerifyField<uint32_t>(verifier, VT_PAYLOADSIZE, 4) &&
+           VerifyField<uint64_t>(verifier, VT_PAYLOADCHECKSUM, 8) &&
+           VerifyField<uint8_t>(verifier, VT_COMPRESSION, 1) &&
+           VerifyField<uint32_t>(verifier, VT_UNCOMPRESSEDSIZE, 4) &&
+           VerifyField<uint8_t>(verifier, VT_ENCODING, 1) &&
+           VerifyField<uint32_t>(verifier, VT_DECODEDSIZE, 4) &&
            verifier.EndTable();
   }
 };
@@ -2961,6 +3323,27 @@ struct ShaderDataBuilder {
   void add_usesPushConstants(bool usesPushConstants) {
     fbb_.AddElement<uint8_t>(ShaderData::VT_USESPUSHCONSTANTS, static_cast<uint8_t>(usesPushConstants), 1);
   }
+  void add_payloadOffset(uint32_t payloadOffset) {
+    fbb_.AddElement<uint32_t>(ShaderData::VT_PAYLOADOFFSET, payloadOffset, 0);
+  }
+  void add_payloadSize(uint32_t payloadSize) {
+    fbb_.AddElement<uint32_t>(ShaderData::VT_PAYLOADSIZE, payloadSize, 0);
+  }
+  void add_payloadChecksum(uint64_t payloadChecksum) {
+    fbb_.AddElement<uint64_t>(ShaderData::VT_PAYLOADCHECKSUM, payloadChecksum, 0);
+  }
+  void add_compression(mslb::Compression compression) {
+    fbb_.AddElement<uint8_t>(ShaderData::VT_COMPRESSION, static_cast<uint8_t>(compression), 0);
+  }
+  void add_uncompressedSize(uint32_t uncompressedSize) {
+    fbb_.AddElement<uint32_t>(ShaderData::VT_UNCOMPRESSEDSIZE, uncompressedSize, 0);
+  }
+  void add_encoding(mslb::Encoding encoding) {
+    fbb_.AddElement<uint8_t>(ShaderData::VT_ENCODING, static_cast<uint8_t>(encoding), 0);
+  }
+  void add_decodedSize(uint32_t decodedSize) {
+    fbb_.AddElement<uint32_t>(ShaderData::VT_DECODEDSIZE, decodedSize, 0);
+  }
   explicit ShaderDataBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -2976,9 +3359,23 @@ struct ShaderDataBuilder {
 inline ::flatbuffers::Offset<ShaderData> CreateShaderData(
     ::flatbuffers::FlatBufferBuilder &_fbb,
     ::flatbuffers::Offset<::flatbuffers::Vector<uint8_t>> data = 0,
-    bool usesPushConstants = true) {
+    bool usesPushConstants = true,
+    uint32_t payloadOffset = 0,
+    uint32_t payloadSize = 0,
+    uint64_t payloadChecksum = 0,
+    mslb::Compression compression = mslb::Compression::None,
+    uint32_t uncompressedSize = 0,
+    mslb::Encoding encoding = mslb::Encoding::None,
+    uint32_t decodedSize = 0) {
   ShaderDataBuilder builder_(_fbb);
+  builder_.add_payloadChecksum(payloadChecksum);
+  builder_.add_decodedSize(decodedSize);
+  builder_.add_uncompressedSize(uncompressedSize);
+  builder_.add_payloadSize(payloadSize);
+  builder_.add_payloadOffset(payloadOffset);
   builder_.add_data(data);
+  builder_.add_encoding(encoding);
+  builder_.add_compression(compression);
   builder_.add_usesPushConstants(usesPushConstants);
   return builder_.Finish();
 }
@@ -2986,12 +3383,175 @@ inline ::flatbuffers::Offset<ShaderData> CreateShaderData(
 inline ::flatbuffers::Offset<ShaderData> CreateShaderDataDirect(
     ::flatbuffers::FlatBufferBuilder &_fbb,
     const std::vector<uint8_t> *data = nullptr,
-    bool usesPushConstants = true) {
+    bool usesPushConstants = true,
+    uint32_t payloadOffset = 0,
+    uint32_t payloadSize = 0,
+    uint64_t payloadChecksum = 0,
+    mslb::Compression compression = mslb::Compression::None,
+    uint32_t uncompressedSize = 0,
+    mslb::Encoding encoding = mslb::Encoding::None,
+    uint32_t decodedSize = 0) {
   auto data__ = data ? _fbb.CreateVector<uint8_t>(*data) : 0;
   return mslb::CreateShaderData(
       _fbb,
       data__,
-      usesPushConstants);
+      usesPushConstants,
+      payloadOffset,
+      payloadSize,
+      payloadChecksum,
+      compression,
+      uncompressedSize,
+      encoding,
+      decodedSize);
+}
+
+struct VariantKeyword FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
+  typedef VariantKeywordBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_NAME = 4,
+    VT_VALUES = 6
+  };
+  const ::flatbuffers::String *name() const {
+    return GetPointer<const ::flatbuffers::String *>(VT_NAME);
+  }
+  ::flatbuffers::String *mutable_name() {
+    return GetPointer<::flatbuffers::String *>(VT_NAME);
+  }
+  const ::flatbuffers::Vector<::flatbuffers::Offset<::flatbuffers::String>> *values() const {
+    return GetPointer<const ::flatbuffers::Vector<::flatbuffers::Offset<::flatbuffers::String>> *>(VT_VALUES);
+  }
+  ::flatbuffers::Vector<::flatbuffers::Offset<::flatbuffers::String>> *mutable_values() {
+    return GetPointer<::flatbuffers::Vector<::flatbuffers::Offset<::flatbuffers::String>> *>(VT_VALUES);
+  }
+  template <bool B = false>
+  bool Verify(::flatbuffers::VerifierTemplate<B> &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffsetRequired(verifier, VT_NAME) &&
+           verifier.VerifyString(name()) &&
+           VerifyOffsetRequired(verifier, VT_VALUES) &&
+           verifier.VerifyVector(values()) &&
+           verifier.VerifyVectorOfStrings(values()) &&
+           verifier.EndTable();
+  }
+};
+
+struct VariantKeywordBuilder {
+  typedef VariantKeyword Table;
+  ::flatbuffers::FlatBufferBuilder &fbb_;
+  ::flatbuffers::uoffset_t start_;
+  void add_name(::flatbuffers::Offset<::flatbuffers::String> name) {
+    fbb_.AddOffset(VariantKeyword::VT_NAME, name);
+  }
+  void add_values(::flatbuffers::Offset<::flatbuffers::Vector<::flatbuffers::Offset<::flatbuffers::String>>> values) {
+    fbb_.AddOffset(VariantKeyword::VT_VALUES, values);
+  }
+  explicit VariantKeywordBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ::flatbuffers::Offset<VariantKeyword> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = ::flatbuffers::Offset<VariantKeyword>(end);
+    fbb_.Required(o, VariantKeyword::VT_NAME);
+    fbb_.Required(o, VariantKeyword::VT_VALUES);
+    return o;
+  }
+};
+
+inline ::flatbuffers::Offset<VariantKeyword> CreateVariantKeyword(
+    ::flatbuffers::FlatBufferBuilder &_fbb,
+    ::flatbuffers::Offset<::flatbuffers::String> name = 0,
+    ::flatbuffers::Offset<::flatbuffers::Vector<::flatbuffers::Offset<::flatbuffers::String>>> values = 0) {
+  VariantKeywordBuilder builder_(_fbb);
+  builder_.add_values(values);
+  builder_.add_name(name);
+  return builder_.Finish();
+}
+
+inline ::flatbuffers::Offset<VariantKeyword> CreateVariantKeywordDirect(
+    ::flatbuffers::FlatBufferBuilder &_fbb,
+    const char *name = nullptr,
+    const std::vector<::flatbuffers::Offset<::flatbuffers::String>> *values = nullptr) {
+  auto name__ = name ? _fbb.CreateString(name) : 0;
+  auto values__ = values ? _fbb.CreateVector<::flatbuffers::Offset<::flatbuffers::String>>(*values) : 0;
+  return mslb::CreateVariantKeyword(
+      _fbb,
+      name__,
+      values__);
+}
+
+struct Variant FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
+  typedef VariantBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_NAME = 4,
+    VT_PIPELINES = 6
+  };
+  const ::flatbuffers::String *name() const {
+    return GetPointer<const ::flatbuffers::String *>(VT_NAME);
+  }
+  ::flatbuffers::String *mutable_name() {
+    return GetPointer<::flatbuffers::String *>(VT_NAME);
+  }
+  const ::flatbuffers::Vector<uint32_t> *pipelines() const {
+    return GetPointer<const ::flatbuffers::Vector<uint32_t> *>(VT_PIPELINES);
+  }
+  ::flatbuffers::Vector<uint32_t> *mutable_pipelines() {
+    return GetPointer<::flatbuffers::Vector<uint32_t> *>(VT_PIPELINES);
+  }
+  template <bool B = false>
+  bool Verify(::flatbuffers::VerifierTemplate<B> &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffsetRequired(verifier, VT_NAME) &&
+           verifier.VerifyString(name()) &&
+           VerifyOffsetRequired(verifier, VT_PIPELINES) &&
+           verifier.VerifyVector(pipelines()) &&
+           verifier.EndTable();
+  }
+};
+
+struct VariantBuilder {
+  typedef Variant Table;
+  ::flatbuffers::FlatBufferBuilder &fbb_;
+  ::flatbuffers::uoffset_t start_;
+  void add_name(::flatbuffers::Offset<::flatbuffers::String> name) {
+    fbb_.AddOffset(Variant::VT_NAME, name);
+  }
+  void add_pipelines(::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> pipelines) {
+    fbb_.AddOffset(Variant::VT_PIPELINES, pipelines);
+  }
+  explicit VariantBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ::flatbuffers::Offset<Variant> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = ::flatbuffers::Offset<Variant>(end);
+    fbb_.Required(o, Variant::VT_NAME);
+    fbb_.Required(o, Variant::VT_PIPELINES);
+    return o;
+  }
+};
+
+inline ::flatbuffers::Offset<Variant> CreateVariant(
+    ::flatbuffers::FlatBufferBuilder &_fbb,
+    ::flatbuffers::Offset<::flatbuffers::String> name = 0,
+    ::flatbuffers::Offset<::flatbuffers::Vector<uint32_t>> pipelines = 0) {
+  VariantBuilder builder_(_fbb);
+  builder_.add_pipelines(pipelines);
+  builder_.add_name(name);
+  return builder_.Finish();
+}
+
+inline ::flatbuffers::Offset<Variant> CreateVariantDirect(
+    ::flatbuffers::FlatBufferBuilder &_fbb,
+    const char *name = nullptr,
+    const std::vector<uint32_t> *pipelines = nullptr) {
+  auto name__ = name ? _fbb.CreateString(name) : 0;
+  auto pipelines__ = pipelines ? _fbb.CreateVector<uint32_t>(*pipelines) : 0;
+  return mslb::CreateVariant(
+      _fbb,
+      name__,
+      pipelines__);
 }
 
 struct Module FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
@@ -3003,7 +3563,13 @@ struct Module FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
     VT_ADJUSTABLEBINDINGS = 10,
     VT_PIPELINES = 12,
     VT_SHADERS = 14,
-    VT_SHAREDDATA = 16
+    VT_SHAREDDATA = 16,
+    VT_VARIANTKEYWORDS = 18,
+    VT_VARIANTS = 20,
+    VT_ARGUMENTBUFFERS = 22,
+    VT_CHECKSUM = 24,
+    VT_SHADERALIGNMENT = 28,
+    VT_SHADERDATAFORMAT = 30
   };
   uint32_t version() const {
     return GetField<uint32_t>(VT_VERSION, 0);
@@ -3047,6 +3613,42 @@ struct Module FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   ::flatbuffers::Vector<uint8_t> *mutable_sharedData() {
     return GetPointer<::flatbuffers::Vector<uint8_t> *>(VT_SHAREDDATA);
   }
+  const ::flatbuffers::Vector<::flatbuffers::Offset<mslb::VariantKeyword>> *variantKeywords() const {
+    return GetPointer<const ::flatbuffers::Vector<::flatbuffers::Offset<mslb::VariantKeyword>> *>(VT_VARIANTKEYWORDS);
+  }
+  ::flatbuffers::Vector<::flatbuffers::Offset<mslb::VariantKeyword>> *mutable_variantKeywords() {
+    return GetPointer<::flatbuffers::Vector<::flatbuffers::Offset<mslb::VariantKeyword>> *>(VT_VARIANTKEYWORDS);
+  }
+  const ::flatbuffers::Vector<::flatbuffers::Offset<mslb::Variant>> *variants() const {
+    return GetPointer<const ::flatbuffers::Vector<::flatbuffers::Offset<mslb::Variant>> *>(VT_VARIANTS);
+  }
+  ::flatbuffers::Vector<::flatbuffers::Offset<mslb::Variant>> *mutable_variants() {
+    return GetPointer<::flatbuffers::Vector<::flatbuffers::Offset<mslb::Variant>> *>(VT_VARIANTS);
+  }
+  bool argumentBuffers() const {
+    return GetField<uint8_t>(VT_ARGUMENTBUFFERS, 0) != 0;
+  }
+  bool mutate_argumentBuffers(bool _argumentBuffers = 0) {
+    return SetField<uint8_t>(VT_ARGUMENTBUFFERS, static_cast<uint8_t>(_argumentBuffers), 0);
+  }
+  uint64_t checksum() const {
+    return GetField<uint64_t>(VT_CHECKSUM, 0);
+  }
+  bool mutate_checksum(uint64_t _checksum = 0) {
+    return SetField<uint64_t>(VT_CHECKSUM, _checksum, 0);
+  }
+  uint32_t shaderAlignment() const {
+    return GetField<uint32_t>(VT_SHADERALIGNMENT, 0);
+  }
+  bool mutate_shaderAlignment(uint32_t _shaderAlignment = 0) {
+    return SetField<uint32_t>(VT_SHADERALIGNMENT, _shaderAlignment, 0);
+  }
+  mslb::ShaderDataFormat shaderDataFormat() const {
+    return static_cast<mslb::ShaderDataFormat>(GetField<uint8_t>(VT_SHADERDATAFORMAT, 0));
+  }
+  bool mutate_shaderDataFormat(mslb::ShaderDataFormat _shaderDataFormat = static_cast<mslb::ShaderDataFormat>(0)) {
+    return SetField<uint8_t>(VT_SHADERDATAFORMAT, static_cast<uint8_t>(_shaderDataFormat), 0);
+  }
   template <bool B = false>
   bool Verify(::flatbuffers::VerifierTemplate<B> &verifier) const {
     return VerifyTableStart(verifier) &&
@@ -3062,6 +3664,16 @@ struct Module FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
            verifier.VerifyVectorOfTables(shaders()) &&
            VerifyOffsetRequired(verifier, VT_SHAREDDATA) &&
            verifier.VerifyVector(sharedData()) &&
+           VerifyOffset(verifier, VT_VARIANTKEYWORDS) &&
+           verifier.VerifyVector(variantKeywords()) &&
+           verifier.VerifyVectorOfTables(variantKeywords()) &&
+           VerifyOffset(verifier, VT_VARIANTS) &&
+           verifier.VerifyVector(variants()) &&
+           verifier.VerifyVectorOfTables(variants()) &&
+           VerifyField<uint8_t>(verifier, VT_ARGUMENTBUFFERS, 1) &&
+           VerifyField<uint64_t>(verifier, VT_CHECKSUM, 8) &&
+           VerifyField<uint32_t>(verifier, VT_SHADERALIGNMENT, 4) &&
+           VerifyField<uint8_t>(verifier, VT_SHADERDATAFORMAT, 1) &&
            verifier.EndTable();
   }
 };
@@ -3091,6 +3703,24 @@ struct ModuleBuilder {
   void add_sharedData(::flatbuffers::Offset<::flatbuffers::Vector<uint8_t>> sharedData) {
     fbb_.AddOffset(Module::VT_SHAREDDATA, sharedData);
   }
+  void add_variantKeywords(::flatbuffers::Offset<::flatbuffers::Vector<::flatbuffers::Offset<mslb::VariantKeyword>>> variantKeywords) {
+    fbb_.AddOffset(Module::VT_VARIANTKEYWORDS, variantKeywords);
+  }
+  void add_variants(::flatbuffers::Offset<::flatbuffers::Vector<::flatbuffers::Offset<mslb::Variant>>> variants) {
+    fbb_.AddOffset(Module::VT_VARIANTS, variants);
+  }
+  void add_argumentBuffers(bool argumentBuffers) {
+    fbb_.AddElement<uint8_t>(Module::VT_ARGUMENTBUFFERS, static_cast<uint8_t>(argumentBuffers), 0);
+  }
+  void add_checksum(uint64_t checksum) {
+    fbb_.AddElement<uint64_t>(Module::VT_CHECKSUM, checksum, 0);
+  }
+  void add_shaderAlignment(uint32_t shaderAlignment) {
+    fbb_.AddElement<uint32_t>(Module::VT_SHADERALIGNMENT, shaderAlignment, 0);
+  }
+  void add_shaderDataFormat(mslb::ShaderDataFormat shaderDataFormat) {
+    fbb_.AddElement<uint8_t>(Module::VT_SHADERDATAFORMAT, static_cast<uint8_t>(shaderDataFormat), 0);
+  }
   explicit ModuleBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -3113,14 +3743,26 @@ inline ::flatbuffers::Offset<Module> CreateModule(
     bool adjustableBindings = false,
     ::flatbuffers::Offset<::flatbuffers::Vector<::flatbuffers::Offset<mslb::Pipeline>>> pipelines = 0,
     ::flatbuffers::Offset<::flatbuffers::Vector<::flatbuffers::Offset<mslb::ShaderData>>> shaders = 0,
-    ::flatbuffers::Offset<::flatbuffers::Vector<uint8_t>> sharedData = 0) {
+    ::flatbuffers::Offset<::flatbuffers::Vector<uint8_t>> sharedData = 0,
+    ::flatbuffers::Offset<::flatbuffers::Vector<::flatbuffers::Offset<mslb::VariantKeyword>>> variantKeywords = 0,
+    ::flatbuffers::Offset<::flatbuffers::Vector<::flatbuffers::Offset<mslb::Variant>>> variants = 0,
+    bool argumentBuffers = false,
+    uint64_t checksum = 0,
+    uint32_t shaderAlignment = 0,
+    mslb::ShaderDataFormat shaderDataFormat = mslb::ShaderDataFormat::Native) {
   ModuleBuilder builder_(_fbb);
+  builder_.add_checksum(checksum);
+  builder_.add_shaderAlignment(shaderAlignment);
+  builder_.add_variants(variants);
+  builder_.add_variantKeywords(variantKeywords);
   builder_.add_sharedData(sharedData);
   builder_.add_shaders(shaders);
   builder_.add_pipelines(pipelines);
   builder_.add_targetVersion(targetVersion);
   builder_.add_targetId(targetId);
   builder_.add_version(version);
+  builder_.add_shaderDataFormat(shaderDataFormat);
+  builder_.add_argumentBuffers(argumentBuffers);
   builder_.add_adjustableBindings(adjustableBindings);
   return builder_.Finish();
 }
@@ -3133,10 +3775,18 @@ inline ::flatbuffers::Offset<Module> CreateModuleDirect(
     bool adjustableBindings = false,
     const std::vector<::flatbuffers::Offset<mslb::Pipeline>> *pipelines = nullptr,
     const std::vector<::flatbuffers::Offset<mslb::ShaderData>> *shaders = nullptr,
-    const std::vector<uint8_t> *sharedData = nullptr) {
+    const std::vector<uint8_t> *sharedData = nullptr,
+    const std::vector<::flatbuffers::Offset<mslb::VariantKeyword>> *variantKeywords = nullptr,
+    const std::vector<::flatbuffers::Offset<mslb::Variant>> *variants = nullptr,
+    bool argumentBuffers = false,
+    uint64_t checksum = 0,
+    uint32_t shaderAlignment = 0,
+    mslb::ShaderDataFormat shaderDataFormat = mslb::ShaderDataFormat::Native) {
   auto pipelines__ = pipelines ? _fbb.CreateVector<::flatbuffers::Offset<mslb::Pipeline>>(*pipelines) : 0;
   auto shaders__ = shaders ? _fbb.CreateVector<::flatbuffers::Offset<mslb::ShaderData>>(*shaders) : 0;
   auto sharedData__ = sharedData ? _fbb.CreateVector<uint8_t>(*sharedData) : 0;
+  auto variantKeywords__ = variantKeywords ? _fbb.CreateVector<::flatbuffers::Offset<mslb::VariantKeyword>>(*variantKeywords) : 0;
+  auto variants__ = variants ? _fbb.CreateVector<::flatbuffers::Offset<mslb::Variant>>(*variants) : 0;
   return mslb::CreateModule(
       _fbb,
       version,
@@ -3145,7 +3795,13 @@ inline ::flatbuffers::Offset<Module> CreateModuleDirect(
       adjustableBindings,
       pipelines__,
       shaders__,
-      sharedData__);
+      sharedData__,
+      variantKeywords__,
+      variants__,
+      argumentBuffers,
+      checksum,
+      shaderAlignment,
+      shaderDataFormat);
 }
 
 inline const mslb::Module *GetModule(const void *buf) {
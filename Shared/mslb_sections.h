@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Layout for sectioned modules, shared between the compiler when saving and the client when
+// loading. A sectioned module starts with a fixed size header, followed by the index flatbuffer
+// with the reflection for each pipeline, then the payload section with the data for each shader.
+// This allows the index to be loaded on its own and each shader to be loaded when it's used.
+//
+// Modules that aren't sectioned start with the root offset of the flatbuffer, which would only
+// match the magic value for a module over 1 GB.
+namespace mslb
+{
+
+// The first module version that may be sectioned.
+const std::uint32_t sectionedVersion = 1;
+
+// "MSLS" read as a little endian 32-bit value.
+const std::uint32_t sectionedMagic = 0x534C534D;
+
+// The header is 16 bytes to keep the index aligned for its 64-bit values.
+const std::size_t sectionedHeaderSize = 16;
+
+struct SectionedHeader
+{
+	// The size of the index flatbuffer, which starts immediately after the header.
+	std::uint32_t indexSize;
+
+	// The offset of the payload section from the start of the module. This is aligned to the
+	// shader alignment stored in the index.
+	std::uint32_t payloadOffset;
+};
+
+namespace detail
+{
+
+inline std::uint32_t readSectionedWord(const std::uint8_t* data)
+{
+	return static_cast<std::uint32_t>(data[0]) | (static_cast<std::uint32_t>(data[1]) << 8) |
+		(static_cast<std::uint32_t>(data[2]) << 16) | (static_cast<std::uint32_t>(data[3]) << 24);
+}
+
+inline void writeSectionedWord(std::uint8_t* data, std::uint32_t value)
+{
+	data[0] = static_cast<std::uint8_t>(value);
+	data[1] = static_cast<std::uint8_t>(value >> 8);
+	data[2] = static_cast<std::uint8_t>(value >> 16);
+	data[3] = static_cast<std::uint8_t>(value >> 24);
+}
+
+} // namespace detail
+
+// Checks if the start of a module is a sectioned header. This only requires the first 4 bytes.
+inline bool isSectioned(const void* data, std::size_t size)
+{
+	return size >= sizeof(std::uint32_t) &&
+		detail::readSectionedWord(reinterpret_cast<const std::uint8_t*>(data)) == sectionedMagic;
+}
+
+// Reads the header for a sectioned module, checking that the sections lie within the module size.
+// Returns false if the module isn't sectioned or the header is invalid.
+inline bool readSectionedHeader(SectionedHeader& outHeader, const void* data,
+	std::size_t moduleSize)
+{
+	if (moduleSize < sectionedHeaderSize || !isSectioned(data, moduleSize))
+		return false;
+
+	const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(data);
+	outHeader.indexSize = detail::readSectionedWord(bytes + 4);
+	outHeader.payloadOffset = detail::readSectionedWord(bytes + 8);
+	return outHeader.payloadOffset >= sectionedHeaderSize &&
+		outHeader.payloadOffset <= moduleSize && outHeader.indexSize > 0 &&
+		outHeader.indexSize <= outHeader.payloadOffset - sectionedHeaderSize;
+}
+
+// Writes the header for a sectioned module into sectionedHeaderSize bytes.
+inline void writeSectionedHeader(std::uint8_t* outData, const SectionedHeader& header)
+{
+	detail::writeSectionedWord(outData, sectionedMagic);
+	detail::writeSectionedWord(outData + 4, header.indexSize);
+	detail::writeSectionedWord(outData + 8, header.payloadOffset);
+	detail::writeSectionedWord(outData + 12, 0);
+}
+
+} // namespace mslb
@@ -0,0 +1,333 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Compact encoding for SPIR-V, shared between the compiler when saving and the client when loading.
+// This is similar to SMOL-V, but doesn't require tables for the operands of each instruction:
+// - The header words are stored as varints.
+// - The opcode and word count of each instruction are packed into a single varint.
+// - The first operands of each instruction are stored as the zigzag varint delta from the same
+//   operand of the previous instruction with the same opcode. This makes repeated type IDs a
+//   single byte and increasing result IDs small.
+// - Later operands are stored as the delta from the previous operand, since they are frequently
+//   IDs that were declared near each other.
+// - Operands for instructions that are mostly strings are stored as raw 32-bit values.
+//
+// The encoding is applied before compression, which is much more effective on the resulting bytes
+// than on raw SPIR-V words. The encoder only accepts data that can be decoded in place when placed
+// at the end of the output buffer, which allows the client to decompress and decode without a
+// separate buffer.
+namespace mslb
+{
+
+// The first module version that may contain encoded SPIR-V.
+const std::uint32_t spirVEncodingVersion = 3;
+
+namespace detail
+{
+
+const std::uint32_t spirVMagic = 0x07230203;
+const std::size_t spirVHeaderWords = 5;
+const std::uint32_t spirVWordCountShift = 16;
+const std::uint32_t spirVOpcodeMask = 0xFFFF;
+const std::uint32_t spirVMaxInlineLength = 0xF;
+const unsigned int spirVLengthBits = 4;
+const unsigned int spirVHistoryOperands = 4;
+const unsigned int spirVHistorySlots = 256;
+
+inline bool isSpirVStringOpcode(std::uint32_t opcode)
+{
+	switch (opcode)
+	{
+		case 2: // OpSourceContinued
+		case 3: // OpSource
+		case 4: // OpSourceExtension
+		case 5: // OpName
+		case 6: // OpMemberName
+		case 7: // OpString
+		case 10: // OpExtension
+		case 11: // OpExtInstImport
+		case 15: // OpEntryPoint
+		case 330: // OpModuleProcessed
+			return true;
+		default:
+			return false;
+	}
+}
+
+inline std::uint32_t readSpirVWord(const std::uint8_t* data)
+{
+	return static_cast<std::uint32_t>(data[0]) | (static_cast<std::uint32_t>(data[1]) << 8) |
+		(static_cast<std::uint32_t>(data[2]) << 16) | (static_cast<std::uint32_t>(data[3]) << 24);
+}
+
+inline void writeSpirVWord(std::uint8_t* data, std::uint32_t value)
+{
+	data[0] = static_cast<std::uint8_t>(value);
+	data[1] = static_cast<std::uint8_t>(value >> 8);
+	data[2] = static_cast<std::uint8_t>(value >> 16);
+	data[3] = static_cast<std::uint8_t>(value >> 24);
+}
+
+inline std::uint32_t zigzagEncode(std::uint32_t value)
+{
+	return (value << 1) ^ (0 - (value >> 31));
+}
+
+inline std::uint32_t zigzagDecode(std::uint32_t value)
+{
+	return (value >> 1) ^ (0 - (value & 1));
+}
+
+inline std::uint8_t* writeVarint(std::uint8_t* outData, std::uint32_t value)
+{
+	for (; value >= 0x80; value >>= 7)
+		*outData++ = static_cast<std::uint8_t>(value | 0x80);
+	*outData++ = static_cast<std::uint8_t>(value);
+	return outData;
+}
+
+template <typename Source>
+bool readVarint(std::uint32_t& outValue, Source& source)
+{
+	outValue = 0;
+	for (unsigned int shift = 0; shift < 35; shift += 7)
+	{
+		std::uint8_t value;
+		if (!source.read(&value, 1))
+			return false;
+
+		// The final byte may only have the 4 remaining bits.
+		if (shift == 28 && value > 0xF)
+			return false;
+
+		outValue |= static_cast<std::uint32_t>(value & 0x7F) << shift;
+		if (!(value & 0x80))
+			return true;
+	}
+
+	return false;
+}
+
+// Tracks how far the decoded output is ahead of the encoded input to ensure in-place decoding is
+// safe.
+class SpirVEncodeState
+{
+public:
+	SpirVEncodeState(const std::uint8_t* outStart)
+		: m_outStart(outStart)
+		, m_wordCount(0)
+		, m_maxDeficit(0)
+	{
+	}
+
+	void wordWritten(const std::uint8_t* outData)
+	{
+		++m_wordCount;
+		std::ptrdiff_t deficit = static_cast<std::ptrdiff_t>(m_wordCount*sizeof(std::uint32_t)) -
+			(outData - m_outStart);
+		if (deficit > m_maxDeficit)
+			m_maxDeficit = deficit;
+	}
+
+	std::ptrdiff_t getMaxDeficit() const
+	{
+		return m_maxDeficit;
+	}
+
+private:
+	const std::uint8_t* m_outStart;
+	std::size_t m_wordCount;
+	std::ptrdiff_t m_maxDeficit;
+};
+
+} // namespace detail
+
+// Gets the maximum size of the encoded data for an input size.
+inline std::size_t encodedSpirVSizeBound(std::size_t size)
+{
+	// The first word of each instruction may take 6 bytes and other words 5 bytes.
+	return size/sizeof(std::uint32_t)*6;
+}
+
+// Encodes SPIR-V into outData, which must have at least encodedSpirVSizeBound(size) bytes. The
+// SPIR-V words are little endian. Returns the size of the encoded data, or 0 if the data isn't
+// valid SPIR-V or the encoded data isn't smaller.
+inline std::size_t encodeSpirV(std::uint8_t* outData, const void* data, std::size_t size)
+{
+	using namespace detail;
+	const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(data);
+	if (size % sizeof(std::uint32_t) != 0 || size < spirVHeaderWords*sizeof(std::uint32_t) ||
+		readSpirVWord(bytes) != spirVMagic)
+	{
+		return 0;
+	}
+
+	std::uint8_t* outStart = outData;
+	SpirVEncodeState state(outStart);
+	std::size_t wordCount = size/sizeof(std::uint32_t);
+	for (std::size_t i = 0; i < spirVHeaderWords; ++i)
+	{
+		outData = writeVarint(outData, readSpirVWord(bytes + i*sizeof(std::uint32_t)));
+		state.wordWritten(outData);
+	}
+
+	std::uint32_t history[spirVHistorySlots][spirVHistoryOperands] = {};
+	for (std::size_t i = spirVHeaderWords; i < wordCount;)
+	{
+		std::uint32_t firstWord = readSpirVWord(bytes + i*sizeof(std::uint32_t));
+		std::uint32_t opcode = firstWord & spirVOpcodeMask;
+		std::uint32_t instructionWords = firstWord >> spirVWordCountShift;
+		if (instructionWords == 0 || instructionWords > wordCount - i)
+			return 0;
+
+		std::uint32_t length = instructionWords - 1;
+		std::uint32_t inlineLength = length < spirVMaxInlineLength ? length : spirVMaxInlineLength;
+		outData = writeVarint(outData, opcode << spirVLengthBits | inlineLength);
+		if (inlineLength == spirVMaxInlineLength)
+			outData = writeVarint(outData, length - spirVMaxInlineLength);
+		state.wordWritten(outData);
+
+		const std::uint8_t* operands = bytes + (i + 1)*sizeof(std::uint32_t);
+		if (isSpirVStringOpcode(opcode))
+		{
+			for (std::uint32_t j = 0; j < length; ++j)
+			{
+				for (unsigned int k = 0; k < sizeof(std::uint32_t); ++k)
+					*outData++ = operands[j*sizeof(std::uint32_t) + k];
+				state.wordWritten(outData);
+			}
+		}
+		else
+		{
+			std::uint32_t* opcodeHistory = history[opcode % spirVHistorySlots];
+			std::uint32_t previous = 0;
+			for (std::uint32_t j = 0; j < length; ++j)
+			{
+				std::uint32_t value = readSpirVWord(operands + j*sizeof(std::uint32_t));
+				std::uint32_t predicted = j < spirVHistoryOperands ? opcodeHistory[j] : previous;
+				outData = writeVarint(outData, zigzagEncode(value - predicted));
+				state.wordWritten(outData);
+				if (j < spirVHistoryOperands)
+					opcodeHistory[j] = value;
+				previous = value;
+			}
+		}
+
+		i += instructionWords;
+	}
+
+	// When placed at the end of the output buffer, the decoder must never write past what it has
+	// read.
+	std::size_t encodedSize = outData - outStart;
+	if (encodedSize >= size ||
+		state.getMaxDeficit() > static_cast<std::ptrdiff_t>(size - encodedSize))
+	{
+		return 0;
+	}
+
+	return encodedSize;
+}
+
+// Decodes SPIR-V from source into outData, which is exactly outSize bytes. The SPIR-V words are
+// written as little endian. Source must provide the functions
+// bool read(void* outData, std::size_t size) and bool atEnd() const. Returns false if the encoded
+// data is invalid.
+//
+// The source may read from the end of outData, so only a single value is read from the source
+// before writing each word.
+template <typename Source>
+bool decodeSpirV(void* outData, std::size_t outSize, Source& source)
+{
+	using namespace detail;
+	std::uint8_t* bytes = reinterpret_cast<std::uint8_t*>(outData);
+	if (outSize % sizeof(std::uint32_t) != 0 || outSize < spirVHeaderWords*sizeof(std::uint32_t))
+		return false;
+
+	std::size_t wordCount = outSize/sizeof(std::uint32_t);
+	for (std::size_t i = 0; i < spirVHeaderWords; ++i)
+	{
+		std::uint32_t value;
+		if (!readVarint(value, source))
+			return false;
+		writeSpirVWord(bytes + i*sizeof(std::uint32_t), value);
+	}
+
+	std::uint32_t history[spirVHistorySlots][spirVHistoryOperands] = {};
+	for (std::size_t i = spirVHeaderWords; i < wordCount;)
+	{
+		std::uint32_t token;
+		if (!readVarint(token, source))
+			return false;
+
+		std::uint32_t opcode = token >> spirVLengthBits;
+		std::uint32_t length = token & spirVMaxInlineLength;
+		if (length == spirVMaxInlineLength)
+		{
+			std::uint32_t extraLength;
+			if (!readVarint(extraLength, source) || extraLength > wordCount)
+				return false;
+			length += extraLength;
+		}
+
+		if (opcode > spirVOpcodeMask || length >= wordCount - i)
+			return false;
+
+		std::uint8_t* instruction = bytes + i*sizeof(std::uint32_t);
+		writeSpirVWord(instruction, (length + 1) << spirVWordCountShift | opcode);
+		std::uint8_t* operands = instruction + sizeof(std::uint32_t);
+		if (isSpirVStringOpcode(opcode))
+		{
+			for (std::uint32_t j = 0; j < length; ++j)
+			{
+				std::uint8_t value[sizeof(std::uint32_t)];
+				if (!source.read(value, sizeof(value)))
+					return false;
+
+				for (unsigned int k = 0; k < sizeof(std::uint32_t); ++k)
+					operands[j*sizeof(std::uint32_t) + k] = value[k];
+			}
+		}
+		else
+		{
+			std::uint32_t* opcodeHistory = history[opcode % spirVHistorySlots];
+			std::uint32_t previous = 0;
+			for (std::uint32_t j = 0; j < length; ++j)
+			{
+				std::uint32_t delta;
+				if (!readVarint(delta, source))
+					return false;
+
+				std::uint32_t predicted = j < spirVHistoryOperands ? opcodeHistory[j] : previous;
+				std::uint32_t value = predicted + zigzagDecode(delta);
+				writeSpirVWord(operands + j*sizeof(std::uint32_t), value);
+				if (j < spirVHistoryOperands)
+					opcodeHistory[j] = value;
+				previous = value;
+			}
+		}
+
+		i += length + 1;
+	}
+
+	return source.atEnd();
+}
+
+} // namespace mslb
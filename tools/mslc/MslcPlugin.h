@@ -0,0 +1,176 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file
+ * @brief ABI for plugins loaded by mslc to transform shaders in-process.
+ *
+ * A plugin is a shared library passed to mslc with the --plugin option. It must export
+ * mslcPluginVersion() returning MSLC_PLUGIN_VERSION, and may export either or both of
+ * mslcTransformSpirV() and mslcTransformGlsl(). These are equivalent to the spirv-command and
+ * glsl-command-* configuration options, but are run without launching a process for each stage.
+ *
+ * Plugins should define MSLC_BUILD_PLUGIN before including this header so the functions are
+ * exported.
+ */
+
+/**
+ * @brief The version of the plugin ABI.
+ */
+#define MSLC_PLUGIN_VERSION 1
+
+#if defined(MSLC_BUILD_PLUGIN)
+#	if defined(_WIN32)
+#		define MSLC_PLUGIN_EXPORT __declspec(dllexport)
+#	else
+#		define MSLC_PLUGIN_EXPORT __attribute__((visibility("default")))
+#	endif
+#else
+#	define MSLC_PLUGIN_EXPORT
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Struct describing the stage being transformed.
+ */
+typedef struct mslcStageInfo
+{
+	/**
+	 * @brief The file the entry point was declared in.
+	 */
+	const char* fileName;
+
+	/**
+	 * @brief The line of the entry point declaration.
+	 */
+	size_t line;
+
+	/**
+	 * @brief The column of the entry point declaration.
+	 */
+	size_t column;
+
+	/**
+	 * @brief The stage being transformed. This uses the same values as mslStage.
+	 */
+	uint32_t stage;
+
+	/**
+	 * @brief The name of the entry point function.
+	 */
+	const char* entryPoint;
+
+	/**
+	 * @brief The name of the pipeline the stage belongs to.
+	 */
+	const char* pipeline;
+} mslcStageInfo;
+
+/**
+ * @brief Struct with the functions to report the result of a transform.
+ */
+typedef struct mslcTransformContext
+{
+	/**
+	 * @brief Opaque data to pass to the functions.
+	 */
+	void* userData;
+
+	/**
+	 * @brief Sets the transformed result, which is copied before returning.
+	 *
+	 * If this isn't called, the input will be used unchanged. For SPIR-V the size is in bytes
+	 * and must be a multiple of 4.
+	 */
+	void (*setResult)(void* userData, const void* data, size_t size);
+
+	/**
+	 * @brief Adds a message to the compiler output.
+	 *
+	 * Errors should be followed by returning false from the transform function.
+	 */
+	void (*addMessage)(void* userData, bool error, const char* message);
+} mslcTransformContext;
+
+/**
+ * @brief Function type for mslcPluginVersion().
+ * @return MSLC_PLUGIN_VERSION when the plugin was built.
+ */
+typedef uint32_t (*mslcPluginVersionFunction)(void);
+
+/**
+ * @brief Function type for mslcTransformSpirV().
+ * @param context The context to report the result with.
+ * @param stage The stage being transformed.
+ * @param spirv The SPIR-V words for the stage.
+ * @param wordCount The number of SPIR-V words.
+ * @return False if the transform failed.
+ */
+typedef bool (*mslcTransformSpirVFunction)(const mslcTransformContext* context,
+	const mslcStageInfo* stage, const uint32_t* spirv, size_t wordCount);
+
+/**
+ * @brief Function type for mslcTransformGlsl().
+ * @param context The context to report the result with.
+ * @param stage The stage being transformed.
+ * @param glsl The GLSL source for the stage. This is null-terminated.
+ * @param length The length of the GLSL source, excluding the null terminator.
+ * @return False if the transform failed.
+ */
+typedef bool (*mslcTransformGlslFunction)(const mslcTransformContext* context,
+	const mslcStageInfo* stage, const char* glsl, size_t length);
+
+/**
+ * @brief Gets the plugin ABI version the plugin was built with.
+ * @return MSLC_PLUGIN_VERSION.
+ */
+MSLC_PLUGIN_EXPORT uint32_t mslcPluginVersion(void);
+
+/**
+ * @brief Transforms the SPIR-V for a stage before cross-compiling.
+ * @param context The context to report the result with.
+ * @param stage The stage being transformed.
+ * @param spirv The SPIR-V words for the stage.
+ * @param wordCount The number of SPIR-V words.
+ * @return False if the transform failed.
+ */
+MSLC_PLUGIN_EXPORT bool mslcTransformSpirV(const mslcTransformContext* context,
+	const mslcStageInfo* stage, const uint32_t* spirv, size_t wordCount);
+
+/**
+ * @brief Transforms the GLSL for a stage for GLSL targets.
+ * @param context The context to report the result with.
+ * @param stage The stage being transformed.
+ * @param glsl The GLSL source for the stage. This is null-terminated.
+ * @param length The length of the GLSL source, excluding the null terminator.
+ * @return False if the transform failed.
+ */
+MSLC_PLUGIN_EXPORT bool mslcTransformGlsl(const mslcTransformContext* context,
+	const mslcStageInfo* stage, const char* glsl, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2025 Aaron Barany
+ * Copyright 2016-2026 Aaron Barany
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,20 +17,207 @@
 #include <MSL/Compile/CompiledResult.h>
 #include <MSL/Compile/Output.h>
 #include <MSL/Compile/TargetGlsl.h>
+#include <MSL/Compile/TargetGroup.h>
 #include <MSL/Compile/TargetMetal.h>
 #include <MSL/Compile/TargetSpirV.h>
+#include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/replace.hpp>
+#include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/program_options.hpp>
 #include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <unordered_map>
 
+#include "MslcPlugin.h"
+
+#if MSL_WINDOWS
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
 using namespace boost::program_options;
 
+// Shared library with in-process transforms. The library is kept loaded for the lifetime of the
+// plugin.
+class Plugin
+{
+public:
+	Plugin() = default;
+	Plugin(const Plugin&) = delete;
+	Plugin& operator=(const Plugin&) = delete;
+
+	~Plugin()
+	{
+		if (!m_handle)
+			return;
+
+#if MSL_WINDOWS
+		FreeLibrary(reinterpret_cast<HMODULE>(m_handle));
+#else
+		dlclose(m_handle);
+#endif
+	}
+
+	bool load(const std::string& path)
+	{
+#if MSL_WINDOWS
+		m_handle = LoadLibraryA(path.c_str());
+#else
+		m_handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+		if (!m_handle)
+		{
+			std::cerr << "error: could not load plugin: " << path << std::endl;
+			return false;
+		}
+
+		auto version = reinterpret_cast<mslcPluginVersionFunction>(
+			findSymbol("mslcPluginVersion"));
+		if (!version || version() != MSLC_PLUGIN_VERSION)
+		{
+			std::cerr << "error: plugin has an incompatible version: " << path << std::endl;
+			return false;
+		}
+
+		transformSpirV = reinterpret_cast<mslcTransformSpirVFunction>(
+			findSymbol("mslcTransformSpirV"));
+		transformGlsl = reinterpret_cast<mslcTransformGlslFunction>(
+			findSymbol("mslcTransformGlsl"));
+		if (!transformSpirV && !transformGlsl)
+		{
+			std::cerr << "error: plugin doesn't have any transform functions: " << path <<
+				std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	mslcTransformSpirVFunction transformSpirV = nullptr;
+	mslcTransformGlslFunction transformGlsl = nullptr;
+
+private:
+	void* findSymbol(const char* name)
+	{
+#if MSL_WINDOWS
+		return reinterpret_cast<void*>(
+			GetProcAddress(reinterpret_cast<HMODULE>(m_handle), name));
+#else
+		return dlsym(m_handle, name);
+#endif
+	}
+
+	void* m_handle = nullptr;
+};
+
+using PluginList = std::vector<std::unique_ptr<Plugin>>;
+
+// State passed through mslcTransformContext while running a plugin transform.
+struct TransformState
+{
+	msl::Output& output;
+	const msl::Target::StageInfo& stage;
+	std::vector<char> result;
+	bool hasResult;
+};
+
+static void setTransformResult(void* userData, const void* data, std::size_t size)
+{
+	auto state = reinterpret_cast<TransformState*>(userData);
+	const char* charData = reinterpret_cast<const char*>(data);
+	state->result.assign(charData, charData + size);
+	state->hasResult = true;
+}
+
+static void addTransformMessage(void* userData, bool error, const char* message)
+{
+	auto state = reinterpret_cast<TransformState*>(userData);
+	state->output.addMessage(error ? msl::Output::Level::Error : msl::Output::Level::Warning,
+		state->stage.fileName, state->stage.line, state->stage.column, false, message);
+}
+
+static void setPluginTransforms(msl::Target& target, const PluginList& plugins)
+{
+	bool hasSpirVTransform = false;
+	bool hasGlslTransform = false;
+	for (const std::unique_ptr<Plugin>& plugin : plugins)
+	{
+		hasSpirVTransform |= plugin->transformSpirV != nullptr;
+		hasGlslTransform |= plugin->transformGlsl != nullptr;
+	}
+
+	// Plugins are run in the order they were provided, each on the result of the previous.
+	if (hasSpirVTransform)
+	{
+		target.setSpirVTransform([&plugins](std::vector<std::uint32_t>& spirv,
+			msl::Output& output, const msl::Target::StageInfo& stage)
+			{
+				mslcStageInfo stageInfo = {stage.fileName.c_str(), stage.line, stage.column,
+					static_cast<std::uint32_t>(stage.stage), stage.entryPoint.c_str(),
+					stage.pipeline.c_str()};
+				for (const std::unique_ptr<Plugin>& plugin : plugins)
+				{
+					if (!plugin->transformSpirV)
+						continue;
+
+					TransformState state = {output, stage, {}, false};
+					mslcTransformContext context = {&state, &setTransformResult,
+						&addTransformMessage};
+					if (!plugin->transformSpirV(&context, &stageInfo, spirv.data(), spirv.size()))
+						return false;
+
+					if (!state.hasResult)
+						continue;
+
+					if (state.result.size() % sizeof(std::uint32_t) != 0)
+					{
+						output.addMessage(msl::Output::Level::Error, stage.fileName, stage.line,
+							stage.column, false, "plugin output invalid spir-v");
+						return false;
+					}
+
+					spirv.resize(state.result.size()/sizeof(std::uint32_t));
+					std::memcpy(spirv.data(), state.result.data(), state.result.size());
+				}
+				return true;
+			});
+	}
+
+	auto glslTarget = dynamic_cast<msl::TargetGlsl*>(&target);
+	if (hasGlslTransform && glslTarget)
+	{
+		glslTarget->setGlslTransform([&plugins](std::string& glsl, msl::Output& output,
+			const msl::Target::StageInfo& stage)
+			{
+				mslcStageInfo stageInfo = {stage.fileName.c_str(), stage.line, stage.column,
+					static_cast<std::uint32_t>(stage.stage), stage.entryPoint.c_str(),
+					stage.pipeline.c_str()};
+				for (const std::unique_ptr<Plugin>& plugin : plugins)
+				{
+					if (!plugin->transformGlsl)
+						continue;
+
+					TransformState state = {output, stage, {}, false};
+					mslcTransformContext context = {&state, &setTransformResult,
+						&addTransformMessage};
+					if (!plugin->transformGlsl(&context, &stageInfo, glsl.c_str(), glsl.size()))
+						return false;
+
+					if (state.hasResult)
+						glsl.assign(state.result.begin(), state.result.end());
+				}
+				return true;
+			});
+	}
+}
+
 static const char* programName(const char* programPath)
 {
 	std::size_t length = std::strlen(programPath);
@@ -328,7 +515,20 @@ static std::unique_ptr<msl::Target> createMetalTarget(const std::string& targetN
 		return nullptr;
 	}
 
-	return std::unique_ptr<msl::Target>(new msl::TargetMetal(version, platform));
+	std::unique_ptr<msl::TargetMetal> target(new msl::TargetMetal(version, platform));
+	if (config.count("metal-toolchain"))
+		target->setToolchainCommand(config["metal-toolchain"].as<std::string>());
+
+	if (config.count("metal-shared-library"))
+		target->setSharedLibrary(config["metal-shared-library"].as<bool>());
+
+	if (config.count("metal-source-only"))
+		target->setSourceOnly(config["metal-source-only"].as<bool>());
+
+	if (config.count("metal-argument-buffers"))
+		target->setArgumentBuffers(config["metal-argument-buffers"].as<bool>());
+
+	return std::move(target);
 }
 
 static std::pair<std::string, std::string> splitDefineString(const std::string& str)
@@ -348,6 +548,54 @@ static std::pair<std::string, std::string> splitDefineString(const std::string&
 	return definePair;
 }
 
+static bool isIdentifier(const std::string& str)
+{
+	if (str.empty() || (!std::isalpha(static_cast<unsigned char>(str[0])) && str[0] != '_'))
+		return false;
+
+	return std::all_of(str.begin() + 1, str.end(), [](char c)
+		{
+			return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+		});
+}
+
+static bool addVariantKeyword(msl::Target& target, const std::string& str,
+	const std::string& errorPrefix)
+{
+	auto variantPair = splitDefineString(str);
+	std::vector<std::string> values;
+	boost::algorithm::split(values, variantPair.second, boost::algorithm::is_any_of(","));
+	for (std::string& value : values)
+		boost::algorithm::trim(value);
+
+	if (variantPair.first.empty() || variantPair.second.empty())
+	{
+		std::cerr << errorPrefix << "error: invalid variant: " << str << std::endl << std::endl;
+		return false;
+	}
+
+	// The keyword is set as a define, so it must be usable as a macro name.
+	if (!isIdentifier(variantPair.first))
+	{
+		std::cerr << errorPrefix << "error: variant keyword isn't a valid identifier: " <<
+			variantPair.first << std::endl << std::endl;
+		return false;
+	}
+
+	for (const msl::Target::VariantKeyword& keyword : target.getVariantKeywords())
+	{
+		if (keyword.name == variantPair.first)
+		{
+			std::cerr << errorPrefix << "error: variant declared multiple times: " <<
+				variantPair.first << std::endl << std::endl;
+			return false;
+		}
+	}
+
+	target.addVariantKeyword(std::move(variantPair.first), std::move(values));
+	return true;
+}
+
 static bool setCommonTargetConfig(msl::Target& target, const variables_map& options,
 	const variables_map& config, const std::string& configFilePath)
 {
@@ -397,6 +645,9 @@ static bool setCommonTargetConfig(msl::Target& target, const variables_map& opti
 	if (config.count("spirv-command"))
 		target.setSpirVToolCommand(config["spirv-command"].as<std::string>());
 
+	if (config.count("batch-commands"))
+		target.setBatchToolCommands(config["batch-commands"].as<bool>());
+
 	// Add inlcudes and defines.
 	if (options.count("include"))
 	{
@@ -424,6 +675,25 @@ static bool setCommonTargetConfig(msl::Target& target, const variables_map& opti
 		}
 	}
 
+	// Variant keywords
+	if (options.count("variant"))
+	{
+		for (const std::string& str : options["variant"].as<std::vector<std::string>>())
+		{
+			if (!addVariantKeyword(target, str, ""))
+				return false;
+		}
+	}
+
+	if (config.count("variant"))
+	{
+		for (const std::string& str : config["variant"].as<std::vector<std::string>>())
+		{
+			if (!addVariantKeyword(target, str, configFilePath + " "))
+				return false;
+		}
+	}
+
 	if (config.count("pre-header-line"))
 	{
 		for (const std::string& str : config["pre-header-line"].as<std::vector<std::string>>())
@@ -439,6 +709,38 @@ static bool setCommonTargetConfig(msl::Target& target, const variables_map& opti
 	if (config.count("adjustable-bindings"))
 		target.setAdjustableBindings(config["adjustable-bindings"].as<bool>());
 
+	if (config.count("shader-alignment"))
+	{
+		unsigned int alignment = config["shader-alignment"].as<unsigned int>();
+		if (!target.setShaderAlignment(alignment))
+		{
+			std::cerr << configFilePath << " error: invalid shader alignment: " << alignment <<
+				std::endl << std::endl;
+			return false;
+		}
+	}
+
+	if (config.count("sectioned"))
+		target.setSectionedModules(config["sectioned"].as<bool>());
+
+	if (config.count("encode-spirv"))
+		target.setEncodeSpirV(config["encode-spirv"].as<bool>());
+
+	if (config.count("compression"))
+	{
+		std::string compression = config["compression"].as<std::string>();
+		if (compression == "none")
+			target.setCompression(msl::Target::Compression::None);
+		else if (compression == "lz4")
+			target.setCompression(msl::Target::Compression::LZ4);
+		else
+		{
+			std::cerr << configFilePath << " error: unknown compression: " << compression <<
+				std::endl << std::endl;
+			return false;
+		}
+	}
+
 	target.setStripDebug(options.count("strip") > 0);
 	if (options.count("optimize"))
 	{
@@ -449,62 +751,68 @@ static bool setCommonTargetConfig(msl::Target& target, const variables_map& opti
 			target.setOptimize(msl::Target::Optimize::Full);
 	}
 
+	if (options.count("pipeline"))
+	{
+		for (const std::string& pipeline : options["pipeline"].as<std::vector<std::string>>())
+			target.addPipelineFilter(pipeline);
+	}
+
+	if (options.count("command-cache"))
+		target.setCommandCacheDirectory(options["command-cache"].as<std::string>());
+
 	return true;
 }
 
-static void printOutput(msl::Output& output, bool printWarnings)
+static void printMessage(const msl::Output::Message& message, bool printWarnings)
 {
 	const char* continueStr = "note: ";
-	for (const msl::Output::Message& message : output.getMessages())
+	std::ostream* stream;
+	const char* levelStr;
+	switch (message.level)
 	{
-		std::ostream* stream;
-		const char* levelStr;
-		switch (message.level)
-		{
-			case msl::Output::Level::Error:
-				levelStr = "error: ";
-				stream = &std::cerr;
-				break;
-			case msl::Output::Level::Warning:
-				if (!printWarnings)
-					continue;
-				levelStr = "warning: ";
-				stream = &std::cerr;
-				break;
-			case msl::Output::Level::Info:
-				levelStr = "note: ";
-				stream = &std::cout;
-				break;
-			default:
-				continue;
-		}
+		case msl::Output::Level::Error:
+			levelStr = "error: ";
+			stream = &std::cerr;
+			break;
+		case msl::Output::Level::Warning:
+			if (!printWarnings)
+				return;
+			levelStr = "warning: ";
+			stream = &std::cerr;
+			break;
+		case msl::Output::Level::Info:
+			levelStr = "note: ";
+			stream = &std::cout;
+			break;
+		default:
+			return;
+	}
 
-		if (message.continued)
-			levelStr = continueStr;
+	if (message.continued)
+		levelStr = continueStr;
 
-		// Try to emulate the formatting of the host compiler.
-		if (!message.file.empty())
+	// Try to emulate the formatting of the host compiler.
+	if (!message.file.empty())
+	{
+		*stream << message.file;
+		if (message.line > 0)
 		{
-			*stream << message.file;
-			if (message.line > 0)
-			{
 #if MSL_MSC
-				*stream << "(" << message.line;
-				if (message.column > 0)
-					*stream << "," << message.column;
-				*stream << ")";
+			*stream << "(" << message.line;
+			if (message.column > 0)
+				*stream << "," << message.column;
+			*stream << ")";
 #else
-				*stream << ":" << message.line;
-				if (message.column > 0)
-					*stream << ":" << message.column;
+			*stream << ":" << message.line;
+			if (message.column > 0)
+				*stream << ":" << message.column;
 #endif
-			}
-
-			*stream << ": ";
 		}
 
-		*stream << levelStr << message.message << std::endl;
+		*stream << ": ";
 	}
+
+	*stream << levelStr << message.message << std::endl;
 }
 
 int main(int argc, char** argv)
@@ -514,10 +822,13 @@ int main(int argc, char** argv)
 	mainOptions.add_options()
 		("help,h", "display this help message")
 		("version,v", "print the version number and exit")
-		("config,c", value<std::string>()->required(), "configuration file describing the target")
+		("config,c", value<std::vector<std::string>>()->required(), "configuration file "
+			"describing the target. Multiple configurations may be provided to compile for "
+			"multiple targets at once, sharing work between them, with one output for each.")
 		("input,i", value<std::vector<std::string>>()->required(), "input file to compile. "
 			"Multiple inputs may be provided to compile into a single module.")
-		("output,o", value<std::string>()->required(), "output file for the compiled result")
+		("output,o", value<std::vector<std::string>>()->required(), "output file for the compiled "
+			"result. One output must be provided for each configuration, in the same order.")
 		("include,I", value<std::vector<std::string>>(), "directory to search for includes")
 		("define,D", value<std::vector<std::string>>(), "add a define for the preprocessor. A "
 			"value may optionally be assigned with =. (i.e. -D DEFINE=val)")
@@ -526,7 +837,19 @@ int main(int argc, char** argv)
 		("strip,s", "strip debug symbols")
 		("optimize,O", value<unsigned int>(), "optimize the compiled result. An integer value "
 			"(1, 2) determines the optimization level. If not provided, the maximum level will be "
-			"used.");
+			"used.")
+		("variant,V", value<std::vector<std::string>>(), "compile a variant of each pipeline for "
+			"each value of a keyword, set as a define. Values are separated by commas. (i.e. "
+			"-V SHADOWS=0,1) Multiple keywords will compile every permutation into the module.")
+		("pipeline,p", value<std::vector<std::string>>(), "only compile pipelines matching the "
+			"name. Wildcards * and ? may be used. Multiple names may be provided. Other pipelines "
+			"are still validated.")
+		("command-cache", value<std::string>(), "directory to cache the results of external "
+			"commands in, such as spirv-command, glsl-command-*, and building Metal libraries. "
+			"Commands with the same input will re-use the cached result.")
+		("plugin,P", value<std::vector<std::string>>(), "shared library implementing the mslc "
+			"plugin interface to transform the SPIR-V or GLSL in-process. Multiple plugins are run "
+			"in order.");
 
 	options_description configOptions("options in target configuration file");
 	configOptions.add_options()
@@ -537,17 +860,33 @@ int main(int argc, char** argv)
 			"Metal.")
 		("define", value<std::vector<std::string>>(), "add a define for the preprocessor. A value "
 			"may optionally be assigned with =. (i.e. DEFINE=val)")
+		("variant", value<std::vector<std::string>>(), "compile a variant of each pipeline for "
+			"each value of a keyword, set as a define. Values are separated by commas. (i.e. "
+			"SHADOWS=0,1)")
 		("force-enable", value<std::vector<std::string>>(), "force a feature to be enabled")
 		("force-disable", value<std::vector<std::string>>(), "force a feature to be disabled")
 		("resources", value<std::string>(), "a path to a file describing custom resource limits. "
 			"This uses the same format as glslangValidator.")
 		("spirv-command", value<std::string>(), "external command to run on the intermediate "
 			"SPIR-V. The string $input will be replaced by the input file path, while the string "
-			"$output will be replaced by the output file path.")
+			"$output will be replaced by the output file path. "
+			"Either may be omitted to use stdin or stdout instead.")
+		("batch-commands", value<bool>(), "run spirv-command and glsl-command-* once for all "
+			"stages of each file with a manifest of input and output paths rather than once for "
+			"each stage")
 		("remap-variables", value<bool>(), "remap variable ranges to improve compression of SPIR-V")
 		("dummy-bindings", value<bool>(), "add dummy bindings in SPIR-V to be changed later")
 		("adjustable-bindings", value<bool>(), "allow uniform bindings to be adjusted in-place "
 			"with SPIR-V; this also enables dummy-bindings")
+		("shader-alignment", value<unsigned int>(), "the alignment in bytes of the data for each "
+			"shader in the output module. Must be a power of two between 4 and 65536. Defaults to "
+			"4.")
+		("sectioned", value<bool>(), "save the data for each shader in a separate section after "
+			"the reflection info so the client can load shaders on demand")
+		("compression", value<std::string>(), "how to compress the data for each shader. "
+			"Possible values are: none, lz4. Defaults to none.")
+		("encode-spirv", value<bool>(), "use a compact encoding for SPIR-V to reduce its size and "
+			"improve compression")
 		("remap-depth-range", value<bool>(), "boolean for whether or not to remap the depth range "
 			"from [0, 1] to [-1, 1] in the  vertex shader output for GLSL or Metal targets. "
 			"Defaults to false.")
@@ -588,22 +927,39 @@ int main(int argc, char** argv)
 			"for GLSL targets. This will be used for the compute stage.")
 		("glsl-command-vert", value<std::string>(), "external command to run on GLSL targets "
 			"for the vertex stage. The string $input will be replaced by the input file path, "
-			"while the string $output will be replaced by the output file path.")
+			"while the string $output will be replaced by the output file path. "
+			"Either may be omitted to use stdin or stdout instead.")
 		("glsl-command-tess-ctrl", value<std::string>(), "external command to run on GLSL targets "
 			"for the tessellation control stage. The string $input will be replaced by the input "
-			"file path, while the string $output will be replaced by the output file path.")
+			"file path, while the string $output will be replaced by the output file path. "
+			"Either may be omitted to use stdin or stdout instead.")
 		("glsl-command-tess-eval", value<std::string>(), "external command to run on GLSL targets "
 			"for the tessellation evaluation stage. The string $input will be replaced by the "
-			"input file path, while the string $output will be replaced by the output file path.")
+			"input file path, while the string $output will be replaced by the output file path. "
+			"Either may be omitted to use stdin or stdout instead.")
 		("glsl-command-geom", value<std::string>(), "external command to run on GLSL targets for "
 			"the vertex stage. The string $input will be replaced by the input file path, while "
-			"the string $output will be replaced by the output file path.")
+			"the string $output will be replaced by the output file path. "
+			"Either may be omitted to use stdin or stdout instead.")
 		("glsl-command-frag", value<std::string>(), "external command to run on GLSL targets for "
 			"the fragment stage. The string $input will be replaced by the input file path, while "
-			"the string $output will be replaced by the output file path.")
+			"the string $output will be replaced by the output file path. "
+			"Either may be omitted to use stdin or stdout instead.")
 		("glsl-command-comp", value<std::string>(), "external command to run on GLSL targets for "
 			"the compute stage. The string $input will be replaced by the input file path, while "
-			"the string $output will be replaced by the output file path.");
+			"the string $output will be replaced by the output file path. "
+			"Either may be omitted to use stdin or stdout instead.")
+		("metal-toolchain", value<std::string>(), "command prefix to run the Metal tools with for "
+			"Metal targets. Defaults to xcrun with the SDK for the platform.")
+		("metal-shared-library", value<bool>(), "boolean for whether or not to link all shaders "
+			"into a single library for Metal targets, compiling the shaders in parallel. Defaults "
+			"to false.")
+		("metal-source-only", value<bool>(), "boolean for whether or not to output the Metal "
+			"source to compile at runtime rather than running the Metal tools for Metal targets. "
+			"Defaults to false.")
+		("metal-argument-buffers", value<bool>(), "boolean for whether or not to place the "
+			"uniforms for each shader in an argument buffer for Metal targets. Requires Metal 2.0 "
+			"or later. Defaults to false.");
 
 	positional_options_description positionalOptions;
 	positionalOptions.add("input", -1);
@@ -630,52 +986,97 @@ int main(int argc, char** argv)
 	bool printHelp = options.count("help") > 0 || argc <= 1;
 	bool printVersion = options.count("version") > 0;
 
-	// Parse the config file.
-	variables_map config;
-	std::string configFilePath;
+	// Parse the config files.
+	std::vector<std::string> configFilePaths;
+	std::vector<variables_map> configs;
 	if (exitCode == 0 && !printHelp && !printVersion)
 	{
-		configFilePath = options["config"].as<std::string>();
-		try
+		configFilePaths = options["config"].as<std::vector<std::string>>();
+		if (configFilePaths.size() != options["output"].as<std::vector<std::string>>().size())
 		{
-			store(parse_config_file<char>(configFilePath.c_str(), configOptions), config);
-			notify(config);
-		}
-		catch (std::exception& e)
-		{
-			std::cerr << configFilePath << " error: " << e.what() << std::endl;
+			std::cerr << "error: the number of outputs must match the number of configurations" <<
+				std::endl;
 			exitCode = 1;
 		}
 	}
 
-	// Create the target and set the options.
-	std::unique_ptr<msl::Target> target;
 	if (exitCode == 0 && !printHelp && !printVersion)
 	{
-		std::string targetName = config["target"].as<std::string>();
-		if (targetName == "spirv")
-			target = createSpirVTarget(targetName, config, configFilePath);
-		else if (targetName == "glsl" || targetName== "glsl-es")
-			target = createGlslTarget(targetName, config, configFilePath);
-		else if (targetName == "metal-osx" || targetName == "metal-macos" ||
-			targetName == "metal-ios" || targetName == "metal-ios-simulator")
+		configs.resize(configFilePaths.size());
+		for (std::size_t i = 0; i < configFilePaths.size(); ++i)
 		{
-			target = createMetalTarget(targetName, config, configFilePath);
+			try
+			{
+				store(parse_config_file<char>(configFilePaths[i].c_str(), configOptions),
+					configs[i]);
+				notify(configs[i]);
+			}
+			catch (std::exception& e)
+			{
+				std::cerr << configFilePaths[i] << " error: " << e.what() << std::endl;
+				exitCode = 1;
+			}
 		}
-		else
+	}
+
+	// Load the plugins before the targets so they outlive them.
+	PluginList plugins;
+	if (exitCode == 0 && !printHelp && !printVersion && options.count("plugin"))
+	{
+		for (const std::string& path : options["plugin"].as<std::vector<std::string>>())
 		{
-			std::cerr << "error: unkown target: " << targetName << std::endl;
-			exitCode = 1;
+			std::unique_ptr<Plugin> plugin(new Plugin);
+			if (!plugin->load(path))
+			{
+				exitCode = 1;
+				break;
+			}
+			plugins.push_back(std::move(plugin));
 		}
+	}
 
-		if (!target || !setCommonTargetConfig(*target, options, config, configFilePath))
-			exitCode = 1;
+	// Create the targets and set the options.
+	std::vector<std::unique_ptr<msl::Target>> targets;
+	msl::TargetGroup targetGroup;
+	if (exitCode == 0 && !printHelp && !printVersion)
+	{
+		for (std::size_t i = 0; i < configs.size() && exitCode == 0; ++i)
+		{
+			const variables_map& config = configs[i];
+			const std::string& configFilePath = configFilePaths[i];
+			std::unique_ptr<msl::Target> target;
+			std::string targetName = config["target"].as<std::string>();
+			if (targetName == "spirv")
+				target = createSpirVTarget(targetName, config, configFilePath);
+			else if (targetName == "glsl" || targetName== "glsl-es")
+				target = createGlslTarget(targetName, config, configFilePath);
+			else if (targetName == "metal-osx" || targetName == "metal-macos" ||
+				targetName == "metal-ios" || targetName == "metal-ios-simulator")
+			{
+				target = createMetalTarget(targetName, config, configFilePath);
+			}
+			else
+			{
+				std::cerr << "error: unkown target: " << targetName << std::endl;
+				exitCode = 1;
+			}
+
+			if (!target || !setCommonTargetConfig(*target, options, config, configFilePath))
+			{
+				exitCode = 1;
+				break;
+			}
+
+			setPluginTransforms(*target, plugins);
+			targetGroup.addTarget(*target);
+			targets.push_back(std::move(target));
+		}
 	}
 
 	if (printHelp)
 	{
-		std::cout << "Usage: mslc [options] -c config -o output file1 [file2...]" << std::endl <<
-			std::endl;
+		std::cout << "Usage: mslc [options] -c config -o output [-c config2 -o output2...] file1 "
+			"[file2...]" << std::endl << std::endl;
 		std::cout << "Version " << MSL_MAJOR_VERSION << "." << MSL_MINOR_VERSION << "." <<
 			MSL_PATCH_VERSION << std::endl;
 		std::cout << "Compile one or more shader source files into a shader module." << std::endl <<
@@ -723,27 +1124,38 @@ int main(int argc, char** argv)
 		return exitCode;
 	}
 
-	msl::Output output;
-	msl::CompiledResult result;
+	// Print messages as they're reported rather than after all inputs are compiled.
+	bool printWarnings = options.count("warn-none") == 0;
+	msl::Output output([printWarnings](const msl::Output::Message& message)
+		{
+			printMessage(message, printWarnings);
+		});
+	std::vector<msl::CompiledResult> results;
 	for (const std::string& input : options["input"].as<std::vector<std::string>>())
 	{
-		if (!target->compile(result, output, input))
+		if (!targetGroup.compile(results, output, input))
 		{
 			exitCode = 2;
 			break;
 		}
 	}
 
+	if (exitCode == 0 && options.count("pipeline") && results.front().getPipelines().empty())
+	{
+		output.addMessage(msl::Output::Level::Error, "", 0, 0, false,
+			"no pipelines matched the pipeline filters");
+		exitCode = 2;
+	}
+
 	if (exitCode == 0)
 	{
-		if (!target->finish(result, output))
+		if (!targetGroup.finish(results, output))
 			exitCode = 2;
 	}
 
 	if (output.getErrorCount() > 0)
 		exitCode = 2;
 
-	printOutput(output, options.count("warn-none") == 0);
 	if (options.count("warn-error") && output.getWarningCount() > 0)
 	{
 		std::cerr << "error: warnings treated as errors" << std::endl;
@@ -756,13 +1168,17 @@ int main(int argc, char** argv)
 		return exitCode;
 	}
 
-	std::string outputFile = options["output"].as<std::string>();
-	if (!result.save(outputFile))
+	const std::vector<std::string>& outputFiles = options["output"].as<std::vector<std::string>>();
+	for (std::size_t i = 0; i < results.size(); ++i)
 	{
-		std::cerr << "error: could not write output file: " << outputFile << std::endl;
-		return 4;
+		if (!results[i].save(outputFiles[i]))
+		{
+			std::cerr << "error: could not write output file: " << outputFiles[i] << std::endl;
+			return 4;
+		}
+
+		std::cout << "output shader module to " << outputFiles[i] << std::endl;
 	}
 
-	std::cout << "output shader module to " << outputFile << std::endl;
 	return exitCode;
 }
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2026 Aaron Barany
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define MSLC_BUILD_PLUGIN
+#include "MslcPlugin.h"
+#include <stdlib.h>
+#include <string.h>
+
+uint32_t mslcPluginVersion(void)
+{
+	return MSLC_PLUGIN_VERSION;
+}
+
+bool mslcTransformSpirV(const mslcTransformContext* context, const mslcStageInfo* stage,
+	const uint32_t* spirv, size_t wordCount)
+{
+	if (!stage->pipeline || !*stage->pipeline)
+	{
+		context->addMessage(context->userData, true, "missing pipeline passed to plugin");
+		return false;
+	}
+
+	// Check for the SPIR-V magic number and otherwise leave the input unchanged.
+	if (wordCount == 0 || spirv[0] != 0x07230203)
+	{
+		context->addMessage(context->userData, true, "invalid SPIR-V passed to plugin");
+		return false;
+	}
+
+	return true;
+}
+
+bool mslcTransformGlsl(const mslcTransformContext* context, const mslcStageInfo* stage,
+	const char* glsl, size_t length)
+{
+	static const char comment[] = "// Transformed by the test plugin.\n";
+	size_t commentLength = sizeof(comment) - 1;
+	char* result;
+
+	(void)stage;
+
+	result = (char*)malloc(length + commentLength);
+	if (!result)
+		return false;
+
+	memcpy(result, glsl, length);
+	memcpy(result + length, comment, commentLength);
+	context->setResult(context->userData, result, length + commentLength);
+	free(result);
+	return true;
+}